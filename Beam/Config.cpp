@@ -0,0 +1,131 @@
+/* ===========================================================================
+
+	Project: Beam AI player for Blokus
+
+	Description:
+	  Engine parameters read from the config file at startup, including the
+	  heuristic weights, with the bounds and step sizes used for tuning.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Standard Includes
+#include "Includes.h"
+
+// Include header
+#include "Config.h"
+
+// Engine parameter defaults
+float Config::engine[nEngineParameters] = {
+	2,				// Minimum search depth
+	MAX_DEPTH,		// Maximum search depth
+	3.0f,			// Search time after which deepening stops
+	TRUE,			// Beam search enabled
+	FALSE,			// Beam verification enabled
+	20, 12, 8, 6,	// Beam width by distance from the root, 0 for full width
+	1, 3,			// Region heuristic influence and score weights
+	3, 1			// Spaces heuristic liberty space and score weights
+};
+
+// Parameter count
+const int Config::nParameters = nEngineParameters + nWeights;
+
+// Parameter names, bounds and tuning step sizes
+const Config::Parameter Config::parameter[nParameters] = {
+	{ "Min_Search_Depth",	 &engine[pMinDepth],		   1, MAX_DEPTH,  0.0f },
+	{ "Max_Search_Depth",	 &engine[pMaxDepth],		   1, MAX_DEPTH,  0.0f },
+	{ "Search_Time",		 &engine[pSearchTime],		   0,     60.0f,  0.0f },
+	{ "Beam_Search",		 &engine[pBeamSearch],		   0,      1.0f,  0.0f },
+	{ "Beam_Verify",		 &engine[pBeamVerify],		   0,      1.0f,  0.0f },
+	{ "Beam_Width_0",		 &engine[pBeamWidth0],		   0,    100.0f,  2.0f },
+	{ "Beam_Width_1",		 &engine[pBeamWidth1],		   0, BEAM_MAX_WIDTH,  2.0f },
+	{ "Beam_Width_2",		 &engine[pBeamWidth2],		   0, BEAM_MAX_WIDTH,  1.0f },
+	{ "Beam_Width_3",		 &engine[pBeamWidth3],		   0, BEAM_MAX_WIDTH,  1.0f },
+	{ "Region_Weight_Areas", &engine[pRegionAreas],		   0,    100.0f,  0.5f },
+	{ "Region_Weight_Score", &engine[pRegionScore],		   0,    100.0f,  0.5f },
+	{ "Spaces_Weight_Areas", &engine[pSpacesAreas],		   0,    100.0f,  0.5f },
+	{ "Spaces_Weight_Score", &engine[pSpacesScore],		   0,    100.0f,  0.5f },
+	{ "Weight_Score",		 &Heuristic::weights[wScore],	 -1e4f, 1e4f, 10.0f },
+	{ "Weight_At_Move",		 &Heuristic::weights[wAtMove],	 -1e4f, 1e4f, 20.0f },
+	{ "Weight_Default",		 &Heuristic::weights[wDefault],	 -1e4f, 1e4f, 10.0f },
+	{ "Weight_Fighting",	 &Heuristic::weights[wFighting], -1e4f, 1e4f, 10.0f },
+	{ "Weight_Piece",		 &Heuristic::weights[wPiece],	 -1e4f, 1e4f,  2.0f },
+	{ "Weight_Move",		 &Heuristic::weights[wMove],	 -1e4f, 1e4f,  2.0f },
+	{ "Weight_Dist",		 &Heuristic::weights[wDist],	 -1e4f, 1e4f,  5.0f },
+	{ "Weight_Ang_Good",	 &Heuristic::weights[wAngGood],	 -1e4f, 1e4f,  5.0f },
+	{ "Weight_Ang_Bad",		 &Heuristic::weights[wAngBad],	 -1e4f, 1e4f,  5.0f },
+	{ "Weight_Leak",		 &Heuristic::weights[wLeak],	 -1e4f, 1e4f, 50.0f }
+};
+
+// --------------------------------------------------------
+//	Sets the value of a named parameter, clamped to the
+//  bounds of the parameter.
+// --------------------------------------------------------
+void Config::set( const std::string& name, float value )
+{
+	// Find the named parameter
+	int i = 0; while( i < nParameters && name != parameter[i].name ) i++;
+	if( i == nParameters ) throw "Unknown parameter in config file";
+
+	// Store the clamped value
+	*parameter[i].value = max( parameter[i].minimum, min( value, parameter[i].maximum ) );
+}
+//
+// --------------------------------------------------------
+//	Loads parameters from a config file. Parameters which
+//  are missing from the file keep their values.
+// --------------------------------------------------------
+void Config::load( const char* filename )
+{
+	// Open the specified file for reading
+	std::ifstream file( filename );
+	if( !file.is_open( ) ) throw "Could not open config file";
+
+	// Parse file using newline and space delimiters
+	std::string line; while( std::getline( file, line ) )
+	{
+		// Put line data onto stream for delimination
+		std::string token; std::stringstream iss; iss << line;
+		if( !(iss >> token) || token.substr( 0, 2 ) == "//" ) continue;
+
+		// Read the named parameter
+		float value; if( !(iss >> value) ) throw "Error parsing parameter value";
+		set( token, value );
+	}
+}
+//
+// --------------------------------------------------------
+//	Saves every parameter to a config file, overwriting
+//  an existing file if necessary.
+// --------------------------------------------------------
+void Config::save( const char* filename )
+{
+	// Open the specified file for rewriting
+	std::ofstream file( filename, std::ios::trunc );
+	if( !file.is_open( ) ) throw "Could not open config file";
+
+	// Write version header into the file
+	file << "// --------------------------------\n";
+	file << "//       Beam Engine Config\n";
+	file << "// --------------------------------\n\n";
+
+	// Write the named parameters
+	for( int i = 0; i < nParameters; i++ )
+		file << parameter[i].name << " " << *parameter[i].value << "\n";
+}
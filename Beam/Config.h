@@ -0,0 +1,71 @@
+/* ===========================================================================
+
+	Project: Beam AI player for Blokus
+
+	Description:
+	  Engine parameters read from the config file at startup, including the
+	  heuristic weights, with the bounds and step sizes used for tuning.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Include gaurds
+#ifndef CONFIG_H
+#define CONFIG_H
+
+// Maximum minimax search depth
+#define MAX_DEPTH 4
+
+// Maximum beam width of an interior node
+#define BEAM_MAX_WIDTH 16
+
+// Engine parameters
+enum EngineParameter { pMinDepth, pMaxDepth, pSearchTime, pBeamSearch, pBeamVerify,
+	pBeamWidth0, pBeamWidth1, pBeamWidth2, pBeamWidth3, pRegionAreas, pRegionScore,
+	pSpacesAreas, pSpacesScore, nEngineParameters };
+
+// Config namespace
+namespace Config {
+
+	// Named parameter, a step of zero excludes it from tuning
+	struct Parameter { const char* name; float* value;
+		float minimum; float maximum; float step; };
+
+	// Engine parameter values
+	extern float engine[nEngineParameters];
+
+	// Parameter table of the engine parameters and heuristic weights
+	extern const int nParameters;
+	extern const Parameter parameter[];
+
+	// Rounded value of a non-negative integral engine parameter
+	inline int getInt( int p ) { return (int)( engine[p] + 0.5f ); }
+
+	// Sets a named parameter within its bounds, throws a string on failure
+	void set( const std::string& name, float value );
+
+	// Config file input and output, throws a string on failure
+	void load( const char* filename );
+	void save( const char* filename );
+
+// End namespace
+} // Config
+
+// End definition
+#endif
@@ -31,13 +31,6 @@
 // Include header
 #include "Heuristic.h"
 
-// Board evaluation heuristic function prototypes
-float random( MoveLists* moves, short grid[][14], int pieces[], int score[], int player );
-float simple( MoveLists* moves, short grid[][14], int pieces[], int score[], int player );
-float weight( MoveLists* moves, short grid[][14], int pieces[], int score[], int player );
-float region( MoveLists* moves, short grid[][14], int pieces[], int score[], int player );
-float spaces( MoveLists* moves, short grid[][14], int pieces[], int score[], int player );
-
 // Board evaluation function count
 const int Heuristic::nEvaluationFunctions = 5;
 
@@ -46,10 +39,13 @@ const char* Heuristic::evalFunctionName[nEvaluationFunctions] = {
 	"Random utility evaluation heuristic.",
 	"Simple score based evaluation heuristic.",
 	"Simple score based on weighted liberties.",
-	"Combined ranking of score and player influence."
+	"Combined ranking of score and player influence.",
 	"Combined ranking of score and liberty influence."
 };
 
+// Weight heuristic weights, tuned values are loaded from the config file
+float Heuristic::weights[nWeights] = { 100, 200, 100, 0, 10, 0, 33, 33, 0, 1000 };
+
 // Board evaluation function pointers
 const EvalFunction Heuristic::evalFunction[nEvaluationFunctions] = {
 	&random,    // "Random utility evaluation heuristic."
@@ -63,7 +59,7 @@ const EvalFunction Heuristic::evalFunction[nEvaluationFunctions] = {
 //	Random board evaluation heuristic. Returns a random
 //  utility value between FLT_MAX and FLT_MIN.
 // --------------------------------------------------------
-float random( MoveLists* moves, short grid[][14], int pieces[], 
+float Heuristic::random( MoveLists* moves, short grid[][14], int pieces[],
 			 int score[], int player ) 
 {
 	return (float)( rand( ) - RAND_MAX/2 ) ;
@@ -73,7 +69,7 @@ float random( MoveLists* moves, short grid[][14], int pieces[],
 //	Simple board evaluation heuristic. Returns the total
 //  difference in score between max player and min player.
 // --------------------------------------------------------
-float simple( MoveLists* moves, short grid[][14], int pieces[], 
+float Heuristic::simple( MoveLists* moves, short grid[][14], int pieces[],
 			 int score[], int player ) 
 {
 	return (float)( score[PLAYER_MAX] - score[PLAYER_MIN] );
@@ -81,84 +77,87 @@ float simple( MoveLists* moves, short grid[][14], int pieces[],
 //
 // --------------------------------------------------------
 //	Simple board evaluation heuristic. Weights liberties
-//  using data from the MoveLists for each player. This is
-//  an excellent heuristic to attempt neural network 
-//  integration with at some point.
+//  using data from the MoveLists for each player. The
+//  weights can be fit to game records with the Tuner.
 // --------------------------------------------------------
-float weight( MoveLists* moves, short grid[][14], int pieces[],
+float Heuristic::weight( MoveLists* moves, short grid[][14], int pieces[],
 			 int score[], int player )
 {
-	// Static liberty weight values
-	static const int WEIGHT_SCORE	 =  100;
-	static const int WEIGHT_ATMOVE	 =  200;
-	static const int WEIGHT_DEFAULT  =  100;
-	static const int WEIGHT_FIGHTING =    0;
-	static const int WEIGHT_PIECE	 =   10;
-	static const int WEIGHT_MOVE	 =    0;
-	static const int WEIGHT_DIST	 =   33;
-	static const int WEIGHT_ANG_GOOD =   33;
-	static const int WEIGHT_ANG_BAD  =    0;
-	static const int WEIGHT_LEAK	 = 1000;
-
-	// Initialize weights with player to move advantage
-	int moveAdv = (player == PLAYER_MAX) ? WEIGHT_ATMOVE : -WEIGHT_ATMOVE;
-	int weights[NUM_PLAYERS] = { 0, 0 };
+	// Compute the features, skipping the move counts if unweighted
+	int features[nWeights]; getWeightFeatures( moves, grid, pieces,
+		score, player, features, weights[wMove] != 0.0f );
 
-	// Compute weights for individual players
+	// Compute total utility value
+	float utility = 0.0f;
+	for( int i = 0; i < nWeights; i++ )
+		utility += weights[i] * (float)features[i];
+
+	return utility;
+}
+//
+// --------------------------------------------------------
+//	Computes the features of the weight heuristic as the
+//  difference between the max and min players. Counting
+//  the available moves of each liberty is comparatively
+//  expensive and may be skipped.
+// --------------------------------------------------------
+void Heuristic::getWeightFeatures( MoveLists* moves, short grid[][14], int pieces[],
+		int score[], int player, int features[], bool countMoves )
+{
+	// Initialize the score and player to move advantage
+	for( int i = 0; i < nWeights; i++ ) features[i] = 0;
+	features[wScore] = score[PLAYER_MAX] - score[PLAYER_MIN];
+	features[wAtMove] = (player == PLAYER_MAX) ? 1 : -1;
+
+	// Compute features for individual players
 	for( int p = 0; p < NUM_PLAYERS; p++ )
 	{
+		int sign = (p == PLAYER_MAX) ? 1 : -1;
 		MoveList* iter = moves->getList( p );
 		if( moves->isMoveAvailable( p ) ) do
 		{
-			// Weights for available pieces
+			// Available pieces
 			int validPieces = iter->getValidPieces( );
 			for( int i = 0; i < PIECE_COUNT; i++ )
 			if( validPieces & (1<<i) ) 
-				weights[p] += WEIGHT_PIECE;
+				features[wPiece] += sign;
 
-			// Weights for available moves
-			weights[p] += iter->getNumMoves( ) * WEIGHT_MOVE;
+			// Available moves
+			if( countMoves ) features[wMove] += sign * iter->getNumMoves( );
 
-			// Weights for fighting liberties
-			if( iter->isFighting( ) ) weights[p] += WEIGHT_FIGHTING;
+			// Fighting liberties
+			if( iter->isFighting( ) ) features[wFighting] += sign;
 
-			// Weight for center-ness ( Technically incorrect )
+			// Center-ness ( Technically incorrect )
 			int x = abs( iter->getPositionX( ) - BOARD_SIZE/2 );
 			int y = abs( iter->getPositionY( ) - BOARD_SIZE/2 );
-			weights[p] += ( BOARD_SIZE/2 - max( x, y ) ) * WEIGHT_DIST;
+			features[wDist] += sign * ( BOARD_SIZE/2 - max( x, y ) );
 
-			// Weight for different liberty angles
-			if( iter->getAngle( ) == (3-p*2) ) weights[p] += WEIGHT_ANG_GOOD;
-			else if( iter->getAngle( ) == (p*2+1) ) weights[p] += WEIGHT_ANG_BAD;
+			// Different liberty angles
+			if( iter->getAngle( ) == (3-p*2) ) features[wAngGood] += sign;
+			else if( iter->getAngle( ) == (p*2+1) ) features[wAngBad] += sign;
 			
-			// Weight for potential leaks ( ignore 1 & 2 piece leaks )
+			// Potential leaks ( ignore 1 & 2 piece leaks )
 			if( iter->isLeak( ) && (iter->getValidPieces( )&0x1FFFFC) )
-				weights[p] += WEIGHT_LEAK;
+				features[wLeak] += sign;
 
-			// Default weight for active liberty
-			weights[p] += WEIGHT_DEFAULT;
+			// Active liberty
+			features[wDefault] += sign;
 		} 
 		while( iter = iter->getNext( ) ); 
 	}
-
-	// Compute total utility value
-	int utility = weights[PLAYER_MAX] - weights[PLAYER_MIN]
-		+ WEIGHT_SCORE * ( score[PLAYER_MAX] - score[PLAYER_MIN] );
-
-    // Give player to move advantage
-	return (float)( utility + moveAdv );
 }
 //
 // --------------------------------------------------------
 //	Simple board evaluation heuristic. Adds a fraction of
 //  the player's influence territory to their score.
 // --------------------------------------------------------
-float region( MoveLists* moves, short grid[][14], int pieces[],
+float Heuristic::region( MoveLists* moves, short grid[][14], int pieces[],
 			 int score[], int player ) 
 {
-	// Static weight values
-	static const int WEIGHT_AREAS = 1;
-	static const int WEIGHT_SCORE = 3;
+	// Configured weight values
+	const float WEIGHT_AREAS = Config::engine[pRegionAreas];
+	const float WEIGHT_SCORE = Config::engine[pRegionScore];
 
 	// Territory influence map
 	InfluenceMap influenceMap;
@@ -172,21 +171,20 @@ float region( MoveLists* moves, short grid[][14], int pieces[],
 	areas[PLAYER_MIN] = influenceMap.getPlayerInfluence( PLAYER_MIN );
 
 	// Return weighted board utility
-	return ( float )
-		   ( WEIGHT_SCORE * (score[PLAYER_MAX] - score[PLAYER_MIN]) +
-		     WEIGHT_AREAS * (areas[PLAYER_MAX] - areas[PLAYER_MIN]) );
+	return WEIGHT_SCORE * (score[PLAYER_MAX] - score[PLAYER_MIN]) +
+		   WEIGHT_AREAS * (areas[PLAYER_MAX] - areas[PLAYER_MIN]);
 }
 //
 // --------------------------------------------------------
 //	Simple board evaluation heuristic. Adds a fraction of
 //  the player's libertie's open tiles to their score.
 // --------------------------------------------------------
-float spaces( MoveLists* moves, short grid[][14], int pieces[],
+float Heuristic::spaces( MoveLists* moves, short grid[][14], int pieces[],
 			 int score[], int player ) 
 {
-	// Static weight values
-	static const int WEIGHT_AREAS = 3;
-	static const int WEIGHT_SCORE = 1;
+	// Configured weight values
+	const float WEIGHT_AREAS = Config::engine[pSpacesAreas];
+	const float WEIGHT_SCORE = Config::engine[pSpacesScore];
 
 	// Total free area / player
 	int areas[2] = { 0, 0 };
@@ -199,7 +197,6 @@ float spaces( MoveLists* moves, short grid[][14], int pieces[],
 		while( iter = iter->getNext( ) ); }
 
 	// Return weighted board utility
-	return ( float )
-		   ( WEIGHT_SCORE * (score[PLAYER_MAX] - score[PLAYER_MIN]) +
-		     WEIGHT_AREAS * (areas[PLAYER_MAX] - areas[PLAYER_MIN]) );
+	return WEIGHT_SCORE * (score[PLAYER_MAX] - score[PLAYER_MIN]) +
+		   WEIGHT_AREAS * (areas[PLAYER_MAX] - areas[PLAYER_MIN]);
 }
\ No newline at end of file
@@ -33,6 +33,10 @@
 typedef float (*EvalFunction) ( MoveLists* moves, 
 	short grid[][14], int pieces[], int score[], int player );
 
+// Weight heuristic features, each a difference between the players
+enum WeightFeature { wScore, wAtMove, wDefault, wFighting, wPiece,
+	wMove, wDist, wAngGood, wAngBad, wLeak, nWeights };
+
 // Heuristic namespace
 namespace Heuristic {
 
@@ -41,6 +45,18 @@ namespace Heuristic {
 	extern const EvalFunction evalFunction[];
 	extern const char* evalFunctionName[];
 
+	// Board evaluation functions, named for search specialization
+	float random( MoveLists* moves, short grid[][14], int pieces[], int score[], int player );
+	float simple( MoveLists* moves, short grid[][14], int pieces[], int score[], int player );
+	float weight( MoveLists* moves, short grid[][14], int pieces[], int score[], int player );
+	float region( MoveLists* moves, short grid[][14], int pieces[], int score[], int player );
+	float spaces( MoveLists* moves, short grid[][14], int pieces[], int score[], int player );
+
+	// Weight heuristic features and their weights
+	extern float weights[nWeights];
+	void getWeightFeatures( MoveLists* moves, short grid[][14], int pieces[],
+		int score[], int player, int features[], bool countMoves = true );
+
 // End namespace
 } // Heuristic
 
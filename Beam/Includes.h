@@ -66,10 +66,24 @@
 // Opening book
 #include "OpeningBook.h"
 
+// Position hashing and evaluation cache
+#include "Zobrist.h"
+#include "Symmetry.h"
+#include "EvalCache.h"
+
+// Policy network for move ordering
+#include "Policy.h"
+
 // Heuristic functions
 #include "InfluenceMap.h"
 #include "Heuristic.h"
 
+// Engine parameters
+#include "Config.h"
+
+// Self-play driver
+#include "SelfPlay.h"
+
 // Include header
 #include "Minimax.h"
 
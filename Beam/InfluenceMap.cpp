@@ -32,17 +32,21 @@
 
 // --------------------------------------------------------
 //	ComputeInfluenceMap - Generates an influence map for 
-//  the specified game state.
+//  the specified game state. Influence spreads from the
+//  liberties of both players simultaneously, one tile in
+//  all 8 directions per step, until the map is filled. A
+//  tile reached by both players on the same step is
+//  conflicted and spreads no further.
 // --------------------------------------------------------
 void InfluenceMap::generate( MoveLists* lists, short grid[][14], 
 		int pieces[], int score[], int player )
 {
-	// Create queue for influence propogation
-	Influence queue[BOARD_SIZE*BOARD_SIZE];
-	int queueWrite = 0, queueRead = 0;
+	// Influence spread on the last step and all tiles reached
+	unsigned int frontier[NUM_PLAYERS][MAP_WORDS];
+	unsigned int reached[MAP_WORDS];
 
-	// Zero influence map and influence buffer memory
-	ZeroMemory( m_influence, sizeof(char)*14*14 );
+	// Zero influence map memory
+	ZeroMemory( m_influence, sizeof(m_influence) );
 
 	// Initialize influence map 
 	for( int p = 0; p < NUM_PLAYERS; p++ )
@@ -52,62 +56,80 @@ void InfluenceMap::generate( MoveLists* lists, short grid[][14],
 			int x = iter->getPositionX( );
 			int y = iter->getPositionY( );
 
-			m_influence[x][y] |= (1<<p)|0x4;
-
-			if( !(m_influence[x][y]&0x8) )
-			{
-				m_influence[x][y] |= 0x8;
-				queue[queueWrite].x = x; 
-				queue[queueWrite].y = y; 
-				queueWrite++;
-			}
-		}
-
-	// Spread influence outward
-	while( queueRead != queueWrite )
-	{ 
-		static const int NUM_NEIGHBORS = 8;
-		static const int nx[NUM_NEIGHBORS] = { -1, 0, 1,  0, -1, -1, 1,  1 };
-		static const int ny[NUM_NEIGHBORS] = {  0, 1, 0, -1, -1,  1, 1, -1 };
-
-		int x = queue[queueRead].x;
-		int y = queue[queueRead].y;
-
-		// Check for territory clash
-		if( (m_influence[x][y]&0x3) != 0x3 )
-		for( int n = 0; n < NUM_NEIGHBORS; n++ )
-		{
-			int cx = x + nx[n];
-			int cy = y + ny[n];
-
-			// Check for invalid child coordinates
-			if( cx >= 0 && cx < BOARD_SIZE && 
-				cy >= 0 && cy < BOARD_SIZE &&
-				!( m_influence[cx][cy] & 0x4 ) )
-			{
-				// Add the node to the queue
-				if( !(m_influence[cx][cy]&0x8) )
-				{
-					ASSERT( queueWrite < 196 );
-					queue[queueWrite].x = cx;
-					queue[queueWrite].y = cy;
-					queueWrite++;
-				}
-
-				// Spread influence to the tile
-				m_influence[cx][cy] |= (m_influence[x][y]&0xB);
-				ASSERT( m_influence[cx][cy]&0x8 );
-			}
+			m_influence[p][x/2] |= 1 << (x%2*16+y);
 		}
 
-		// Mark search completed
-		m_influence[x][y] |= 0x4;
+	// Liberties held by both players do not spread
+	for( int i = 0; i < MAP_WORDS; i++ ) {
+		unsigned int conflicted = m_influence[0][i] & m_influence[1][i];
+		frontier[0][i] = m_influence[0][i] & ~conflicted;
+		frontier[1][i] = m_influence[1][i] & ~conflicted;
+		reached[i] = m_influence[0][i] | m_influence[1][i]; }
 
-		queueRead++;
+	// Spread influence outward
+	while( TRUE )
+	{
+		// Spread each player's frontier onto unreached tiles
+		unsigned int spread[NUM_PLAYERS][MAP_WORDS], grown = 0;
+		for( int p = 0; p < NUM_PLAYERS; p++ ) {
+			dilate( frontier[p], spread[p] );
+			for( int i = 0; i < MAP_WORDS; i++ ) {
+				spread[p][i] &= ~reached[i]; grown |= spread[p][i]; } }
+
+		// Check for a filled map
+		if( !grown ) break;
+
+		// Mark the new tiles, where tiles reached by both clash
+		for( int i = 0; i < MAP_WORDS; i++ ) {
+			unsigned int conflicted = spread[0][i] & spread[1][i];
+			m_influence[0][i] |= spread[0][i]; frontier[0][i] = spread[0][i] & ~conflicted;
+			m_influence[1][i] |= spread[1][i]; frontier[1][i] = spread[1][i] & ~conflicted;
+			reached[i] |= spread[0][i] | spread[1][i]; }
 	}
+
+	// Count the tiles held by each player alone and the conflicted tiles
+	unsigned int held[MAP_WORDS];
+	for( int p = 0; p < NUM_PLAYERS; p++ ) {
+		for( int i = 0; i < MAP_WORDS; i++ ) held[i] = m_influence[p][i] & ~m_influence[1-p][i];
+		m_areas[p] = countBits( held ); }
+	for( int i = 0; i < MAP_WORDS; i++ ) held[i] = m_influence[0][i] & m_influence[1][i];
+	m_borderAreas = countBits( held );
 }
 //
 // --------------------------------------------------------
+//	Dilate - Spreads each tile of an influence bitboard
+//  to its 8 neighbours. Bits shifted past the end of a row
+//  fall into the two unused bits at its end, which the 
+//  map mask clears.
+// --------------------------------------------------------
+void InfluenceMap::dilate( const unsigned int in[], unsigned int out[] )
+{
+	// Spread along the rows
+	unsigned int rows[MAP_WORDS];
+	for( int i = 0; i < MAP_WORDS; i++ )
+		rows[i] = ( in[i] | in[i]<<1 | in[i]>>1 ) & MAP_MASK;
+
+	// Spread across the rows, within and between words
+	for( int i = 0; i < MAP_WORDS; i++ )
+		out[i] = rows[i] | rows[i]<<16 | rows[i]>>16 |
+			( i > 0 ? rows[i-1]>>16 : 0 ) | ( i < MAP_WORDS-1 ? rows[i+1]<<16 : 0 );
+}
+//
+// --------------------------------------------------------
+//	CountBits - Returns the number of tiles marked in an 
+//  influence bitboard.
+// --------------------------------------------------------
+int InfluenceMap::countBits( const unsigned int map[] )
+{
+	int count = 0;
+	for( int i = 0; i < MAP_WORDS; i++ ) {
+		unsigned int v = map[i] - ( (map[i]>>1) & 0x55555555 );
+		v = ( v & 0x33333333 ) + ( (v>>2) & 0x33333333 );
+		count += ( ( (v + (v>>4)) & 0x0F0F0F0F ) * 0x01010101 ) >> 24; }
+
+	return count;
+}
+// --------------------------------------------------------
 //	DisplayMap - Outputs the influence map to console.
 // --------------------------------------------------------
 void InfluenceMap::displayMap( )
@@ -125,11 +147,11 @@ void InfluenceMap::displayMap( )
 	std::cout << "\nInfluence Map:";
 	for( int y = 0; y < BOARD_SIZE; y++ ) { std::cout << "\n";
 	for( int x = 0; x < BOARD_SIZE; x++ ) { std::cout << " ";
-		if( m_influence[x][y] & 0x4 )
-			if( (m_influence[x][y] & 0x3) == 0x3 ) std::cout << "O"; 
-			else if( m_influence[x][y] & 0x1 ) std::cout << "B"; 
-			else if( m_influence[x][y] & 0x2 ) std::cout << "R"; 
-			else std::cout << "-";
+		bool blue = isInfluencedByPlayer( x, y, PLAYER_BLUE );
+		bool red = isInfluencedByPlayer( x, y, PLAYER_RED );
+		if( blue && red ) std::cout << "O"; 
+		else if( blue ) std::cout << "B"; 
+		else if( red ) std::cout << "R"; 
 		else std::cout << "-"; } }
 
 	// Release mutex ownership
@@ -37,7 +37,8 @@ public:
 		int pieces[], int score[], int player );
 
 	// Influence map accessors
-	void isInfluencedByPlayer( int x, int y, int player );
+	bool isInfluencedByPlayer( int x, int y, int player ) 
+		{ return ( m_influence[player][x/2] >> (x%2*16+y) ) & 1; }
 	int getPlayerInfluence( int player ) { return m_areas[player]; }
 	int getConflictedInfluence( ) { return m_borderAreas; }
 
@@ -45,8 +46,15 @@ public:
 	void displayMap( );
 
 private:
-	struct Influence { int x, y, i, p; };
-	char m_influence[14][14];
+	// Influence bitboards, each word holds two board rows of 16 bits
+	static const int MAP_WORDS = BOARD_SIZE/2;
+	static const unsigned int MAP_MASK = 0x3FFF3FFF;
+
+	// Bitboard operations
+	static void dilate( const unsigned int in[], unsigned int out[] );
+	static int countBits( const unsigned int map[] );
+
+	unsigned int m_influence[NUM_PLAYERS][MAP_WORDS];
 	int m_areas[NUM_PLAYERS];
 	int m_borderAreas;
 };
@@ -31,12 +31,23 @@
 #define FORCE_EVAL_STD	  2   //< Forces the specified eval funct
 #define FORCE_EVAL_END	  2   //< Forces the specified eval funct
 #define MAX_THREADS       4   //< Maximum minimax thread count
-#define MIN_DEPTH	      2   //< Minimum minimax search depth
-#define MAX_DEPTH         2   //< Maximum minimax search depth
+#define EVAL_CACHE  (1<<18)   //< Entries in the evaluation cache (power of two), 0 for none
+#define BENCHMARK_KERNEL FALSE //< Times searches with the search kernel before each move
+#define BENCHMARK_DEPTH   2   //< Depth of the benchmark searches
+#define BENCHMARK_POSITIONS 32 //< Most positions searched by the benchmark
+#define SYMMETRY_PRUNING TRUE  //< Searches one of each pair of mirrored root moves
+#define POLICY_ORDERING FALSE //< Orders the unranked moves by the policy head of a network
+#define POLICY_DEPTH      1   //< Least remaining depth of the nodes ordered by the policy
 
 // Opening book filename
 #define BOOK_FNAME	NULL   //< Opening book filename, NULL for none
 
+// Policy network filename
+#define POLICY_FNAME "policy.nnue"  //< Network whose policy head orders moves, NULL for none
+
+// Engine config filename
+#define CONFIG_FNAME "BeamConfig.txt" //< Search settings and heuristic weights, NULL for defaults
+
 // Evaluation functions
 #define EVAL_STD  0		   //< Index of eval function used by default in board evaluation
 #define EVAL_END  1		   //< Index of Eval function used when no liberties are awake
@@ -44,8 +55,36 @@
 // Static member declarations
 int Minimax::m_startTile[4][2];
 int Minimax::m_evalFunction[2];
+Minimax::SearchKernel Minimax::m_minimax;
+Minimax::RankingKernel Minimax::m_getBeamMoves;
+EvalCache Minimax::m_evalCache;
+unsigned __int64 Minimax::m_configKey;
 Timer Minimax::m_matchTimer;
 OpeningBook Minimax::m_book;
+float Minimax::m_moveUtility;
+bool Minimax::m_moveSearched;
+int Minimax::m_rootPly;
+int Minimax::m_minDepth;
+int Minimax::m_maxDepth;
+float Minimax::m_searchTime;
+int Minimax::m_beamSearch;
+int Minimax::m_beamVerify;
+int Minimax::m_beamWidth[MAX_DEPTH];
+
+// Search kernels by standard and endgame evaluation function
+// in Heuristic::evalFunction order
+#define SEARCH_KERNELS( evalStd ) { &minimax<evalStd,Heuristic::random>, \
+	&minimax<evalStd,Heuristic::simple>, &minimax<evalStd,Heuristic::weight>, \
+	&minimax<evalStd,Heuristic::region>, &minimax<evalStd,Heuristic::spaces> }
+const Minimax::SearchKernel Minimax::m_searchKernel[][5] = {
+	SEARCH_KERNELS( Heuristic::random ), SEARCH_KERNELS( Heuristic::simple ),
+	SEARCH_KERNELS( Heuristic::weight ), SEARCH_KERNELS( Heuristic::region ),
+	SEARCH_KERNELS( Heuristic::spaces ) };
+
+// Move ranking kernels by standard evaluation function
+const Minimax::RankingKernel Minimax::m_rankingKernel[] = {
+	&getBeamMoves<Heuristic::random>, &getBeamMoves<Heuristic::simple>, &getBeamMoves<Heuristic::weight>,
+	&getBeamMoves<Heuristic::region>, &getBeamMoves<Heuristic::spaces> };
 
 // --------------------------------------------------------
 //	Startup - Store match settings data and load piece 
@@ -63,6 +102,13 @@ void Minimax::startup( int boardSize, int startTile[][2], int nPlayers )
 	// Load piece configurations
 	PieceSet::initPieceConfigurations( );
 
+	// Allocate the evaluation cache
+	Zobrist::initKeys( );
+	if( EVAL_CACHE ) m_evalCache.allocate( EVAL_CACHE );
+
+	// Build the piece tile tables for mirroring moves
+	Symmetry::initialize( );
+
 	// Store starting liberty tiles
 	for( int i = 0; i < nPlayers; i++ ) {
 		m_startTile[i][0] = startTile[i][0];
@@ -75,10 +121,25 @@ void Minimax::startup( int boardSize, int startTile[][2], int nPlayers )
 			std::cerr << "Error with opening book:\n	" << s << "\n\n"; } 
 	} else std::cout << "No opening book loaded\n";
 
+	// Load the policy head for move ordering
+	if( POLICY_ORDERING && POLICY_FNAME ) {
+		if( Policy::load( POLICY_FNAME ) )
+			std::cout << "Policy network " << POLICY_FNAME << " loaded\n";
+		else std::cout << "No policy network loaded\n"; }
+
+	// Load engine config
+	if( CONFIG_FNAME ) { try { Config::load( CONFIG_FNAME );
+			std::cout << "Engine config " << CONFIG_FNAME << " loaded\n";
+		} catch( const char *s ) {
+			std::cout << "Using default engine config:\n	" << s << "\n"; }
+	} else std::cout << "Using default engine config\n";
+	configure( );
+
 	// Print settings to standard io
 	std::cout << "Max Thread Count: " << MAX_THREADS << "\n";
-	std::cout << "Min Search Depth: " << MIN_DEPTH << "\n";
-	std::cout << "Max Search Depth: " << MAX_DEPTH << "\n";
+	std::cout << "Min Search Depth: " << m_minDepth << "\n";
+	std::cout << "Max Search Depth: " << m_maxDepth << "\n";
+	std::cout << "Beam Search: " << (m_beamSearch ? "On" : "Off") << "\n";
 
 	// Select an evaluation function
 	for( int j = 0; j < 2; j++ )
@@ -113,11 +174,52 @@ void Minimax::startup( int boardSize, int startTile[][2], int nPlayers )
 		if( !success ) m_evalFunction[j] = 0;
     }
 
+	// Select the search kernels of the functions
+	ASSERT( sizeof(m_rankingKernel)/sizeof(RankingKernel) == Heuristic::nEvaluationFunctions );
+	m_minimax = m_searchKernel[m_evalFunction[EVAL_STD]][m_evalFunction[EVAL_END]];
+	m_getBeamMoves = m_rankingKernel[m_evalFunction[EVAL_STD]];
+
 	// Print ready message
 	std::cout << "Ready to Move!!!\n";
 } 
 //
 // --------------------------------------------------------
+//	Shutdown - Releases the evaluation cache.
+// --------------------------------------------------------
+void Minimax::shutdown( )
+{
+	m_evalCache.release( );
+}
+//
+// --------------------------------------------------------
+//	Configure - Copies the search settings from the engine
+//  config and keys its evaluation weights. The key is
+//  mixed into the cache keys, so evaluations cached with
+//  other weights are not found and configs which take
+//  turns, as in tuning games, keep their cached entries.
+// --------------------------------------------------------
+void Minimax::configure( )
+{
+	// Search depths and deepening time limit
+	m_minDepth = Config::getInt( pMinDepth );
+	m_maxDepth = max( Config::getInt( pMaxDepth ), m_minDepth );
+	m_searchTime = Config::engine[pSearchTime];
+
+	// Beam search settings
+	m_beamSearch = Config::getInt( pBeamSearch );
+	m_beamVerify = Config::getInt( pBeamVerify );
+	for( int i = 0; i < MAX_DEPTH; i++ )
+		m_beamWidth[i] = Config::getInt( pBeamWidth0 + i );
+
+	// Key the region, spaces and heuristic weights, which
+	// follow the search settings in the parameter table
+	m_configKey = 0;
+	for( int i = pRegionAreas; i < Config::nParameters; i++ ) {
+		unsigned int bits; memcpy( &bits, Config::parameter[i].value, sizeof(bits) );
+		m_configKey = ( m_configKey ^ bits ) * 0x9E3779B97F4A7C15ULL; }
+}
+//
+// --------------------------------------------------------
 //	MakeMove - Returns a move based on the current board
 //  configuration. If a response appears in the loaded
 //  opening book, then it is used. Otherwise the move is
@@ -127,7 +229,8 @@ Move Minimax::makeMove( char grid[][20], bool pieces[][21], int score[],
 					   int player, int ply, Move moves[42] )
 {
 	// First check if position is in opening book
-	std::vector<Move> moveHistory( 42 ); 
+	m_moveSearched = false;
+	std::vector<Move> moveHistory;
 	for( int i = 0; i < ply; i++ ) 
 		moveHistory.push_back( moves[i] );
 	if( m_book.isInBook( moveHistory ) ) {
@@ -135,8 +238,13 @@ Move Minimax::makeMove( char grid[][20], bool pieces[][21], int score[],
 		} catch( const char *s ) { 
 			std::cerr << "Error with opening book\n" << s << "\n"; } }
 
+	// Benchmark the search kernel on the current position
+	if( BENCHMARK_KERNEL ) { short newGrid[14][14]; int newPieces[2];
+		MoveSimulator::reformatBoard( grid, newGrid, pieces, newPieces, m_startTile );
+		benchmarkKernel( newGrid, newPieces, score, player, ply ); }
+
 	// Set the minimum search depth
-	int maxSearchDepth = MIN_DEPTH;
+	int maxSearchDepth = m_minDepth;
 
 	// Iterative deepening loop
 	while( TRUE )
@@ -171,7 +279,7 @@ Move Minimax::makeMove( char grid[][20], bool pieces[][21], int score[],
 		maxSearchDepth = maxSearchDepth + 1;
 		
 		// Check for terminal condition in search settings
-		if( searchTime > 3.0f || maxSearchDepth > MAX_DEPTH )
+		if( searchTime > m_searchTime || maxSearchDepth > m_maxDepth )
 			return move;
 	}
 }
@@ -192,8 +300,9 @@ Move Minimax::getMinimaxMove( short grid[][14], int pieces[],
 	MtGameState threadStates[MAX_THREADS];
 	HANDLE threadHandles[MAX_THREADS];
 
-	// Generate base move lists for minimax searching
-	MoveLists moveLists; moveLists.allocateMemoryPool( 50 );
+	// Generate base move lists for minimax searching, the pool is
+	// shared with the move lists of the ranked root moves
+	MoveLists moveLists; moveLists.allocateMemoryPool( 250 );
 	moveLists.generateMoves( grid, pieces );
 
 	// :DEBUG: Display Influence Map
@@ -201,6 +310,9 @@ Move Minimax::getMinimaxMove( short grid[][14], int pieces[],
 	//imap.generate( &moveLists, grid, pieces, score, player );
 	//imap.displayMap( );
 
+	// Compute the root position key
+	unsigned __int64 key = Zobrist::getKey( grid, pieces, player );
+
 	// Initialize thread data
 	float alpha = -FLT_MAX, beta = FLT_MAX; 
 	for( int i = 0; i < MAX_THREADS; i++ ) {
@@ -223,6 +335,38 @@ Move Minimax::getMinimaxMove( short grid[][14], int pieces[],
 	if( move == NULL ) moveLists.clearLibertyModeSettings( );
 	move = moveLists.getFirstMove( player, validPieces );
 
+	// Rank the root moves for the beam, searching the moves
+	// outside of the beam last when verification is enabled
+	std::vector<BeamMove> beam; int beamIndex = 0, beamSize = 0; m_rootPly = ply;
+	if( m_beamSearch && move && depth > 1 && m_beamWidth[0] )
+	{
+		// Count the available moves
+		int nMoves = 0; while( move ) { nMoves++; move = moveLists.getNextMove( ); }
+
+		// Rank every move available at the root
+		beam.resize( nMoves ); beamSize = m_getBeamMoves( &moveLists, grid,
+			pieces, score, player, key, validPieces, nMoves, &beam[0] );
+		if( SYMMETRY_PRUNING && Symmetry::isSymmetric( grid ) )
+			beamSize = pruneBeam( &beam[0], beamSize );
+		if( !m_beamVerify ) beamSize = min( beamSize, m_beamWidth[0] );
+		move = beam[0].move;
+	}
+
+	// List the unranked root moves in the order of the policy and
+	// for pruning in a symmetric position
+	else if( move && ( ( POLICY_ORDERING && Policy::isLoaded( ) ) ||
+		( SYMMETRY_PRUNING && Symmetry::isSymmetric( grid ) ) ) )
+	{
+		std::vector<const Move*> ordered( POLICY_MAX_MOVES );
+		int nMoves = getOrderedMoves( &moveLists, move, grid, pieces, player, &ordered[0] );
+		for( int i = 0; i < nMoves; i++ ) {
+			BeamMove entry = { 0.0f, ordered[i] }; beam.push_back( entry ); }
+		beamSize = nMoves;
+		if( SYMMETRY_PRUNING && Symmetry::isSymmetric( grid ) )
+			beamSize = pruneBeam( &beam[0], beamSize );
+		move = beam[0].move;
+	}
+
 	// Get utility values for each move
 	const Move* bestMove = move; int completedThreads = 0; 
 	while( completedThreads < MAX_THREADS )
@@ -260,10 +404,11 @@ Move Minimax::getMinimaxMove( short grid[][14], int pieces[],
 				__int64 simulationTimeID = Profiler::startProfile( );
 
 				// Simulate the selected move on the board for minimax 
+				threadStates[i].key = key;
 				MoveSimulator::simulateMove( move, grid, pieces, score, player, 
 					threadStates[i].grid, threadStates[i].pieces, 
 					threadStates[i].score, &threadStates[i].player,
-					&moveLists, &threadStates[i].moveLists );
+					&moveLists, &threadStates[i].moveLists, &threadStates[i].key );
 
 				// Increment function runtime costs
 				Profiler::endProfile( tSimulateMoves, simulationTimeID );
@@ -273,9 +418,10 @@ Move Minimax::getMinimaxMove( short grid[][14], int pieces[],
 					&getMinimaxUtility, threadStates+i, 0, NULL );
 				
 				// Get next available move
-				__int64 moveEnumerationTimeID = Profiler::startProfile( );
-				move = moveLists.getNextMove( );
-				Profiler::endProfile( tMoveEnumeration, moveEnumerationTimeID );
+				if( beamSize ) move = ( ++beamIndex < beamSize ) ? beam[beamIndex].move : NULL;
+				else { __int64 moveEnumerationTimeID = Profiler::startProfile( );
+					   move = moveLists.getNextMove( );
+					   Profiler::endProfile( tMoveEnumeration, moveEnumerationTimeID ); }
 			}
 			else completedThreads++;
 		} 
@@ -290,6 +436,9 @@ Move Minimax::getMinimaxMove( short grid[][14], int pieces[],
 	// Get a copy of the move
 	Move returnedMove = *bestMove; 
 
+	// Store the utility of the selected move
+	m_moveUtility = (player == PLAYER_MAX) ? alpha : beta; m_moveSearched = true;
+
 	// Deallocate memory pools
 	moveLists.deallocateMemoryPool( );
 	for( int i = 0; i < MAX_THREADS; i++ )
@@ -313,8 +462,8 @@ unsigned int Minimax::getMinimaxUtility( void* dataOut )
 	MtGameState* state = (MtGameState*)dataOut;
 
 	// Perform minimax search
-	state->utility = minimax( &state->moveLists, state->grid, state->pieces, state->score, 
-		state->player, state->depth, state->ply, state->alpha, state->beta );
+	state->utility = m_minimax( &state->moveLists, state->grid, state->pieces, state->score,
+		state->player, state->depth, state->ply, state->alpha, state->beta, state->key );
 
 	// Mark the thread done
 	state->completed = true;
@@ -326,10 +475,13 @@ unsigned int Minimax::getMinimaxUtility( void* dataOut )
 // --------------------------------------------------------
 //	Minimax - Uses the minimax algorithm with alpha-beta 
 //  pruning to compute the utility value of a given board 
-//  position. 
+//  position. Search kernels are instantiated per pair of
+//  evaluation functions so the evaluation is bound at
+//  compile time.
 // --------------------------------------------------------
+template<EvalFunction evalStd, EvalFunction evalEnd>
 float Minimax::minimax( MoveLists* moveLists, short grid[][14], int pieces[], int score[], int player,
-						 int depth, int ply, float alpha, float beta )
+						 int depth, int ply, float alpha, float beta, unsigned __int64 key )
 {	
 	// Increment search count
 	Profiler::addSearchNode( );
@@ -345,8 +497,8 @@ float Minimax::minimax( MoveLists* moveLists, short grid[][14], int pieces[], in
 		__int64 evaluationTimeID = Profiler::startProfile( );
 
 		// Compute board utility
-		float utility = Heuristic::evalFunction[m_evalFunction[EVAL_STD]]
-			( moveLists, grid, pieces, score, player );
+		float utility = getUtility<evalStd>( m_evalFunction[EVAL_STD],
+			moveLists, grid, pieces, score, player, key );
 
 		// Increment function runtime costs
 		Profiler::endProfile( tStandard, evaluationTimeID );
@@ -366,7 +518,8 @@ float Minimax::minimax( MoveLists* moveLists, short grid[][14], int pieces[], in
 
 		// Player's loss is not definitive, but player is out
 		else if( moveLists->isMoveAvailable( 1-player ) == TRUE )
-			return minimax( moveLists, grid, pieces, score, 1-player, depth-1, ply+1, alpha, beta );
+			return minimax<evalStd,evalEnd>( moveLists, grid, pieces, score, 1-player, depth-1, ply+1,
+				alpha, beta, key^Zobrist::getPlayerKey( ) );
 
 		// Player has tied with other player
 		else if( score[player] == score[1-player] )
@@ -392,8 +545,8 @@ float Minimax::minimax( MoveLists* moveLists, short grid[][14], int pieces[], in
 		__int64 endEvaluationTimeID = Profiler::startProfile( );
 
 		// Compute board utility
-		float utility = Heuristic::evalFunction[m_evalFunction[EVAL_END]]
-			( moveLists, grid, pieces, score, player );
+		float utility = getUtility<evalEnd>( m_evalFunction[EVAL_END],
+			moveLists, grid, pieces, score, player, key );
 
 		// Increment function runtime costs
 		Profiler::endProfile( tEndGame, endEvaluationTimeID );
@@ -404,27 +557,43 @@ float Minimax::minimax( MoveLists* moveLists, short grid[][14], int pieces[], in
 		return utility;
 	}
 
+	// Restrict the search to the best ranked moves when the
+	// children are interior nodes
+	BeamMove beam[BEAM_MAX_WIDTH]; int beamIndex = 0, beamSize = 0;
+	int beamWidth = min( m_beamWidth[ply-m_rootPly], BEAM_MAX_WIDTH );
+	if( m_beamSearch && depth > 1 && beamWidth ) {
+		beamSize = getBeamMoves<evalStd>( moveLists, grid, pieces, score,
+			player, key, validPieces, beamWidth, beam );
+		move = beam[0].move; }
+
+	// Otherwise search the moves the policy rates best first
+	const Move* ordered[POLICY_MAX_MOVES]; int orderIndex = 0, nOrdered = 0;
+	if( !beamSize && POLICY_ORDERING && depth >= POLICY_DEPTH && Policy::isLoaded( ) ) {
+		nOrdered = getOrderedMoves( moveLists, move, grid, pieces, player, ordered );
+		move = ordered[0]; }
+
 	// Recursively perform minimax on each move
+	const Move* firstMove = move;
 	while( move != NULL )
 	{
 		// Game state variables from move simulation output
-		short newGrid[14][14]; int newPieces[2]; int newScore[4]; int newPlayer; 
-		MoveLists newMoveLists;
+		short newGrid[14][14]; int newPieces[2]; int newScore[4]; int newPlayer;
+		MoveLists newMoveLists; unsigned __int64 newKey = key;
 
 		// Begin profiling move simulation
 		__int64 simulationTimeID = Profiler::startProfile( );
 
 		// Simulate the selected move on the board for minimax evaluation
-		MoveSimulator::simulateMove( move, grid, pieces, score, player, 
+		MoveSimulator::simulateMove( move, grid, pieces, score, player,
 									newGrid, newPieces, newScore, &newPlayer,
-									moveLists, &newMoveLists );
+									moveLists, &newMoveLists, &newKey );
 
 		// Increment function runtime costs
 		Profiler::endProfile( tSimulateMoves, simulationTimeID );
 
 		// Perform minimax on the new board state
-		float newUtility = minimax( &newMoveLists, newGrid, newPieces, 
-			newScore, newPlayer, depth-1, ply+1, alpha, beta );
+		float newUtility = minimax<evalStd,evalEnd>( &newMoveLists, newGrid, newPieces,
+			newScore, newPlayer, depth-1, ply+1, alpha, beta, newKey );
 
 		// Return used memory chunks to pool
 		newMoveLists.deallocateMemoryChunks( );
@@ -434,10 +603,12 @@ float Minimax::minimax( MoveLists* moveLists, short grid[][14], int pieces[], in
 			if( newUtility > alpha ) alpha = newUtility; }
 		else if( newUtility < beta ) beta = newUtility;
 
-		// Check for alpha-beta cut-off
-		if( beta <= alpha ) break;
+		// Check for alpha-beta cut-off, counting those made by the first move
+		if( beta <= alpha ) { Profiler::addCutoff( move == firstMove ); break; }
 
 		// Get next available move
+		if( beamSize ) { move = ( ++beamIndex < beamSize ) ? beam[beamIndex].move : NULL; continue; }
+		if( nOrdered ) { move = ( ++orderIndex < nOrdered ) ? ordered[orderIndex] : NULL; continue; }
 		__int64 moveEnumerationTimeID = Profiler::startProfile( );
 		move = moveLists->getNextMove( );
 		Profiler::endProfile( tMoveEnumeration, moveEnumerationTimeID );
@@ -448,6 +619,226 @@ float Minimax::minimax( MoveLists* moveLists, short grid[][14], int pieces[], in
 }
 //
 // --------------------------------------------------------
+//	GetUtility - Evaluates a board position with the given
+//  evaluation function, looking the utility up in the 
+//  evaluation cache first. The cache is shared by all 
+//  search threads and kept between iterations and moves.
+// --------------------------------------------------------
+template<EvalFunction evaluate>
+float Minimax::getUtility( int function, MoveLists* moveLists, short grid[][14], 
+		int pieces[], int score[], int player, unsigned __int64 key )
+{
+	// Check the cache for the position under the config weights
+	float utility; key ^= m_configKey;
+	if( EVAL_CACHE && m_evalCache.probe( key, function, &utility ) ) {
+		Profiler::addCacheProbe( TRUE ); return utility; }
+
+	// Evaluate and store the board
+	utility = evaluate( moveLists, grid, pieces, score, player );
+	if( EVAL_CACHE ) { Profiler::addCacheProbe( FALSE );
+		m_evalCache.store( key, function, utility ); }
+
+	return utility;
+}
+//
+// --------------------------------------------------------
+//	GetBeamMoves - Simulates each available move and ranks
+//  it by the standard evaluation of the resulting state.
+//  The best moves for the player are stored in the beam in
+//  descending order. Returns the number of moves stored.
+// --------------------------------------------------------
+template<EvalFunction evaluate>
+int Minimax::getBeamMoves( MoveLists* moveLists, short grid[][14], int pieces[], int score[],
+						   int player, unsigned __int64 key, int validPieces, int width, BeamMove beam[] )
+{
+	// Begin profiling move ranking
+	__int64 beamRankingTimeID = Profiler::startProfile( );
+
+	// Rank each available move
+	int beamSize = 0; const Move* move = moveLists->getFirstMove( player, validPieces );
+	while( move != NULL )
+	{
+		// Game state variables from move simulation output
+		short newGrid[14][14]; int newPieces[2]; int newScore[4]; int newPlayer;
+		MoveLists newMoveLists; unsigned __int64 newKey = key;
+
+		// Simulate the move and evaluate the resulting state
+		MoveSimulator::simulateMove( move, grid, pieces, score, player,
+									newGrid, newPieces, newScore, &newPlayer,
+									moveLists, &newMoveLists, &newKey );
+		float value = getUtility<evaluate>( m_evalFunction[EVAL_STD], &newMoveLists,
+			newGrid, newPieces, newScore, newPlayer, newKey );
+		if( player != PLAYER_MAX ) value = -value;
+
+		// Return used memory chunks to pool
+		newMoveLists.deallocateMemoryChunks( );
+
+		// Insert the move into the beam in ranked order
+		if( beamSize < width || value > beam[beamSize-1].value ) {
+			int i = ( beamSize < width ) ? beamSize++ : beamSize-1;
+			for( ; i > 0 && beam[i-1].value < value; i-- ) beam[i] = beam[i-1];
+			beam[i].value = value; beam[i].move = move; }
+
+		// Get next available move
+		move = moveLists->getNextMove( );
+	}
+
+	// Increment function runtime costs
+	Profiler::endProfile( tBeamRanking, beamRankingTimeID );
+
+	return beamSize;
+}
+//
+// --------------------------------------------------------
+//	PruneBeam - Removes the moves of the beam whose diagonal
+//  reflection is ranked higher. In a symmetric position
+//  both lead to mirrored states of equal value, so only
+//  one needs to be searched. Returns the new beam size.
+// --------------------------------------------------------
+int Minimax::pruneBeam( BeamMove beam[], int beamSize )
+{
+	int nKept = 0;
+	for( int i = 0; i < beamSize; i++ )
+	{
+		// Check for the reflection among the kept moves
+		Move mirror = Symmetry::mapMove( SYMMETRY_DIAGONAL, *beam[i].move );
+		bool listed = false;
+		for( int j = 0; j < nKept && !listed; j++ )
+			listed = ( mirror == *beam[j].move );
+		if( !listed ) beam[nKept++] = beam[i];
+	}
+
+	return nKept;
+}
+//
+// --------------------------------------------------------
+//	GetOrderedMoves - Lists the available moves from the 
+//  given first move, sorted from the greatest to the least
+//  policy logit when a policy network is loaded. The 
+//  network runs once for the position, scoring all moves.
+//  Returns the number of moves listed.
+// --------------------------------------------------------
+int Minimax::getOrderedMoves( MoveLists* moveLists, const Move* move, short grid[][14],
+							  int pieces[], int player, const Move* ordered[] )
+{
+	// Begin profiling move ordering
+	__int64 moveOrderingTimeID = Profiler::startProfile( );
+
+	// List the available moves
+	int nMoves = 0;
+	for( ; move && nMoves < POLICY_MAX_MOVES; move = moveLists->getNextMove( ) )
+		ordered[nMoves++] = move;
+
+	// Score and sort the moves
+	if( POLICY_ORDERING && Policy::isLoaded( ) ) {
+		float logits[NNUE_POLICY];
+		Policy::getLogits( grid, pieces, player, logits );
+		Policy::orderMoves( logits, ordered, nMoves ); }
+
+	// Increment function runtime costs
+	Profiler::endProfile( tMoveOrdering, moveOrderingTimeID );
+
+	return nMoves;
+}
+//
+// --------------------------------------------------------
+//	BenchmarkKernel - Compares the speed of fixed depth
+//  searches with the search kernel against searches which
+//  evaluate through the function table, as the search did
+//  before kernels. A spread of the states reached by the
+//  available moves is searched both ways, so each search
+//  runs the move ranking, generation and simulation of the
+//  real search over different leaves.
+// --------------------------------------------------------
+void Minimax::benchmarkKernel( short grid[][14], int pieces[], int score[], int player, int ply )
+{
+	// Generate the move lists of the position
+	MoveLists moveLists; moveLists.allocateMemoryPool( 250 );
+	moveLists.generateMoves( grid, pieces );
+	unsigned __int64 key = Zobrist::getKey( grid, pieces, player );
+
+	// List the available moves, waking all liberties if none are awake
+	const Move* move = moveLists.getFirstMove( player, pieces[player] );
+	if( move == NULL ) moveLists.clearLibertyModeSettings( );
+	std::vector<const Move*> moves;
+	for( move = moveLists.getFirstMove( player, pieces[player] ); 
+		 move != NULL; move = moveLists.getNextMove( ) ) moves.push_back( move );
+
+	// Time the searches of the resulting states
+	__int64 direct = 0, indirect = 0; int nSearches = 0; m_rootPly = ply;
+	int step = max( (int)moves.size( ) / BENCHMARK_POSITIONS, 1 );
+	for( unsigned int i = 0; i < moves.size( ); i += step, nSearches++ )
+	{
+		// Game state variables from move simulation output
+		short newGrid[14][14]; int newPieces[2]; int newScore[4]; int newPlayer;
+		MoveLists newMoveLists; unsigned __int64 newKey = key;
+
+		// Simulate the move and search the resulting state both ways
+		MoveSimulator::simulateMove( moves[i], grid, pieces, score, player,
+									newGrid, newPieces, newScore, &newPlayer,
+									&moveLists, &newMoveLists, &newKey );
+		float directUtility, indirectUtility;
+		direct += benchmarkSearch( m_minimax, &newMoveLists, newGrid, newPieces,
+			newScore, newPlayer, ply+1, newKey, &directUtility );
+		indirect += benchmarkSearch( &minimax<evaluateIndirect,evaluateIndirectEnd>, &newMoveLists,
+			newGrid, newPieces, newScore, newPlayer, ply+1, newKey, &indirectUtility );
+		if( m_evalFunction[EVAL_STD] && m_evalFunction[EVAL_END] ) 
+			ASSERT( directUtility == indirectUtility );
+
+		// Return used memory chunks to pool
+		newMoveLists.deallocateMemoryChunks( );
+	}
+
+	// Deallocate memory pool
+	moveLists.deallocateMemoryPool( );
+
+	// Display search throughput
+	LARGE_INTEGER frequency; QueryPerformanceFrequency( &frequency );
+	double searches = (double)nSearches * (double)frequency.QuadPart;
+	std::cout << "\n-- Search Kernel Benchmark --\n";
+	std::cout << "Positions: " << nSearches << " at Depth " << BENCHMARK_DEPTH << "\n";
+	std::cout << "Kernel Searches/s: " << (int)(searches / (double)max(direct,1LL)) << "\n";
+	std::cout << "Indirect Searches/s: " << (int)(searches / (double)max(indirect,1LL)) << "\n";
+}
+//
+// --------------------------------------------------------
+//	BenchmarkSearch - Searches a board position to the
+//  benchmark depth with the given kernel and returns the
+//  elapsed performance counts. The cache is cleared first
+//  so that every search evaluates the same leaves.
+// --------------------------------------------------------
+__int64 Minimax::benchmarkSearch( SearchKernel kernel, MoveLists* moveLists, short grid[][14],
+		int pieces[], int score[], int player, int ply, unsigned __int64 key, float* utility )
+{
+	if( EVAL_CACHE ) m_evalCache.clear( );
+	LARGE_INTEGER temp; QueryPerformanceCounter( &temp ); __int64 startTime = temp.QuadPart;
+	*utility = kernel( moveLists, grid, pieces, score, player, 
+		BENCHMARK_DEPTH, ply, -FLT_MAX, FLT_MAX, key );
+	QueryPerformanceCounter( &temp ); return temp.QuadPart - startTime;
+}
+//
+// --------------------------------------------------------
+//	EvaluateIndirect - Evaluates a board position with the
+//  standard evaluation function through the function table.
+// --------------------------------------------------------
+float Minimax::evaluateIndirect( MoveLists* moves, short grid[][14],
+		int pieces[], int score[], int player )
+{
+	return Heuristic::evalFunction[m_evalFunction[EVAL_STD]]( moves, grid, pieces, score, player );
+}
+//
+// --------------------------------------------------------
+//	EvaluateIndirectEnd - Evaluates a board position with
+//  the endgame evaluation function through the function
+//  table.
+// --------------------------------------------------------
+float Minimax::evaluateIndirectEnd( MoveLists* moves, short grid[][14],
+		int pieces[], int score[], int player )
+{
+	return Heuristic::evalFunction[m_evalFunction[EVAL_END]]( moves, grid, pieces, score, player );
+}
+//
+// --------------------------------------------------------
 //	DisplayState - Outputs the specified game state to the 
 //  console. Useful for debugging purposes. 
 // --------------------------------------------------------
@@ -40,13 +40,22 @@ public:
 		int player, int ply, Move moves[42] );
 
 	// Shutdown AI player
-	void shutdown( ) { }
+	void shutdown( );
+
+	// Applies changes to the engine config
+	void configure( );
+
+	// Search utility of the last move for PLAYER_MAX, false for book moves
+	bool getMoveUtility( float* utility ) { *utility = m_moveUtility; return m_moveSearched; }
 
 private:
 	// Multi-threading game state communication structure
 	struct MtGameState { short grid[14][14]; int pieces[2]; int score[2]; int player; 
 						 int completed; float utility; int depth; float alpha; float beta; 
-						 const Move* moveIndex; MoveLists moveLists; int ply; };
+						 const Move* moveIndex; MoveLists moveLists; int ply; unsigned __int64 key; };
+
+	// Beam search ranked move structure
+	struct BeamMove { float value; const Move* move; };
 
 	// Move selection function
 	__forceinline static Move getMinimaxMove( short (*__restrict grid)[14], 
@@ -55,16 +64,69 @@ private:
 	// Threaded move selection function
 	static unsigned int __stdcall getMinimaxUtility( void* dataOut );
 
+	// Search kernel formats, minimax and move ranking functions specialized
+	// for the standard and endgame evaluation functions
+	typedef float (*SearchKernel)( MoveLists* moveLists, short (*__restrict grid)[14], int (*__restrict pieces), int (*__restrict score),
+		int player, int depth, int ply, float alpha, float beta, unsigned __int64 key );
+	typedef int (*RankingKernel)( MoveLists* moveLists, short grid[][14], int pieces[], int score[],
+		int player, unsigned __int64 key, int validPieces, int width, BeamMove beam[] );
+
 	// Minimax function
+	template<EvalFunction evalStd, EvalFunction evalEnd>
 	static float minimax( MoveLists* moveLists, short (*__restrict grid)[14], int (*__restrict pieces), int (*__restrict score), int player,
-		int depth, int ply, float alpha, float beta );
+		int depth, int ply, float alpha, float beta, unsigned __int64 key );
+
+	// Cached board evaluation function
+	template<EvalFunction evaluate>
+	__forceinline static float getUtility( int function, MoveLists* moveLists, short grid[][14], 
+		int pieces[], int score[], int player, unsigned __int64 key );
+
+	// Ranks moves by a static evaluation of the resulting game state
+	template<EvalFunction evaluate>
+	static int getBeamMoves( MoveLists* moveLists, short grid[][14], int pieces[], int score[],
+		int player, unsigned __int64 key, int validPieces, int width, BeamMove beam[] );
+
+	// Removes the reflections of higher ranked moves in a symmetric position
+	static int pruneBeam( BeamMove beam[], int beamSize );
+
+	// Lists the available moves in the order of the policy head
+	static int getOrderedMoves( MoveLists* moveLists, const Move* move, short grid[][14],
+		int pieces[], int player, const Move* ordered[] );
+
+	// Search benchmark of the search kernel against the function table
+	static __int64 benchmarkSearch( SearchKernel kernel, MoveLists* moveLists, short grid[][14],
+		int pieces[], int score[], int player, int ply, unsigned __int64 key, float* utility );
+	static float evaluateIndirect( MoveLists* moves, short grid[][14],
+		int pieces[], int score[], int player );
+	static float evaluateIndirectEnd( MoveLists* moves, short grid[][14],
+		int pieces[], int score[], int player );
+	static void benchmarkKernel( short grid[][14], int pieces[], int score[], int player, int ply );
 
 	// Debugging helper functions 
 	static void displayState( MoveLists* moves, short grid[][14], 
 		int pieces[], int score[], int player );
 
-	// Minimax evaluation function
+	// Minimax evaluation functions and their search kernels
 	static int m_evalFunction[2];
+	static SearchKernel m_minimax;
+	static RankingKernel m_getBeamMoves;
+	static const SearchKernel m_searchKernel[][5];
+	static const RankingKernel m_rankingKernel[];
+
+	// Evaluation cache and the key of the config weights
+	static EvalCache m_evalCache;
+	static unsigned __int64 m_configKey;
+
+	// Search settings from the engine config
+	static int m_minDepth;
+	static int m_maxDepth;
+	static float m_searchTime;
+
+	// Beam search settings, widths by distance from the root
+	static int m_beamSearch;
+	static int m_beamVerify;
+	static int m_beamWidth[MAX_DEPTH];
+	static int m_rootPly;
 
 	// Minimax cut-off timer
 	static Timer m_matchTimer;  
@@ -72,6 +134,10 @@ private:
 
 	// Opening book
 	static OpeningBook m_book;
+
+	// Search utility of the last move
+	static float m_moveUtility;
+	static bool m_moveSearched;
 };
 
 // End definition
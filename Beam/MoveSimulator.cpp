@@ -126,7 +126,7 @@ void MoveSimulator::reformatBoard( char boardIn[][20], short boardOut[][14],
 void MoveSimulator::simulateMove( const Move* move, 
 		short grid[][14], int pieces[], int score[], int player,
 		short gridOut[][14], int piecesOut[], int scoreOut[], int* playerOut,
-		MoveLists* movelists, MoveLists* movelistsOut )
+		MoveLists* movelists, MoveLists* movelistsOut, unsigned __int64* key )
 {
 	// Copy board data to output
 	for( int i = 0; i < BOARD_SIZE; i++ )
@@ -175,25 +175,25 @@ void MoveSimulator::simulateMove( const Move* move,
 			for( int j = 0, gy = move->gridY; j < y; j++,gy++ )
 			for( int i = 0, gx = move->gridX; i < x; i++,gx++ ) 
 				applyPiecePattern( piece, movelistsOut, gridOut, player, playerBit, i, j, gx, gy,
-					nNewLiberties, newLiberties ); }
+					nNewLiberties, newLiberties, key ); }
 
 		else if( move->rotated == PIECE_ROTATE_90 ) {
 			for( int i = x-1, gy = move->gridY; i >= 0; i--,gy++ )
 			for( int j =   0, gx = move->gridX; j <  y; j++,gx++ )
 				applyPiecePattern( piece, movelistsOut, gridOut, player, playerBit, i, j, gx, gy,
-					nNewLiberties, newLiberties ); }
+					nNewLiberties, newLiberties, key ); }
 
 		else if( move->rotated == PIECE_ROTATE_180 ) {
 			for( int j = y-1, gy = move->gridY; j >= 0; j--,gy++ )
 			for( int i = x-1, gx = move->gridX; i >= 0; i--,gx++ )
 				applyPiecePattern( piece, movelistsOut, gridOut, player, playerBit, i, j, gx, gy,
-					nNewLiberties, newLiberties ); }
+					nNewLiberties, newLiberties, key ); }
 
 		else if( move->rotated == PIECE_ROTATE_270 ) {
 			for( int i =   0, gy = move->gridY; i <  x; i++,gy++ )
 			for( int j = y-1, gx = move->gridX; j >= 0; j--,gx++ )
 				applyPiecePattern( piece, movelistsOut, gridOut, player, playerBit, i, j, gx, gy,
-					nNewLiberties, newLiberties ); }
+					nNewLiberties, newLiberties, key ); }
 
 	} else 
 	{
@@ -201,25 +201,25 @@ void MoveSimulator::simulateMove( const Move* move,
 			for( int j =   0, gy = move->gridY; j <  y; j++,gy++ )
 			for( int i = x-1, gx = move->gridX; i >= 0; i--,gx++ )
 				applyPiecePattern( piece, movelistsOut, gridOut, player, playerBit, i, j, gx, gy,
-					nNewLiberties, newLiberties ); }
+					nNewLiberties, newLiberties, key ); }
 
 		else if( move->rotated == PIECE_ROTATE_90 ) {
 			for( int i = x-1, gy = move->gridY; i >= 0; i--,gy++ )
 			for( int j = y-1, gx = move->gridX; j >= 0; j--,gx++ )
 				applyPiecePattern( piece, movelistsOut, gridOut, player, playerBit, i, j, gx, gy,
-					nNewLiberties, newLiberties ); }
+					nNewLiberties, newLiberties, key ); }
 
 		else if( move->rotated == PIECE_ROTATE_180 ) {
 			for( int j = y-1, gy = move->gridY; j >= 0; j--,gy++ )
 			for( int i =   0, gx = move->gridX; i <  x; i++,gx++ )
 				applyPiecePattern( piece, movelistsOut, gridOut, player, playerBit, i, j, gx, gy,
-					nNewLiberties, newLiberties ); }
+					nNewLiberties, newLiberties, key ); }
 
 		else if( move->rotated == PIECE_ROTATE_270 ) {
 			for( int i = 0, gy = move->gridY; i < x; i++,gy++ )
 			for( int j = 0, gx = move->gridX; j < y; j++,gx++ )
 				applyPiecePattern( piece, movelistsOut, gridOut, player, playerBit, i, j, gx, gy,
-					nNewLiberties, newLiberties ); }
+					nNewLiberties, newLiberties, key ); }
 	}
 
 	// Update any affect liberty move lists
@@ -252,15 +252,19 @@ void MoveSimulator::simulateMove( const Move* move,
 
 	// Switch player to move
 	*playerOut = 1 - player;
+
+	// Update the position key for the piece and player to move
+	if( key ) *key ^= Zobrist::getPieceKey( move->pieceNumber, player ) ^ Zobrist::getPlayerKey( );
 }
 //
 // --------------------------------------------------------
 //  ApplyPiecePattern - Applies a piece pattern to the grid 
-//  at the specified piece and grid coordinates.
+//  at the specified piece and grid coordinates, updating
+//  the position key for newly covered tiles if one is set.
 // --------------------------------------------------------
 void MoveSimulator::applyPiecePattern( Piece* piece, MoveLists* moveLists,
 	short gridOut[][14], int player, int playerBit, int i, int j, int gx, int gy,
-	int& nNewLiberties, GridLiberty newLiberties[] )
+	int& nNewLiberties, GridLiberty newLiberties[], unsigned __int64* key )
 {
 	// Get piece layout
 	short pattern = piece->getLayout( i, j );
@@ -283,6 +287,11 @@ void MoveSimulator::applyPiecePattern( Piece* piece, MoveLists* moveLists,
 		moveLists->markUnsafeTile( gx, gy, PLAYER_MAX );
 		moveLists->markUnsafeTile( gx, gy, PLAYER_MIN );
 
+		// Update the key, removing any cover being overwritten
+		if( key ) { *key ^= Zobrist::getTileKey( gx, gy, player );
+			for( int p = 0; p < NUM_PLAYERS; p++ ) if( gridOut[gx][gy] & ((1<<p)<<EX_GRID_COVERED) )
+				*key ^= Zobrist::getTileKey( gx, gy, p ); }
+
 		// Cover the underlying grid square with unsafe marks
 		gridOut[gx][gy] = (playerBit | (0x3<<EX_GRID_NOT_SAFE));
 	}
@@ -300,4 +309,78 @@ void MoveSimulator::applyPiecePattern( Piece* piece, MoveLists* moveLists,
 			nNewLiberties++;
 		}
 	}
+}
+//
+// --------------------------------------------------------
+//	IsValidMove - Checks that a move is valid for a player
+//  on the extended format board. Every covered tile must
+//  be safe for the player and one must be a liberty.
+// --------------------------------------------------------
+bool MoveSimulator::isValidMove( const Move* move, short grid[][14], int pieces[], int player )
+{
+	// Check the piece is available
+	if( !(pieces[player] & (1<<move->pieceNumber)) ) return false;
+
+	// Get piece object handle
+	Piece* piece = PieceSet::getPiece( move->pieceNumber );
+	int x = piece->getSizeX( ), y = piece->getSizeY( );
+
+	// Check the covered tiles
+	bool liberty = false;
+	for( int i = 0; i < x; i++ )
+	for( int j = 0; j < y; j++ )
+	if( piece->getLayout( i, j ) == EX_MATCH_NOT_COVERED )
+	{
+		// Check the tile is on the board and safe
+		int gx, gy; getTile( move, x, y, i, j, gx, gy );
+		if( gx < 0 || gx >= BOARD_SIZE || gy < 0 || gy >= BOARD_SIZE ) return false;
+		if( EX_GRID_IS( grid[gx][gy], EX_GRID_NOT_SAFE, player ) ) return false;
+
+		// Check for a liberty of the player
+		for( int a = 0; a < 4; a++ )
+			if( EX_GRID_IS( grid[gx][gy], EX_LBTY_ANGLE(a), player ) ) liberty = true;
+	}
+
+	return liberty;
+}
+//
+// --------------------------------------------------------
+//	ApplyMove - Covers the tiles of a valid move on the
+//  game board, returning the number of tiles covered.
+// --------------------------------------------------------
+int MoveSimulator::applyMove( const Move* move, char boardOut[][20], int player )
+{
+	// Get piece object handle
+	Piece* piece = PieceSet::getPiece( move->pieceNumber );
+	int x = piece->getSizeX( ), y = piece->getSizeY( );
+
+	// Cover the tiles of the piece
+	int nTiles = 0;
+	for( int i = 0; i < x; i++ )
+	for( int j = 0; j < y; j++ )
+	if( piece->getLayout( i, j ) == EX_MATCH_NOT_COVERED ) {
+		int gx, gy; getTile( move, x, y, i, j, gx, gy );
+		boardOut[gx][gy] = (char)player; nTiles++; }
+
+	return nTiles;
+}
+//
+// --------------------------------------------------------
+//	GetTile - Maps the piece layout coordinates of a tile
+//  to board coordinates for the orientation of the move,
+//  matching the pattern traversal of simulateMove.
+// --------------------------------------------------------
+void MoveSimulator::getTile( const Move* move, int x, int y, int i, int j, int& gx, int& gy )
+{
+	// Unflipped and flipped orientations
+	if( move->flipped == PIECE_UNFLIPPED ) switch( move->rotated % 4 ) {
+		case PIECE_ROTATE_0:   gx = move->gridX + i;     gy = move->gridY + j;     break;
+		case PIECE_ROTATE_90:  gx = move->gridX + j;     gy = move->gridY + x-1-i; break;
+		case PIECE_ROTATE_180: gx = move->gridX + x-1-i; gy = move->gridY + y-1-j; break;
+		default:               gx = move->gridX + y-1-j; gy = move->gridY + i;     break; }
+	else switch( move->rotated % 4 ) {
+		case PIECE_ROTATE_0:   gx = move->gridX + x-1-i; gy = move->gridY + j;     break;
+		case PIECE_ROTATE_90:  gx = move->gridX + y-1-j; gy = move->gridY + x-1-i; break;
+		case PIECE_ROTATE_180: gx = move->gridX + i;     gy = move->gridY + y-1-j; break;
+		default:               gx = move->gridX + j;     gy = move->gridY + i;     break; }
 }
\ No newline at end of file
@@ -38,20 +38,30 @@ public:
 	static void reformatBoard( char boardIn[][20], short boardOut[][14],
 		bool piecesIn[][21], int piecesOut[], int startTile[][2] );
 
-	// Simulates a move on an extended format board
+	// Simulates a move on an extended format board, updating
+	// the position key in place if one is specified
 	static void simulateMove( const Move* move, 
 		short grid[][14], int pieces[], int score[], int player,
 		short gridOut[][14], int piecesOut[], int scoreOut[], int* playerOut,
-		MoveLists* movelists, MoveLists* movelistsOut );
+		MoveLists* movelists, MoveLists* movelistsOut, unsigned __int64* key = NULL );
+
+	// Checks that a move is valid for a player on an extended format board
+	static bool isValidMove( const Move* move, short grid[][14], int pieces[], int player );
+
+	// Covers the tiles of a move on a game board, returns the tile count
+	static int applyMove( const Move* move, char boardOut[][20], int player );
 
 protected:
 	// Liberty location structure
 	struct GridLiberty { int x, y, angle; };
 
+	// Maps piece layout coordinates to grid coordinates for a move
+	static void getTile( const Move* move, int x, int y, int i, int j, int& gx, int& gy );
+
 	// Pattern applyer helper
 	__forceinline static void applyPiecePattern( Piece* piece, MoveLists* moveList,
 		short gridOut[][14], int player, int playerBit, int i, int j, int gx, int gy,
-		int& nNewLiberties, GridLiberty newLiberties[] );
+		int& nNewLiberties, GridLiberty newLiberties[], unsigned __int64* key );
 };
 
 // End definition 
@@ -34,4 +34,8 @@
 // Profiler data members
 __int64 Profiler::m_timeCosts[tMax];
 unsigned int Profiler::m_nodesSearched;
-unsigned int Profiler::m_leavesSearched;
\ No newline at end of file
+unsigned int Profiler::m_leavesSearched;
+unsigned int Profiler::m_cacheProbes;
+unsigned int Profiler::m_cacheHits;
+unsigned int Profiler::m_cutoffNodes;
+unsigned int Profiler::m_firstMoveCutoffs;
\ No newline at end of file
@@ -37,6 +37,8 @@ enum ProfilerFunction
 	tTotal,
 	tReformatBoard,
 	tMinimaxSearch,
+		tBeamRanking,
+		tMoveOrdering,
 		tMoveGeneration,
 		tMoveEnumeration,
 		tSimulateMoves,
@@ -78,12 +80,22 @@ public:
 	__forceinline static void addSearchNode( ) { if( PROFILE ) m_nodesSearched++; }
 	__forceinline static void addLeafNode( ) { if( PROFILE ) m_leavesSearched++; }
 
+	// Increment the evaluation cache counters
+	__forceinline static void addCacheProbe( bool hit ) 
+		{ if( PROFILE ) { m_cacheProbes++; if( hit ) m_cacheHits++; } }
+
+	// Increment the alpha-beta cut-off counters
+	__forceinline static void addCutoff( bool firstMove ) 
+		{ if( PROFILE ) { m_cutoffNodes++; if( firstMove ) m_firstMoveCutoffs++; } }
+
 	// Clear profiler data
 	__forceinline static void clear( )
 	{
 		if( PROFILE ) {
 			for( int i = 0; i < tMax; i++ ) m_timeCosts[i] = 0; 
-			m_nodesSearched = 0; m_leavesSearched = 0; }
+			m_nodesSearched = 0; m_leavesSearched = 0; 
+			m_cacheProbes = 0; m_cacheHits = 0;
+			m_cutoffNodes = 0; m_firstMoveCutoffs = 0; }
 	}
 
 	// Print profile data to std output
@@ -97,12 +109,20 @@ public:
 		if( PROFILE ) {
 		std::cout << "Searched Nodes: " << m_nodesSearched << "\n";
 		std::cout << "Searched Leafs: " << m_leavesSearched << "\n";
+		std::cout << "Eval Cache Hits: " << m_cacheHits << "/" << m_cacheProbes << " (" 
+			<< (int)(100.0*(double)m_cacheHits/(double)max(m_cacheProbes,1u) + 0.5) << "%)\n";
+		std::cout << "First Move Cutoffs: " << m_firstMoveCutoffs << "/" << m_cutoffNodes << " (" 
+			<< (int)(100.0*(double)m_firstMoveCutoffs/(double)max(m_cutoffNodes,1u) + 0.5) << "%)\n";
 		std::cout << "Total Time " << (int)(100.0*(double)m_timeCosts[tTotal] 
 			/ (double)m_timeCosts[tTotal] + 0.5) << "%\n";
 		std::cout << "  - Reformat Board: " << (int)(100.0*(double)m_timeCosts[tReformatBoard] 
 			/ (double)m_timeCosts[tTotal] + 0.5) << "%\n";
 		std::cout << "  - Minimax: " << (int)(100.0*(double)m_timeCosts[tMinimaxSearch] 
 			/ (double)m_timeCosts[tTotal] + 0.5) << "%\n";
+		std::cout << "      - Beam Ranking: " << (int)(100.0*(double)m_timeCosts[tBeamRanking]
+			/ (double)m_timeCosts[tTotal] + 0.5) << "%\n";
+		std::cout << "      - Move Ordering: " << (int)(100.0*(double)m_timeCosts[tMoveOrdering]
+			/ (double)m_timeCosts[tTotal] + 0.5) << "%\n";
 		std::cout << "      - Move Enumeration: " << (int)(100.0*(double)m_timeCosts[tMoveEnumeration] 
 			/ (double)m_timeCosts[tTotal] + 0.5) << "%\n";
 		std::cout << "      - Move Simulation: " << (int)(100.0*(double)m_timeCosts[tSimulateMoves] 
@@ -137,6 +157,10 @@ private:
 	static __int64 m_timeCosts[tMax];
 	static unsigned int m_nodesSearched;
 	static unsigned int m_leavesSearched;
+	static unsigned int m_cacheProbes;
+	static unsigned int m_cacheHits;
+	static unsigned int m_cutoffNodes;
+	static unsigned int m_firstMoveCutoffs;
 };
 
 // End def
@@ -30,9 +30,31 @@
 // Standard Includes
 #include "Includes.h"
 
+// Self-play adapter of the AI player
+class BeamSelfPlay : public SelfPlayEngine
+{
+public:
+	void startup( int boardSize, int startTile[][2], int nPlayers ) {
+		m_player.startup( boardSize, startTile, nPlayers ); }
+	void shutdown( ) { m_player.shutdown( ); }
+	Move makeMove( char board[][20], bool pieces[][21], int score[], int player, int ply, Move moves[42] ) {
+		return m_player.makeMove( board, pieces, score, player, ply, moves ); }
+	bool getMoveUtility( float* utility ) { return m_player.getMoveUtility( utility ); }
+
+private:
+	Minimax m_player;
+};
+
+// Self-play adapter construction
+static SelfPlayEngine* createEngine( ) { return new BeamSelfPlay; }
+
 // Application entry point
 int main( int argc, char* argv[] )
 {
+	// Play headless self-play games for training data
+	if( argc > 1 && std::string( argv[1] ) == "-selfplay" )
+		return SelfPlay::runCommand( argc-2, argv+2, &createEngine, true );
+
 	// AI Player
 	Minimax player;
 
@@ -25,16 +25,19 @@
 =========================================================================== */
 
 // Windows headers
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 // C++ Standard IO
 #include <iostream>
+#include <cstdlib>
 
 // Debug flag
 #ifdef _DEBUG
-#define DEBUG TRUE
+#define DEBUG 1
 #else 
-#define DEBUG FALSE
+#define DEBUG 0
 #endif
 
 // Break into debugger
@@ -0,0 +1,103 @@
+/* ===========================================================================
+
+	Project: AI player for Blokus
+
+	Description:
+	  Fixed size cache of board evaluations keyed by position hash.
+
+    Copyright (C) 2011 Lucas Sherman
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Standard includes
+#include <windows.h>
+
+// Include header
+#include "EvalCache.h"
+
+// --------------------------------------------------------
+//	Allocate - Allocates an empty table with the specified
+//  number of entries, which must be a power of two.
+// --------------------------------------------------------
+void EvalCache::allocate( int nEntries )
+{
+	release( );
+
+	m_table = new Entry[nEntries];
+	m_mask = nEntries - 1;
+	clear( );
+}
+//
+// --------------------------------------------------------
+//	Release - Releases the table memory.
+// --------------------------------------------------------
+void EvalCache::release( )
+{
+	delete [] m_table;
+	m_table = NULL; m_mask = 0;
+}
+//
+// --------------------------------------------------------
+//	Clear - Marks every table entry unused. Zobrist keys 
+//  start from a nonzero base, so zeroed entries are not
+//  expected to match a key.
+// --------------------------------------------------------
+void EvalCache::clear( )
+{
+	if( m_table ) ZeroMemory( m_table, sizeof(Entry)*(m_mask+1) );
+}
+//
+// --------------------------------------------------------
+//	Probe - Retrieves the cached evaluation of a position 
+//  by the specified evaluation function. Returns false if
+//  the position is not in the table. The data word holds
+//  the function in its upper half and the value bits in
+//  its lower half. The table is read without locking, so
+//  the entry is copied before it is checked.
+// --------------------------------------------------------
+bool EvalCache::probe( unsigned __int64 key, int function, float* value )
+{
+	// Copy the entry
+	Entry entry = m_table[key&m_mask];
+
+	// Check the key and function
+	if( (entry.check^entry.data) != key ) return false;
+	if( (int)(entry.data>>32) != function ) return false;
+
+	// Unpack the value
+	unsigned int bits = (unsigned int)entry.data;
+	*value = *(float*)&bits;
+
+	return true;
+}
+//
+// --------------------------------------------------------
+//	Store - Stores the evaluation of a position by the 
+//  specified evaluation function, always replacing the
+//  previous entry.
+// --------------------------------------------------------
+void EvalCache::store( unsigned __int64 key, int function, float value )
+{
+	// Pack the data word
+	unsigned __int64 data = ((unsigned __int64)function<<32) | *(unsigned int*)&value;
+
+	// Write the entry
+	Entry* entry = &m_table[key&m_mask];
+	entry->check = key ^ data;
+	entry->data = data;
+}
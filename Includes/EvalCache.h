@@ -0,0 +1,60 @@
+/* ===========================================================================
+
+	Project: AI player for Blokus
+
+	Description:
+	  Fixed size cache of board evaluations keyed by position hash.
+
+    Copyright (C) 2011 Lucas Sherman
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Begin definition
+#ifndef EVAL_CACHE_H
+#define EVAL_CACHE_H
+
+// Evaluation cache
+class EvalCache
+{
+public:
+	// Construction
+	EvalCache( ) { m_table = NULL; m_mask = 0; }
+
+	// Table allocation, the entry count must be a power of two
+	void allocate( int nEntries );
+	void release( );
+	void clear( );
+
+	// Looks up the evaluation of a position by the specified function
+	bool probe( unsigned __int64 key, int function, float* value );
+
+	// Stores the evaluation of a position by the specified function
+	void store( unsigned __int64 key, int function, float value );
+
+private:
+	// Table entries store the position key xor the data so
+	// that entries torn by concurrent writes fail the key check
+	struct Entry { unsigned __int64 check; unsigned __int64 data; };
+
+	// Table data
+	Entry* m_table;			//< Entry table
+	unsigned int m_mask;	//< Entry index mask
+};
+
+// End definition
+#endif
@@ -0,0 +1,213 @@
+/* ===========================================================================
+
+	Project: AI player for Blokus
+
+	Description:
+	  Evaluation service shared by the search threads, which queue
+	  positions for a single evaluator thread to run through the
+	  network in batches.
+
+    Copyright (C) 2011 Lucas Sherman
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Standard includes
+#include <windows.h>
+#include <process.h>
+
+// Include header
+#include "EvalService.h"
+
+// Static member variables
+EvalService::Request EvalService::m_queue[EVAL_QUEUE_SIZE];
+volatile long EvalService::m_tail;
+long EvalService::m_head;
+const Nnue* EvalService::m_network;
+int EvalService::m_batchSize;
+HANDLE EvalService::m_thread;
+volatile long EvalService::m_stop;
+unsigned int EvalService::m_nRequests;
+unsigned int EvalService::m_nBatches;
+__int64 EvalService::m_latencySum;
+__int64 EvalService::m_latencyMax;
+
+// --------------------------------------------------------
+//	Start - Resets the queue and starts the evaluator
+//  thread on the network.
+// --------------------------------------------------------
+bool EvalService::start( const Nnue* network, int batchSize )
+{
+	if( m_thread ) return false;
+
+	// Reset the queue slots to the first tickets
+	for( int i = 0; i < EVAL_QUEUE_SIZE; i++ )
+		m_queue[i].sequence = i;
+	m_tail = 0; m_head = 0;
+
+	// Store the evaluator settings
+	m_network = network; m_stop = FALSE;
+	m_batchSize = batchSize < 1 ? 1 : batchSize > EVAL_MAX_BATCH ? EVAL_MAX_BATCH : batchSize;
+	clearStats( );
+
+	// Start the evaluator thread
+	m_thread = (HANDLE)_beginthreadex( NULL, 0, &evaluatorThread, NULL, 0, NULL );
+
+	return m_thread != NULL;
+}
+//
+// --------------------------------------------------------
+//	Stop - Signals the evaluator thread and waits for it
+//  to exit.
+// --------------------------------------------------------
+void EvalService::stop( )
+{
+	if( !m_thread ) return;
+
+	InterlockedExchange( &m_stop, TRUE );
+	WaitForSingleObject( m_thread, INFINITE );
+	CloseHandle( m_thread ); m_thread = NULL;
+}
+//
+// --------------------------------------------------------
+//	Submit - Takes the next ticket and fills its slot once
+//  the previous ticket of the slot has been collected.
+// --------------------------------------------------------
+long EvalService::submit( const NnueAccumulator* accumulator, int player )
+{
+	long ticket = InterlockedIncrement( &m_tail ) - 1;
+	Request& request = m_queue[ticket & (EVAL_QUEUE_SIZE-1)];
+	while( request.sequence != ticket ) SwitchToThread( );
+
+	// Fill the slot then publish it to the evaluator
+	LARGE_INTEGER time; QueryPerformanceCounter( &time );
+	request.accumulator = accumulator; request.player = player;
+	request.submitTime = time.QuadPart;
+	InterlockedExchange( &request.sequence, ticket+1 );
+
+	return ticket;
+}
+//
+// --------------------------------------------------------
+//	Poll - Takes the result of an evaluated ticket and
+//  frees its slot for the ticket a queue length later.
+// --------------------------------------------------------
+bool EvalService::poll( long ticket, float* value )
+{
+	Request& request = m_queue[ticket & (EVAL_QUEUE_SIZE-1)];
+	if( request.sequence != ticket+2 ) return false;
+
+	*value = request.value;
+	InterlockedExchange( &request.sequence, ticket+EVAL_QUEUE_SIZE );
+
+	return true;
+}
+//
+// --------------------------------------------------------
+//	Wait - Yields the processor to other threads until the
+//  ticket has been evaluated.
+// --------------------------------------------------------
+float EvalService::wait( long ticket )
+{
+	float value;
+	while( !poll( ticket, &value ) ) SwitchToThread( );
+
+	return value;
+}
+//
+// --------------------------------------------------------
+//	Evaluate - Submits a single request and waits for it.
+// --------------------------------------------------------
+float EvalService::evaluate( const NnueAccumulator* accumulator, int player )
+{
+	return wait( submit( accumulator, player ) );
+}
+//
+// --------------------------------------------------------
+//	GetStats - Converts the counters to batch and latency
+//  averages, latencies in microseconds.
+// --------------------------------------------------------
+void EvalService::getStats( EvalServiceStats* stats )
+{
+	LARGE_INTEGER frequency; QueryPerformanceFrequency( &frequency );
+	double toMicro = 1e6 / (double)frequency.QuadPart;
+
+	stats->nRequests = m_nRequests; stats->nBatches = m_nBatches;
+	stats->meanBatch = m_nBatches ? (float)m_nRequests / m_nBatches : 0.0f;
+	stats->batchFill = m_batchSize ? 100.0f * stats->meanBatch / m_batchSize : 0.0f;
+	stats->meanLatency = m_nRequests ? (float)(m_latencySum * toMicro / m_nRequests) : 0.0f;
+	stats->maxLatency = (float)(m_latencyMax * toMicro);
+}
+//
+// --------------------------------------------------------
+//	ClearStats - Resets the counters of the evaluator.
+// --------------------------------------------------------
+void EvalService::clearStats( )
+{
+	m_nRequests = 0; m_nBatches = 0;
+	m_latencySum = 0; m_latencyMax = 0;
+}
+//
+// --------------------------------------------------------
+//	EvaluatorThread - Gathers the consecutive submitted
+//  requests from the head of the queue, checking again
+//  for those whose tickets are taken but not yet filled,
+//  and evaluates them as a single batch.
+// --------------------------------------------------------
+unsigned int EvalService::evaluatorThread( void* data )
+{
+	const NnueAccumulator* accumulators[EVAL_MAX_BATCH];
+	int players[EVAL_MAX_BATCH]; float values[EVAL_MAX_BATCH];
+
+	while( !m_stop )
+	{
+		// Gather the submitted requests
+		int nRequests = 0, spins = 0;
+		while( nRequests < m_batchSize ) {
+			long ticket = m_head + nRequests;
+			Request& request = m_queue[ticket & (EVAL_QUEUE_SIZE-1)];
+			if( request.sequence != ticket+1 ) {
+				if( m_tail != ticket && spins++ < EVAL_GATHER_SPINS ) continue;
+				break; }
+			accumulators[nRequests] = request.accumulator;
+			players[nRequests] = request.player;
+			nRequests++; }
+
+		// Wait for requests
+		if( nRequests == 0 ) { SwitchToThread( ); continue; }
+
+		// Run the batch through the network
+		m_network->evaluateBatch( accumulators, players, nRequests, values );
+
+		// Publish the results, recording their latency
+		LARGE_INTEGER time; QueryPerformanceCounter( &time );
+		for( int i = 0; i < nRequests; i++ ) {
+			long ticket = m_head + i;
+			Request& request = m_queue[ticket & (EVAL_QUEUE_SIZE-1)];
+			__int64 latency = time.QuadPart - request.submitTime;
+			m_latencySum += latency;
+			if( latency > m_latencyMax ) m_latencyMax = latency;
+			request.value = values[i];
+			InterlockedExchange( &request.sequence, ticket+2 ); }
+
+		// Advance past the batch
+		m_head += nRequests;
+		m_nRequests += nRequests; m_nBatches++;
+	}
+
+	return 0;
+}
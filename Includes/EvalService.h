@@ -0,0 +1,117 @@
+/* ===========================================================================
+
+	Project: AI player for Blokus
+
+	Description:
+	  Evaluation service shared by the search threads, which queue
+	  positions for a single evaluator thread to run through the
+	  network in batches.
+
+    Copyright (C) 2011 Lucas Sherman
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Begin definition
+#ifndef EVAL_SERVICE_H
+#define EVAL_SERVICE_H
+
+// Evaluation network
+#include "Nnue.h"
+
+// Service settings
+#define EVAL_QUEUE_SIZE   256   //< Requests in the queue (power of two)
+#define EVAL_MAX_BATCH NNUE_MAX_BATCH //< Most requests evaluated at once
+#define EVAL_GATHER_SPINS  64   //< Checks for a claimed request before evaluating without it
+
+// Service statistics
+struct EvalServiceStats
+{
+	unsigned int nRequests;		//< Requests evaluated
+	unsigned int nBatches;		//< Batches evaluated
+	float meanBatch;			//< Mean requests per batch
+	float batchFill;			//< Mean batch size over the batch limit (%)
+	float meanLatency;			//< Mean time from submission to result (us)
+	float maxLatency;			//< Longest time from submission to result (us)
+};
+
+// Batched network evaluation
+class EvalService
+{
+public:
+	// Starts the evaluator thread on a loaded network, evaluating up
+	// to batchSize requests at once. Returns false if already running.
+	static bool start( const Nnue* network, int batchSize = EVAL_MAX_BATCH );
+
+	// Stops the evaluator thread, all requests must be collected
+	static void stop( );
+	static bool isRunning( ) { return m_thread != NULL; }
+
+	// Queues an accumulator for evaluation for the player to move and
+	// returns the ticket of its result. The accumulator must remain
+	// valid until the result is collected, and the uncollected tickets
+	// of all threads must fit in the queue.
+	static long submit( const NnueAccumulator* accumulator, int player );
+
+	// Collects the result of a ticket if it has been evaluated
+	static bool poll( long ticket, float* value );
+
+	// Collects the result of a ticket, yielding until it is evaluated
+	static float wait( long ticket );
+
+	// Evaluates a single accumulator through the queue
+	static float evaluate( const NnueAccumulator* accumulator, int player );
+
+	// Statistics since the last clear
+	static void getStats( EvalServiceStats* stats );
+	static void clearStats( );
+
+private:
+	EvalService( );
+
+	// Queue slot, the sequence tracks the slot through its use by
+	// the ticket t: t when free, t+1 when submitted, t+2 when
+	// evaluated, then t+EVAL_QUEUE_SIZE for the next ticket
+	struct Request {
+		volatile long sequence;
+		const NnueAccumulator* accumulator;
+		int player;
+		float value;
+		__int64 submitTime;
+	};
+
+	// Evaluator thread entry, evaluates batches until stopped
+	static unsigned int __stdcall evaluatorThread( void* data );
+
+	// Queue data
+	static Request m_queue[EVAL_QUEUE_SIZE];
+	static volatile long m_tail;			//< Next ticket to submit
+	static long m_head;						//< Next ticket to evaluate
+
+	// Evaluator data
+	static const Nnue* m_network;
+	static int m_batchSize;
+	static HANDLE m_thread;
+	static volatile long m_stop;
+
+	// Statistics data
+	static unsigned int m_nRequests, m_nBatches;
+	static __int64 m_latencySum, m_latencyMax;
+};
+
+// End definition
+#endif
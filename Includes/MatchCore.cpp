@@ -0,0 +1,671 @@
+/* ===========================================================================
+
+	Project: MetaBlok - MatchCore
+
+	Description: Rules and state of Blokus matches, shared by the
+	  simulator and the headless match runners
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Standard includes
+#include <sstream>
+#include <string>
+#include <algorithm>
+
+// Include header
+#include "MatchCore.h"
+
+// --------------------------------------------------------
+//	Loads the piece layouts and begins a duo match.
+// --------------------------------------------------------
+MatchCore::MatchCore( )
+{
+	// Load game piece layouts
+	m_gamePieceLayouts = PieceSet::instance( );
+
+	// Begin initial match
+	reset( MODE_DUO );
+}
+//
+// --------------------------------------------------------
+//	Applies the board size, player count and start tiles
+//  of a match mode and clears the board.
+// --------------------------------------------------------
+void MatchCore::reset( int matchMode )
+{
+	// Update match type
+	m_matchMode = matchMode;
+
+	// Number of players
+	if( m_matchMode == MODE_DUO ) m_numberOfPlayers = 2;
+	else m_numberOfPlayers = 2;
+
+	// Board dimensions
+	if( m_matchMode == MODE_DUO ) m_boardSize = 14;
+	else m_boardSize = 20;
+
+	// Starting tile
+	if( m_matchMode == MODE_DUO ) {
+		m_startTile[PLAYER_BLUE][0] = 4;
+		m_startTile[PLAYER_BLUE][1] = 4;
+		m_startTile[PLAYER_RED] [0] = 9;
+		m_startTile[PLAYER_RED] [1] = 9;
+	} else {
+		m_startTile[PLAYER_BLUE][0] = 0;
+		m_startTile[PLAYER_BLUE][1] = 0;
+		m_startTile[PLAYER_RED][0] = 19;
+		m_startTile[PLAYER_RED][1] = 0;
+		m_startTile[PLAYER_GREEN][0] = 19;
+		m_startTile[PLAYER_GREEN][1] = 19;
+		m_startTile[PLAYER_YELLOW][0] = 0;
+		m_startTile[PLAYER_YELLOW][1] = 19; }
+
+	// Clear the game state
+	clear( );
+}
+//
+// --------------------------------------------------------
+//	Empties the board, returns every piece and resets the
+//  scores and move history.
+// --------------------------------------------------------
+void MatchCore::clear( )
+{
+	// Clear board data
+	for( int i = 0; i < 20; i++ )
+	for( int j = 0; j < 20; j++ )
+		m_board[i][j] = GRID_COVER_NONE;
+
+	// Reset player scores
+	for( int i = 0; i < 4; i++ )
+		m_score[i] = 0;
+
+	// Replace game pieces
+	for( int i = 0; i < 4;  i++ )
+	for( int j = 0; j < 21; j++ )
+		m_pieces[i][j] = true;
+
+	// Clear tracking variables
+	m_currentPlayer = PLAYER_BLUE;
+	m_currentPly = 0;
+
+	// Set match end flag
+	m_matchEnd = false;
+}
+//
+// --------------------------------------------------------
+//	Checks the validity of the given move for the current
+//  player.
+// --------------------------------------------------------
+bool MatchCore::isValidMove( const Move& move ) const
+{
+	// Check if piece pattern is available for use
+	if( move.pieceNumber < 0 || move.pieceNumber >= 21 ||
+		!m_pieces[m_currentPlayer][move.pieceNumber] )
+		return false;
+
+	// Check for valid rotation angle
+	if( move.rotated < PIECE_ROTATE_0 ||
+		move.rotated > PIECE_ROTATE_270 )
+		return false;
+
+	// Run pattern analysis between grid and piece
+	bool coversLiberty = false;
+	int x = m_gamePieceLayouts->getSizeX( move.pieceNumber );
+	int y = m_gamePieceLayouts->getSizeY( move.pieceNumber );
+	if( move.flipped == PIECE_UNFLIPPED ) {
+		if( move.rotated == PIECE_ROTATE_0 ) {
+			for( int j = 0, gy = move.gridY; j < y; j++,gy++ )
+			for( int i = 0, gx = move.gridX; i < x; i++,gx++ )
+				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy ) ) return false; }
+
+		else if( move.rotated == PIECE_ROTATE_90 ) {
+			for( int i = x-1, gy = move.gridY; i >= 0; i--,gy++ )
+			for( int j =   0, gx = move.gridX; j <  y; j++,gx++ )
+				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy ) ) return false; }
+
+		else if( move.rotated == PIECE_ROTATE_180 ) {
+			for( int j = y-1, gy = move.gridY; j >= 0; j--,gy++ )
+			for( int i = x-1, gx = move.gridX; i >= 0; i--,gx++ )
+				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy ) ) return false; }
+
+		else if( move.rotated == PIECE_ROTATE_270 ) {
+			for( int i =   0, gy = move.gridY; i <  x; i++,gy++ )
+			for( int j = y-1, gx = move.gridX; j >= 0; j--,gx++ )
+				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy ) ) return false; }
+	} else {
+		if( move.rotated == PIECE_ROTATE_0 ) {
+			for( int j =   0, gy = move.gridY; j <  y; j++,gy++ )
+			for( int i = x-1, gx = move.gridX; i >= 0; i--,gx++ )
+				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy ) ) return false; }
+
+		else if( move.rotated == PIECE_ROTATE_90 ) {
+			for( int i = x-1, gy = move.gridY; i >= 0; i--,gy++ )
+			for( int j = y-1, gx = move.gridX; j >= 0; j--,gx++ )
+				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy ) ) return false; }
+
+		else if( move.rotated == PIECE_ROTATE_180 ) {
+			for( int j = y-1, gy = move.gridY; j >= 0; j--,gy++ )
+			for( int i =   0, gx = move.gridX; i <  x; i++,gx++ )
+				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy ) ) return false; }
+
+		else if( move.rotated == PIECE_ROTATE_270 ) {
+			for( int i = 0, gy = move.gridY; i < x; i++,gy++ )
+			for( int j = 0, gx = move.gridX; j < y; j++,gx++ )
+				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy ) ) return false; }
+	}
+
+	// Check if liberty is covered
+	if( coversLiberty ) return true;
+	else return false;
+}
+//
+// --------------------------------------------------------
+//	Checks if the patterns on the grid and piece are
+//	compatible and updates the liberty covered flag
+//	if necessary.
+// --------------------------------------------------------
+bool MatchCore::isValidPattern( int pieceNumber, bool* liberty,
+						   int px, int py, int gx, int gy ) const
+{
+	// Check for outside grid bounds on a covering tile
+	char piecePattern = m_gamePieceLayouts->indexOf( pieceNumber, px, py );
+	if( gx < 0 || gx >= m_boardSize || gy < 0 || gy >= m_boardSize ) {
+		if( piecePattern == MATCH_NOT_COVERED ) return false;
+		else return true; }
+
+	// Check if local patterns are acceptable
+	char gridPattern = m_board[gx][gy];
+	switch( piecePattern ) {
+		case MATCH_NOT_PLAYERS:
+			if( gridPattern == m_currentPlayer ) return false;
+			break;
+		case MATCH_NOT_COVERED:
+			if( gridPattern != GRID_COVER_NONE ) return false;
+			else if( gx == m_startTile[m_currentPlayer][0] &&
+					 gy == m_startTile[m_currentPlayer][1] ) *liberty = true;
+			break;
+		case MATCH_LIBERTY:
+			if( gridPattern == m_currentPlayer ) *liberty = true; }
+
+	return true;
+}
+//
+// --------------------------------------------------------
+//	Returns false if there is no available move for the
+//	current player.
+// --------------------------------------------------------
+bool MatchCore::isMoveAvailable( ) const
+{
+	Move move;
+
+	// Cycle through available pieces
+	for( int i = 0; i < 21; i++ )
+	if( m_pieces[m_currentPlayer][i] )
+	{
+		move.pieceNumber = i;
+
+		// Cycle through all orients
+		for( int x = -1; x < m_boardSize-m_gamePieceLayouts->getSizeY( move.pieceNumber )+2; x++ )
+		for( int y = -1; y < m_boardSize-m_gamePieceLayouts->getSizeY( move.pieceNumber )+2; y++ )
+		for( int r = 0; r < m_gamePieceLayouts->getOrients( move.pieceNumber ); r++ )
+		for( int f = 0; f <= m_gamePieceLayouts->getFlips( move.pieceNumber ); f++ )
+		{
+			move.flipped = f;
+			move.rotated = r;
+			move.gridX = x;
+			move.gridY = y;
+
+			if( isValidMove( move ) )
+				return true;
+		}
+	}
+
+	return false;
+}
+//
+// --------------------------------------------------------
+//	Lists every valid move of the current player in its
+//  unambiguous orientation. The grid position of a piece
+//  layout may start outside of the board, so positions
+//  are tried from one layout width before the board.
+// --------------------------------------------------------
+void MatchCore::getMoves( std::vector<Move>& moves ) const
+{
+	moves.clear( ); Move move;
+
+	// Cycle through available pieces
+	for( int i = 0; i < 21; i++ )
+	if( m_pieces[m_currentPlayer][i] )
+	{
+		move.pieceNumber = i;
+		int size = std::max( m_gamePieceLayouts->getSizeX( i ), m_gamePieceLayouts->getSizeY( i ) );
+
+		// Cycle through all positions and orients
+		for( int x = 1-size; x < m_boardSize; x++ )
+		for( int y = 1-size; y < m_boardSize; y++ )
+		for( int r = 0; r < m_gamePieceLayouts->getOrients( i ); r++ )
+		for( int f = 0; f <= m_gamePieceLayouts->getFlips( i ); f++ )
+		{
+			move.flipped = f;
+			move.rotated = r;
+			move.gridX = x;
+			move.gridY = y;
+
+			if( isValidMove( move ) )
+				moves.push_back( move );
+		}
+	}
+}
+//
+// --------------------------------------------------------
+//	Maps a move to the unique orientation recorded in the
+//  move history.
+// --------------------------------------------------------
+Move MatchCore::getUniqueMove( Move move ) const
+{
+	// Pieces without a flip are flipped by one of their rotations,
+	// which depends on the axis of symmetry of the piece layout
+	if( move.flipped && !m_gamePieceLayouts->getFlips( move.pieceNumber ) )
+	{
+		int tiles[5][2], nTiles = getPieceTiles( move, tiles );
+		move.flipped = PIECE_UNFLIPPED;
+		for( move.rotated = 0; move.rotated < 4; move.rotated++ )
+		{
+			// Find the rotation covering the same tiles
+			int rotTiles[5][2], nRotTiles = getPieceTiles( move, rotTiles ), nShared = 0;
+			for( int i = 0; i < nTiles; i++ )
+			for( int j = 0; j < nRotTiles; j++ )
+				if( tiles[i][0] == rotTiles[j][0] && tiles[i][1] == rotTiles[j][1] ) nShared++;
+			if( nShared == nTiles ) break;
+		}
+	}
+
+	// Rotations beyond the distinct orients repeat the layout
+	move.rotated %= m_gamePieceLayouts->getOrients( move.pieceNumber );
+
+	return move;
+}
+//
+// --------------------------------------------------------
+//	Updates the game data to reflect the execution of the
+//  valid input move.
+// --------------------------------------------------------
+void MatchCore::makeMove( Move move )
+{
+	// Map the move to unique value
+	move = getUniqueMove( move );
+
+	// Add the move to the move history
+	m_moveHistory[m_currentPly] = move;
+	m_currentPly++;
+
+	// Update piece registry
+	m_pieces[m_currentPlayer][move.pieceNumber] = false;
+
+	// Iterate over piece pattern and update game board
+	setPieceTiles( move, (char)m_currentPlayer );
+
+	// Update player score variable
+	m_score[m_currentPlayer] += getPieceScore( move.pieceNumber );
+
+	// Update current player variable
+	int prevPlayer = m_currentPlayer;
+	m_currentPlayer++; m_currentPlayer %= m_numberOfPlayers;
+
+	// Skip turns for players unable to move
+	while( !isMoveAvailable( ) && prevPlayer != m_currentPlayer)
+	{
+		// Move to next player
+		m_currentPlayer++; m_currentPlayer %= m_numberOfPlayers;
+
+		// Put a skip move on the history
+		Move skip; skip.pieceNumber = -1;
+		skip.flipped = skip.gridX = skip.gridY = skip.rotated = 0;
+		m_moveHistory[m_currentPly] = skip;
+		m_currentPly++;
+	}
+
+	// Check for game over condition (if no one can move)
+	if( prevPlayer == m_currentPlayer && !isMoveAvailable( ) )
+	{
+		// Remove the skips of the other players, leaving the turn
+		// with the next player so that undoing takes the last move
+		m_currentPly -= m_numberOfPlayers-1;
+		m_currentPlayer = (prevPlayer+1) % m_numberOfPlayers;
+
+		// Set the end flag
+		m_matchEnd = true;
+	}
+}
+//
+// --------------------------------------------------------
+//	Removes the last ply from the history, returning to
+//  the player who made it and taking a move back off the
+//  board. Returns the move, which is a skip if its piece
+//  number is -1.
+// --------------------------------------------------------
+Move MatchCore::undoPly( )
+{
+	// Mark match incomplete
+	m_matchEnd = false;
+
+	// Remove the move from the history
+	m_currentPly--; Move move = m_moveHistory[m_currentPly];
+
+	// Return to the previous player
+	if( !m_currentPlayer )
+		m_currentPlayer = m_numberOfPlayers;
+	m_currentPlayer--;
+
+	// Check if the move was a skip
+	if( move.pieceNumber == -1 ) return move;
+
+	// Move the piece off the board
+	setPieceTiles( move, GRID_COVER_NONE );
+
+	// Update piece registry
+	m_pieces[m_currentPlayer][move.pieceNumber] = true;
+
+	// Update player score variable
+	m_score[m_currentPlayer] -= getPieceScore( move.pieceNumber );
+
+	return move;
+}
+//
+// --------------------------------------------------------
+//	Sets the board tiles covered by the piece pattern of a
+//  move to the given cover.
+// --------------------------------------------------------
+void MatchCore::setPieceTiles( const Move& move, char cover )
+{
+	int tiles[5][2], nTiles = getPieceTiles( move, tiles );
+	for( int i = 0; i < nTiles; i++ )
+		m_board[tiles[i][0]][tiles[i][1]] = cover;
+}
+//
+// --------------------------------------------------------
+//	Lists the board tiles covered by the piece pattern of
+//  a move. Returns the number of tiles.
+// --------------------------------------------------------
+int MatchCore::getPieceTiles( const Move& move, int tiles[][2] ) const
+{
+	int nTiles = 0;
+	int x = m_gamePieceLayouts->getSizeX( move.pieceNumber );
+	int y = m_gamePieceLayouts->getSizeY( move.pieceNumber );
+	if( move.flipped == PIECE_UNFLIPPED )
+	{
+		if( move.rotated == PIECE_ROTATE_0 ) {
+			for( int j = 0, gy = move.gridY; j < y; j++,gy++ )
+			for( int i = 0, gx = move.gridX; i < x; i++,gx++ )
+				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED )
+					{ tiles[nTiles][0] = gx; tiles[nTiles][1] = gy; nTiles++; } }
+
+		else if( move.rotated == PIECE_ROTATE_90 ) {
+			for( int i = x-1, gy = move.gridY; i >= 0; i--,gy++ )
+			for( int j =   0, gx = move.gridX; j <  y; j++,gx++ )
+				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED )
+					{ tiles[nTiles][0] = gx; tiles[nTiles][1] = gy; nTiles++; } }
+
+		else if( move.rotated == PIECE_ROTATE_180 ) {
+			for( int j = y-1, gy = move.gridY; j >= 0; j--,gy++ )
+			for( int i = x-1, gx = move.gridX; i >= 0; i--,gx++ )
+				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED )
+					{ tiles[nTiles][0] = gx; tiles[nTiles][1] = gy; nTiles++; } }
+
+		else if( move.rotated == PIECE_ROTATE_270 ) {
+			for( int i =   0, gy = move.gridY; i <  x; i++,gy++ )
+			for( int j = y-1, gx = move.gridX; j >= 0; j--,gx++ )
+				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED )
+					{ tiles[nTiles][0] = gx; tiles[nTiles][1] = gy; nTiles++; } }
+	} else {
+		if( move.rotated == PIECE_ROTATE_0 ) {
+			for( int j =   0, gy = move.gridY; j <  y; j++,gy++ )
+			for( int i = x-1, gx = move.gridX; i >= 0; i--,gx++ )
+				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED )
+					{ tiles[nTiles][0] = gx; tiles[nTiles][1] = gy; nTiles++; } }
+
+		else if( move.rotated == PIECE_ROTATE_90 ) {
+			for( int i = x-1, gy = move.gridY; i >= 0; i--,gy++ )
+			for( int j = y-1, gx = move.gridX; j >= 0; j--,gx++ )
+				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED )
+					{ tiles[nTiles][0] = gx; tiles[nTiles][1] = gy; nTiles++; } }
+
+		else if( move.rotated == PIECE_ROTATE_180 ) {
+			for( int j = y-1, gy = move.gridY; j >= 0; j--,gy++ )
+			for( int i =   0, gx = move.gridX; i <  x; i++,gx++ )
+				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED )
+					{ tiles[nTiles][0] = gx; tiles[nTiles][1] = gy; nTiles++; } }
+
+		else if( move.rotated == PIECE_ROTATE_270 ) {
+			for( int i = 0, gy = move.gridY; i < x; i++,gy++ )
+			for( int j = 0, gx = move.gridX; j < y; j++,gx++ )
+				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED )
+					{ tiles[nTiles][0] = gx; tiles[nTiles][1] = gy; nTiles++; } }
+	}
+
+	return nTiles;
+}
+//
+// --------------------------------------------------------
+//	Returns the tile count of a piece, which it scores.
+// --------------------------------------------------------
+int MatchCore::getPieceScore( int piece )
+{
+	if     ( piece < 1 ) return 1;
+	else if( piece < 2 ) return 2;
+	else if( piece < 4 ) return 3;
+	else if( piece < 9 ) return 4;
+	else return 5;
+}
+//
+// --------------------------------------------------------
+//	Returns true if no player has a higher score.
+// --------------------------------------------------------
+bool MatchCore::isWinner( int player ) const
+{
+	for( int i = 0; i < m_numberOfPlayers; i++ )
+		if( m_score[i] > m_score[player] ) return false;
+
+	return true;
+}
+//
+// --------------------------------------------------------
+//	Loads the match settings into an AI memory map before
+//  the player is launched and clears its indicators.
+// --------------------------------------------------------
+void MatchCore::getGameSettings( GameData* data, int player ) const
+{
+	// Load match settings into mapped file
+	data->nPlayers = m_numberOfPlayers;
+	data->boardSize = m_boardSize;
+	data->player = player;
+
+	// Clear indicator variables
+	data->moveReady = false;
+	data->matchOver = false;
+	data->turnReady = false;
+
+	// Load starting tiles into mapped file
+	for( int i = 0; i < m_numberOfPlayers; i++ ) {
+		data->startTile[i][0] = m_startTile[i][0];
+		data->startTile[i][1] = m_startTile[i][1]; }
+}
+//
+// --------------------------------------------------------
+//	Copies the match state into an AI memory map for the
+//  turn of the current player.
+// --------------------------------------------------------
+void MatchCore::getGameState( GameData* data ) const
+{
+	// Copy board structure
+	for( int i = 0; i < 20; i++ )
+	for( int j = 0; j < 20; j++ )
+		data->board[i][j] = m_board[i][j];
+
+	// Copy piece structure
+	for( int i = 0; i < 4;  i++ )
+	for( int j = 0; j < 21; j++ )
+		data->pieces[i][j] = m_pieces[i][j];
+
+	// Copy move history structure
+	for( int i = 0; i < m_currentPly; i++ )
+		data->moveHistory[i] = m_moveHistory[i];
+
+	// Copy score structure
+	for( int i = 0; i < 4; i++ )
+		data->score[i] = m_score[i];
+
+	// Copy current move ply
+	data->ply = m_currentPly;
+
+	// Copy player
+	data->player = m_currentPlayer;
+}
+//
+// --------------------------------------------------------
+//   Writes the match in the save file format. If the
+//   write fails, the function will return false.
+// --------------------------------------------------------
+bool MatchCore::saveToStream( std::ostream& file ) const
+{
+	// Write version header into the file
+	file << "// --------------------------------\n";
+	file << "//        Blokus Save File\n";
+	file << "// --------------------------------\n";
+
+	// Write match settings into the file
+	file << "\n// MatchSettings";
+	file << "\nNumber_Of_Players " << m_numberOfPlayers;
+	file << "\nSize_Of_Board "	   << m_boardSize;
+
+	// Write start tile data into the file
+	file << "\n\n// Start Tiles";
+	for( int i = 0; i < m_numberOfPlayers; i++ )
+		file << "\nStart_Tile " << i
+			<< " " << m_startTile[i][0]
+			<< " " << m_startTile[i][1];
+
+	// Write move history into the file
+	file << "\n\n// Move History";
+	for( int i = 0; i < m_currentPly; i++ ) {
+		Move move = m_moveHistory[i];
+		if( move.pieceNumber == -1 ) continue;
+		file << "\nMove"
+			 << " " << move.pieceNumber
+			 << " " << move.gridX
+			 << " " << move.gridY
+			 << " " << move.rotated
+			 << " " << move.flipped; }
+
+	// Write available pieces into the file
+	file << "\n\n// Available Pieces";
+	for( int i = 0; i < m_numberOfPlayers; i++ ) {
+		file << "\nPieces " << i << " ";
+		for( int j = 0; j < 21; j++ )
+			file << m_pieces[i][j]; }
+
+	// Write endl
+	file << "\n";
+
+	return !file.fail( );
+}
+//
+// --------------------------------------------------------
+//   Reads a match in the save file format, replaying its
+//	 moves from the empty board. If the read is corrupt
+//	 the function will return false.
+// --------------------------------------------------------
+bool MatchCore::loadFromStream( std::istream& file )
+{
+	// Begin from the empty board
+	clear( );
+
+	// Parse file using newline and space delimiters
+	std::string line; while( std::getline( file, line ) )
+	{
+		// Put line data onto stream for delimination
+		std::string token; std::stringstream iss; iss << line;
+
+		// Parse leading token on line
+		while( std::getline( iss, token, ' ' ) )
+		{
+			// Ignore line comments
+			if( token.substr( 0, 2 ) == "//" ) break;
+
+			// Read simple state and settings data
+			else if( token == "Number_Of_Players" ) iss >> m_numberOfPlayers;
+			else if( token == "Size_Of_Board" )		iss >> m_boardSize;
+			else if( token == "Wait_Turn" )	;
+			else if( token == "Wait_Game" )	;
+			else if( token == "Score" ) ; // Score, used for neural network
+
+			// Read starting tiles
+			else if( token == "Start_Tile" )
+			{
+				// Read in player start tile data
+				int playerNumber; iss >> playerNumber;
+				iss >> m_startTile[playerNumber][0];
+				iss >> m_startTile[playerNumber][1];
+			}
+
+			// Read player pieces
+			else if( token == "Pieces" )
+			{
+				// Get the player number
+				int playerNumber; iss >> playerNumber;
+
+				// Read the players piece bitstring
+				std::string bitStr; iss >> bitStr;
+				if( bitStr.size( ) != 21 ) return false;
+				for( int i = 0; i < (int)bitStr.size( ); i++ )
+					if( bitStr.at( i ) == '0' )
+						m_pieces[playerNumber][i] = false;
+					else m_pieces[playerNumber][i] = true;
+			}
+
+			// Read in move
+			else if( token == "Move" )
+			{
+				Move move;
+
+				// Get the move definition
+				iss >> move.pieceNumber;
+				iss >> move.gridX;
+				iss >> move.gridY;
+				iss >> move.rotated;
+				iss >> move.flipped;
+
+				// Convert to newer version
+				// if necessary to do so
+				move.rotated %= m_gamePieceLayouts->getOrients( move.pieceNumber );
+				if( move.flipped && !m_gamePieceLayouts->getFlips( move.pieceNumber ) )
+					move.flipped = PIECE_UNFLIPPED;
+
+				// Make the move
+				makeMove( move );
+			}
+
+			// Unexpected token
+			else return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,129 @@
+/* ===========================================================================
+
+	Project: MetaBlok - MatchCore
+
+	Description: Rules and state of Blokus matches, shared by the
+	  simulator and the headless match runners
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Begin definition
+#ifndef MATCH_CORE_H
+#define MATCH_CORE_H
+
+// Standard includes
+#include <iostream>
+#include <vector>
+
+// Game definitions
+#include "Types.h"
+#include "PieceSet.h"
+
+// Match rules and state
+class MatchCore
+{
+public:
+	// Constructor, begins a duo match
+	MatchCore( );
+
+	// Begins a new match in the given mode with an empty board
+	void reset( int matchMode = MODE_DUO );
+
+	// Clears the board, pieces and scores keeping the settings
+	void clear( );
+
+	// Checks the validity of a move for the current player
+	bool isValidMove( const Move& move ) const;
+
+	// Returns false if the current player has no move available
+	bool isMoveAvailable( ) const;
+
+	// Lists the valid moves of the current player
+	void getMoves( std::vector<Move>& moves ) const;
+
+	// Reduces a move to its unambiguous orientation
+	Move getUniqueMove( Move move ) const;
+
+	// Plays a valid move for the current player, passing for the players
+	// unable to move after it. The match ends once no one can move.
+	void makeMove( Move move );
+
+	// Takes back the last ply, a move or a pass, and returns it
+	Move undoPly( );
+
+	// Copies the settings or the match state into an AI memory map
+	void getGameSettings( GameData* data, int player ) const;
+	void getGameState( GameData* data ) const;
+
+	// Writes and reads the save file format, returns false on failure
+	bool saveToStream( std::ostream& file ) const;
+	bool loadFromStream( std::istream& file );
+
+	// Match settings
+	int getMatchMode( ) const { return m_matchMode; }
+	int getBoardSize( ) const { return m_boardSize; }
+	int getNumberOfPlayers( ) const { return m_numberOfPlayers; }
+	int getStartTile( int player, int axis ) const { return m_startTile[player][axis]; }
+
+	// Match state
+	char getBoard( int x, int y ) const { return m_board[x][y]; }
+	bool hasPiece( int player, int piece ) const { return m_pieces[player][piece]; }
+	int getScore( int player ) const { return m_score[player]; }
+	int getCurrentPlayer( ) const { return m_currentPlayer; }
+	int getPly( ) const { return m_currentPly; }
+	const Move& getMove( int ply ) const { return m_moveHistory[ply]; }
+	int isOver( ) const { return m_matchEnd; }
+
+	// Returns true if the player has the highest score, tied players all win
+	bool isWinner( int player ) const;
+
+	// Piece scores by piece number
+	static int getPieceScore( int piece );
+
+private:
+	// Piece layouts singleton
+	PieceSet* m_gamePieceLayouts;
+
+	// Match State
+	Move m_moveHistory[42];			//< History of each move this game
+	int m_currentPly;				//< Current move ply
+	int m_startTile[4][2];			//< Start tile of each player
+	char m_board[20][20];			//< Game board state
+	int m_boardSize;				//< Size in tiles of game board
+	bool m_pieces[4][21];			//< Pieces remaining for each player
+	int m_currentPlayer;			//< Current player to move
+	int m_numberOfPlayers;			//< Number of players in this match
+	int m_matchMode;				//< Match mode (duo or classic)
+	int m_score[4];					//< Current score of each player
+	int m_matchEnd;					//< Match completed indicator
+
+	// Sets the board tiles covered by a move
+	void setPieceTiles( const Move& move, char cover );
+
+	// Lists the board tiles covered by a move
+	int getPieceTiles( const Move& move, int tiles[][2] ) const;
+
+	// Pattern check between a piece and grid tile
+	bool isValidPattern( int pieceNumber, bool* liberty,
+			int px, int py, int gx, int gy ) const;
+};
+
+// End definition
+#endif
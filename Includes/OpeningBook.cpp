@@ -37,6 +37,7 @@
 
 // Local includes
 #include "OpeningBook.h"
+#include "Symmetry.h"
 
 // -----------------------------------------------------------------------------
 // Constructor
@@ -52,6 +53,9 @@ void OpeningBook::openBook(const char *filename)
     // Initialize random number generator
     srand((unsigned)time(NULL));
     
+    // Build the piece tile tables for mirroring moves
+    Symmetry::initialize();
+    
     // Initialize book root
     m_book.prob = 1.0;
     
@@ -79,46 +83,39 @@ void OpeningBook::openBook(const char *filename)
 // -----------------------------------------------------------------------------
 Move OpeningBook::makeMove(std::vector<Move> &movelist)
 {
-    std::vector<Move>::iterator mlit;
     std::vector<MoveProb>::iterator chit;
-    MoveProb *curMove = &m_book;
-    bool found;
+    MoveProb *curMove = NULL;
+    int symmetry;
     float prob;
     
-    // Move through the move list, traversing the tree
-    for(mlit = movelist.begin(); mlit != movelist.end(); mlit++) {
-    
-        // Find child which corresponds to the current move
-        found = false;
-        for(chit = curMove->nextmoves.begin(); 
-            chit != curMove->nextmoves.end(); chit++) {
-            if(*mlit == chit->move) {
-                curMove = &*chit;
-                found = true;
-                break;
-            }
-        }
-        
-        // If we didn't find a move, we are not in book
-        // This is an error because they should have checked that it was in book
-        // already.
-        if(!found) {
-            throw "Move not found in opening book!";
+    // Find the position as played, or else its reflection
+    for(symmetry = SYMMETRY_IDENTITY; symmetry <= SYMMETRY_DIAGONAL; symmetry++) {
+        curMove = findPosition(movelist, symmetry);
+        if(curMove && curMove->nextmoves.size() != 0) {
+            break;
         }
     }
     
+    // If we didn't find the position, we are not in book
+    // This is an error because they should have checked that it was in book
+    // already.
+    if(!curMove) {
+        throw "Move not found in opening book!";
+    }
+    
     if(curMove->nextmoves.size() == 0) {
         throw "Move has no following moves in opening book!";
     }
     
-    // Now the children of the current move are the possible next moves
+    // Now the children of the current move are the possible next moves,
+    // reflected back if the position was found reflected
     prob = (float)rand() / (float)RAND_MAX;
     for(chit = curMove->nextmoves.begin(); 
         chit <= curMove->nextmoves.end(); chit++) {
         prob -= chit->prob;
         // If prob is lower than 0, choose this move
         if(prob <= 0.0) {
-            return chit->move;
+            return Symmetry::mapMove(symmetry, chit->move);
         }
     }
     
@@ -132,6 +129,29 @@ Move OpeningBook::makeMove(std::vector<Move> &movelist)
 // -----------------------------------------------------------------------------
 bool OpeningBook::isInBook(std::vector<Move> &movelist)
 {    
+    MoveProb *curMove;
+    
+    // Look up the position as played and reflected in the diagonal
+    for(int symmetry = SYMMETRY_IDENTITY; symmetry <= SYMMETRY_DIAGONAL; symmetry++) {
+        curMove = findPosition(movelist, symmetry);
+        
+        // This can't be a leaf node
+        if(curMove && curMove->nextmoves.size() != 0) {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+// findPosition
+// Returns the book position reached by the mirrored move list, or NULL if
+// a move is not in the book
+// -----------------------------------------------------------------------------
+OpeningBook::MoveProb *OpeningBook::findPosition(std::vector<Move> &movelist,
+                                                 int symmetry)
+{
     std::vector<Move>::iterator mlit;
     std::vector<MoveProb>::iterator chit;
     MoveProb *curMove = &m_book;
@@ -139,12 +159,16 @@ bool OpeningBook::isInBook(std::vector<Move> &movelist)
     
     // Move through the move list, traversing the tree
     for(mlit = movelist.begin(); mlit != movelist.end(); mlit++) {
+        if(curMove->nextmoves.size() == 0) {
+            return NULL;
+        }
+        Move move = Symmetry::mapMove(symmetry, *mlit);
     
         // Find child which corresponds to the current move
         found = false;
         for(chit = curMove->nextmoves.begin(); 
             chit != curMove->nextmoves.end(); chit++) {
-            if(*mlit == chit->move) {
+            if(move == chit->move) {
                 curMove = &*chit;
                 found = true;
                 break;
@@ -153,16 +177,11 @@ bool OpeningBook::isInBook(std::vector<Move> &movelist)
         
         // If we didn't find a move, we are not in book
         if(!found) {
-            return false;
+            return NULL;
         }
     }
     
-    // This can't be a leaf node
-    if(curMove->nextmoves.size() == 0) {
-        return false;
-    }
-    
-    return true;
+    return curMove;
 }
 
 // -----------------------------------------------------------------------------
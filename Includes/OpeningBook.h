@@ -53,7 +53,9 @@ public:
     // Throws an error message on error.
     Move makeMove(std::vector<Move>&);
     
-    // Determines whether the given position is in the opening book
+    // Determines whether the given position is in the opening book,
+    // either as played or reflected in the diagonal through the
+    // start tiles
     bool isInBook(std::vector<Move>&);
 
 	// Prints the book to the given outstream depth-first
@@ -68,6 +70,9 @@ private:
 
     MoveProb m_book;    // Root of opening book tree
     
+    // Finds the book position reached by the moves mirrored by the
+    // symmetry, or NULL if the moves leave the book
+    MoveProb *findPosition(std::vector<Move>&, int symmetry);
     void parseLine(const char *, std::vector<MoveProb*>&);
 	void printBook(std::ostream&, MoveProb&, int);
 	const char *pieceNumToName(int pieceNumber);
@@ -51,7 +51,7 @@ void PieceSet::initPieceConfigurations( )
 	if( m_initialized ) return; 
 
 	// Open piece structure file for reading
-	std::wstring filename = std::wstring( L"Pieces.txt" );
+	std::string filename = "Pieces.txt";
 	std::fstream file( filename.c_str( ), std::ios::in );
 
 	// Check for file load failure
@@ -0,0 +1,132 @@
+/* ===========================================================================
+
+	Project: AI player for Blokus
+
+	Description:
+	  Move ordering by the policy head of an evaluation network, which
+	  scores every move of a position from a single network pass.
+
+    Copyright (C) 2011 Lucas Sherman
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Standard includes
+#include <windows.h>
+#include <utility>
+#include <algorithm>
+#include "Types.h"
+#include "TypesEx.h"
+#include "Symmetry.h"
+
+// Include header
+#include "Policy.h"
+
+// Static member variables
+bool Policy::m_loaded;
+Nnue Policy::m_network;
+
+// --------------------------------------------------------
+//	Load - Maps the network and builds the piece tile
+//  tables used to find the cells each move covers.
+// --------------------------------------------------------
+bool Policy::load( const char* filename )
+{
+	m_loaded = m_network.load( filename ) && m_network.hasPolicy( );
+	if( m_loaded ) Symmetry::initialize( );
+
+	return m_loaded;
+}
+//
+// --------------------------------------------------------
+//	GetLogits - Sums the first layer of the network over
+//  the covered tiles and remaining pieces of the position
+//  and runs the policy head for the player to move.
+// --------------------------------------------------------
+void Policy::getLogits( short grid[][14], int pieces[], int player, float logits[] )
+{
+	int features[NNUE_FEATURES], nFeatures = 0;
+
+	// Covered tiles, the low bits hold the covering player
+	for( int x = 0; x < BOARD_SIZE; x++ )
+	for( int y = 0; y < BOARD_SIZE; y++ ) {
+		int cover = grid[x][y] & 0x3;
+		if( cover ) features[nFeatures++] = Nnue::cellFeature( x, y, cover-1 ); }
+
+	// Remaining pieces
+	for( int p = 0; p < 2; p++ )
+	for( int i = 0; i < NNUE_PIECES; i++ )
+		if( pieces[p] & (1<<i) )
+			features[nFeatures++] = Nnue::pieceFeature( i, p );
+
+	// Run the policy head
+	NnueAccumulator accumulator;
+	m_network.refresh( features, nFeatures, &accumulator );
+	m_network.policy( &accumulator, player, logits );
+}
+//
+// --------------------------------------------------------
+//	GetMoveLogit - Scores a move by its piece and the cells
+//  it covers. Passes have no alternative and score zero.
+// --------------------------------------------------------
+float Policy::getMoveLogit( const float logits[], const Move& move )
+{
+	if( move.pieceNumber < 0 ) return 0.0f;
+
+	int tiles[25][2], nTiles = Symmetry::getTiles( move, tiles );
+	return Nnue::placementLogit( logits, move.pieceNumber, tiles, nTiles );
+}
+//
+// --------------------------------------------------------
+//	OrderMoves - Sorts a move list by the policy, breaking
+//  ties by the original list position.
+// --------------------------------------------------------
+void Policy::orderMoves( const float logits[], Move moves[], int nMoves )
+{
+	if( nMoves > POLICY_MAX_MOVES ) return;
+
+	// Sort the negated scores with the list positions
+	std::pair<float,int> order[POLICY_MAX_MOVES];
+	for( int i = 0; i < nMoves; i++ )
+		order[i] = std::make_pair( -getMoveLogit( logits, moves[i] ), i );
+	std::sort( order, order+nMoves );
+
+	// Rearrange the moves
+	Move sorted[POLICY_MAX_MOVES];
+	for( int i = 0; i < nMoves; i++ ) sorted[i] = moves[order[i].second];
+	for( int i = 0; i < nMoves; i++ ) moves[i] = sorted[i];
+}
+//
+// --------------------------------------------------------
+//	OrderMoves - Sorts a list of move pointers, as kept by
+//  the move lists, by the policy.
+// --------------------------------------------------------
+void Policy::orderMoves( const float logits[], const Move* moves[], int nMoves )
+{
+	if( nMoves > POLICY_MAX_MOVES ) return;
+
+	// Sort the negated scores with the list positions
+	std::pair<float,int> order[POLICY_MAX_MOVES];
+	for( int i = 0; i < nMoves; i++ )
+		order[i] = std::make_pair( -getMoveLogit( logits, *moves[i] ), i );
+	std::sort( order, order+nMoves );
+
+	// Rearrange the moves
+	const Move* sorted[POLICY_MAX_MOVES];
+	for( int i = 0; i < nMoves; i++ ) sorted[i] = moves[order[i].second];
+	for( int i = 0; i < nMoves; i++ ) moves[i] = sorted[i];
+}
@@ -0,0 +1,68 @@
+/* ===========================================================================
+
+	Project: AI player for Blokus
+
+	Description:
+	  Move ordering by the policy head of an evaluation network, which
+	  scores every move of a position from a single network pass.
+
+    Copyright (C) 2011 Lucas Sherman
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Begin definition
+#ifndef POLICY_H
+#define POLICY_H
+
+// Evaluation network with the policy head
+#include "Nnue.h"
+
+// Most moves ordered at once
+#define POLICY_MAX_MOVES 1200
+
+// Policy head move ordering
+class Policy
+{
+public:
+	// Maps a network with a policy head, returns false if the
+	// file is missing or the network has no policy head
+	static bool load( const char* filename );
+	static bool isLoaded( ) { return m_loaded; }
+
+	// Computes the policy logits of an extended format game state
+	// for the player to move, the pieces given as masks
+	static void getLogits( short grid[][14], int pieces[], int player, float logits[] );
+
+	// Scores a move from the logits of its position
+	static float getMoveLogit( const float logits[], const Move& move );
+
+	// Sorts moves from the greatest to the least logit, moves with
+	// equal logits keep their order. Longer lists are left unsorted.
+	static void orderMoves( const float logits[], Move moves[], int nMoves );
+	static void orderMoves( const float logits[], const Move* moves[], int nMoves );
+
+private:
+	Policy( );
+
+	// Network data
+	static bool m_loaded;
+	static Nnue m_network;
+};
+
+// End definition
+#endif
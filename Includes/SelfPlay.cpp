@@ -0,0 +1,263 @@
+/* ===========================================================================
+
+	Project: AI player for Blokus
+
+	Description:
+	  Headless self-play driver which plays games between copies of an AI
+	  player on worker threads and appends each finished game to a binary
+	  training dataset.
+
+    Copyright (C) 2011 Lucas Sherman
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Standard includes
+#include <windows.h>
+#include <process.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <time.h>
+
+// Match rules
+#include "Types.h"
+#include "MatchCore.h"
+
+// Include header
+#include "SelfPlay.h"
+
+// Shared run data
+const char* SelfPlay::m_filename;
+SelfPlaySettings SelfPlay::m_settings;
+volatile long SelfPlay::m_nextGame;
+HANDLE SelfPlay::m_engineMutex;
+HANDLE SelfPlay::m_fileMutex;
+
+// Run statistics
+int SelfPlay::m_nGames, SelfPlay::m_nPositions, SelfPlay::m_nSearched, SelfPlay::m_nWins[3];
+
+// --------------------------------------------------------
+//	RunCommand - Parses the self-play arguments following
+//  the -selfplay switch of an AI player and plays the
+//  games. Returns the process exit code.
+// --------------------------------------------------------
+int SelfPlay::runCommand( int argc, char* argv[], SelfPlayFactory factory, bool sharedEngine )
+{
+	// Read the command line
+	if( argc < 1 ) { std::cerr << "Usage: -selfplay <dataset> [games] "
+		"[threads] [random plies] [seed]\n"; return 1; }
+	SYSTEM_INFO systemInfo; GetSystemInfo( &systemInfo );
+	SelfPlaySettings settings;
+	settings.nGames = ( argc > 1 ) ? atoi( argv[1] ) : 100;
+	settings.nThreads = ( argc > 2 ) ? atoi( argv[2] ) : (int)systemInfo.dwNumberOfProcessors;
+	settings.randomPlies = ( argc > 3 ) ? atoi( argv[3] ) : SELFPLAY_RANDOM_PLIES;
+	settings.seed = ( argc > 4 ) ? (unsigned int)atoi( argv[4] ) : (unsigned int)time(NULL);
+	settings.sharedEngine = sharedEngine;
+
+	// Play the games
+	try { run( argv[0], factory, settings );
+	} catch( const char *s ) {
+		std::cerr << "Error playing self-play games:\n	" << s << "\n\n"; return 1; }
+
+	return 0;
+}
+//
+// --------------------------------------------------------
+//	Run - Starts the players and plays the games on the
+//  worker threads. Players are started here, one at a
+//  time, since their startup is not thread safe. The
+//  piece layouts are loaded here too, before the match
+//  of each worker shares them. Engine output is silenced
+//  and progress reported on cerr.
+// --------------------------------------------------------
+void SelfPlay::run( const char* filename, SelfPlayFactory factory,
+	const SelfPlaySettings& settings )
+{
+	// Begin a duo match for the settings of the players
+	MatchCore match; int startTile[4][2];
+	for( int p = 0; p < match.getNumberOfPlayers( ); p++ ) {
+		startTile[p][0] = match.getStartTile( p, 0 );
+		startTile[p][1] = match.getStartTile( p, 1 ); }
+	if( !match.isMoveAvailable( ) ) throw "Couldn't load the piece layouts from Pieces.txt";
+
+	// Store the run settings
+	m_filename = filename; m_settings = settings;
+	m_settings.nThreads = max( 1, min( settings.nThreads, SELFPLAY_MAX_THREADS ) );
+	m_nextGame = 0; m_nGames = 0; m_nPositions = 0; m_nSearched = 0;
+	m_nWins[0] = m_nWins[1] = m_nWins[2] = 0;
+	m_engineMutex = CreateMutex( NULL, FALSE, NULL );
+	m_fileMutex = CreateMutex( NULL, FALSE, NULL );
+
+	// Silence the engine output
+	std::cout.setstate( std::ios::failbit );
+
+	// Start a player for each worker, or one for all of them
+	int nThreads = m_settings.nThreads;
+	int nEngines = m_settings.sharedEngine ? 1 : nThreads;
+	std::vector<SelfPlayEngine*> engines( nEngines );
+	for( int i = 0; i < nEngines; i++ ) {
+		engines[i] = factory( );
+		engines[i]->startup( match.getBoardSize( ), startTile, match.getNumberOfPlayers( ) ); }
+
+	// Launch the workers
+	HANDLE threadHandles[SELFPLAY_MAX_THREADS];
+	clock_t start = clock( );
+	for( int i = 0; i < nThreads; i++ )
+		threadHandles[i] = (HANDLE)_beginthreadex( NULL, 0, &workerThread, (void*)engines[i % nEngines], 0, NULL );
+
+	// Wait for all of the workers
+	WaitForMultipleObjects( nThreads, threadHandles, TRUE, INFINITE );
+	for( int i = 0; i < nThreads; i++ ) CloseHandle( threadHandles[i] );
+	double seconds = (double)( clock( ) - start ) / CLOCKS_PER_SEC;
+
+	// Shutdown the players
+	for( int i = 0; i < nEngines; i++ ) {
+		engines[i]->shutdown( ); delete engines[i]; }
+	CloseHandle( m_engineMutex ); CloseHandle( m_fileMutex );
+	std::cout.clear( );
+
+	// Display the run statistics
+	std::cerr << m_nGames << " games, " << m_nPositions << " positions ("
+			  << m_nSearched << " searched) written to " << filename << " in "
+			  << seconds << "s\n";
+	std::cerr << "Blue wins " << m_nWins[0] << ", gold wins " << m_nWins[1]
+			  << ", draws " << m_nWins[2] << "\n";
+	if( m_nGames < m_settings.nGames ) throw "Not every game was played and written";
+}
+//
+// --------------------------------------------------------
+//	WorkerThread - Claims games by index and plays them
+//  until every game has been started. The seed of each
+//  game follows from its index, so the random openings
+//  do not depend on the thread that plays them. Games
+//  with an invalid move are reported and skipped.
+// --------------------------------------------------------
+unsigned int SelfPlay::workerThread( void* data )
+{
+	SelfPlayEngine* engine = (SelfPlayEngine*)data;
+	std::vector<PositionRecord> records;
+
+	// Game loop
+	int game;
+	while( ( game = (int)InterlockedIncrement( &m_nextGame ) - 1 ) < m_settings.nGames )
+	{
+		// Play the game
+		const char* error = NULL;
+		try { playGame( engine, m_settings.seed + game, records );
+		} catch( const char *s ) { error = s; }
+
+		// Append the game to the dataset
+		WaitForSingleObject( m_fileMutex, INFINITE );
+		if( error ) std::cerr << "Error in game " << game << ":\n	" << error << "\n";
+		else if( !Dataset::appendGame( m_filename, &records[0], (int)records.size( ) ) )
+			std::cerr << "Could not append game " << game << " to " << m_filename << "\n";
+		else
+		{
+			// Update the statistics
+			int result = records[0].result;
+			m_nGames++; m_nPositions += (int)records.size( );
+			m_nWins[ result == 100 ? 0 : ( result == 0 ? 1 : 2 ) ]++;
+			for( size_t i = 0; i < records.size( ); i++ )
+				if( records[i].hasSearch( ) ) m_nSearched++;
+
+			// Report the progress
+			if( m_nGames % 10 == 0 || m_nGames == m_settings.nGames )
+				std::cerr << "Game " << m_nGames << " of " << m_settings.nGames << "\n";
+		}
+		ReleaseMutex( m_fileMutex );
+	}
+
+	return 0;
+}
+//
+// --------------------------------------------------------
+//	PlayGame - Plays a duo match from the empty board,
+//  opening with random moves and then letting the player
+//  move for both sides. The match applies the rules and
+//  passes for a player without a move until neither can
+//  move. The position before each move is recorded with
+//  the search utility of the move and labelled with the
+//  final result once it is known.
+// --------------------------------------------------------
+void SelfPlay::playGame( SelfPlayEngine* engine, unsigned int seed,
+	std::vector<PositionRecord>& records )
+{
+	// Begin from the empty board
+	MatchCore match; GameData state;
+	records.clear( );
+
+	// Seed the random opening and any random player
+	srand( seed );
+
+	// Game loop
+	std::vector<Move> available; available.reserve( 1200 );
+	while( !match.isOver( ) )
+	{
+		// Record the position
+		match.getGameState( &state );
+		int player = state.player, ply = state.ply;
+		records.push_back( makeRecord( state.board, state.pieces, player, ply ) );
+
+		// Select a random opening move
+		Move move; if( ply < m_settings.randomPlies ) {
+			match.getMoves( available );
+			move = available[ rand( ) % available.size( ) ]; }
+
+		// Select a move with the player, one move at a time if shared
+		else {
+			float utility;
+			if( m_settings.sharedEngine ) WaitForSingleObject( m_engineMutex, INFINITE );
+			move = engine->makeMove( state.board, state.pieces, state.score, player, ply, state.moveHistory );
+			bool searched = engine->getMoveUtility( &utility );
+			if( m_settings.sharedEngine ) ReleaseMutex( m_engineMutex );
+			if( searched ) records.back( ).setSearch( utility );
+			if( !match.isValidMove( move ) ) throw "Player made an invalid move"; }
+
+		// Make the move
+		match.makeMove( move );
+	}
+
+	// Label the positions with the result for blue
+	int blue = match.getScore( PLAYER_BLUE ), red = match.getScore( PLAYER_RED );
+	unsigned char result = ( blue > red ) ? 100 : ( ( blue < red ) ? 0 : 50 );
+	for( size_t i = 0; i < records.size( ); i++ ) records[i].result = result;
+}
+//
+// --------------------------------------------------------
+//	MakeRecord - Packs the position before a move into a
+//  dataset record. The result and game index are set
+//  once the game is over.
+// --------------------------------------------------------
+PositionRecord SelfPlay::makeRecord( char board[][20], bool pieces[][21], int player, int ply )
+{
+	PositionRecord record;
+	memset( &record, 0, sizeof(record) );
+
+	// Board squares and remaining pieces
+	for( int i = 0; i < 14; i++ ) for( int j = 0; j < 14; j++ )
+		if( board[i][j] != GRID_COVER_NONE ) record.setSquare( i, j, RECORD_BLUE + board[i][j] );
+	for( int p = 0; p < 2; p++ ) for( int i = 0; i < 21; i++ )
+		if( pieces[p][i] ) record.pieces[p][i/8] |= (unsigned char)( 1 << (i%8) );
+
+	// Player to move and ply
+	record.player = (unsigned char)player;
+	record.ply = (unsigned char)ply;
+	record.search = RECORD_NO_SEARCH;
+
+	return record;
+}
@@ -0,0 +1,108 @@
+/* ===========================================================================
+
+	Project: AI player for Blokus
+
+	Description:
+	  Headless self-play driver which plays games between copies of an AI
+	  player on worker threads and appends each finished game to a binary
+	  training dataset.
+
+    Copyright (C) 2011 Lucas Sherman
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Begin definition
+#ifndef SELF_PLAY_H
+#define SELF_PLAY_H
+
+// Training dataset records
+#include "Dataset.h"
+
+// Self-play defaults
+#define SELFPLAY_MAX_THREADS   64   //< Maximum worker thread count
+#define SELFPLAY_RANDOM_PLIES   4   //< Default random plies opening each game
+
+// AI player interface of the driver, implemented by each player
+class SelfPlayEngine
+{
+public:
+	virtual ~SelfPlayEngine( ) { }
+
+	// Initialize and shutdown the AI player
+	virtual void startup( int boardSize, int startTile[][2], int nPlayers ) = 0;
+	virtual void shutdown( ) = 0;
+
+	// Selects a move, the player always has a move available
+	virtual Move makeMove( char board[][20], bool pieces[][21], int score[],
+		int player, int ply, Move moves[42] ) = 0;
+
+	// Search utility of the last move for PLAYER_BLUE, false
+	// if the move was not searched
+	virtual bool getMoveUtility( float* utility ) = 0;
+};
+
+// AI player construction function
+typedef SelfPlayEngine* (*SelfPlayFactory)( );
+
+// Self-play settings
+struct SelfPlaySettings
+{
+	int nGames;				//< Number of games to play
+	int nThreads;			//< Worker threads, one game each at a time
+	int randomPlies;		//< Plies of random moves opening each game
+	unsigned int seed;		//< Seed of the first game, each game adds one
+	bool sharedEngine;		//< Players with static search state are shared
+							//  between workers, one move at a time
+};
+
+// Self-play driver
+class SelfPlay
+{
+public:
+	// Parses the self-play command line of an AI player and plays the games:
+	//   <player> -selfplay <dataset> [games] [threads] [random plies] [seed]
+	static int runCommand( int argc, char* argv[], SelfPlayFactory factory, bool sharedEngine );
+
+	// Plays the games, appending each finished game to the dataset file
+	static void run( const char* filename, SelfPlayFactory factory,
+		const SelfPlaySettings& settings );
+
+private:
+	// Worker thread entry, plays games until none are left
+	static unsigned int __stdcall workerThread( void* data );
+
+	// Plays a game, recording the position before each move
+	static void playGame( SelfPlayEngine* engine, unsigned int seed,
+		std::vector<PositionRecord>& records );
+
+	// Records the position before a move
+	static PositionRecord makeRecord( char board[][20], bool pieces[][21], int player, int ply );
+
+	// Shared run data
+	static const char* m_filename;			//< Dataset file
+	static SelfPlaySettings m_settings;		//< Run settings
+	static volatile long m_nextGame;		//< Index of the next game to start
+	static HANDLE m_engineMutex;			//< Serializes moves of a shared player
+	static HANDLE m_fileMutex;				//< Serializes dataset writes and statistics
+
+	// Run statistics
+	static int m_nGames, m_nPositions, m_nSearched, m_nWins[3];
+};
+
+// End definition
+#endif
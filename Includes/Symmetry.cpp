@@ -0,0 +1,265 @@
+/* ===========================================================================
+
+	Project: AI player for Blokus
+
+	Description:
+	  Board symmetries of Blokus Duo for mapping positions and moves onto
+	  their mirror images and picking a canonical representative.
+
+    Copyright (C) 2011 Lucas Sherman
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+
+// Standard includes
+#include <algorithm>
+#include <limits.h>
+#include "Types.h"
+#include "TypesEx.h"
+#include "Piece.h"
+#include "Zobrist.h"
+
+// Include header
+#include "Symmetry.h"
+
+// Static member variables
+bool Symmetry::m_initialized;
+int Symmetry::m_nTiles[21];
+int Symmetry::m_tiles[21][4][2][5][2];
+
+// --------------------------------------------------------
+//	Initialize - Builds the tile tables of every piece
+//  orientation from the piece set shared by the engines,
+//  orienting the covered tiles of each piece pattern as
+//  the referee places them.
+// --------------------------------------------------------
+void Symmetry::initialize( )
+{
+	// Check for initialization
+	if( m_initialized ) return;
+
+	// Load the piece set
+	PieceSet::initPieceConfigurations( );
+
+	// Orient the covered tiles of each piece pattern
+	for( int p = 0; p < 21; p++ )
+	{
+		Piece* piece = PieceSet::getPiece( p );
+		int x = piece->getSizeX( ), y = piece->getSizeY( );
+		for( int r = 0; r < 4; r++ )
+		for( int f = 0; f < 2; f++ )
+		{
+			int nTiles = 0;
+			for( int j = 0; j < y; j++ )
+			for( int i = 0; i < x; i++ )
+			if( piece->getLayout( i, j ) == EX_MATCH_NOT_COVERED )
+			{
+				int* tile = m_tiles[p][r][f][nTiles++];
+				if( f == PIECE_UNFLIPPED ) switch( r ) {
+					case PIECE_ROTATE_0:   tile[0] = i;     tile[1] = j;     break;
+					case PIECE_ROTATE_90:  tile[0] = j;     tile[1] = x-1-i; break;
+					case PIECE_ROTATE_180: tile[0] = x-1-i; tile[1] = y-1-j; break;
+					default:               tile[0] = y-1-j; tile[1] = i;     break; }
+				else switch( r ) {
+					case PIECE_ROTATE_0:   tile[0] = x-1-i; tile[1] = j;     break;
+					case PIECE_ROTATE_90:  tile[0] = y-1-j; tile[1] = x-1-i; break;
+					case PIECE_ROTATE_180: tile[0] = i;     tile[1] = y-1-j; break;
+					default:               tile[0] = j;     tile[1] = i;     break; }
+			}
+			m_nTiles[p] = nTiles;
+		}
+	}
+
+	// Mark initialized
+	m_initialized = true;
+}
+//
+// --------------------------------------------------------
+//	MapPlayer - Returns the player occupying the mirrored
+//  start tile.
+// --------------------------------------------------------
+int Symmetry::mapPlayer( int symmetry, int player )
+{
+	return swapsColours( symmetry ) ? 1 - player : player;
+}
+//
+// --------------------------------------------------------
+//	MapTile - Returns the mirror image of a board tile.
+// --------------------------------------------------------
+void Symmetry::mapTile( int symmetry, int x, int y, int* outX, int* outY )
+{
+	static const int last = BOARD_SIZE-1;
+	switch( symmetry ) {
+		case SYMMETRY_DIAGONAL:     *outX = y;      *outY = x;      break;
+		case SYMMETRY_ANTIDIAGONAL: *outX = last-y; *outY = last-x; break;
+		case SYMMETRY_ROTATE_180:   *outX = last-x; *outY = last-y; break;
+		default:                    *outX = x;      *outY = y;      break; }
+}
+//
+// --------------------------------------------------------
+//	MapBoard - Mirrors a standard format board, exchanging
+//  the colours of the tiles if the symmetry swaps them.
+//  The output board must not be the input board.
+// --------------------------------------------------------
+void Symmetry::mapBoard( int symmetry, char board[][20], char boardOut[][20] )
+{
+	for( int x = 0; x < BOARD_SIZE; x++ )
+	for( int y = 0; y < BOARD_SIZE; y++ )
+	{
+		int mx, my; mapTile( symmetry, x, y, &mx, &my );
+		char tile = board[x][y];
+		boardOut[mx][my] = ( tile == GRID_COVER_NONE ) ? tile : (char)mapPlayer( symmetry, tile );
+	}
+}
+//
+// --------------------------------------------------------
+//	MapPieces - Exchanges the remaining pieces of the
+//  players if the symmetry swaps their colours.
+// --------------------------------------------------------
+void Symmetry::mapPieces( int symmetry, bool pieces[][21], bool piecesOut[][21] )
+{
+	for( int p = 0; p < NUM_PLAYERS; p++ )
+	for( int i = 0; i < 21; i++ )
+		piecesOut[mapPlayer( symmetry, p )][i] = pieces[p][i];
+}
+//
+// --------------------------------------------------------
+//	MapMove - Mirrors the tiles covered by a move and finds
+//  the orientation of the piece covering them, placed so
+//  that the corners of both tile sets coincide. Throws an
+//  error message if no orientation matches, which means
+//  the piece layouts are inconsistent.
+// --------------------------------------------------------
+Move Symmetry::mapMove( int symmetry, const Move& move )
+{
+	if( symmetry == SYMMETRY_IDENTITY ) return move;
+
+	// Mirror the covered tiles
+	int tiles[25][2], nTiles = getTiles( move, tiles );
+	int minX = INT_MAX, minY = INT_MAX;
+	for( int t = 0; t < nTiles; t++ ) {
+		mapTile( symmetry, tiles[t][0], tiles[t][1], &tiles[t][0], &tiles[t][1] );
+		minX = std::min( minX, tiles[t][0] ); minY = std::min( minY, tiles[t][1] ); }
+
+	// Find the orientation covering the mirrored tiles
+	Piece* piece = PieceSet::getPiece( move.pieceNumber );
+	Move mapped( move.pieceNumber, 0, 0, 0, 0 );
+	for( mapped.rotated = 0; mapped.rotated < piece->getNumOfRots( ); mapped.rotated++ )
+	for( mapped.flipped = 0; mapped.flipped <= piece->isFlippable( ); mapped.flipped++ )
+	{
+		// Align the corner of the oriented pattern
+		int pattern[25][2]; mapped.gridX = 0; mapped.gridY = 0;
+		int nPattern = getTiles( mapped, pattern );
+		int px = INT_MAX, py = INT_MAX;
+		for( int t = 0; t < nPattern; t++ ) {
+			px = std::min( px, pattern[t][0] ); py = std::min( py, pattern[t][1] ); }
+		mapped.gridX = minX - px; mapped.gridY = minY - py;
+
+		// Compare the covered tiles
+		int nMatched = 0;
+		for( int t = 0; t < nPattern; t++ )
+		for( int s = 0; s < nTiles; s++ )
+			if( pattern[t][0] + mapped.gridX == tiles[s][0] &&
+				pattern[t][1] + mapped.gridY == tiles[s][1] ) { nMatched++; break; }
+		if( nMatched == nTiles && nPattern == nTiles ) return mapped;
+	}
+
+	throw "No orientation of the piece matches the mirrored move";
+}
+//
+// --------------------------------------------------------
+//	GetCanonicalKey - Returns the lesser of the Zobrist
+//  keys of the game state and its diagonal reflection.
+// --------------------------------------------------------
+unsigned __int64 Symmetry::getCanonicalKey( short grid[][14], int pieces[], int player )
+{
+	unsigned __int64 keys[2]; getKeys( grid, pieces, player, keys );
+	return ( keys[1] < keys[0] ) ? keys[1] : keys[0];
+}
+//
+// --------------------------------------------------------
+//	GetKeys - Computes the Zobrist key of the game state
+//  and of its diagonal reflection, which differs only in
+//  the tile keys.
+// --------------------------------------------------------
+void Symmetry::getKeys( short grid[][14], int pieces[], int player, unsigned __int64 keys[2] )
+{
+	unsigned __int64 key = Zobrist::getKey( grid, pieces, player ), mirror = key;
+
+	// Move the tile keys to the mirrored tiles
+	for( int x = 0; x < BOARD_SIZE; x++ )
+	for( int y = 0; y < BOARD_SIZE; y++ )
+	if( x != y )
+	for( int p = 0; p < NUM_PLAYERS; p++ )
+		if( grid[x][y] & ((1<<p)<<EX_GRID_COVERED) )
+			mirror ^= Zobrist::getTileKey( x, y, p ) ^ Zobrist::getTileKey( y, x, p );
+
+	keys[0] = key; keys[1] = mirror;
+}
+//
+// --------------------------------------------------------
+//	IsSymmetric - Compares the covered tiles of the board
+//  with those of its diagonal reflection.
+// --------------------------------------------------------
+bool Symmetry::isSymmetric( short grid[][14] )
+{
+	static const short covered = 3<<EX_GRID_COVERED;
+	for( int x = 0; x < BOARD_SIZE; x++ )
+	for( int y = x+1; y < BOARD_SIZE; y++ )
+		if( (grid[x][y] & covered) != (grid[y][x] & covered) ) return false;
+
+	return true;
+}
+//
+// --------------------------------------------------------
+//	PruneMoves - Keeps the first move of each pair of moves
+//  which are diagonal reflections of each other. In a
+//  symmetric position both lead to mirrored positions of
+//  equal value, so only one needs to be searched.
+// --------------------------------------------------------
+int Symmetry::pruneMoves( Move moves[], int nMoves )
+{
+	int nKept = 0;
+	for( int i = 0; i < nMoves; i++ )
+	{
+		// Check for the reflection among the kept moves
+		Move mirror = mapMove( SYMMETRY_DIAGONAL, moves[i] );
+		bool listed = false;
+		for( int j = 0; j < nKept && !listed; j++ )
+			listed = ( moves[j] == mirror );
+		if( !listed ) moves[nKept++] = moves[i];
+	}
+
+	return nKept;
+}
+//
+// --------------------------------------------------------
+//	GetTiles - Finds the board tiles covered by a move by
+//  offsetting the tile table of its piece orientation.
+//  Returns the number of tiles.
+// --------------------------------------------------------
+int Symmetry::getTiles( const Move& move, int tiles[][2] )
+{
+	int nTiles = m_nTiles[move.pieceNumber];
+	const int (*pattern)[2] = m_tiles[move.pieceNumber][move.rotated][move.flipped];
+	for( int t = 0; t < nTiles; t++ ) {
+		tiles[t][0] = move.gridX + pattern[t][0];
+		tiles[t][1] = move.gridY + pattern[t][1]; }
+
+	return nTiles;
+}
@@ -0,0 +1,94 @@
+/* ===========================================================================
+
+	Project: AI player for Blokus
+
+	Description:
+	  Board symmetries of Blokus Duo for mapping positions and moves onto
+	  their mirror images and picking a canonical representative.
+
+    Copyright (C) 2011 Lucas Sherman
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Begin definition
+#ifndef SYMMETRY_H
+#define SYMMETRY_H
+
+// Board symmetries, the start tiles (4,4) and (9,9) lie on the diagonal
+enum SymmetryType {
+	SYMMETRY_IDENTITY,		//< Position unchanged
+	SYMMETRY_DIAGONAL,		//< Reflection in the diagonal through the start tiles
+	SYMMETRY_ANTIDIAGONAL,	//< Reflection in the other diagonal, colours swapped
+	SYMMETRY_ROTATE_180,	//< Half turn about the centre, colours swapped
+	SYMMETRY_COUNT
+};
+
+// Board symmetry mappings
+class Symmetry
+{
+public:
+	// Builds the piece tile tables used for mapping moves
+	static void initialize( );
+
+	// Whether the symmetry exchanges the start tiles of the players
+	static bool swapsColours( int symmetry ) { return symmetry >= SYMMETRY_ANTIDIAGONAL; }
+
+	// Position mappings
+	static int mapPlayer( int symmetry, int player );
+	static void mapTile( int symmetry, int x, int y, int* outX, int* outY );
+	static void mapBoard( int symmetry, char board[][20], char boardOut[][20] );
+	static void mapPieces( int symmetry, bool pieces[][21], bool piecesOut[][21] );
+
+	// Maps a move to the same placement on the mirrored board,
+	// expressed in one of the orientations the piece enumerates
+	static Move mapMove( int symmetry, const Move& move );
+
+	// Canonical Zobrist key of an extended format game state, the
+	// lesser key of the state and its diagonal reflection. Colour
+	// swapping symmetries are excluded as they change the player
+	// to move and so the perspective of a stored utility.
+	static unsigned __int64 getCanonicalKey( short grid[][14], int pieces[], int player );
+
+	// Zobrist keys of an extended format game state and of its
+	// diagonal reflection, for searches which update them with
+	// each move and take the lesser one as the canonical key
+	static void getKeys( short grid[][14], int pieces[], int player, unsigned __int64 keys[2] );
+
+	// Checks whether an extended format board is its own
+	// diagonal reflection, as in the first plies of a game
+	static bool isSymmetric( short grid[][14] );
+
+	// Removes the moves whose diagonal reflection appears earlier in
+	// the list, for a symmetric position. Returns the new move count.
+	static int pruneMoves( Move moves[], int nMoves );
+
+	// Finds the board tiles covered by a move, returns the tile count
+	static int getTiles( const Move& move, int tiles[][2] );
+
+private:
+	Symmetry( );
+
+	// Tiles covered by each orientation of each piece, relative
+	// to the corner of its oriented pattern
+	static bool m_initialized;
+	static int m_nTiles[21];
+	static int m_tiles[21][4][2][5][2];
+};
+
+// End definition
+#endif
@@ -29,6 +29,11 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+// 64 bit integers of the Visual C++ keyword on other compilers
+#ifndef _MSC_VER
+#define __int64 long long
+#endif
+
 // Move selection structure with simple construct/compare ops
 struct Move { int pieceNumber, gridX, gridY, flipped, rotated; 
 Move(int p, int x, int y, int f, int r) :
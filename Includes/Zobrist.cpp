@@ -0,0 +1,104 @@
+/* ===========================================================================
+
+	Project: AI player for Blokus
+
+	Description:
+	  Zobrist hash keys for identifying extended format game states.
+
+    Copyright (C) 2011 Lucas Sherman
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Standard includes
+#include "Types.h"
+#include "TypesEx.h"
+#include "Piece.h"
+
+// Include header
+#include "Zobrist.h"
+
+// Static member variables
+bool Zobrist::m_initialized;
+unsigned __int64 Zobrist::m_tileKeys[14][14][2];
+unsigned __int64 Zobrist::m_pieceKeys[21][2];
+unsigned __int64 Zobrist::m_playerKey;
+unsigned __int64 Zobrist::m_baseKey;
+
+// --------------------------------------------------------
+//	InitKeys - Fills the key tables from a fixed seed so
+//  that keys are identical across processes and runs.
+// --------------------------------------------------------
+void Zobrist::initKeys( )
+{
+	// Check for initialization
+	if( m_initialized ) return;
+
+	// Xorshift generator state
+	unsigned __int64 state = 0x9E3779B97F4A7C15ULL;
+	#define NEXT_KEY( ) ( state ^= state << 13, state ^= state >> 7, \
+						  state ^= state << 17, state * 0x2545F4914F6CDD1DULL )
+
+	// Generate tile keys
+	for( int x = 0; x < BOARD_SIZE; x++ )
+	for( int y = 0; y < BOARD_SIZE; y++ )
+	for( int p = 0; p < NUM_PLAYERS; p++ )
+		m_tileKeys[x][y][p] = NEXT_KEY( );
+
+	// Generate piece keys
+	for( int i = 0; i < PIECE_COUNT; i++ )
+	for( int p = 0; p < NUM_PLAYERS; p++ )
+		m_pieceKeys[i][p] = NEXT_KEY( );
+
+	// Generate player and base keys
+	m_playerKey = NEXT_KEY( );
+	m_baseKey = NEXT_KEY( );
+
+	#undef NEXT_KEY
+
+	// Mark initialized
+	m_initialized = true;
+}
+//
+// --------------------------------------------------------
+//	GetKey - Computes the key of a game state from scratch.
+//  The key covers the tiles covered by each player, the
+//  pieces each player has played, and the player to move.
+//  Keys start from a nonzero base so that the empty board
+//  does not hash to zero, which marks unused table entries.
+// --------------------------------------------------------
+unsigned __int64 Zobrist::getKey( short grid[][14], int pieces[], int player )
+{
+	unsigned __int64 key = m_baseKey;
+
+	// Hash covered tiles
+	for( int x = 0; x < BOARD_SIZE; x++ )
+	for( int y = 0; y < BOARD_SIZE; y++ )
+	for( int p = 0; p < NUM_PLAYERS; p++ )
+		if( grid[x][y] & ((1<<p)<<EX_GRID_COVERED) )
+			key ^= m_tileKeys[x][y][p];
+
+	// Hash played pieces
+	for( int p = 0; p < NUM_PLAYERS; p++ )
+	for( int i = 0; i < PIECE_COUNT; i++ )
+		if( !(pieces[p] & (1<<i)) ) key ^= m_pieceKeys[i][p];
+
+	// Hash player to move
+	if( player == PLAYER_RED ) key ^= m_playerKey;
+
+	return key;
+}
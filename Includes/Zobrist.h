@@ -0,0 +1,61 @@
+/* ===========================================================================
+
+	Project: AI player for Blokus
+
+	Description:
+	  Zobrist hash keys for identifying extended format game states.
+
+    Copyright (C) 2011 Lucas Sherman
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Begin definition
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+// Zobrist hash key set
+class Zobrist
+{
+public:
+	// Key table initialization
+	static void initKeys( );
+
+	// Computes the key of an extended format game state
+	static unsigned __int64 getKey( short grid[][14], int pieces[], int player );
+
+	// Key accessors for incremental updates
+	static unsigned __int64 getTileKey( int x, int y, int player )
+	{ return m_tileKeys[x][y][player]; }
+	static unsigned __int64 getPieceKey( int piece, int player )
+	{ return m_pieceKeys[piece][player]; }
+	static unsigned __int64 getPlayerKey( )
+	{ return m_playerKey; }
+
+private:
+	Zobrist( );
+
+	// Key data
+	static bool m_initialized;
+	static unsigned __int64 m_tileKeys[14][14][2];	//< Tile covered by player
+	static unsigned __int64 m_pieceKeys[21][2];		//< Piece played by player
+	static unsigned __int64 m_playerKey;			//< PLAYER_RED to move
+	static unsigned __int64 m_baseKey;				//< Key of the empty board
+};
+
+// End definition
+#endif
@@ -31,38 +31,61 @@
 #include "Heuristic.h"
 
 // Board evaluation heuristic function prototypes
-float simple( short grid[][14], int pieces[][3], int score[], int player );
-float random( short grid[][14], int pieces[][3], int score[], int player );
-float liberties( short grid[][14], int pieces[][3], int score[], int player );
 float lib_diff( short grid[][14], int pieces[][3], int score[], int player );	//does not work properly (yet)
 
 //Utility functions for board evaluation functions
 	//For heuristic liberties
-	float libValue_uni( short grid[][14], int x, int y, int player);
+	int libValue_uni( const unsigned int open[], int x, int y );
+	void buildStateRow( short grid[][14], EvalState* state, int x );
 	float libValue_diff( short grid[][14], int x, int y, int player);
 
+// Liberty space path tables
+int buildPathTables( );
+unsigned char pathTails[4][4096];	//< Paths beyond a second step by entry and tile pattern
+int pathClose[4][4];				//< Tile pattern masks closing the liberty by first and second step
+const int pathStepX[4] = { 1, -1, 0,  0 };
+const int pathStepY[4] = { 0,  0, 1, -1 };
+const int pathFirstStep[16] = { 0, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0 };
+const int nPathTails = buildPathTables( );
+
+// Index of the lowest set bit of a nonzero word
+const int deBruijnBits[32] = { 0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+	31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9 };
+inline int lowestBit( unsigned int bits )
+{ return deBruijnBits[((bits & (0-bits)) * 0x077CB531U) >> 27]; }
+
 // Board evaluation function count
-const int Heuristic::nEvaluationFunctions = 3;
+const int Heuristic::nEvaluationFunctions = 4;
 
 // Board evaluation function descriptions
 const char* Heuristic::evalFunctionName[nEvaluationFunctions] = {
 	"Random utility evaluation heuristic.",
 	"Simple score based evaluation heuristic.",
-	"A heuristic which takes the liberties into account, with relative weights."
+	"A heuristic which takes the liberties into account, with relative weights.",
+	"Learned network evaluation, requires a network file."
 };
 
+// Board evaluation functions maintained by EvalState
+const int Heuristic::incrementalFunction = 2;
+const int Heuristic::networkFunction = 3;
+
+// Evaluation network weights
+Nnue evalNetwork;
+int getNetworkFeatures( short grid[][14], int pieces[][3], int features[] );
+
 // Board evaluation function pointers
 const EvalFunction Heuristic::evalFunction[nEvaluationFunctions] = {
 	&random, // "Random utility evaluation heuristic."
 	&simple, // "Simple score based evaluation heuristic"
 	&liberties, //"Heuristic with relative weights for the liberties"
+	&network,	// "Learned network evaluation"
 };
 
 // --------------------------------------------------------
 //	Random board evaluation heuristic. Returns a random
 //  utility value between FLT_MAX and FLT_MIN.
 // --------------------------------------------------------
-float random( short grid[][14], int pieces[][3], 
+float Heuristic::random( short grid[][14], int pieces[][3],
 			 int score[], int player ) 
 {
 	return (float)( rand( ) - RAND_MAX/2 ) ;
@@ -72,7 +95,7 @@ float random( short grid[][14], int pieces[][3],
 //	Simple board evaluation heuristic. Returns the total
 //  difference in score between max player and min player.
 // --------------------------------------------------------
-float simple( short grid[][14], int pieces[][3], 
+float Heuristic::simple( short grid[][14], int pieces[][3],
 			 int score[], int player ) 
 {
 	return (float)( score[PLAYER_MAX] - score[PLAYER_MIN] );
@@ -82,525 +105,314 @@ float simple( short grid[][14], int pieces[][3],
 //The previous attempt for assigning a value to a liberty, based on space
 //So far, this is the best working try I have - on ply 3, it can compete with me
 // --------------------------------------------------------
-float liberties( short grid[][14], int pieces[][3], 
+float Heuristic::liberties( short grid[][14], int pieces[][3],
 			 int score[], int player ) 
 {
 	//Consider the Liberties, i.e. the squares where each player can play
-	float lib_MAX=0;
-	float lib_MIN=0;
-	float weight_Lib=3;     //specifier for how many placed pieces an entirely free liberty makes up
-	
-	for (int x=0; x<14; x++){
-		for (int y=0; y<14; y++){
-			if ( ( grid[x][y]&(1<<(player+4)) )||( grid[x][y]&(1<<(player+6)) )||( grid[x][y]&(1<<(player+8)) )//player+2*i+4, i=0,1,2,3
-				||( grid[x][y]&(1<<(player+10)) ) ){         //check whether it's a liberty for the current player
-				lib_MAX += libValue_uni(grid, x, y, player);     //give in the grid position (x,y)
-			}
-			if ( ( grid[x][y]&(1<<(5-player)) )||( grid[x][y]&(1<<(7-player)) )||( grid[x][y]&(1<<(9-player)) )//(1-player)+2*i+4
-				||( grid[x][y]&(1<<(11-player)) ) ){		 //check whether it's a liberty for the opposing player
-				lib_MIN += libValue_uni(grid, x, y, 1-player);   //give in the grid position (x,y)
-			}
-		}
-	}
-	
+	EvalState state;
+	Heuristic::initEvalState( grid, &state );
+
 	//Calculate the heuristic value out of the current score and the amount of space around liberties
+	return Heuristic::evalState( &state, score, player );
+}
+//
+// --------------------------------------------------------
+//	EvalState - Computes the liberties heuristic from the
+//  path counts of an evaluation state. Each path behind a
+//  liberty weighs 1/68 of a free liberty, which weighs as
+//  much as weight_Lib placed tiles.
+// --------------------------------------------------------
+float Heuristic::evalState( const EvalState* state, int score[], int player )
+{
+	float lib_MAX = ((float) state->total[player])/68;
+	float lib_MIN = ((float) state->total[1-player])/68;
+	float weight_Lib=3;     //specifier for how many placed pieces an entirely free liberty makes up
+
 	float BoardScore=0;
 	BoardScore = score[player] - score[1-player] + weight_Lib * (lib_MAX - lib_MIN);
 	return BoardScore;
 }
+//
+// --------------------------------------------------------
+//	InitEvalState - Computes an evaluation state from
+//  scratch, marking the safe tiles and liberties of each
+//  player and counting the paths behind every liberty.
+// --------------------------------------------------------
+void Heuristic::initEvalState( short grid[][14], EvalState* state )
+{
+	// Mark the safe tiles and liberties
+	for( int x = 0; x < PATH_ROWS; x++ ) 
+		state->open[0][x] = state->open[1][x] = 0;
+	for( int x = 0; x < 14; x++ ) 
+		buildStateRow( grid, state, x );
 
-//assigns a relative weight to every liberty, where every free spot in space has the same contribution
-float libValue_uni( short grid[][14], int x, int y, int player){
-	//easy first version for debugging, minimax only maximizes the number of available liberties
-	//under the constraint of placing the biggest piece:
-	//	return (float) 1.0;
-	
-	/* Note: the assigned values for each step may be adjusted, first attempt with 1 each */
-	/* Note: need an overall prefactor, otherwise huge weight on liberties... */
-	int value=0;
-	
-	//go through all possible paths, every node has 3 new child nodes.
-	//exception 1: first liberty has 4 (simply do that check, then don't need to check on kind of liberty)
-	//			   2 trees will be cut right at the root -> same number of if-statements
-	//exception 2: on depth 4 possibility of returning to liberty, don't need to check, trivially available
-	
-	//Tree written for depth 4 behind liberty (max size of a piece)
-	
-	/* Note: this seems quite bulky in code, there are more elegant solutions, but in my humble opinion
-	this should be the better one for performance. Later on assign different values for different depths,
-	and if these are safe spots, fighting liberties, or other characteristics.*/
-
-	//Comments denote the direction of the moves
-	
-	if ( (x<13) && !(grid[x+1][y]&(1<<(player+2))) ){//depth 1, first branch (x)
-		value++;
-		if ( (x<12) && !(grid[x+2][y]&(1<<(player+2))) ){//depth 2, first branch (xx)
-			value++;
-			if ( (x<11) && !(grid[x+3][y]&(1<<(player+2))) ){//depth 3, first branch (xxx)
-				value++;
-				if ( (x<10) && !(grid[x+4][y]&(1<<(player+2))) ){//(xxxx)
-					value++;
-				}
-				if ( (y<13) && !(grid[x+3][y+1]&(1<<(player+2))) ){//(xxxy)
-					value++;
-				}
-				if ( (y>0) && !(grid[x+3][y-1]&(1<<(player+2))) ){//(xxx-y)
-					value++;
-				}
-			}
-			if ( (y<13) && !(grid[x+2][y+1]&(1<<(player+2))) ){//depth 3, second branch (xxy)
-				value++;
-				if ( (x<11) && !(grid[x+3][y+1]&(1<<(player+2))) ){//(xxyx)
-					value++;
-				}
-				if ( (y<12) && !(grid[x+2][y+2]&(1<<(player+2))) ){//(xxyy)
-					value++;
-				}
-				if ( !(grid[x+1][y+1]&(1<<(player+2))) ){//(xxy-x)
-					value++;
-				}
-			}
-			if ( (y>0) && !(grid[x+2][y-1]&(1<<(player+2))) ){//depth 3, third branch (xx-y)
-				value++;
-				if ( (x<11) && !(grid[x+3][y-1]&(1<<(player+2))) ){//(xx-yx)
-					value++;
-				}
-				if ( (y>1) && !(grid[x+2][y-2]&(1<<(player+2))) ){//(xx-y-y)
-					value++;
-				}
-				if ( !(grid[x+1][y-1]&(1<<(player+2))) ){//(xx-y-x)
-					value++;
-				}
-			}
-		}
-		if ( (y<13) && !(grid[x+1][y+1]&(1<<(player+2))) ){//depth 2, second branch (xy)
-			value++;
-			if ( (x<12) && !(grid[x+2][y+1]&(1<<(player+2))) ){//depth 3, first branch (xyx)
-				value++;
-				if ( (x<11) && !(grid[x+3][y+1]&(1<<(player+2))) ){//(xyxx)
-					value++;
-				}
-				if ( (y<12) && !(grid[x+2][y+2]&(1<<(player+2))) ){//(xyxy)
-					value++;
-				}
-				if ( !(grid[x+2][y]&(1<<(player+2))) ){//(xyx-y)
-					value++;
-				}
-			}
-			if ( (y<12) && !(grid[x+1][y+2]&(1<<(player+2))) ){//depth 3, second branch (xyy)
-				value++;
-				if ( (x<12) && !(grid[x+2][y+2]&(1<<(player+2))) ){//(xyyx)
-					value++;
-				}
-				if ( !(grid[x][y+2]&(1<<(player+2))) ){//(xyy-x)
-					value++;
-				}
-				if ( (y<11) && !(grid[x+1][y+3]&(1<<(player+2))) ){//(xyyy)
-					value++;
-				}
-			}
-			if ( !(grid[x][y+1]&(1<<(player+2))) ){//depth 3, third branch (xy-x)
-				value++;
-				if ( (x>0) && !(grid[x-1][y+1]&(1<<(player+2))) ){//(xy-x-x)
-					value++;
-				}
-				if ( (y<12) && !(grid[x][y+2]&(1<<(player+2))) ){//(xy-xy)
-					value++;
-				}
-				//(xy-x-y) would be return to initial liberty - trivially available
-			}
-		}
-		if ( (y>0) && !(grid[x+1][y-1]&(1<<(player+2))) ){//depth 2, third branch (x-y)
-			value++;
-			if ( (x<12) && !(grid[x+2][y-1]&(1<<(player+2))) ){//depth 3, first branch (x-yx)
-				value++;
-				if ( (x<11) && !(grid[x+3][y-1]&(1<<(player+2))) ){//(x-yxx)
-					value++;
-				}
-				if ( (y>1) && !(grid[x+2][y-2]&(1<<(player+2))) ){//(x-yx-y)
-					value++;
-				}
-				if ( !(grid[x+2][y]&(1<<(player+2))) ){//(x-yxy)
-					value++;
-				}
-			}
-			if ( (y>1) && !(grid[x+1][y-2]&(1<<(player+2))) ){//depth 3, second branch (x-y-y)
-				value++;
-				if ( (x<12) && !(grid[x+2][y-2]&(1<<(player+2))) ){//(x-y-yx)
-					value++;
-				}
-				if ( !(grid[x][y-2]&(1<<(player+2))) ){//(x-y-y-x)
-					value++;
-				}
-				if ( (y>2) && !(grid[x+1][y-3]&(1<<(player+2))) ){//(x-y-y-y)
-					value++;
-				}
-			}
-			if ( !(grid[x][y-1]&(1<<(player+2))) ){//depth 3, third branch (x-y-x)
-				value++;
-				if ( (x>0) && !(grid[x-1][y-1]&(1<<(player+2))) ){//(x-y-x-x)
-					value++;
-				}
-				if ( (y>1) && !(grid[x][y-2]&(1<<(player+2))) ){//(x-y-x-y)
-					value++;
-				}
-				//(x-y-xy) would be return to initial liberty - trivially available
-			}
+	// Count the paths behind each liberty
+	for( int p = 0; p < 2; p++ )
+	{
+		state->total[p] = 0;
+		for( int x = 0; x < 14; x++ )
+		for( int y = 0; y < 14; y++ )
+		{
+			int paths = ( (state->libs[p][x]>>y)&1 ) ? libValue_uni( state->open[p], x, y ) : 0;
+			state->paths[p][x][y] = (unsigned char)paths; state->total[p] += paths;
 		}
 	}
-	
-	if ( (x>0) && !(grid[x-1][y]&(1<<(player+2))) ){//depth 1, second branch (-x)
-		value++;
-		if ( (x>1) && !(grid[x-2][y]&(1<<(player+2))) ){//depth 2, first branch (-x-x)
-			value++;
-			if ( (x>2) && !(grid[x-3][y]&(1<<(player+2))) ){//depth 3, first branch (-x-x-x)
-				value++;
-				if ( (x>3) && !(grid[x-4][y]&(1<<(player+2))) ){//(-x-x-x-x)
-					value++;
-				}
-				if ( (y<13) && !(grid[x-3][y+1]&(1<<(player+2))) ){//(-x-x-xy)
-					value++;
-				}
-				if ( (y>0) && !(grid[x-3][y-1]&(1<<(player+2))) ){//(-x-x-x-y)
-					value++;
-				}
-			}
-			if ( (y<13) && !(grid[x-2][y+1]&(1<<(player+2))) ){//depth 3, second branch (-x-xy)
-				value++;
-				if ( (x>2) && !(grid[x-3][y+1]&(1<<(player+2))) ){//(-x-xy-x)
-					value++;
-				}
-				if ( (y<12) && !(grid[x-2][y+2]&(1<<(player+2))) ){//(-x-xyy)
-					value++;
-				}
-				if ( !(grid[x-1][y+1]&(1<<(player+2))) ){//(-x-xyx)
-					value++;
-				}
-			}
-			if ( (y>0) && !(grid[x-2][y-1]&(1<<(player+2))) ){//depth 3, third branch (-x-x-y)
-				value++;
-				if ( (x>2) && !(grid[x-3][y-1]&(1<<(player+2))) ){//(-x-x-y-x)
-					value++;
-				}
-				if ( (y>1) && !(grid[x-2][y-2]&(1<<(player+2))) ){//(-x-x-y-y)
-					value++;
-				}
-				if ( !(grid[x-1][y-1]&(1<<(player+2))) ){//(-x-x-yx)
-					value++;
-				}
-			}
-		}
-		if ( (y<13) && !(grid[x-1][y+1]&(1<<(player+2))) ){//depth 2, second branch (-xy)
-			value++;
-			if ( (x>1) && !(grid[x-2][y+1]&(1<<(player+2))) ){//depth 3, first branch (-xy-x)
-				value++;
-				if ( (x>2) && !(grid[x-3][y+1]&(1<<(player+2))) ){//(-xy-x-x)
-					value++;
-				}
-				if ( (y<12) && !(grid[x-2][y+2]&(1<<(player+2))) ){//(-xy-xy)
-					value++;
-				}
-				if ( !(grid[x-2][y]&(1<<(player+2))) ){//(-xy-x-y)
-					value++;
-				}
-			}
-			if ( (y<12) && !(grid[x-1][y+2]&(1<<(player+2))) ){//depth 3, second branch (-xyy)
-				value++;
-				if ( (x>1) && !(grid[x-2][y+2]&(1<<(player+2))) ){//(-xyy-x)
-					value++;
-				}
-				if ( !(grid[x][y+2]&(1<<(player+2))) ){//(-xyyx)
-					value++;
-				}
-				if ( (y<11) && !(grid[x-1][y+3]&(1<<(player+2))) ){//(-xyyy)
-					value++;
-				}
-			}
-			if ( !(grid[x][y+1]&(1<<(player+2))) ){//depth 3, third branch (-xyx)
-				value++;
-				if ( (x<13) && !(grid[x+1][y+1]&(1<<(player+2))) ){//(-xyxx)
-					value++;
-				}
-				if ( (y<12) && !(grid[x][y+2]&(1<<(player+2))) ){//(-xyxy)
-					value++;
-				}
-				//(-xyx-y) would be return to initial liberty - trivially available
-			}
+}
+//
+// --------------------------------------------------------
+//	UpdateEvalState - Computes the evaluation state of a
+//  grid from the state before a move, where the move only
+//  changed the rows from minX to maxX. Only the liberties
+//  which were added or removed, or which lie within the
+//  path length of a tile whose safety changed, are counted
+//  again.
+// --------------------------------------------------------
+void Heuristic::updateEvalState( short grid[][14], const EvalState* in, 
+								 EvalState* out, int minX, int maxX )
+{
+	// Copy the unchanged state
+	*out = *in;
+
+	// Mark the safe tiles and liberties of the changed rows
+	for( int x = minX; x <= maxX; x++ ) 
+		buildStateRow( grid, out, x );
+
+	// Rows which may hold liberties affected by the move
+	int loX = max( minX-PATH_BORDER, 0 );
+	int hiX = min( maxX+PATH_BORDER, 13 );
+
+	for( int p = 0; p < 2; p++ )
+	{
+		// Mark the tiles whose safety changed
+		unsigned int reach[2][14];
+		for( int x = loX; x <= hiX; x++ ) reach[0][x] = 
+			( in->open[p][x+PATH_BORDER] ^ out->open[p][x+PATH_BORDER] ) >> PATH_BORDER;
+
+		// Spread the marks by the path length, the shortest route 
+		// between two tiles never leaves the board
+		for( int step = 0; step < PATH_BORDER; step++ ) 
+		{
+			unsigned int* from = reach[step&1]; unsigned int* to = reach[1-(step&1)];
+			for( int x = loX; x <= hiX; x++ ) to[x] = ( from[x] | from[x]<<1 | from[x]>>1 |
+				( x > loX ? from[x-1] : 0 ) | ( x < hiX ? from[x+1] : 0 ) ) & 0x3FFF;
 		}
-		if ( (y>0) && !(grid[x-1][y-1]&(1<<(player+2))) ){//depth 2, third branch (-x-y)
-			value++;
-			if ( (x>1) && !(grid[x-2][y-1]&(1<<(player+2))) ){//depth 3, first branch (-x-y-x)
-				value++;
-				if ( (x>2) && !(grid[x-3][y-1]&(1<<(player+2))) ){//(-x-y-x-x)
-					value++;
-				}
-				if ( (y>1) && !(grid[x-2][y-2]&(1<<(player+2))) ){//(-x-y-x-y)
-					value++;
-				}
-				if ( !(grid[x-2][y]&(1<<(player+2))) ){//(-x-y-xy)
-					value++;
-				}
-			}
-			if ( (y>1) && !(grid[x-1][y-2]&(1<<(player+2))) ){//depth 3, second branch (-x-y-y)
-				value++;
-				if ( (x>1) && !(grid[x-2][y-2]&(1<<(player+2))) ){//(-x-y-y-x)
-					value++;
-				}
-				if ( !(grid[x][y-2]&(1<<(player+2))) ){//(-x-y-yx)
-					value++;
-				}
-				if ( (y>2) && !(grid[x-1][y-3]&(1<<(player+2))) ){//(-x-y-y-y)
-					value++;
-				}
-			}
-			if ( !(grid[x][y-1]&(1<<(player+2))) ){//depth 3, third branch (-x-yx)
-				value++;
-				if ( (x<13) && !(grid[x+1][y-1]&(1<<(player+2))) ){//(-x-yxx)
-					value++;
-				}
-				if ( (y>1) && !(grid[x][y-2]&(1<<(player+2))) ){//(-x-yx-y)
-					value++;
-				}
-				//(-x-yxy) would be return to initial liberty - trivially available
-			}
+
+		// Count the paths of the affected liberties again
+		for( int x = loX; x <= hiX; x++ )
+		{
+			unsigned int lost = in->libs[p][x] & ~out->libs[p][x];
+			unsigned int found = out->libs[p][x] & ( reach[0][x] | ~in->libs[p][x] );
+			for( ; lost; lost &= lost-1 ) { int y = lowestBit( lost );
+				out->total[p] -= out->paths[p][x][y]; out->paths[p][x][y] = 0; }
+			for( ; found; found &= found-1 ) { int y = lowestBit( found );
+				int paths = libValue_uni( out->open[p], x, y );
+				out->total[p] += paths - out->paths[p][x][y]; 
+				out->paths[p][x][y] = (unsigned char)paths; }
 		}
 	}
+}
+//
+// --------------------------------------------------------
+//	Learned network evaluation. Sums the first layer of the
+//  network from scratch, the search keeps these sums in
+//  the EvalState instead.
+// --------------------------------------------------------
+float Heuristic::network( short grid[][14], int pieces[][3],
+			 int score[], int player )
+{
+	EvalState state;
+	Heuristic::initNetworkState( grid, pieces, &state );
 
-	if ( (y<13) && !(grid[x][y+1]&(1<<(player+2))) ){//depth 1, third branch (y)
-		value++;
-		if ( (y<12) && !(grid[x][y+2]&(1<<(player+2))) ){//depth 2, first branch (yy)
-			value++;
-			if ( (y<11) && !(grid[x][y+3]&(1<<(player+2))) ){//depth 3, first branch (yyy)
-				value++;
-				if ( (y<10) && !(grid[x][y+4]&(1<<(player+2))) ){//(yyyy)
-					value++;
-				}
-				if ( (x<13) && !(grid[x+1][y+3]&(1<<(player+2))) ){//(yyyx)
-					value++;
-				}
-				if ( (x>0) && !(grid[x-1][y+3]&(1<<(player+2))) ){//(yyy-x)
-					value++;
-				}
-			}
-			if ( (x<13) && !(grid[x+1][y+2]&(1<<(player+2))) ){//depth 3, second branch (yyx)
-				value++;
-				if ( (y<11) && !(grid[x+1][y+3]&(1<<(player+2))) ){//(yyxy)
-					value++;
-				}
-				if ( (x<12) && !(grid[x+2][y+2]&(1<<(player+2))) ){//(yyxx)
-					value++;
-				}
-				if ( !(grid[x+1][y+1]&(1<<(player+2))) ){//(yyx-y)
-					value++;
-				}
-			}
-			if ( (x>0) && !(grid[x-1][y+2]&(1<<(player+2))) ){//depth 3, third branch (yy-x)
-				value++;
-				if ( (y<11) && !(grid[x-1][y+3]&(1<<(player+2))) ){//(yy-xy)
-					value++;
-				}
-				if ( (x>1) && !(grid[x-2][y+2]&(1<<(player+2))) ){//(yy-x-x)
-					value++;
-				}
-				if ( !(grid[x-1][y+1]&(1<<(player+2))) ){//(yy-x-y)
-					value++;
-				}
-			}
-		}
-		if ( (x<13) && !(grid[x+1][y+1]&(1<<(player+2))) ){//depth 2, second branch (yx)
-			value++;
-			if ( (y<12) && !(grid[x+1][y+2]&(1<<(player+2))) ){//depth 3, first branch (yxy)
-				value++;
-				if ( (y<11) && !(grid[x+1][y+3]&(1<<(player+2))) ){//(yxyy)
-					value++;
-				}
-				if ( (x<12) && !(grid[x+2][y+2]&(1<<(player+2))) ){//(yxyx)
-					value++;
-				}
-				if ( !(grid[x][y+2]&(1<<(player+2))) ){//(yxy-x)
-					value++;
-				}
-			}
-			if ( (x<12) && !(grid[x+2][y+1]&(1<<(player+2))) ){//depth 3, second branch (yxx)
-				value++;
-				if ( (y<12) && !(grid[x+2][y+2]&(1<<(player+2))) ){//(yxxy)
-					value++;
-				}
-				if ( !(grid[x+2][y]&(1<<(player+2))) ){//(yxx-y)
-					value++;
-				}
-				if ( (x<11) && !(grid[x+3][y+1]&(1<<(player+2))) ){//(yxxx)
-					value++;
-				}
-			}
-			if ( !(grid[x+1][y]&(1<<(player+2))) ){//depth 3, third branch (yx-y)
-				value++;
-				if ( (y>0) && !(grid[x+1][y-1]&(1<<(player+2))) ){//(yx-y-y)
-					value++;
-				}
-				if ( (x<12) && !(grid[x+2][y]&(1<<(player+2))) ){//(yx-yx)
-					value++;
-				}
-				//(yx-y-x) would be return to initial liberty - trivially available
-			}
-		}
-		if ( (x>0) && !(grid[x-1][y+1]&(1<<(player+2))) ){//depth 2, third branch (y-x)
-			value++;
-			if ( (y<12) && !(grid[x-1][y+2]&(1<<(player+2))) ){//depth 3, first branch (y-xy)
-				value++;
-				if ( (y<11) && !(grid[x-1][y+3]&(1<<(player+2))) ){//(y-xyy)
-					value++;
-				}
-				if ( (x>1) && !(grid[x-2][y+2]&(1<<(player+2))) ){//(y-xy-x)
-					value++;
-				}
-				if ( !(grid[x][y+2]&(1<<(player+2))) ){//(y-xyx)
-					value++;
-				}
-			}
-			if ( (x>1) && !(grid[x-2][y+1]&(1<<(player+2))) ){//depth 3, second branch (y-x-x)
-				value++;
-				if ( (y<12) && !(grid[x-2][y+2]&(1<<(player+2))) ){//(y-x-xy)
-					value++;
-				}
-				if ( !(grid[x-2][y]&(1<<(player+2))) ){//(y-x-x-y)
-					value++;
-				}
-				if ( (x>2) && !(grid[x-3][y+1]&(1<<(player+2))) ){//(y-x-x-x)
-					value++;
-				}
-			}
-			if ( !(grid[x-1][y]&(1<<(player+2))) ){//depth 3, third branch (y-x-y)
-				value++;
-				if ( (y>0) && !(grid[x-1][y-1]&(1<<(player+2))) ){//(y-x-y-y)
-					value++;
-				}
-				if ( (x>1) && !(grid[x-2][y]&(1<<(player+2))) ){//(y-x-y-x)
-					value++;
-				}
-				//(y-x-yx) would be return to initial liberty - trivially available
-			}
-		}
+	return Heuristic::evalNetworkState( &state, player );
+}
+//
+// --------------------------------------------------------
+//	LoadNetwork - Loads the weights of the evaluation
+//  network, quantising them if specified. Model files are
+//  mapped and evaluated in place. Returns false if the
+//  file is missing or is not an Nnue network.
+// --------------------------------------------------------
+bool Heuristic::loadNetwork( const char* filename, bool quantised )
+{
+	if( !evalNetwork.load( filename ) ) return false;
+	if( quantised ) evalNetwork.quantise( );
+	return true;
+}
+//
+// --------------------------------------------------------
+//	InitNetworkState - Computes the network accumulator
+//  of a position from its covered tiles and pieces.
+// --------------------------------------------------------
+void Heuristic::initNetworkState( short grid[][14], int pieces[][3], EvalState* state )
+{
+	int features[NNUE_FEATURES];
+	int nFeatures = getNetworkFeatures( grid, pieces, features );
+	evalNetwork.refresh( features, nFeatures, &state->network );
+}
+//
+// --------------------------------------------------------
+//	UpdateNetworkState - Computes the network accumulator
+//  after a move from the one before it, adding the tiles
+//  the move covered and removing the piece it placed.
+// --------------------------------------------------------
+void Heuristic::updateNetworkState( const EvalState* in, EvalState* out,
+								 const int added[], int nAdded, int removed )
+{
+	evalNetwork.update( &in->network, &out->network, added, nAdded, &removed, 1 );
+}
+//
+// --------------------------------------------------------
+//	EvalNetworkState - Evaluates the layers after the
+//  accumulator, the advantage of PLAYER_MAX.
+// --------------------------------------------------------
+float Heuristic::evalNetworkState( const EvalState* state, int player )
+{
+	return evalNetwork.evaluate( &state->network, player );
+}
+//
+// --------------------------------------------------------
+//	GetNetwork - Returns the evaluation network, for the
+//  evaluation service to batch the accumulators of the
+//  network states.
+// --------------------------------------------------------
+const Nnue* Heuristic::getNetwork( )
+{
+	return &evalNetwork;
+}
+//
+// --------------------------------------------------------
+//	GetNetworkFeatures - Lists the active network features
+//  of a position, returns the feature count.
+// --------------------------------------------------------
+int getNetworkFeatures( short grid[][14], int pieces[][3], int features[] )
+{
+	int nFeatures = 0;
+
+	// Covered tiles, the low bits hold the covering player
+	for( int x = 0; x < 14; x++ )
+	for( int y = 0; y < 14; y++ ) {
+		int cover = grid[x][y] & 0x3;
+		if( cover ) features[nFeatures++] = Nnue::cellFeature( x, y, cover-1 ); }
+
+	// Remaining pieces
+	for( int p = 0; p < 2; p++ )
+	for( int i = 0; i < NNUE_PIECES; i++ )
+		if( pieces[p][i/8] & (1<<(i%8)) )
+			features[nFeatures++] = Nnue::pieceFeature( i, p );
+
+	return nFeatures;
+}
+//
+// --------------------------------------------------------
+//	BuildStateRow - Marks the tiles which are safe for each
+//  player in a row of the padded board, and the liberties
+//  of each player in a row of the board.
+// --------------------------------------------------------
+void buildStateRow( short grid[][14], EvalState* state, int x )
+{
+	unsigned int open[2] = { 0, 0 }, libs[2] = { 0, 0 };
+	for( int y = 0; y < 14; y++ )
+	{
+		unsigned int safe = ~grid[x][y] >> EX_GRID_NOT_SAFE;
+		unsigned int lbty = grid[x][y] >> EX_GRID_LBTY_UR;
+		open[0] |= ( safe&1 ) << y; open[1] |= ( (safe>>1)&1 ) << y;
+		libs[0] |= ( (lbty&0x55) != 0 ) << y; libs[1] |= ( (lbty&0xAA) != 0 ) << y;
 	}
-	
-	if ( (y>0) && !(grid[x][y-1]&(1<<(player+2))) ){//depth 1, fourth branch (-y)
+
+	for( int p = 0; p < 2; p++ ) {
+		state->open[p][x+PATH_BORDER] = open[p] << PATH_BORDER;
+		state->libs[p][x] = libs[p]; }
+}
+//
+// --------------------------------------------------------
+//	LibValue_uni - Assigns a relative weight to a liberty,
+//  where every free spot in space has the same contribution.
+//  Returns the number of paths of up to 4 steps behind the
+//  liberty (the max size of a piece) which never step
+//  straight back, never return onto the liberty, and avoid
+//  tiles that are not safe for the player. The first two steps follow the
+//  safe neighbours in the bit rows of the padded board, and
+//  the paths beyond the second step are looked up by the
+//  pattern of safe tiles within two steps of it.
+// --------------------------------------------------------
+int libValue_uni( const unsigned int open[], int x, int y )
+{
+	int value = 0;
+
+	// Follow each safe first step
+	const unsigned int* row = open + x + PATH_BORDER; int col = y + PATH_BORDER;
+	int firstSteps = ( (row[1]>>col)&1 ) | ( (row[-1]>>col)&1 ) << 1 |
+					 ( (row[0]>>(col+1))&1 ) << 2 | ( (row[0]>>(col-1))&1 ) << 3;
+	while( firstSteps )
+	{
+		int first = pathFirstStep[firstSteps]; firstSteps &= firstSteps-1;
+		const unsigned int* row1 = row + pathStepX[first]; int col1 = col + pathStepY[first];
 		value++;
-		if ( (y>1) && !(grid[x][y-2]&(1<<(player+2))) ){//depth 2, first branch (-y-y)
-			value++;
-			if ( (y>2) && !(grid[x][y-3]&(1<<(player+2))) ){//depth 3, first branch (-y-y-y)
-				value++;
-				if ( (y>3) && !(grid[x][y-4]&(1<<(player+2))) ){//(-y-y-y-y)
-					value++;
-				}
-				if ( (x<13) && !(grid[x+1][y-3]&(1<<(player+2))) ){//(-y-y-yx)
-					value++;
-				}
-				if ( (x>0) && !(grid[x-1][y-3]&(1<<(player+2))) ){//(-y-y-y-x)
-					value++;
-				}
-			}
-			if ( (x<13) && !(grid[x+1][y-2]&(1<<(player+2))) ){//depth 3, second branch (-y-yx)
-				value++;
-				if ( (y>2) && !(grid[x+1][y-3]&(1<<(player+2))) ){//(-y-yx-y)
-					value++;
-				}
-				if ( (x<12) && !(grid[x+2][y-2]&(1<<(player+2))) ){//(-y-yxx)
-					value++;
-				}
-				if ( !(grid[x+1][y-1]&(1<<(player+2))) ){//(-y-yxy)
-					value++;
-				}
-			}
-			if ( (x>0) && !(grid[x-1][y-2]&(1<<(player+2))) ){//depth 3, third branch (-y-y-x)
-				value++;
-				if ( (y>2) && !(grid[x-1][y-3]&(1<<(player+2))) ){//(-y-y-x-y)
-					value++;
-				}
-				if ( (x>1) && !(grid[x-2][y-2]&(1<<(player+2))) ){//(-y-y-x-x)
-					value++;
-				}
-				if ( !(grid[x-1][y-1]&(1<<(player+2))) ){//(-y-y-xy)
-					value++;
-				}
-			}
-		}
-		if ( (x<13) && !(grid[x+1][y-1]&(1<<(player+2))) ){//depth 2, second branch (-yx)
-			value++;
-			if ( (y>1) && !(grid[x+1][y-2]&(1<<(player+2))) ){//depth 3, first branch (-yx-y)
-				value++;
-				if ( (y>2) && !(grid[x+1][y-3]&(1<<(player+2))) ){//(-yx-y-y)
-					value++;
-				}
-				if ( (x<12) && !(grid[x+2][y-2]&(1<<(player+2))) ){//(-yx-yx)
-					value++;
-				}
-				if ( !(grid[x][y-2]&(1<<(player+2))) ){//(-yx-y-x)
-					value++;
-				}
-			}
-			if ( (x<12) && !(grid[x+2][y-1]&(1<<(player+2))) ){//depth 3, second branch (-yxx)
-				value++;
-				if ( (y>1) && !(grid[x+2][y-2]&(1<<(player+2))) ){//(-yxx-y)
-					value++;
-				}
-				if ( !(grid[x+2][y]&(1<<(player+2))) ){//(-yxxy)
-					value++;
-				}
-				if ( (x<11) && !(grid[x+3][y-1]&(1<<(player+2))) ){//(-yxxx)
-					value++;
-				}
-			}
-			if ( !(grid[x+1][y]&(1<<(player+2))) ){//depth 3, third branch (-yxy)
-				value++;
-				if ( (y<13) && !(grid[x+1][y+1]&(1<<(player+2))) ){//(-yxyy)
-					value++;
-				}
-				if ( (x<12) && !(grid[x+2][y]&(1<<(player+2))) ){//(-yxyx)
-					value++;
-				}
-				//(-yxy-x) would be return to initial libertx - triviallx available
-			}
+
+		// Follow each safe second step which does not step back
+		int secondSteps = ( (row1[1]>>col1)&1 ) | ( (row1[-1]>>col1)&1 ) << 1 |
+						  ( (row1[0]>>(col1+1))&1 ) << 2 | ( (row1[0]>>(col1-1))&1 ) << 3;
+		secondSteps &= ~( 1<<(first^1) );
+		while( secondSteps )
+		{
+			int second = pathFirstStep[secondSteps]; secondSteps &= secondSteps-1;
+			const unsigned int* r = row1 + pathStepX[second]; int c = col1 + pathStepY[second];
+
+			// Add the step and the paths beyond it
+			int pattern = ( (r[-2]>>c)&1 ) | ( (r[-1]>>(c-1))&7 ) << 1 |
+						  ( (r[0]>>(c-2))&3 ) << 4 | ( (r[0]>>(c+1))&3 ) << 6 |
+						  ( (r[1]>>(c-1))&7 ) << 8 | ( (r[2]>>c)&1 ) << 11;
+			value += 1 + pathTails[second][pattern & pathClose[first][second]];
 		}
-		if ( (x>0) && !(grid[x-1][y-1]&(1<<(player+2))) ){//depth 2, third branch (-y-x)
-			value++;
-			if ( (y>1) && !(grid[x-1][y-2]&(1<<(player+2))) ){//depth 3, first branch (-y-x-y)
-				value++;
-				if ( (y>2) && !(grid[x-1][y-3]&(1<<(player+2))) ){//(-y-x-y-y)
-					value++;
-				}
-				if ( (x>1) && !(grid[x-2][y-2]&(1<<(player+2))) ){//(-y-x-y-x)
-					value++;
-				}
-				if ( !(grid[x][y-2]&(1<<(player+2))) ){//(-y-x-yx)
-					value++;
-				}
-			}
-			if ( (x>1) && !(grid[x-2][y-1]&(1<<(player+2))) ){//depth 3, second branch (-y-x-x)
-				value++;
-				if ( (y>1) && !(grid[x-2][y-2]&(1<<(player+2))) ){//(-y-x-x-y)
-					value++;
-				}
-				if ( !(grid[x-2][y]&(1<<(player+2))) ){//(-y-x-xy)
-					value++;
-				}
-				if ( (x>2) && !(grid[x-3][y-1]&(1<<(player+2))) ){//(-y-x-x-x)
-					value++;
-				}
-			}
-			if ( !(grid[x-1][y]&(1<<(player+2))) ){//depth 3, third branch (-y-xy)
-				value++;
-				if ( (y<13) && !(grid[x-1][y+1]&(1<<(player+2))) ){//(-y-xyy)
-					value++;
-				}
-				if ( (x>1) && !(grid[x-2][y]&(1<<(player+2))) ){//(-y-xy-x)
-					value++;
-				}
-				//(-y-xyx) would be return to initial liberty - trivially available
-			}
+	}
+
+	return value;
+}
+//
+// --------------------------------------------------------
+//	BuildPathTables - Counts the paths beyond a second step
+//  for each direction it was entered from and each pattern
+//  of safe tiles within two steps of it, and builds the
+//  masks which close the liberty in those patterns. Tile
+//  pattern bits are ordered by row, then column. Returns
+//  the size of the path table.
+// --------------------------------------------------------
+int buildPathTables( )
+{
+	// Tiles within two steps of a tile, in tile pattern order
+	static const int patternX[12] = { -2, -1, -1, -1,  0,  0, 0, 0,  1, 1, 1, 2 };
+	static const int patternY[12] = {  0, -1,  0,  1, -2, -1, 1, 2, -1, 0, 1, 0 };
+
+	// Count the paths for each entry direction and tile pattern
+	for( int entry = 0; entry < 4; entry++ )
+	for( int pattern = 0; pattern < 4096; pattern++ )
+	{
+		int count = 0;
+		for( int third = 0; third < 4; third++ ) if( (third^1) != entry )
+		for( int t = 0; t < 12; t++ )
+		if( patternX[t] == pathStepX[third] && patternY[t] == pathStepY[third] && (pattern & (1<<t)) )
+		{
+			count++;
+			for( int fourth = 0; fourth < 4; fourth++ ) if( (fourth^1) != third )
+			for( int u = 0; u < 12; u++ )
+			if( patternX[u] == pathStepX[third]+pathStepX[fourth] &&
+				patternY[u] == pathStepY[third]+pathStepY[fourth] && (pattern & (1<<u)) ) count++;
 		}
+		pathTails[entry][pattern] = (unsigned char)count;
 	}
-	float result = ((float) value)/68;
-	return result;
+
+	// Close the liberty, which lies two steps behind the second step
+	for( int first = 0; first < 4; first++ )
+	for( int second = 0; second < 4; second++ )
+	{
+		pathClose[first][second] = 0xFFF;
+		for( int t = 0; t < 12; t++ )
+		if( patternX[t] == -pathStepX[first]-pathStepX[second] &&
+			patternY[t] == -pathStepY[first]-pathStepY[second] )
+			pathClose[first][second] &= ~(1<<t);
+	}
+
+	return 4*4096;
 }
 
 
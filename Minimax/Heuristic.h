@@ -32,6 +32,27 @@
 typedef float (*EvalFunction)
 	( short grid[][14], int pieces[][3], int score[], int player );
 
+// Liberty space path settings
+#define PATH_BORDER	  4   //< Padding around the board for path lookups
+#define PATH_ROWS	 22   //< Row count of the padded board
+
+// Incremental evaluation state, holding either the liberty counts
+// or the network accumulator of the selected evaluation function,
+// and the position keys kept by the search
+struct EvalState
+{
+	union {
+		struct {
+			unsigned int open[2][PATH_ROWS];	//< Safe tiles of each player as bit rows of the padded board
+			unsigned int libs[2][14];			//< Liberties of each player as bit rows of the board
+			unsigned char paths[2][14][14];		//< Path count of each liberty
+			int total[2];						//< Path count of all liberties of each player
+		};
+		NnueAccumulator network;				//< First layer sums of the evaluation network
+	};
+	unsigned __int64 key[2];					//< Zobrist keys of the position and its diagonal reflection
+};
+
 // Heuristic namespace
 namespace Heuristic {
 
@@ -40,6 +61,27 @@ namespace Heuristic {
 	extern const EvalFunction evalFunction[];
 	extern const char* evalFunctionName[];
 
+	// Board evaluation functions, named for search specialization
+	float random( short grid[][14], int pieces[][3], int score[], int player );
+	float simple( short grid[][14], int pieces[][3], int score[], int player );
+	float liberties( short grid[][14], int pieces[][3], int score[], int player );
+	float network( short grid[][14], int pieces[][3], int score[], int player );
+
+	// Incremental liberty evaluation
+	extern const int incrementalFunction;
+	void initEvalState( short grid[][14], EvalState* state );
+	void updateEvalState( short grid[][14], const EvalState* in, EvalState* out, int minX, int maxX );
+	float evalState( const EvalState* state, int score[], int player );
+
+	// Incremental network evaluation
+	extern const int networkFunction;
+	bool loadNetwork( const char* filename, bool quantised );
+	void initNetworkState( short grid[][14], int pieces[][3], EvalState* state );
+	void updateNetworkState( const EvalState* in, EvalState* out,
+		const int added[], int nAdded, int removed );
+	float evalNetworkState( const EvalState* state, int player );
+	const Nnue* getNetwork( );
+
 }
 
 // End definition
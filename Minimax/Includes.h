@@ -42,6 +42,8 @@
 #include <string>
 #include <limits>
 #include <math.h>
+#include <float.h>
+#include <algorithm>
 
 // Debug macros
 #include "Debug.h"
@@ -56,9 +58,24 @@
 // Opening book
 #include "OpeningBook.h"
 
+// Position hashing
+#include "Zobrist.h"
+#include "Symmetry.h"
+
+// Evaluation cache
+#include "EvalCache.h"
+
+// Evaluation and policy network
+#include "Nnue.h"
+#include "Policy.h"
+#include "EvalService.h"
+
 // Heuristic functions
 #include "Heuristic.h"
 
+// Self-play driver
+#include "SelfPlay.h"
+
 // Include header
 #include "Minimax.h"
 
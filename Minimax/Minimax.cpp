@@ -33,29 +33,82 @@
 #define MIN_DEPTH	      3   //< Minimum minimax search depth
 #define MAX_DEPTH         3   //< Maximum minimax search depth
 #define PROFILE		   TRUE   //< Imbeds profile code in build
+#define INCREMENTAL_EVAL TRUE //< Updates the liberties or network evaluation with each move
+#define EVAL_CACHE  (1<<18)   //< Entries in the evaluation cache (power of two), 0 for none
+#define BENCHMARK_KERNEL FALSE //< Times searches with the search kernel before each move
+#define BENCHMARK_DEPTH   2   //< Depth of the benchmark searches
+#define BENCHMARK_POSITIONS 32 //< Most positions searched by the benchmark
+#define SYMMETRY_PRUNING TRUE  //< Searches one of each pair of mirrored root moves
+#define POLICY_ORDERING FALSE //< Orders moves by the policy head of the network
+#define POLICY_DEPTH      1   //< Least remaining depth of the nodes ordered by the policy
+#define EVAL_SERVICE  FALSE   //< Evaluates the network leaves of all threads in batches
+#define EVAL_BATCH       16   //< Most leaves the evaluation service runs at once
+#define EVAL_WINDOW      32   //< Most leaves of a node submitted before taking their results
 
 // Opening book filename
 #define BOOK_FNAME	NULL   //< Opening book filename, NULL for none
 
+// Evaluation network filename
+#define NETWORK_FNAME "network.nnue" //< Network of the learned evaluation, NULL for none
+#define NETWORK_QUANTISED TRUE       //< Evaluates the network with 8 and 16 bit integer weights
+#define POLICY_FNAME "policy.nnue"   //< Network whose policy head orders moves, NULL for none
+
+// Endgame Solver Settings
+#define SOLVER_PLY		 26   //< Ply from which the solver runs (final 16 plies)
+#define SOLVER_TIME	   2.0f   //< Solver time allotted per move (seconds)
+#define SOLVER_TABLE (1<<20)  //< Entries in each solver table (power of two)
+#define SOLVER_STACK (16<<20) //< Stack size of the solver thread (bytes)
+#define PN_INFINITY 100000000 //< Proof number of a disproven target
+
 // Profiler segments
 enum ProfilerFunctions {
 	tTotal, tMinimax, tReformatBoard, tEnumerateMoves, tEvaluateBoards, 
-	tCheckValidMoves, tSimulateMoves, tMoveValidation, tEnd };
+	tCheckValidMoves, tSimulateMoves, tMoveValidation, tOrderMoves, tEnd };
+
+// Endgame solver results
+enum SolverResults { rUnknown, rWin, rDraw, rLoss };
 
 // Static member declarations
 std::vector<Minimax::Liberty> Minimax::m_pieceLiberties[21];
 Minimax::Piece Minimax::m_piece[21];
 int Minimax::m_startTile[4][2];
 int Minimax::m_evalFunction;
+Minimax::SearchKernel Minimax::m_minimax;
 int Minimax::m_boardSize;    
 int Minimax::m_nPlayers;
 Timer Minimax::m_matchTimer;
 OpeningBook Minimax::m_book;
+float Minimax::m_moveUtility;
+bool Minimax::m_moveSearched;
 
 // Profiler data members
 __int64 Minimax::m_timeCosts[10];
 unsigned int Minimax::m_nodesSearched;
 unsigned int Minimax::m_leavesSearched;
+unsigned int Minimax::m_cacheProbes;
+unsigned int Minimax::m_cacheHits;
+unsigned int Minimax::m_cutoffNodes;
+unsigned int Minimax::m_firstMoveCutoffs;
+
+// Evaluation cache
+EvalCache Minimax::m_evalCache;
+
+// Search kernels in Heuristic::evalFunction order
+const Minimax::SearchKernel Minimax::m_searchKernel[] = {
+	&minimax<Heuristic::random>, &minimax<Heuristic::simple>, &minimax<Heuristic::liberties>,
+	&minimax<Heuristic::network> };
+
+// Endgame solver data members
+Minimax::SolverEntry* Minimax::m_solverTable[2];
+Minimax::SolverState Minimax::m_solverState;
+Timer Minimax::m_solverTimer;
+float Minimax::m_solverStart;
+volatile int Minimax::m_solverRunning;
+volatile int Minimax::m_solverStop;
+int Minimax::m_solverActive;
+int Minimax::m_solverResult;
+int Minimax::m_solverTarget;
+unsigned int Minimax::m_solverNodes;
 
 // --------------------------------------------------------
 //	Store match settings data and load piece configuration
@@ -71,6 +124,17 @@ void Minimax::startup( int boardSize, int startTile[][2], int nPlayers )
 
 	// Load piece data
 	loadPieceConfigs( ); getPieceLiberties( );
+	Symmetry::initialize( );
+
+	// Allocate the evaluation cache
+	Zobrist::initKeys( );
+	if( EVAL_CACHE ) m_evalCache.allocate( EVAL_CACHE );
+
+	// Allocate the endgame solver tables
+	for( int t = 0; t < 2; t++ ) {
+		m_solverTable[t] = new SolverEntry[SOLVER_TABLE];
+		ZeroMemory( m_solverTable[t], sizeof(SolverEntry)*SOLVER_TABLE ); }
+	m_solverRunning = FALSE; m_solverActive = FALSE;
 
 	// Store player/board data
 	m_boardSize = boardSize; m_nPlayers = nPlayers;
@@ -91,6 +155,7 @@ void Minimax::startup( int boardSize, int startTile[][2], int nPlayers )
 	std::cout << "Max Thread Count: " << MAX_THREADS << "\n";
 	std::cout << "Min Search Depth: " << MIN_DEPTH << "\n";
 	std::cout << "Max Search Depth: " << MAX_DEPTH << "\n";
+	std::cout << "Endgame Solver: from ply " << SOLVER_PLY << ", " << SOLVER_TIME << "s\n";
 
 	// Select an evaluation function
 	if( FORCE_EVAL != -1 ) m_evalFunction = FORCE_EVAL; else 
@@ -121,11 +186,55 @@ void Minimax::startup( int boardSize, int startTile[][2], int nPlayers )
 		if( !success ) m_evalFunction = 0;
     }
 
+	// Load the evaluation network, falling back on the liberties heuristic
+	if( m_evalFunction == Heuristic::networkFunction ) {
+		if( NETWORK_FNAME && Heuristic::loadNetwork( NETWORK_FNAME, NETWORK_QUANTISED ) )
+			std::cout << "Evaluation network " << NETWORK_FNAME << " loaded\n";
+		else { std::cerr << "Error loading evaluation network, using liberties\n";
+			m_evalFunction = Heuristic::incrementalFunction; } }
+
+	// Start the evaluation service on the network
+	if( EVAL_SERVICE && INCREMENTAL_EVAL && m_evalFunction == Heuristic::networkFunction ) {
+		ASSERT( EVAL_WINDOW*MAX_THREADS <= EVAL_QUEUE_SIZE );
+		if( EvalService::start( Heuristic::getNetwork( ), EVAL_BATCH ) )
+			std::cout << "Evaluation service started, batches of " << EVAL_BATCH << "\n"; }
+
+	// Load the policy head for move ordering
+	if( POLICY_ORDERING && POLICY_FNAME ) {
+		if( Policy::load( POLICY_FNAME ) )
+			std::cout << "Policy network " << POLICY_FNAME << " loaded\n";
+		else std::cout << "No policy network loaded\n"; }
+
+	// Select the search kernel of the function
+	ASSERT( sizeof(m_searchKernel)/sizeof(SearchKernel) == Heuristic::nEvaluationFunctions );
+	m_minimax = m_searchKernel[m_evalFunction];
+
 	// Print ready message
 	std::cout << "Ready to Move!!!\n";
 } 
 //
 // --------------------------------------------------------
+//	Stops the endgame solver and releases its tables.
+// --------------------------------------------------------
+void Minimax::shutdown( )
+{
+	// Wait for the solver thread to exit
+	m_solverStop = TRUE;
+	while( m_solverRunning ) Sleep( 5 );
+
+	// Release the solver tables
+	for( int t = 0; t < 2; t++ ) {
+		delete [] m_solverTable[t];
+		m_solverTable[t] = NULL; }
+
+	// Release the evaluation cache
+	m_evalCache.release( );
+
+	// Stop the evaluation service
+	EvalService::stop( );
+}
+//
+// --------------------------------------------------------
 //	Converts the format of the board from a single byte
 //	cover map to a 4 byte cover, adjacent, diagonal_1-4
 //	map used for speeding up the board reasoning and move
@@ -216,6 +325,7 @@ Move Minimax::makeMove( char grid[][20], bool pieces[][21], int score[], int pla
 {
 	// Set the minimum search depth
 	int maxSearchDepth = MIN_DEPTH;
+	m_moveSearched = false;
 
 	// First check if position is in opening book
 	if(m_book.isInBook(moveHistory)) {
@@ -223,12 +333,32 @@ Move Minimax::makeMove( char grid[][20], bool pieces[][21], int score[], int pla
 		} catch(const char *s) {
 			std::cerr << "Error with opening book " << s << std::endl; } }
 
+	// Start the endgame solver in the background
+	if( (int)moveHistory.size( ) >= SOLVER_PLY ) {
+		short newGrid[14][14]; int newPieces[2][3];
+		reformatBoard( grid, newGrid, pieces, newPieces );
+		startSolver( newGrid, newPieces, score, player ); }
+
+	// Discard the solver of a previous game
+	else if( m_solverActive ) { m_solverStop = TRUE;
+		while( m_solverRunning ) Sleep( 5 );
+		m_solverActive = FALSE; }
+
+	// Benchmark the search kernel on the current position
+	if( BENCHMARK_KERNEL ) { short newGrid[14][14]; int newPieces[2][3];
+		reformatBoard( grid, newGrid, pieces, newPieces );
+		benchmarkKernel( newGrid, newPieces, score, player ); }
+
 	// Iterative deepening loop
+	Move move;
 	while( TRUE )
 	{
 		// Clear profiler data
 		if( PROFILE ) { for( int i = 0; i < tEnd; i++ ) m_timeCosts[i] = 0; 
-				m_nodesSearched = 0; m_leavesSearched = 0; }
+				m_nodesSearched = 0; m_leavesSearched = 0; 
+				m_cacheProbes = 0; m_cacheHits = 0;
+				m_cutoffNodes = 0; m_firstMoveCutoffs = 0;
+				if( EvalService::isRunning( ) ) EvalService::clearStats( ); }
 
 		// Get the current time
 		LARGE_INTEGER temp; __int64 startTimeTotal;
@@ -243,7 +373,7 @@ Move Minimax::makeMove( char grid[][20], bool pieces[][21], int score[], int pla
 		reformatBoard( grid, newGrid, pieces, newPieces );
 
 		// Uses minimax algorithm to select the best move
-		Move move = getMinimaxMoveMultiThreaded( newGrid, newPieces, score, player, maxSearchDepth-1 );
+		move = getMinimaxMoveMultiThreaded( newGrid, newPieces, score, player, maxSearchDepth-1 );
 
 		// Update timer for comparison with remaining match time
 		m_matchTimer.update( ); float endTime = m_matchTimer.getRunningTime( );
@@ -261,8 +391,13 @@ Move Minimax::makeMove( char grid[][20], bool pieces[][21], int score[], int pla
 		
 		// Check for terminal condition
 		if( searchTime > 3.0f || maxSearchDepth > MAX_DEPTH )
-			return move;
+			break;
 	}
+
+	// Override the heuristic move with a proven result
+	if( m_solverActive ) getSolverMove( &move );
+
+	return move;
 }
 // 
 // --------------------------------------------------------
@@ -287,20 +422,31 @@ Move Minimax::getMinimaxMove( short grid[][14],
 		movesFound = getMoveList( moves, grid, pieces, player );
 	}
 
+	// Search one of each pair of mirrored moves in a symmetric position
+	if( SYMMETRY_PRUNING && Symmetry::isSymmetric( grid ) )
+		movesFound = Symmetry::pruneMoves( moves, movesFound );
+
+	// Search the moves the policy rates best first
+	if( POLICY_ORDERING && Policy::isLoaded( ) )
+		orderMoves( moves, movesFound, grid, pieces, player );
+
 	// Number of possible moves output
 	std::cout << "\n\nNumber of possible moves:" << movesFound << "\n";
 
+	// Build the root evaluation state
+	EvalState rootEval; EvalState* eval = getRootEvalState( grid, pieces, player, &rootEval );
+
 	// Recursively perform minimax on each move
 	int move; float alpha = -FLT_MAX, beta = FLT_MAX; 
 	for( int i = 0; i < movesFound; i++ )
 	{
 		// Simulate the selected move on the board for minimax evaluation
-		short mGrid[14][14]; int mPieces[2][3]; int mScore[4]; int mPlayer;
+		short mGrid[14][14]; int mPieces[2][3]; int mScore[4]; int mPlayer; EvalState mEval;
 		simulateMove( moves[i], grid, pieces, score, player, 
-						mGrid, mPieces, mScore, &mPlayer );
+						mGrid, mPieces, mScore, &mPlayer, eval, &mEval );
 
 		// Perform minimax on the new board state
-		float newUtility = minimax( mGrid, mPieces, mScore, mPlayer, depth, alpha, beta );
+		float newUtility = m_minimax( mGrid, mPieces, mScore, mPlayer, depth, alpha, beta, eval ? &mEval : NULL );
 
 		// Update alpha-beta parameters
 		if( player == PLAYER_MAX ) { if( newUtility > alpha ) { alpha = newUtility; move = i; } }
@@ -344,6 +490,14 @@ Move Minimax::getMinimaxMoveMultiThreaded( short grid[][14],
 		maxMoveIndex = getMoveList( moves, grid, pieces, player );
 	}
 
+	// Search one of each pair of mirrored moves in a symmetric position
+	if( SYMMETRY_PRUNING && Symmetry::isSymmetric( grid ) )
+		maxMoveIndex = Symmetry::pruneMoves( moves, maxMoveIndex );
+
+	// Search the moves the policy rates best first
+	if( POLICY_ORDERING && Policy::isLoaded( ) )
+		orderMoves( moves, maxMoveIndex, grid, pieces, player );
+
 	//Number of possible moves output
 	std::cout << "\n\nNumber of possible moves:" << maxMoveIndex << "\n";
 
@@ -352,6 +506,9 @@ Move Minimax::getMinimaxMoveMultiThreaded( short grid[][14],
 	if( nThreads > maxMoveIndex )
 		nThreads = maxMoveIndex;
 
+	// Build the root evaluation state
+	EvalState rootEval; EvalState* eval = getRootEvalState( grid, pieces, player, &rootEval );
+
 	// Initialize thread data
 	float alpha = -FLT_MAX, beta = FLT_MAX; 
 	for( int i = 0; i < nThreads; i++ ) {
@@ -386,9 +543,11 @@ Move Minimax::getMinimaxMoveMultiThreaded( short grid[][14],
 				threadStates[i].alpha = alpha; threadStates[i].beta = beta;
 
 				// Simulate the selected move on the board for minimax 
+				threadStates[i].eval = eval ? &threadStates[i].evalState : NULL;
 				simulateMove( moves[nextMoveIndex], grid, pieces, score, player, 
 					threadStates[i].grid, threadStates[i].pieces, 
-					threadStates[i].score, &threadStates[i].player );
+					threadStates[i].score, &threadStates[i].player,
+					eval, threadStates[i].eval );
 
 				// Begin the utility ranking thread
 				if( _beginthread( &getMinimaxUtility, 0, threadStates+i ) == -1 )
@@ -407,6 +566,9 @@ Move Minimax::getMinimaxMoveMultiThreaded( short grid[][14],
 	if( PROFILE ) { QueryPerformanceCounter( &temp );
 		m_timeCosts[tMinimax] += temp.QuadPart - startTime; } 
 
+	// Store the utility of the selected move
+	m_moveUtility = (player == PLAYER_MAX) ? alpha : beta; m_moveSearched = true;
+
 	// Return index
 	std::cout << "Player " << player << " selects a move with utility " << beta << "\n";
 	return moves[move];
@@ -422,8 +584,8 @@ void Minimax::getMinimaxUtility( void* dataOut )
 	MtGameState* state = (MtGameState*)dataOut;
 
 	// Perform minimax search
-	state->utility = minimax( state->grid, state->pieces, state->score, state->player,
-		state->depth, state->alpha, state->beta );
+	state->utility = m_minimax( state->grid, state->pieces, state->score, state->player,
+		state->depth, state->alpha, state->beta, state->eval );
 
 	// Mark the thread done
 	state->completed = true;
@@ -431,11 +593,19 @@ void Minimax::getMinimaxUtility( void* dataOut )
 //
 // --------------------------------------------------------
 //	Uses the minimax algorithm with alpha-beta pruning to
-//	compute the utility value of a board position.
+//	compute the utility value of a board position. Search
+//  kernels are instantiated per evaluation function so the
+//  evaluation is bound at compile time.
 // --------------------------------------------------------
+template<EvalFunction evaluate>
 float Minimax::minimax( short grid[][14], int pieces[][3], int score[], int player,
-						 int depth, float alpha, float beta )
+						 int depth, float alpha, float beta, const EvalState* eval )
 {	
+	// Use the exact utility of positions proven by the solver
+	float provenUtility;
+	if( m_solverActive && getProvenUtility( eval ? getStateKey( eval ) :
+		getStateKey( grid, pieces, player ), &provenUtility ) ) return provenUtility;
+
 	// Check current depth for search tree cut-off
 	if( depth == 0 ) 
 	{
@@ -444,9 +614,14 @@ float Minimax::minimax( short grid[][14], int pieces[][3], int score[], int play
 		if( PROFILE ) { QueryPerformanceCounter( &temp );
 					  startTime = temp.QuadPart; }
 
-		// Compute board utility
-		float utility = Heuristic::evalFunction[m_evalFunction]
-			( grid, pieces, score, player );
+		// Compute board utility, from the incremental state if one is kept
+		float utility = getUtility<evaluate>( grid, pieces, score, player, eval );
+
+		// Check the incremental state against a full recompute, the
+		// network sums are accumulated in a different order
+		if( eval ) ASSERT( evaluate == Heuristic::network ?
+			fabs( utility - evaluate( grid, pieces, score, player ) ) < 1e-3f :
+			utility == evaluate( grid, pieces, score, player ) );
 
 		// Increment function runtime costs
 		if( PROFILE ) { QueryPerformanceCounter( &temp );
@@ -479,7 +654,9 @@ float Minimax::minimax( short grid[][14], int pieces[][3], int score[], int play
 		else if( isMoveAvailable( grid, pieces, 1-player ) ) {
 			if( PROFILE ) { QueryPerformanceCounter( &temp );
 			m_timeCosts[tCheckValidMoves] += temp.QuadPart - startTime; } 
-			return minimax( grid, pieces, score, 1-player, depth-1, alpha, beta ); }
+			EvalState passEval; if( eval ) { passEval = *eval;
+				passEval.key[0] ^= Zobrist::getPlayerKey( ); passEval.key[1] ^= Zobrist::getPlayerKey( ); }
+			return minimax<evaluate>( grid, pieces, score, 1-player, depth-1, alpha, beta, eval ? &passEval : NULL ); }
 		else if( score[player] == score[1-player] ) {
 			if( PROFILE ) { QueryPerformanceCounter( &temp );
 			m_timeCosts[tCheckValidMoves] += temp.QuadPart - startTime; } 
@@ -494,25 +671,181 @@ float Minimax::minimax( short grid[][14], int pieces[][3], int score[], int play
 	if( PROFILE ) { QueryPerformanceCounter( &temp );
 		m_timeCosts[tCheckValidMoves] += temp.QuadPart - startTime; } 
 
+	// Search the moves the policy rates best first
+	if( POLICY_ORDERING && depth >= POLICY_DEPTH && Policy::isLoaded( ) )
+		orderMoves( moves, nMoves, grid, pieces, player );
+
+	// Evaluate the leaves of the last ply through the evaluation service
+	if( evaluate == Heuristic::network && EVAL_SERVICE && depth == 1 && eval && EvalService::isRunning( ) )
+		return searchLeafBatch( moves, nMoves, grid, pieces, score, player, alpha, beta, eval );
+
 	// Recursively perform minimax on each move
 	for( int i = 0; i < nMoves; i++ )
 	{
 		// Simulate the selected move on the board for minimax evaluation
-		short newGrid[14][14]; int newPieces[2][3]; int newScore[4]; int newPlayer;
+		short newGrid[14][14]; int newPieces[2][3]; int newScore[4]; int newPlayer; EvalState newEval;
 		simulateMove( moves[i], grid, pieces, score, player, newGrid, 
-			newPieces, newScore, &newPlayer );
+			newPieces, newScore, &newPlayer, eval, &newEval );
 
 		// Perform minimax on the new board state
-		float newUtility = minimax( newGrid, newPieces, newScore, 
-			newPlayer, depth-1, alpha, beta );
+		float newUtility = minimax<evaluate>( newGrid, newPieces, newScore,
+			newPlayer, depth-1, alpha, beta, eval ? &newEval : NULL );
 
 		// Update alpha-beta bounds
 		if( player == PLAYER_MAX ) {
 			if( newUtility > alpha ) alpha = newUtility; }
 		else if( newUtility < beta ) beta = newUtility;
 
-		// Check for alpha-beta cut-off
-		if( beta <= alpha ) break;
+		// Check for alpha-beta cut-off, counting those made by the first move
+		if( beta <= alpha ) { if( PROFILE ) { m_cutoffNodes++;
+			if( i == 0 ) m_firstMoveCutoffs++; } break; }
+	}
+
+	// Return the appropriate utility bound
+	return (player==PLAYER_MAX) ? alpha : beta;
+}
+//
+// --------------------------------------------------------
+//	Evaluates a board position with the selected function,
+//  looking the utility up in the evaluation cache first.
+//  The cache is shared by all search threads and is kept
+//  between moves. Positions are keyed by their own key
+//  rather than the one shared with their reflection, as
+//  the network does not value mirrored positions equally.
+//  With an incremental state the key it keeps is used and
+//  the network is run from its accumulator. The liberties
+//  are read from their incremental state directly, a few
+//  operations on the path totals which cost less than
+//  the probe.
+// --------------------------------------------------------
+template<EvalFunction evaluate>
+float Minimax::getUtility( short grid[][14], int pieces[][3], int score[], int player, const EvalState* eval )
+{
+	// Check the incremental key against a full recompute
+	if( eval ) ASSERT( getPositionKey( eval ) == getPositionKey( grid, pieces, player ) &&
+		getStateKey( eval ) == getStateKey( grid, pieces, player ) );
+
+	// Read the liberties from the incremental state
+	if( evaluate == Heuristic::liberties && eval ) return Heuristic::evalState( eval, score, player );
+
+	// Evaluate the board directly without a cache
+	bool fromState = ( evaluate == Heuristic::network && eval );
+	if( !EVAL_CACHE ) return fromState ? Heuristic::evalNetworkState( eval, player ) :
+		evaluate( grid, pieces, score, player );
+
+	// Check the cache for the position
+	float utility; unsigned __int64 key = eval ? getPositionKey( eval ) : getPositionKey( grid, pieces, player );
+	if( PROFILE ) m_cacheProbes++;
+	if( m_evalCache.probe( key, m_evalFunction, &utility ) ) {
+		if( PROFILE ) m_cacheHits++;
+		return utility; }
+
+	// Evaluate and store the board
+	utility = fromState ? Heuristic::evalNetworkState( eval, player ) :
+		evaluate( grid, pieces, score, player );
+	m_evalCache.store( key, m_evalFunction, utility );
+
+	return utility;
+}
+//
+// --------------------------------------------------------
+//	Orders a move list by the policy head of the network so
+//  that alpha-beta cut-offs come from the first moves. The
+//  network runs once for the position, scoring all moves.
+// --------------------------------------------------------
+void Minimax::orderMoves( Move moves[], int nMoves, short grid[][14], int pieces[][3], int player )
+{
+	// Get the current time
+	LARGE_INTEGER temp; __int64 startTime;
+	if( PROFILE ) { QueryPerformanceCounter( &temp );
+				  startTime = temp.QuadPart; }
+
+	// Convert the packed piece bytes to piece masks
+	int masks[2];
+	for( int p = 0; p < 2; p++ )
+		masks[p] = pieces[p][0] | (pieces[p][1]<<8) | (pieces[p][2]<<16);
+
+	// Score and sort the moves
+	float logits[NNUE_POLICY];
+	Policy::getLogits( grid, masks, player, logits );
+	Policy::orderMoves( logits, moves, nMoves );
+
+	// Increment function runtime costs
+	if( PROFILE ) { QueryPerformanceCounter( &temp );
+		m_timeCosts[tOrderMoves] += temp.QuadPart - startTime; } 
+}
+//
+// --------------------------------------------------------
+//	Searches the leaves of a node at the last ply through
+//  the evaluation service. The leaves of each window of
+//  moves are simulated and submitted before the first
+//  result is taken, so the service batches them with the
+//  leaves of the other threads while this one simulates.
+//  Results are taken in move order, giving the bound and
+//  cut-offs of searching the leaves one at a time. Windows
+//  double from a single leaf as most cut-offs are made by
+//  the first moves. Leaves found in the evaluation cache
+//  are not submitted.
+// --------------------------------------------------------
+float Minimax::searchLeafBatch( Move moves[], int nMoves, short grid[][14], int pieces[][3],
+								int score[], int player, float alpha, float beta, const EvalState* eval )
+{
+	EvalState leafEval[EVAL_WINDOW]; long ticket[EVAL_WINDOW];
+	float leafUtility[EVAL_WINDOW]; bool known[EVAL_WINDOW];
+	int leafPlayer[EVAL_WINDOW];
+
+	bool cutoff = false;
+	for( int first = 0, window = 1; first < nMoves && !cutoff; first += window, window = min( 2*window, EVAL_WINDOW ) )
+	{
+		// Simulate and submit the leaves of the window
+		int nLeaves = min( window, nMoves-first );
+		for( int i = 0; i < nLeaves; i++ )
+		{
+			short newGrid[14][14]; int newPieces[2][3]; int newScore[4];
+			simulateMove( moves[first+i], grid, pieces, score, player, newGrid,
+				newPieces, newScore, &leafPlayer[i], eval, &leafEval[i] );
+
+			// Use the exact utility of positions proven by the solver,
+			// then the cached utility of the position
+			known[i] = m_solverActive && getProvenUtility( getStateKey( &leafEval[i] ), &leafUtility[i] );
+			if( PROFILE && !known[i] ) m_leavesSearched++;
+			if( !known[i] && EVAL_CACHE ) { if( PROFILE ) m_cacheProbes++;
+				known[i] = m_evalCache.probe( getPositionKey( &leafEval[i] ), m_evalFunction, &leafUtility[i] );
+				if( PROFILE && known[i] ) m_cacheHits++; }
+			if( !known[i] ) ticket[i] = EvalService::submit( &leafEval[i].network, leafPlayer[i] );
+
+			// Check the accumulator against a full recompute
+			ASSERT( fabs( Heuristic::evalNetworkState( &leafEval[i], leafPlayer[i] ) -
+				Heuristic::network( newGrid, newPieces, newScore, leafPlayer[i] ) ) < 1e-3f );
+		}
+
+		// Get the current time
+		LARGE_INTEGER temp; __int64 startTime;
+		if( PROFILE ) { QueryPerformanceCounter( &temp );
+					  startTime = temp.QuadPart; }
+
+		// Take the results in move order, collecting those after a cut-off
+		for( int i = 0; i < nLeaves; i++ )
+		{
+			if( !known[i] ) {
+				leafUtility[i] = EvalService::wait( ticket[i] );
+				ASSERT( leafUtility[i] == Heuristic::evalNetworkState( &leafEval[i], leafPlayer[i] ) );
+				if( EVAL_CACHE ) m_evalCache.store( getPositionKey( &leafEval[i] ), m_evalFunction, leafUtility[i] ); }
+			if( cutoff ) continue;
+
+			// Update alpha-beta bounds
+			if( player == PLAYER_MAX ) {
+				if( leafUtility[i] > alpha ) alpha = leafUtility[i]; }
+			else if( leafUtility[i] < beta ) beta = leafUtility[i];
+
+			// Check for alpha-beta cut-off, counting those made by the first move
+			if( beta <= alpha ) { if( PROFILE ) { m_cutoffNodes++;
+				if( first+i == 0 ) m_firstMoveCutoffs++; } cutoff = true; }
+		}
+
+		// Increment function runtime costs
+		if( PROFILE ) { QueryPerformanceCounter( &temp );
+			m_timeCosts[tEvaluateBoards] += temp.QuadPart - startTime; } 
 	}
 
 	// Return the appropriate utility bound
@@ -767,7 +1100,8 @@ bool Minimax::isValidMove( Move &move, short grid[][14], int player )
 //	the resulting game states in the output.
 // --------------------------------------------------------
 void Minimax::simulateMove( Move &move, short grid[][14], int pieces[][3], int score[], int player,
-	short gridOut[][14], int piecesOut[][3], int scoreOut[], int* playerOut )
+	short gridOut[][14], int piecesOut[][3], int scoreOut[], int* playerOut, 
+	const EvalState* evalIn, EvalState* evalOut )
 {
 	// Get the current time
 	LARGE_INTEGER temp; __int64 startTime;
@@ -848,12 +1182,68 @@ void Minimax::simulateMove( Move &move, short grid[][14], int pieces[][3], int s
 	// Switch player to move
 	*playerOut = 1 - player;
 
+	// Update the evaluation state over the rows the piece pattern covers
+	if( evalIn ) {
+		int rows = ( move.rotated == PIECE_ROTATE_0 || move.rotated == PIECE_ROTATE_180 ) ? x : y;
+		int cols = x+y-rows;
+		int minX = max( move.gridX, 0 ), maxX = min( move.gridX+rows-1, m_boardSize-1 );
+		int minY = max( move.gridY, 0 ), maxY = min( move.gridY+cols-1, m_boardSize-1 );
+
+		// Find the newly covered tiles, at most 5 tiles
+		int added[5][2], nAdded = 0;
+		for( int i = minX; i <= maxX; i++ )
+		for( int j = minY; j <= maxY; j++ )
+			if( !(grid[i][j]&0x3) && (gridOut[i][j]&0x3) ) {
+				added[nAdded][0] = i; added[nAdded][1] = j; nAdded++; }
+
+		// Add the newly covered tiles to the network accumulator and
+		// remove the placed piece
+		if( m_evalFunction == Heuristic::networkFunction ) {
+			int features[5];
+			for( int t = 0; t < nAdded; t++ )
+				features[t] = Nnue::cellFeature( added[t][0], added[t][1], player );
+			Heuristic::updateNetworkState( evalIn, evalOut, features, nAdded,
+				Nnue::pieceFeature( move.pieceNumber, player ) ); }
+		else Heuristic::updateEvalState( gridOut, evalIn, evalOut, minX, maxX );
+
+		// Update the keys of the position and of its reflection
+		unsigned __int64 moveKey = Zobrist::getPieceKey( move.pieceNumber, player ) ^ Zobrist::getPlayerKey( );
+		evalOut->key[0] = evalIn->key[0] ^ moveKey; evalOut->key[1] = evalIn->key[1] ^ moveKey;
+		for( int t = 0; t < nAdded; t++ ) {
+			evalOut->key[0] ^= Zobrist::getTileKey( added[t][0], added[t][1], player );
+			evalOut->key[1] ^= Zobrist::getTileKey( added[t][1], added[t][0], player ); } }
+
 	// Get the current time
 	if( PROFILE ) { QueryPerformanceCounter( &temp );
 		m_timeCosts[tSimulateMoves] += temp.QuadPart - startTime; } 
 }
 //
 // --------------------------------------------------------
+//	Builds the evaluation state of a root position when the
+//  selected evaluation function is updated incrementally.
+//  Returns NULL if the leaves are evaluated from scratch.
+// --------------------------------------------------------
+EvalState* Minimax::getRootEvalState( short grid[][14], int pieces[][3], int player, EvalState* state )
+{
+	if( !INCREMENTAL_EVAL ) return NULL;
+
+	if( m_evalFunction == Heuristic::networkFunction )
+		Heuristic::initNetworkState( grid, pieces, state );
+	else if( m_evalFunction == Heuristic::incrementalFunction )
+		Heuristic::initEvalState( grid, state );
+	else return NULL;
+
+	// Key the position and its reflection, the search updates
+	// both keys with each move
+	int masks[2];
+	for( int p = 0; p < 2; p++ )
+		masks[p] = pieces[p][0] | (pieces[p][1]<<8) | (pieces[p][2]<<16);
+	Symmetry::getKeys( grid, masks, player, state->key );
+
+	return state;
+}
+//
+// --------------------------------------------------------
 //  Applies a piece pattern to the grid at the specified
 //  piece and grid coordinates.
 // --------------------------------------------------------
@@ -956,6 +1346,397 @@ bool Minimax::isMoveAvailable( short grid[][14], int pieces[][3], int player )
 }
 //
 // --------------------------------------------------------
+//	Starts the endgame solver thread on the specified game
+//  state. The solver runs alongside the heuristic search 
+//  until it proves a result or its time limit expires.
+// --------------------------------------------------------
+void Minimax::startSolver( short grid[][14], int pieces[][3], int score[], int player )
+{
+	// Wait for any previous solver thread to exit
+	m_solverStop = TRUE;
+	while( m_solverRunning ) Sleep( 5 );
+
+	// Copy the root game state
+	for( int i = 0; i < m_boardSize; i++ )
+	for( int j = 0; j < m_boardSize; j++ )
+		m_solverState.grid[i][j] = grid[i][j];
+	for( int i = 0; i < 2; i++ )
+	for( int j = 0; j < 3; j++ )
+		m_solverState.pieces[i][j] = pieces[i][j];
+	for( int i = 0; i < 4; i++ ) m_solverState.score[i] = score[i];
+	m_solverState.player = player;
+
+	// Reset solver status
+	m_solverResult = rUnknown; m_solverNodes = 0;
+	m_solverStop = FALSE; m_solverRunning = TRUE;
+	m_solverActive = TRUE;
+
+	// Begin the solver thread
+	if( _beginthread( &solverThread, SOLVER_STACK, NULL ) == -1 )
+	{ std::cout << "Failed to create thread"; system("pause"); exit(1); }
+}
+//
+// --------------------------------------------------------
+//	Waits for the endgame solver to exit and replaces the
+//  move with a proven one if the solver has proven a win
+//  or draw for the player to move. Returns true if the 
+//  move was replaced.
+// --------------------------------------------------------
+bool Minimax::getSolverMove( Move* move )
+{
+	// Wait for the solver thread to exit
+	while( m_solverRunning ) Sleep( 5 );
+
+	// Display the solver result
+	const char* resultName[] = { "Unknown", "Win", "Draw", "Loss" };
+	std::cout << "Endgame Solver: " << resultName[m_solverResult] 
+			  << " (" << m_solverNodes << " nodes)\n";
+
+	// Only proven wins and draws are worth forcing
+	if( m_solverResult != rWin && m_solverResult != rDraw ) return false;
+
+	// The favorable target value for the player to move
+	SolverState* state = &m_solverState;
+	bool favorable = ( state->player == PLAYER_MAX );
+
+	// Get available moves list
+	Move moves[1200]; int nMoves = 
+		getMoveList( moves, state->grid, state->pieces, state->player );
+
+	// Find a move which leads to the proven result
+	for( int i = 0; i < nMoves; i++ )
+	{
+		// Simulate the move to find the child state
+		short newGrid[14][14]; int newPieces[2][3]; int newScore[4]; int newPlayer;
+		simulateMove( moves[i], state->grid, state->pieces, state->score, state->player, 
+			newGrid, newPieces, newScore, &newPlayer );
+
+		// Check the child for a favorable proof
+		unsigned int pn, dn; unsigned __int64 key = getStateKey( newGrid, newPieces, newPlayer );
+		if( !probeSolverTable( key, m_solverTarget, &pn, &dn ) ) continue;
+		if( ( favorable && pn == 0 ) || ( !favorable && dn == 0 ) ) {
+			*move = moves[i]; return true; }
+	}
+
+	// The root was proven by its score bounds alone
+	return false;
+}
+//
+// --------------------------------------------------------
+//	Starting address of the solver thread. Attempts to
+//  prove a win for the player to move, and if the win is
+//  disproven, attempts to prove a draw. The targets are 
+//  thresholds on the final score margin of PLAYER_MAX.
+// --------------------------------------------------------
+void Minimax::solverThread( void* data )
+{
+	// Start the solver timer
+	m_solverTimer.start( ); m_solverTimer.update( );
+	m_solverStart = m_solverTimer.getRunningTime( );
+
+	// Get the targets for the player to move
+	int player = m_solverState.player;
+	int winTarget  = (player == PLAYER_MAX) ? 1 : 0;
+	int drawTarget = 1 - winTarget;
+	int favorable  = (player == PLAYER_MAX) ? TRUE : FALSE;
+
+	// Attempt to prove a win
+	int winProof = solveTarget( winTarget );
+	if( winProof == favorable ) { 
+		m_solverResult = rWin; m_solverTarget = winTarget; }
+
+	// Attempt to prove a draw
+	else if( winProof != -1 ) 
+	{
+		int drawProof = solveTarget( drawTarget );
+		if( drawProof == favorable ) {
+			m_solverResult = rDraw; m_solverTarget = drawTarget; }
+		else if( drawProof != -1 ) m_solverResult = rLoss;
+	}
+
+	// Mark the thread done
+	m_solverRunning = FALSE;
+}
+//
+// --------------------------------------------------------
+//	Runs a depth-first proof-number search of the solver
+//  root for the specified target. Returns 1 if the final
+//  score margin of PLAYER_MAX is proven to reach the 
+//  target, 0 if it is proven not to, or -1 if the solver
+//  ran out of time.
+// --------------------------------------------------------
+int Minimax::solveTarget( int target )
+{
+	SolverState* state = &m_solverState;
+
+	// Search from the root with infinite thresholds
+	solveNode( state->grid, state->pieces, state->score, 
+		state->player, target, PN_INFINITY, PN_INFINITY );
+
+	// Get the root result from the table
+	unsigned int pn, dn; 
+	unsigned __int64 key = getStateKey( state->grid, state->pieces, state->player );
+	if( !probeSolverTable( key, target, &pn, &dn ) ) return -1;
+	if( pn == 0 ) return 1;
+	if( dn == 0 ) return 0;
+	return -1;
+}
+//
+// --------------------------------------------------------
+//	Performs a multiple iterative deepening step of the
+//  depth-first proof-number search. Nodes where PLAYER_MAX
+//  moves are OR nodes and the remainder are AND nodes. The
+//  phi and delta values are the proof and disproof number 
+//  from the perspective of the player to move. The node
+//  is searched until either value reaches its threshold, 
+//  and the result is stored in the solver table.
+// --------------------------------------------------------
+void Minimax::solveNode( short grid[][14], int pieces[][3], int score[], int player,
+						 int target, unsigned int thPhi, unsigned int thDelta )
+{
+	// Check for solver time out
+	if( m_solverStop ) return;
+	if( (++m_solverNodes & 0x3FF) == 0 ) { m_solverTimer.update( );
+		if( m_solverTimer.getRunningTime( ) - m_solverStart > SOLVER_TIME ) { m_solverStop = TRUE; return; } }
+
+	// Check the table for a proof or exceeded thresholds
+	bool orNode = ( player == PLAYER_MAX ); unsigned int pn = 1, dn = 1; 
+	unsigned __int64 key = getStateKey( grid, pieces, player );
+	probeSolverTable( key, target, &pn, &dn );
+	if( ( orNode ? pn : dn ) >= thPhi || ( orNode ? dn : pn ) >= thDelta ) return;
+
+	// Enumerate available moves
+	Move moves[1200]; int nMoves = 
+		getMoveList( moves, grid, pieces, player );
+
+	// Bound the final score margin, a player who is unable to
+	// move will never be able to move again
+	int margin = score[PLAYER_MAX] - score[PLAYER_MIN];
+	int canMoveMax = ( player == PLAYER_MAX ) ? nMoves > 0 : isMoveAvailable( grid, pieces, PLAYER_MAX );
+	int canMoveMin = ( player == PLAYER_MIN ) ? nMoves > 0 : isMoveAvailable( grid, pieces, PLAYER_MIN );
+	int maxMargin = margin + ( canMoveMax ? getPieceValue( pieces, PLAYER_MAX ) : 0 );
+	int minMargin = margin - ( canMoveMin ? getPieceValue( pieces, PLAYER_MIN ) : 0 );
+
+	// Check for a target decided by the score bounds
+	if( minMargin >= target ) { storeSolverTable( key, target, 0, PN_INFINITY ); return; }
+	if( maxMargin <  target ) { storeSolverTable( key, target, PN_INFINITY, 0 ); return; }
+
+	// Get the child keys, discarding transposed and mirrored moves
+	std::vector< std::pair<unsigned __int64,int> > children;
+	if( nMoves == 0 ) children.push_back( std::make_pair( getStateKey( grid, pieces, 1-player ), -1 ) );
+	for( int i = 0; i < nMoves; i++ ) {
+		short newGrid[14][14]; int newPieces[2][3]; int newScore[4]; int newPlayer;
+		simulateMove( moves[i], grid, pieces, score, player, newGrid, newPieces, newScore, &newPlayer );
+		children.push_back( std::make_pair( getStateKey( newGrid, newPieces, newPlayer ), i ) ); }
+	std::sort( children.begin( ), children.end( ) ); int nChildren = 0;
+	for( unsigned int i = 0; i < children.size( ); i++ )
+		if( i == 0 || children[i].first != children[nChildren-1].first )
+			children[nChildren++] = children[i];
+
+	// Search the most proving child until a threshold is reached
+	unsigned int phi, delta;
+	while( TRUE )
+	{
+		// Compute the node values from the children
+		unsigned int bestPhi = 0, secondDelta = PN_INFINITY; int best = 0; 
+		phi = PN_INFINITY; delta = 0;
+		for( int i = 0; i < nChildren; i++ )
+		{
+			// Get the child values, unknown children are (1,1)
+			unsigned int cpn = 1, cdn = 1;
+			probeSolverTable( children[i].first, target, &cpn, &cdn );
+			unsigned int cPhi   = orNode ? cdn : cpn;
+			unsigned int cDelta = orNode ? cpn : cdn;
+
+			// Sum the child phi values
+			delta = min( delta + cPhi, (unsigned int)PN_INFINITY );
+
+			// Find the child with the least delta value
+			if( cDelta < phi ) { secondDelta = phi; phi = cDelta; best = i; bestPhi = cPhi; }
+			else if( cDelta < secondDelta ) secondDelta = cDelta;
+		}
+
+		// Check the thresholds
+		if( phi >= thPhi || delta >= thDelta || m_solverStop ) break;
+
+		// Compute the child thresholds
+		unsigned int childThPhi = (unsigned int)min( (__int64)thDelta + bestPhi - delta, (__int64)PN_INFINITY );
+		unsigned int childThDelta = min( thPhi, secondDelta+1 );
+
+		// Search the selected child
+		if( children[best].second < 0 ) solveNode( grid, pieces, score, 1-player, target, childThPhi, childThDelta ); 
+		else {
+			short newGrid[14][14]; int newPieces[2][3]; int newScore[4]; int newPlayer;
+			simulateMove( moves[children[best].second], grid, pieces, score, player, 
+				newGrid, newPieces, newScore, &newPlayer );
+			rebuildGrid( newGrid );
+			solveNode( newGrid, newPieces, newScore, newPlayer, target, childThPhi, childThDelta ); }
+	}
+
+	// Store the node values
+	storeSolverTable( key, target, orNode ? phi : delta, orNode ? delta : phi );
+}
+//
+// --------------------------------------------------------
+//	Rebuilds the liberty and safety data of an extended
+//  format grid from its covered tiles. The liberties made
+//  by simulateMove are not rotated with the piece, which
+//  hides many moves from getMoveList, so the solver must
+//  rebuild its grids to consider every available move.
+// --------------------------------------------------------
+void Minimax::rebuildGrid( short grid[][14] )
+{
+	for( int i = 0; i < m_boardSize; i++ )
+	for( int j = 0; j < m_boardSize; j++ )
+	{
+		// Skip covered tiles
+		if( grid[i][j] & 0x3 ) continue;
+		short tile = 0;
+
+		// Check for starting liberty
+		bool isStart = false;
+		for( int k = 0; k < m_nPlayers; k++ )
+		if( i == m_startTile[k][0] && j == m_startTile[k][1] ) {
+			if( k == 0 ) tile = (k+1)<<EX_GRID_LBTY_LR;
+			if( k == 1 ) tile = (k+1)<<EX_GRID_LBTY_UL;
+			isStart = true; }
+		if( isStart ) { grid[i][j] = tile; continue; }
+
+		// Check for adjacent covered tiles
+		if( j<m_boardSize-1 ) tile |= (grid[i][j+1]&0x3)<<EX_GRID_NOT_SAFE;
+		if( i<m_boardSize-1 ) tile |= (grid[i+1][j]&0x3)<<EX_GRID_NOT_SAFE;
+		if( j>0 ) tile |= (grid[i][j-1]&0x3)<<EX_GRID_NOT_SAFE;
+		if( i>0 ) tile |= (grid[i-1][j]&0x3)<<EX_GRID_NOT_SAFE;
+
+		// Check if this tile is a liberty for any players
+		if( i>0 && j<m_boardSize-1 && (grid[i-1][j+1]&0x3) && !(tile&((grid[i-1][j+1]&0x3)<<EX_GRID_NOT_SAFE)) )
+			tile |= (grid[i-1][j+1]&0x3) << EX_GRID_LBTY_UR;
+		if( i<m_boardSize-1 && j<m_boardSize-1 && (grid[i+1][j+1]&0x3) && !(tile&((grid[i+1][j+1]&0x3)<<EX_GRID_NOT_SAFE)) )
+			tile |= (grid[i+1][j+1]&0x3) << EX_GRID_LBTY_UL;
+		if( i<m_boardSize-1 && j>0 && (grid[i+1][j-1]&0x3) && !(tile&((grid[i+1][j-1]&0x3)<<EX_GRID_NOT_SAFE)) )
+			tile |= (grid[i+1][j-1]&0x3) << EX_GRID_LBTY_LL;
+		if( i>0 && j>0 && (grid[i-1][j-1]&0x3) && !(tile&((grid[i-1][j-1]&0x3)<<EX_GRID_NOT_SAFE)) )
+			tile |= (grid[i-1][j-1]&0x3) << EX_GRID_LBTY_LR;
+
+		grid[i][j] = tile;
+	}
+}
+//
+// --------------------------------------------------------
+//	Computes the canonical Zobrist key of a game state, so
+//  that mirrored states share their table entries.
+// --------------------------------------------------------
+unsigned __int64 Minimax::getStateKey( short grid[][14], int pieces[][3], int player )
+{
+	// Convert the packed piece bytes to piece masks
+	int masks[2];
+	for( int p = 0; p < 2; p++ )
+		masks[p] = pieces[p][0] | (pieces[p][1]<<8) | (pieces[p][2]<<16);
+
+	return Symmetry::getCanonicalKey( grid, masks, player );
+}
+//
+// --------------------------------------------------------
+//	Computes the Zobrist key of a game state itself, which
+//  keys the evaluation cache. Mirrored states only share
+//  their value when it is exact, so the cache can not use
+//  the canonical key.
+// --------------------------------------------------------
+unsigned __int64 Minimax::getPositionKey( short grid[][14], int pieces[][3], int player )
+{
+	// Convert the packed piece bytes to piece masks
+	int masks[2];
+	for( int p = 0; p < 2; p++ )
+		masks[p] = pieces[p][0] | (pieces[p][1]<<8) | (pieces[p][2]<<16);
+
+	return Zobrist::getKey( grid, masks, player );
+}
+//
+// --------------------------------------------------------
+//	Retrieves the proof and disproof numbers of a position
+//  for the specified target from the solver table. The
+//  table is read without locks, entries written while
+//  being read fail the key check. Returns true if found.
+// --------------------------------------------------------
+bool Minimax::probeSolverTable( unsigned __int64 key, int target, unsigned int* pn, unsigned int* dn )
+{
+	// Read the entry data
+	SolverEntry* entry = m_solverTable[target] + (key & (SOLVER_TABLE-1));
+	unsigned __int64 data  = entry->data;
+	unsigned __int64 check = entry->check;
+
+	// Verify the entry key
+	if( (check^data) != key ) return false;
+
+	// Unpack the proof numbers
+	*pn = (unsigned int)(data >> 32);
+	*dn = (unsigned int)(data & 0xFFFFFFFF);
+	return true;
+}
+//
+// --------------------------------------------------------
+//	Stores the proof and disproof numbers of a position for
+//  the specified target in the solver table. Proven entries
+//  are only replaced by other proven entries.
+// --------------------------------------------------------
+void Minimax::storeSolverTable( unsigned __int64 key, int target, unsigned int pn, unsigned int dn )
+{
+	// Get the entry for the key
+	SolverEntry* entry = m_solverTable[target] + (key & (SOLVER_TABLE-1));
+
+	// Keep the proofs of other positions
+	unsigned __int64 data = entry->data;
+	bool isOther  = ( entry->check^data ) != key && entry->check != 0;
+	bool isProven = ( data>>32 ) == 0 || ( data&0xFFFFFFFF ) == 0;
+	if( isOther && isProven && pn != 0 && dn != 0 ) return;
+
+	// Write the entry
+	data = ((unsigned __int64)pn << 32) | dn;
+	entry->check = key^data;
+	entry->data = data;
+}
+//
+// --------------------------------------------------------
+//	Looks up a position by its state key in the solver
+//  tables. Returns true and the exact utility of the
+//  position if it has been proven a win, loss, or draw.
+// --------------------------------------------------------
+bool Minimax::getProvenUtility( unsigned __int64 key, float* utility )
+{
+	unsigned int pn, dn; 
+
+	// Check for a proven win or loss for PLAYER_MAX
+	bool noWin = false;
+	if( probeSolverTable( key, 1, &pn, &dn ) ) {
+		if( pn == 0 ) { *utility = FLT_MAX; return true; }
+		noWin = ( dn == 0 ); }
+	if( probeSolverTable( key, 0, &pn, &dn ) ) {
+		if( dn == 0 ) { *utility = -FLT_MAX; return true; }
+		if( pn == 0 && noWin ) { *utility = 0.0f; return true; } }
+
+	return false;
+}
+//
+// --------------------------------------------------------
+//	Returns the score value of a players remaining pieces.
+// --------------------------------------------------------
+int Minimax::getPieceValue( int pieces[][3], int player )
+{
+	int value = 0;
+	for( int p = 0; p < 21; p++ )
+	if( pieces[player][p/8] & (1<<(p%8)) )
+	{
+			 if( p > 8 ) value += 5;
+		else if( p > 3 ) value += 4;
+		else if( p > 1 ) value += 3;
+		else if( p > 0 ) value += 2;
+		else value += 1;
+	}
+
+	return value;
+}
+//
+// --------------------------------------------------------
 //	Initializes the piece information structures.
 // --------------------------------------------------------
 void Minimax::loadPieceConfigs( )
@@ -1064,6 +1845,15 @@ void Minimax::displayProfilerResults( float searchTime, int maxSearchDepth )
 	std::cout << searchTime << "s at Ply " << maxSearchDepth << "\n";
 	std::cout << "Searched Nodes: " << m_nodesSearched << "\n";
 	std::cout << "Searched Leafs: " << m_leavesSearched << "\n";
+	if( EVAL_CACHE ) std::cout << "Eval Cache Hits: " << m_cacheHits << "/" << m_cacheProbes 
+		<< " (" << (int)(100.0*(double)m_cacheHits/(double)max(m_cacheProbes,1u) + 0.5) << "%)\n";
+	std::cout << "First Move Cutoffs: " << m_firstMoveCutoffs << "/" << m_cutoffNodes 
+		<< " (" << (int)(100.0*(double)m_firstMoveCutoffs/(double)max(m_cutoffNodes,1u) + 0.5) << "%)\n";
+	if( EvalService::isRunning( ) ) { EvalServiceStats stats; EvalService::getStats( &stats );
+		std::cout << "Eval Service Batches: " << stats.nBatches << ", " << stats.meanBatch
+			<< " leaves (" << (int)(stats.batchFill + 0.5f) << "% full)\n";
+		std::cout << "Eval Service Latency: " << stats.meanLatency << "us mean, "
+			<< stats.maxLatency << "us max\n"; }
 	std::cout << "Total Time " << (int)(100.0*(double)m_timeCosts[tTotal] 
 		/ (double)m_timeCosts[tTotal] + 0.5) << "%\n";
 	std::cout << "  - Reformat Board: " << (int)(100.0*(double)m_timeCosts[tReformatBoard] 
@@ -1072,6 +1862,8 @@ void Minimax::displayProfilerResults( float searchTime, int maxSearchDepth )
 		/ (double)m_timeCosts[tTotal] + 0.5) << "%\n";
 	std::cout << "      Move Enumeration: " << (int)(100.0*(double)m_timeCosts[tEnumerateMoves] 
 		/ (double)m_timeCosts[tTotal] + 0.5) << "%\n";
+	std::cout << "      Move Ordering: " << (int)(100.0*(double)m_timeCosts[tOrderMoves] 
+		/ (double)m_timeCosts[tTotal] + 0.5) << "%\n";
 	std::cout << "        - Move Validation(shared): " << (int)(100.0*(double)m_timeCosts[tMoveValidation] 
 		/ (double)m_timeCosts[tTotal] + 0.5) << "%\n";
 	std::cout << "      Board Evaluation: " << (int)(100.0*(double)m_timeCosts[tEvaluateBoards] 
@@ -1085,6 +1877,72 @@ void Minimax::displayProfilerResults( float searchTime, int maxSearchDepth )
 }
 //
 // --------------------------------------------------------
+//	Compares the speed of fixed depth searches with the
+//  search kernel against searches which evaluate through
+//  the function table, as the search did before kernels.
+//  A spread of the states reached by the available moves
+//  is searched both ways, so each search runs the move
+//  generation and simulation of the real search over
+//  different leaves. The searches keep no incremental
+//  state, so both evaluate each leaf in full.
+// --------------------------------------------------------
+void Minimax::benchmarkKernel( short grid[][14], int pieces[][3], int score[], int player )
+{
+	// Get available moves list
+	Move moves[1200]; int nMoves = 
+		getMoveList( moves, grid, pieces, player );
+
+	// Time the searches of the resulting states
+	__int64 direct = 0, indirect = 0; int nSearches = 0;
+	unsigned int leaves = m_leavesSearched;
+	int step = max( nMoves / BENCHMARK_POSITIONS, 1 );
+	for( int i = 0; i < nMoves; i += step, nSearches++ )
+	{
+		short newGrid[14][14]; int newPieces[2][3]; int newScore[4]; int newPlayer;
+		simulateMove( moves[i], grid, pieces, score, player, 
+			newGrid, newPieces, newScore, &newPlayer );
+		float directUtility, indirectUtility;
+		direct += benchmarkSearch( m_minimax, newGrid, newPieces, newScore, newPlayer, &directUtility );
+		indirect += benchmarkSearch( &minimax<evaluateIndirect>, newGrid, newPieces, newScore, newPlayer, &indirectUtility );
+		if( m_evalFunction ) ASSERT( directUtility == indirectUtility );
+	}
+	leaves = ( m_leavesSearched - leaves ) / 2;
+
+	// Display search throughput
+	LARGE_INTEGER frequency; QueryPerformanceFrequency( &frequency );
+	double searches = (double)nSearches * (double)frequency.QuadPart;
+	std::cout << "\n-- Search Kernel Benchmark --\n";
+	std::cout << "Positions: " << nSearches << " at Depth " << BENCHMARK_DEPTH << "\n";
+	std::cout << "Kernel Searches/s: " << (int)(searches / (double)max(direct,1LL)) << "\n";
+	std::cout << "Indirect Searches/s: " << (int)(searches / (double)max(indirect,1LL)) << "\n";
+	if( PROFILE && nSearches ) std::cout << "Leafs per Search: " << leaves / nSearches << "\n";
+}
+//
+// --------------------------------------------------------
+//	Searches a board position to the benchmark depth with
+//  the given kernel and returns the elapsed performance
+//  counts. The cache is cleared first so that every
+//  search evaluates the same leaves.
+// --------------------------------------------------------
+__int64 Minimax::benchmarkSearch( SearchKernel kernel, short grid[][14], int pieces[][3], 
+								  int score[], int player, float* utility )
+{
+	if( EVAL_CACHE ) m_evalCache.clear( );
+	LARGE_INTEGER temp; QueryPerformanceCounter( &temp ); __int64 startTime = temp.QuadPart;
+	*utility = kernel( grid, pieces, score, player, BENCHMARK_DEPTH, -FLT_MAX, FLT_MAX, NULL );
+	QueryPerformanceCounter( &temp ); return temp.QuadPart - startTime;
+}
+//
+// --------------------------------------------------------
+//	Evaluates a board position with the selected function
+//  through the function table.
+// --------------------------------------------------------
+float Minimax::evaluateIndirect( short grid[][14], int pieces[][3], int score[], int player )
+{
+	return Heuristic::evalFunction[m_evalFunction]( grid, pieces, score, player );
+}
+//
+// --------------------------------------------------------
 //	Outputs the specified game state to the console. Very
 //  useful for debugging purposes. :TODO: Make thread safe
 // --------------------------------------------------------
@@ -39,13 +39,21 @@ public:
 	Move makeMove( char grid[][20], bool pieces[][21], int score[], int player, std::vector<Move>& moveHistory );
 
 	// Shutdown AI player
-	void shutdown( ) { }
+	void shutdown( );
+
+	// Search utility of the last move for PLAYER_MAX, false for book moves
+	bool getMoveUtility( float* utility ) { *utility = m_moveUtility; return m_moveSearched; }
 
 private:
 	// Multi-threading game state structure
 	struct MtGameState { short grid[14][14]; int pieces[2][3]; int score[2]; int player; 
 						 int completed; float utility; int depth; float alpha; float beta; 
-						 int moveIndex; };
+						 int moveIndex; EvalState evalState; EvalState* eval; };
+
+	// Endgame solver state and table structures, table entries store the
+	// position key xor the data so that torn entries fail the key check
+	struct SolverState { short grid[14][14]; int pieces[2][3]; int score[4]; int player; };
+	struct SolverEntry { unsigned __int64 check; unsigned __int64 data; };
 
 	// Piece layout structures
 	struct Piece { int sizeX, sizeY; int rot; int flip; char layout[7][6]; };
@@ -64,20 +72,66 @@ private:
 	// Threaded move selection function
 	static void getMinimaxUtility( void* dataOut );
 
+	// Search kernel format, a minimax function specialized for one evaluation function
+	typedef float (*SearchKernel)( short (*__restrict grid)[14], int (*__restrict pieces)[3], int (*__restrict score), int player,
+		int depth, float alpha, float beta, const EvalState* eval );
+
 	// Minimax function
+	template<EvalFunction evaluate>
 	static float minimax( short (*__restrict grid)[14], int (*__restrict pieces)[3], int (*__restrict score), int player,
-		int depth, float alpha, float beta );
+		int depth, float alpha, float beta, const EvalState* eval = NULL );
+
+	// Cached board evaluation function
+	template<EvalFunction evaluate>
+	__forceinline static float getUtility( short (*__restrict grid)[14], int (*__restrict pieces)[3], int (*__restrict score), int player,
+		const EvalState* eval = NULL );
+
+	// Search benchmark of the search kernel against the function table
+	static __int64 benchmarkSearch( SearchKernel kernel, short grid[][14], int pieces[][3],
+		int score[], int player, float* utility );
+	static float evaluateIndirect( short grid[][14], int pieces[][3], int score[], int player );
+	static void benchmarkKernel( short grid[][14], int pieces[][3], int score[], int player );
 
 	// Move enumeration functions
 	__forceinline static int getMoveList( Move* __restrict moves, short (*__restrict grid)[14], int (*__restrict pieces)[3], int player );
 	__forceinline static bool isValidMove( Move &move, short (*__restrict grid)[14], int player ); 
 	__forceinline static int getMoveList_5pieces( Move* __restrict moves, short (*__restrict grid)[14], int (*__restrict pieces)[3], int player );
 
+	// Policy move ordering function
+	static void orderMoves( Move moves[], int nMoves, short grid[][14], int pieces[][3], int player );
+
+	// Evaluation cache key functions
+	static unsigned __int64 getPositionKey( short grid[][14], int pieces[][3], int player );
+	static unsigned __int64 getPositionKey( const EvalState* eval ) { return eval->key[0]; }
+
+	// Last ply search through the evaluation service
+	static float searchLeafBatch( Move moves[], int nMoves, short grid[][14], int pieces[][3],
+		int score[], int player, float alpha, float beta, const EvalState* eval );
+
 	// Move simulation function
 	__forceinline static bool isMoveAvailable( short (*__restrict grid)[14], int (*__restrict pieces)[3], int player );
 	__forceinline static void applyPiecePattern( Move move, short (*__restrict grid)[14], int playerBit, int i, int j, int gx, int gy );
 	__forceinline static void simulateMove( Move &move, short (*__restrict grid)[14], int (*__restrict pieces)[3], int (*__restrict score), int player,
-		short (*__restrict gridOut)[14], int (*__restrict piecesOut)[3], int (*__restrict scoreOut), int* __restrict playerOut );
+		short (*__restrict gridOut)[14], int (*__restrict piecesOut)[3], int (*__restrict scoreOut), int* __restrict playerOut,
+		const EvalState* evalIn = NULL, EvalState* evalOut = NULL );
+	__forceinline static EvalState* getRootEvalState( short (*__restrict grid)[14], int (*__restrict pieces)[3], int player, EvalState* state );
+
+	// Endgame proof-number solver functions
+	static void startSolver( short grid[][14], int pieces[][3], int score[], int player );
+	static bool getSolverMove( Move* move );
+	static void solverThread( void* data );
+	static int solveTarget( int target );
+	static void solveNode( short grid[][14], int pieces[][3], int score[], int player,
+		int target, unsigned int thPhi, unsigned int thDelta );
+
+	// Endgame solver table functions
+	static void rebuildGrid( short grid[][14] );
+	static unsigned __int64 getStateKey( short grid[][14], int pieces[][3], int player );
+	static unsigned __int64 getStateKey( const EvalState* eval ) { return min( eval->key[0], eval->key[1] ); }
+	static bool probeSolverTable( unsigned __int64 key, int target, unsigned int* pn, unsigned int* dn );
+	static void storeSolverTable( unsigned __int64 key, int target, unsigned int pn, unsigned int dn );
+	static bool getProvenUtility( unsigned __int64 key, float* utility );
+	__forceinline static int getPieceValue( int pieces[][3], int player );
 
 	// Debugging helper functions 
 	static void displayState( short grid[][14], int pieces[][3], int score[], int player );
@@ -86,10 +140,19 @@ private:
 	// Profiler data members
 	static unsigned int m_leavesSearched;
 	static unsigned int m_nodesSearched;
+	static unsigned int m_cacheProbes;
+	static unsigned int m_cacheHits;
+	static unsigned int m_cutoffNodes;
+	static unsigned int m_firstMoveCutoffs;
 	static __int64 m_timeCosts[10];
 
-	// Minimax evaluation function
+	// Evaluation cache
+	static EvalCache m_evalCache;
+
+	// Minimax evaluation function and its search kernel
 	static int m_evalFunction;
+	static SearchKernel m_minimax;
+	static const SearchKernel m_searchKernel[];
 
 	// Game piece layout patterns
 	static std::vector<Liberty> m_pieceLiberties[21];
@@ -104,6 +167,22 @@ private:
 
 	// Opening book
 	static OpeningBook m_book;
+
+	// Search utility of the last move
+	static float m_moveUtility;
+	static bool m_moveSearched;
+
+	// Endgame solver data
+	static SolverEntry* m_solverTable[2];
+	static SolverState m_solverState;
+	static Timer m_solverTimer;
+	static float m_solverStart;
+	static volatile int m_solverRunning;
+	static volatile int m_solverStop;
+	static int m_solverActive;
+	static int m_solverResult;
+	static int m_solverTarget;
+	static unsigned int m_solverNodes;
 };
 
 // End definition
@@ -0,0 +1,91 @@
+/* ===========================================================================
+
+	Project: Monte AI for Blokus
+
+	Description:
+	 Search parameters read from the config file at startup, with their
+	 bounds.
+
+    Copyright (C) 2011 Lucas Sherman
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Standard Includes
+#include "Includes.h"
+
+// Include header
+#include "Config.h"
+
+// Engine parameter defaults
+float Config::engine[nEngineParameters] = {
+	0.5f,			// Exploration constant of the UCT formula
+	1.5f,			// Exploration constant of the PUCT formula
+	2.0f, 1.0f,		// Eligible children of an unvisited node and their growth factor
+	0.5f,			// Growth exponent of the eligible child count
+	1.0f			// Weight of board centrality in the move prior
+};
+
+// Parameter count
+const int Config::nParameters = nEngineParameters;
+
+// Parameter names and bounds
+const Config::Parameter Config::parameter[nParameters] = {
+	{ "UCT_Constant",		 &engine[pUctConstant],		   0,     10.0f },
+	{ "PUCT_Constant",		 &engine[pPuctConstant],	   0,     10.0f },
+	{ "Widen_Base",			 &engine[pWidenBase],		   1,    100.0f },
+	{ "Widen_Scale",		 &engine[pWidenScale],		   0,    100.0f },
+	{ "Widen_Exponent",		 &engine[pWidenExp],		   0,      1.0f },
+	{ "Prior_Center",		 &engine[pPriorCenter],		   0,    100.0f }
+};
+
+// --------------------------------------------------------
+//	Sets the value of a named parameter, clamped to the
+//  bounds of the parameter.
+// --------------------------------------------------------
+void Config::set( const std::string& name, float value )
+{
+	// Find the named parameter
+	int i = 0; while( i < nParameters && name != parameter[i].name ) i++;
+	if( i == nParameters ) throw "Unknown parameter in config file";
+
+	// Store the clamped value
+	*parameter[i].value = max( parameter[i].minimum, min( value, parameter[i].maximum ) );
+}
+//
+// --------------------------------------------------------
+//	Loads parameters from a config file. Parameters which
+//  are missing from the file keep their values.
+// --------------------------------------------------------
+void Config::load( const char* filename )
+{
+	// Open the specified file for reading
+	std::ifstream file( filename );
+	if( !file.is_open( ) ) throw "Could not open config file";
+
+	// Parse file using newline and space delimiters
+	std::string line; while( std::getline( file, line ) )
+	{
+		// Put line data onto stream for delimination
+		std::string token; std::stringstream iss; iss << line;
+		if( !(iss >> token) || token.substr( 0, 2 ) == "//" ) continue;
+
+		// Read the named parameter
+		float value; if( !(iss >> value) ) throw "Error parsing parameter value";
+		set( token, value );
+	}
+}
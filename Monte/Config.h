@@ -0,0 +1,60 @@
+/* ===========================================================================
+
+	Project: Monte AI for Blokus
+
+	Description:
+	 Search parameters read from the config file at startup, with their
+	 bounds.
+
+    Copyright (C) 2011 Lucas Sherman
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Include gaurds
+#ifndef CONFIG_H
+#define CONFIG_H
+
+// Engine parameters
+enum EngineParameter { pUctConstant, pPuctConstant, pWidenBase, pWidenScale,
+	pWidenExp, pPriorCenter, nEngineParameters };
+
+// Config namespace
+namespace Config {
+
+	// Named parameter
+	struct Parameter { const char* name; float* value;
+		float minimum; float maximum; };
+
+	// Engine parameter values
+	extern float engine[nEngineParameters];
+
+	// Parameter table of the engine parameters
+	extern const int nParameters;
+	extern const Parameter parameter[];
+
+	// Sets a named parameter within its bounds, throws a string on failure
+	void set( const std::string& name, float value );
+
+	// Config file input, throws a string on failure
+	void load( const char* filename );
+
+// End namespace
+} // Config
+
+// End definition
+#endif
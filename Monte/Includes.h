@@ -39,6 +39,10 @@
 #include <vector>
 #include <string>
 #include <time.h>
+#include <math.h>
+#include <limits>
+#include <float.h>
+#include <algorithm>
 
 // Type definitions
 #include "Types.h"
@@ -50,18 +54,36 @@
 // Piece definitions
 #include "Piece.h"
 
+// Position hashing
+#include "Zobrist.h"
+
 // Memory pools
 #include "MemoryPool.h"
 
+// High-res Timer
+#include "Timer.h"
+
 // Profiler
 #include "Profiler.h"
 
 // Move enumeration
 #include "MoveLists.h"
 
+// Move simulation
+#include "MoveSimulator.h"
+
+// Policy network for the move priors
+#include "Policy.h"
+
 // Monte Carlo search
 #include "Node.h"
 
+// Engine parameters
+#include "Config.h"
+
+// Self-play driver
+#include "SelfPlay.h"
+
 // Include header
 #include "Monte.h"
 
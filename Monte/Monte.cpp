@@ -30,199 +30,672 @@
 // Include header
 #include "Monte.h"
 
+// Monte-Carlo Search Settings
+#define SEARCH_TIME		3.0f   //< Search time allotted per move (seconds)
+#define TABLE_SIZE	  262144   //< Entries in the node table (power of two)
+#define TABLE_PROBES       4   //< Table entries probed for each position
+#define MAX_EDGES    1000000   //< Maximum number of edges in the search graph
+#define EXPAND_VISITS      2   //< Visits to a node before it is expanded
+#define LIST_CHUNKS      250   //< Move list chunks in the simulation pool
+
+// Progressive Widening Settings
+#define PROGRESSIVE_WIDENING TRUE  //< Limits selection to the best prior moves
+
+// Policy Network Settings
+#define PUCT_PRIORS     TRUE   //< Selects edges by PUCT with policy head priors when loaded
+#define POLICY_FNAME "policy.nnue"  //< Network whose policy head gives the priors, NULL for none
+
+// Engine config filename
+#define CONFIG_FNAME "MonteConfig.txt" //< Exploration and widening settings, NULL for defaults
+
 // --------------------------------------------------------
-//	Startup - Sets the seed for the rand generator and 
-//  stores the match settings data.
+//	Startup - Sets the seed for the rand generator, loads
+//  the piece configurations and allocates the node table
+//  and the edge and move list memory pools.
 // --------------------------------------------------------
-void Monte::startup( int boardSize, int startTile[][2], int nPlayers ) 
+void Monte::startup( int boardSize, int startTile[][2], int nPlayers )
 {
+	// Initiate the timer
+	m_matchTimer.start( );
+
 	// Generate a new random seed
 	srand( (unsigned int)time(NULL) );
 
-	// Load piece data
-	loadPieceConfigs( );
+	// Load piece configurations
+	PieceSet::initPieceConfigurations( );
 
-	// Store player/board data
-	m_boardSize = boardSize;
-	m_nPlayers = nPlayers;
+	// Initialize position hash keys
+	Zobrist::initKeys( );
 
 	// Store starting liberty tiles
 	for( int i = 0; i < nPlayers; i++ ) {
 		m_startTile[i][0] = startTile[i][0];
 		m_startTile[i][1] = startTile[i][1]; }
-} 
+
+	// Allocate the node table
+	m_table = new Node[TABLE_SIZE];
+	for( int i = 0; i < TABLE_SIZE; i++ )
+		m_table[i].m_key = 0;
+
+	// Allocate the edge arena
+	m_edgePool.allocateMemory( sizeof(Edge), MAX_EDGES+1 );
+
+	// Allocate the move list pool shared by the search states
+	m_rootState.moveLists.allocateMemoryPool( LIST_CHUNKS );
+
+	// Load the policy head for the move priors
+	if( PUCT_PRIORS && POLICY_FNAME ) {
+		if( Policy::load( POLICY_FNAME ) )
+			std::cout << "Policy network " << POLICY_FNAME << " loaded\n";
+		else std::cout << "No policy network loaded\n"; }
+
+	// Load engine config
+	if( CONFIG_FNAME ) { try { Config::load( CONFIG_FNAME );
+			std::cout << "Engine config " << CONFIG_FNAME << " loaded\n";
+		} catch( const char *s ) {
+			std::cout << "Using default engine config:\n	" << s << "\n"; }
+	} else std::cout << "Using default engine config\n";
+
+	// Print settings to standard io
+	std::cout << "Search Time: " << SEARCH_TIME << "s\n";
+	std::cout << "Node Table Size: " << TABLE_SIZE << " nodes\n";
+	std::cout << "Max Edges: " << MAX_EDGES << "\n";
+	if( PUCT_PRIORS && Policy::isLoaded( ) ) std::cout << "PUCT Constant: " << Config::engine[pPuctConstant] << "\n";
+	else std::cout << "UCT Constant: " << Config::engine[pUctConstant] << "\n";
+	if( PROGRESSIVE_WIDENING ) std::cout << "Widening Schedule: " << Config::engine[pWidenBase]
+		<< " + " << Config::engine[pWidenScale] << "*n^" << Config::engine[pWidenExp] << "\n";
+
+	// Print ready message
+	std::cout << "Ready to Move!!!\n";
+}
 //
 // --------------------------------------------------------
-//	MakeMove - Returns a move at random from those that
-//  are returned by the GetAvailableMoves function.
+//	Shutdown - Releases the node table and memory pools.
+// --------------------------------------------------------
+void Monte::shutdown( )
+{
+	// Release the search graph
+	delete [] m_table; m_table = NULL;
+	m_edgePool.deallocateMemory( );
+	m_root = NULL; m_nodeCount = 0; m_edgeCount = 0;
+
+	// Release the move list pool
+	m_rootState.moveLists.deallocateMemoryPool( );
+}
+//
+// --------------------------------------------------------
+//	MakeMove - Returns a move based on the current board
+//  configuration. The root position is looked up in the 
+//  node table, so the subgraph searched below it on the
+//  previous turn is kept and its search is continued
+//  until the time limit expires. The remainder of the
+//  graph is recycled.
 // --------------------------------------------------------
 Move Monte::makeMove( char grid[][20], bool pieces[][21], int score[], int player )
 {
-	// Enumerate all available moves
-	std::vector<Move> moves; moves.reserve( 1200 );
-	getAvailableMoves( &moves, grid, pieces, player );
+	// Clear profiler data
+	Profiler::clear( );
+
+	// Get the current time
+	__int64 totalTimeID = Profiler::startProfile( );
+
+	// Update timer and store starting data
+	m_matchTimer.update( ); float startTime = m_matchTimer.getRunningTime( );
+
+	// Release the previous root move lists
+	m_rootState.moveLists.deallocateMemoryChunks( );
+
+	// Reformat game board for optimized move searches
+	MoveSimulator::reformatBoard( grid, m_rootState.grid, pieces,
+		m_rootState.pieces, m_startTile );
+	m_rootState.score[PLAYER_BLUE] = score[PLAYER_BLUE];
+	m_rootState.score[PLAYER_RED]  = score[PLAYER_RED];
+	m_rootState.player = player;
+
+	// Generate base move lists for the search
+	m_rootState.moveLists.generateMoves( m_rootState.grid, m_rootState.pieces );
+
+	// Find the root node from the previous search
+	unsigned __int64 rootKey = Zobrist::getKey( m_rootState.grid, m_rootState.pieces, player );
+	m_root = findNode( rootKey ); m_pathLength = 0;
+	float reusedVisits = m_root ? m_root->m_nVisits : 0.0f;
+
+	// Recycle the nodes which can not be reached from it
+	releaseUnreachableNodes( );
+	int reusedNodes = m_nodeCount;
+
+	// Create a new root node if none was recovered
+	if( !m_root ) m_root = insertNode( rootKey, player );
+
+	// Search until the time limit expires
+	int nSimulations = 0; float searchTime = 0.0f;
+	m_nTranspositions = 0; m_nReplacements = 0;
+	while( searchTime < SEARCH_TIME )
+	{
+		// Run a single tree search iteration
+		runSimulation( ); nSimulations++;
+
+		// Stop when the root has been solved
+		if( m_root->m_expanded && !m_root->m_edges ) break;
+
+		// Update search time
+		m_matchTimer.update( );
+		searchTime = m_matchTimer.getRunningTime( ) - startTime;
+	}
+
+	// Select the most visited edge from the root
+	Edge* bestEdge = NULL; int nChildren = 0, nVisited = 0;
+	for( Edge* edge = m_root->m_edges; edge; edge = edge->m_next ) {
+		if( !bestEdge || edge->m_nVisits > bestEdge->m_nVisits ) bestEdge = edge;
+		if( edge->m_nVisits > 0.0f ) nVisited++; nChildren++; }
+
+	// Acquire total run time profile
+	Profiler::endProfile( tTotal, totalTimeID );
+
+	// Display search statistics
+	std::cout << "\n-- Move Selection Statistics --\n";
+	std::cout << searchTime << "s at Depth " << getDepth( m_rootState.pieces ) << "\n";
+	std::cout << "Simulations: " << nSimulations << "\n";
+	std::cout << "Reused Nodes: " << reusedNodes << "\n";
+	std::cout << "Reused Visits: " << reusedVisits << "\n";
+	std::cout << "Graph Size: " << m_nodeCount << " nodes, " << m_edgeCount << " edges\n";
+	std::cout << "Transpositions: " << m_nTranspositions << " nodes shared\n";
+	std::cout << "Replacements: " << m_nReplacements << " nodes evicted\n";
+	std::cout << "Root Children: " << nVisited << " visited, "
+		<< getEligibleChildren( m_root ) << " eligible, " << nChildren << " total\n";
+	if( bestEdge ) std::cout << "Best Move Value: " << ( (player == PLAYER_MAX) ? 
+		bestEdge->getMeanValue( ) : 1.0f - bestEdge->getMeanValue( ) ) << "\n";
 
-	// Select random element 
- 	int index = rand( ) % moves.size( );
-	return moves[index];
+	// Store the value of the selected move
+	m_moveSearched = ( bestEdge != NULL );
+	if( bestEdge ) m_moveUtility = bestEdge->getMeanValue( );
+
+	// Return the selected move
+	Move move( -1, 0, 0, 0, 0 );
+	if( bestEdge ) move = bestEdge->m_move;
+	return move;
 }
 //
 // --------------------------------------------------------
-//	GetAvailableMoves - Enumerates all available moves by 
-//  searching through all possible orientations of a piece 
-//  on the board.
+//	RunSimulation - Performs a single iteration of the UCT
+//  algorithm. The graph is descended from the root using
+//  the UCT policy until a node outside the table or a leaf
+//  is reached, a random playout is performed, and the
+//  result is propagated back along the traversed path. 
+//  Since nodes are shared between transpositions, both 
+//  the nodes and edges on the path are updated.
 // --------------------------------------------------------
-void Monte::getAvailableMoves( std::vector<Move>* out, 
-			char grid[][20], bool pieces[][21], int player )
+void Monte::runSimulation( )
 {
-	Move move;
+	// Get the simulation state buffers
+	SearchState* state = m_state;
+	SearchState* next  = m_state+1;
+
+	// Copy the root game state
+	memcpy( state->grid, m_rootState.grid, sizeof(state->grid) );
+	state->pieces[PLAYER_BLUE] = m_rootState.pieces[PLAYER_BLUE];
+	state->pieces[PLAYER_RED]  = m_rootState.pieces[PLAYER_RED];
+	state->score[PLAYER_BLUE]  = m_rootState.score[PLAYER_BLUE];
+	state->score[PLAYER_RED]   = m_rootState.score[PLAYER_RED];
+	state->player = m_rootState.player;
+	state->moveLists.copy( &m_rootState.moveLists );
 
-	// Compile move list
-	for( int i = 0; i < 21; i++ ) 
-	if( pieces[player][i] )
+	// Descend the graph using the UCT policy
+	Node* node = m_root; m_pathLength = 0;
+	while( node )
 	{
-		move.pieceNumber = i;
-
-		// Precompute iteration bounds
-		int maxSizeX = m_boardSize - m_piece[move.pieceNumber].sizeX + 2;
-		int maxSizeY = m_boardSize - m_piece[move.pieceNumber].sizeY + 2;
-		int maxRange = max( maxSizeX, maxSizeY );
-
-		// Check for valid move with subrange
-		for( move.rotated = 0; move.rotated < m_piece[move.pieceNumber].rot; move.rotated++ ) 
-		for( move.flipped = 0; move.flipped <= m_piece[move.pieceNumber].flip; move.flipped++ ) 
-		for( move.gridX = -1; move.gridX < maxRange; move.gridX++ )
-		for( move.gridY = -1; move.gridY < maxRange; move.gridY++ )
-		if( isValidMove( move, grid, player ) ) out->push_back( move );
+		// Expand nodes which have been visited enough
+		if( !node->m_expanded ) {
+			if( node != m_root && node->m_nVisits < EXPAND_VISITS ) break;
+			expandNode( node, state ); }
+
+		// Stop at terminal and unexpandable nodes
+		if( !node->m_edges ) break;
+
+		// Select an edge and record the path
+		Edge* edge = selectEdge( node );
+		m_pathNodes[m_pathLength] = node;
+		m_pathEdges[m_pathLength] = edge;
+		m_pathLength++;
+
+		// Apply the move along the edge
+		applyMove( &edge->m_move, state, next );
+
+		// Compute the key of the position reached
+		if( !edge->m_childKey ) edge->m_childKey = 
+			Zobrist::getKey( state->grid, state->pieces, state->player );
+
+		// Find the node reached by the edge
+		Node* child = getChild( edge );
+		if( !child ) {
+			edge->m_child = insertNode( edge->m_childKey, state->player );
+			node = edge->m_child; break; }
+
+		// Count edges leading into an existing position
+		if( edge->m_nVisits == 0.0f && child->m_nVisits > 0.0f )
+			m_nTranspositions++;
+
+		node = child;
 	}
+
+	// Perform a random playout from the leaf
+	float reward = playout( state, next );
+
+	// Return used memory chunks to pool
+	state->moveLists.deallocateMemoryChunks( );
+
+	// Propagate the result back along the path
+	for( int i = 0; i < m_pathLength; i++ ) {
+		m_pathNodes[i]->m_nVisits += 1.0f; m_pathNodes[i]->m_value += reward;
+		m_pathEdges[i]->m_nVisits += 1.0f; m_pathEdges[i]->m_value += reward; }
+	if( node ) { node->m_nVisits += 1.0f; node->m_value += reward; }
 }
 //
 // --------------------------------------------------------
-//	IsValidMove - Checks if the given move is valid.
+//	SelectEdge - Returns the edge from the node which
+//  maximizes the UCT value. Only the edges eligible under
+//  the progressive widening schedule are considered. The
+//  exploitation term uses the statistics of the node the
+//  edge leads to, which include the playouts made through 
+//  its transpositions, while the exploration term uses 
+//  the edge visit count. Unvisited edges are selected 
+//  first in the order of the edge list. With policy head
+//  priors the PUCT value is used instead, which weights
+//  the exploration of each edge by its prior, and an
+//  unvisited edge takes the mean value of the node.
 // --------------------------------------------------------
-bool Monte::isValidMove( Move move, char grid[][20], int player )
+Edge* Monte::selectEdge( Node* node )
 {
-	bool coversLiberty = false;
+	// Precompute the exploration terms
+	float logVisits = logf( node->m_nVisits + 1.0f );
+	float rootVisits = sqrtf( node->m_nVisits );
+	float uctConstant = Config::engine[pUctConstant];
+	float puctConstant = Config::engine[pPuctConstant];
+	bool puct = ( PUCT_PRIORS && Policy::isLoaded( ) );
+
+	// Get the value of the node for the player to move
+	float nodeMean = node->getMeanValue( );
+	if( node->m_player != PLAYER_MAX ) nodeMean = 1.0f - nodeMean;
+
+	// Get the number of edges eligible for selection
+	int nEligible = getEligibleChildren( node );
 
-	// Run pattern analysis between grid and piece
-	int gx = move.gridX, gy = move.gridY;
-	int x = m_piece[move.pieceNumber].sizeX;
-	int y = m_piece[move.pieceNumber].sizeY;
-	if( move.flipped == PIECE_UNFLIPPED )
+	// Find the edge with the greatest UCT value
+	Edge* bestEdge = NULL; float bestValue = -FLT_MAX;
+	for( Edge* edge = node->m_edges; edge && nEligible > 0;
+		 edge = edge->m_next, nEligible-- )
 	{
-		if( move.rotated == PIECE_ROTATE_0 ) {
-			for( int j = 0, gy = move.gridY; j < y; j++,gy++ )
-			for( int i = 0, gx = move.gridX; i < x; i++,gx++ )
-				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy, grid, player ) ) return false;
-		}
+		// Compute the PUCT value of the edge
+		if( puct ) {
+			float mean = nodeMean;
+			if( edge->m_nVisits > 0.0f ) { Node* child = getChild( edge );
+				mean = ( child && child->m_nVisits > 0.0f ) ?
+					child->getMeanValue( ) : edge->getMeanValue( );
+				if( node->m_player != PLAYER_MAX ) mean = 1.0f - mean; }
+			float value = mean + puctConstant * edge->m_prior * rootVisits / ( 1.0f + edge->m_nVisits );
+			if( value > bestValue ) { bestValue = value; bestEdge = edge; }
+			continue; }
 
-		else if( move.rotated == PIECE_ROTATE_90 ) {
-			for( int i = x-1, gy = move.gridY; i >= 0; i--,gy++ )
-			for( int j =   0, gx = move.gridX; j <  y; j++,gx++ )
-				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy, grid, player ) ) return false;
-		}
+		// Always try unvisited edges first
+		if( edge->m_nVisits == 0.0f ) return edge;
 
-		else if( move.rotated == PIECE_ROTATE_180 ) {
-			for( int j = y-1, gy = move.gridY; j >= 0; j--,gy++ )
-			for( int i = x-1, gx = move.gridX; i >= 0; i--,gx++ )
-				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy, grid, player ) ) return false;
-		}
+		// Get the shared value of the position reached
+		Node* child = getChild( edge );
+		float mean = ( child && child->m_nVisits > 0.0f ) ?
+			child->getMeanValue( ) : edge->getMeanValue( );
+		if( node->m_player != PLAYER_MAX ) mean = 1.0f - mean;
 
-		else if( move.rotated == PIECE_ROTATE_270 ) {
-			for( int i =   0, gy = move.gridY; i <  x; i++,gy++ )
-			for( int j = y-1, gx = move.gridX; j >= 0; j--,gx++ )
-				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy, grid, player ) ) return false;
-		}
-	} else 
+		// Compute the UCT value of the edge
+		float value = mean + uctConstant * sqrtf( logVisits / edge->m_nVisits );
+		if( value > bestValue ) { bestValue = value; bestEdge = edge; }
+	}
+
+	return bestEdge;
+}
+//
+// --------------------------------------------------------
+//	GetEligibleChildren - Returns the number of children of
+//  the node which may be selected given its visit count.
+//  Children are ordered by prior, so these are always the
+//  children with the greatest prior values.
+// --------------------------------------------------------
+int Monte::getEligibleChildren( Node* node )
+{
+	if( !PROGRESSIVE_WIDENING ) return INT_MAX;
+	return (int)( Config::engine[pWidenBase] + Config::engine[pWidenScale] *
+		powf( node->m_nVisits, Config::engine[pWidenExp] ) );
+}
+//
+// --------------------------------------------------------
+//	ExpandNode - Generates the edges of a node from the 
+//  moves available in the specified state. Edges are
+//  ordered from the greatest to the least prior value, the
+//  policy head probabilities when a policy network is
+//  loaded and the heuristic estimate otherwise. A
+//  pass edge is created when only the opponent is able to
+//  move. No edges are created for terminal states or when
+//  the edge arena does not have room for them.
+// --------------------------------------------------------
+void Monte::expandNode( Node* node, SearchState* state )
+{
+	int player = state->player;
+
+	// Enumerate the available moves
+	std::vector<Move> moves;
+	if( state->moveLists.isMoveAvailable( player ) )
 	{
-		if( move.rotated == PIECE_ROTATE_0 ) {
-			for( int j =   0, gy = move.gridY; j <  y; j++,gy++ )
-			for( int i = x-1, gx = move.gridX; i >= 0; i--,gx++ )
-				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy, grid, player ) ) return false;
-		}
+		// Wake all liberties to search the full move set
+		state->moveLists.clearLibertyModeSettings( );
 
-		else if( move.rotated == PIECE_ROTATE_90 ) {
-			for( int i = x-1, gy = move.gridY; i >= 0; i--,gy++ )
-			for( int j = y-1, gx = move.gridX; j >= 0; j--,gx++ )
-				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy, grid, player ) ) return false;
+		// Collect the moves, discarding duplicates
+		for( const Move* move = state->moveLists.getFirstMove( player, state->pieces[player] );
+			 move != NULL; move = state->moveLists.getNextMove( ) )
+		{
+			Move newMove = *move; bool duplicate = false;
+			for( unsigned int i = 0; i < moves.size( ) && !duplicate; i++ )
+				if( moves[i] == newMove ) duplicate = true;
+			if( !duplicate ) moves.push_back( newMove );
 		}
+	}
 
-		else if( move.rotated == PIECE_ROTATE_180 ) {
-			for( int j = y-1, gy = move.gridY; j >= 0; j--,gy++ )
-			for( int i =   0, gx = move.gridX; i <  x; i++,gx++ )
-				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy, grid, player ) ) return false;
-		}
+	// Insert a pass move if only the opponent can move, the
+	// move lists are searched since passes must not form cycles
+	if( moves.empty( ) && state->moveLists.isMoveAvailable( 1-player ) &&
+		state->moveLists.getFirstMove( 1-player, state->pieces[1-player] ) )
+		moves.push_back( Move( -1, 0, 0, 0, 0 ) );
+
+	// Check for room in the edge arena
+	if( m_edgeCount + (int)moves.size( ) > MAX_EDGES ) return;
 
-		else if( move.rotated == PIECE_ROTATE_270 ) {
-			for( int i = 0, gy = move.gridY; i < x; i++,gy++ )
-			for( int j = 0, gx = move.gridX; j < y; j++,gx++ )
-				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy, grid, player ) ) return false;
+	// Randomize the order of moves with equal priors
+	std::random_shuffle( moves.begin( ), moves.end( ) );
+
+	// Compute the move priors
+	std::vector< std::pair<float,int> > priors( moves.size( ) );
+	if( PUCT_PRIORS && Policy::isLoaded( ) && !moves.empty( ) )
+		getPolicyPriors( moves, state, &priors[0] );
+	else for( unsigned int i = 0; i < moves.size( ); i++ )
+		priors[i] = std::make_pair( getPrior( moves[i] ), (int)i );
+	std::stable_sort( priors.begin( ), priors.end( ) );
+
+	// Create the edges, best prior at the list head
+	for( unsigned int i = 0; i < priors.size( ); i++ ) {
+		Edge* edge = (Edge*)m_edgePool.getChunk( ); m_edgeCount++;
+		edge->initialize( moves[priors[i].second], priors[i].first );
+		edge->m_next = node->m_edges;
+		node->m_edges = edge; }
+
+	// Mark the node as expanded
+	node->m_expanded = TRUE;
+}
+//
+// --------------------------------------------------------
+//	Playout - Plays random moves from the specified state
+//  until neither player is able to move. Returns 1 if the
+//  PLAYER_MAX has won the game, 0 if PLAYER_MIN has won,
+//  and 0.5 if the game is a tie.
+// --------------------------------------------------------
+float Monte::playout( SearchState*& state, SearchState*& next )
+{
+	// Play until both players pass in turn
+	int nPasses = 0;
+	while( nPasses < NUM_PLAYERS )
+	{
+		int player = state->player;
+
+		// Select a move uniformly at random
+		const Move* selected = NULL; int nMoves = 0;
+		if( state->moveLists.isMoveAvailable( player ) )
+		{
+			// Wake all liberties to search the full move set
+			state->moveLists.clearLibertyModeSettings( );
+
+			// Reservoir sample the available moves
+			for( const Move* move = state->moveLists.getFirstMove( player, state->pieces[player] );
+				 move != NULL; move = state->moveLists.getNextMove( ) )
+				if( rand( ) % (++nMoves) == 0 ) selected = move;
 		}
+
+		// Pass if no move is available
+		if( !selected ) { state->player = 1-player; nPasses++; continue; }
+
+		// Simulate the selected move
+		applyMove( selected, state, next ); nPasses = 0;
 	}
 
-	// Check if liberty is covered
-	if( coversLiberty ) return true;
-	else return false;
+	// Return the game result
+	if( state->score[PLAYER_MAX] > state->score[PLAYER_MIN] ) return 1.0f;
+	if( state->score[PLAYER_MAX] < state->score[PLAYER_MIN] ) return 0.0f;
+	return 0.5f;
 }
 //
 // --------------------------------------------------------
-//	IsValidPattern - Checks if the patterns on the grid and 
-//  piece are compatible and updates the liberty covered 
-//  flag if a liberty was covered.
+//	ApplyMove - Simulates a move on the current state and
+//  swaps the state buffers so that state holds the result.
+//  Pass moves only change the player to move.
 // --------------------------------------------------------
-bool Monte::isValidPattern( int pieceNumber, bool* liberty, int px, int py, 
-						   int gx, int gy, char grid[][20], int player )
+void Monte::applyMove( const Move* move, SearchState*& state, SearchState*& next )
 {
-	// Check for outside grid bounds on a covering tile
-	char piecePattern = m_piece[pieceNumber].layout[px][py];
-	if( gx < 0 || gx >= m_boardSize || gy < 0 || gy >= m_boardSize ) 
-		if( piecePattern == MATCH_NOT_COVERED ) return false;
-		else return true;
+	// Check for a pass move
+	if( move->pieceNumber < 0 ) { state->player = 1-state->player; return; }
+
+	// Begin profiling move simulation
+	__int64 simulationTimeID = Profiler::startProfile( );
+
+	// Wake all liberties so that every affected move list is
+	// updated, sleeping liberties are not otherwise maintained
+	state->moveLists.clearLibertyModeSettings( );
+
+	// Simulate the move into the next state
+	MoveSimulator::simulateMove( move, state->grid, state->pieces, state->score,
+		state->player, next->grid, next->pieces, next->score, &next->player,
+		&state->moveLists, &next->moveLists );
+
+	// Increment function runtime costs
+	Profiler::endProfile( tSimulateMoves, simulationTimeID );
+
+	// Return used memory chunks to pool
+	state->moveLists.deallocateMemoryChunks( );
+
+	// Swap state buffers
+	SearchState* temp = state; state = next; next = temp;
+}
+//
+// --------------------------------------------------------
+//	GetPrior - Computes a cheap estimate of the strength of
+//  a move for progressive widening. The estimate is the
+//  score gained by the move plus a bonus for placing the 
+//  piece near the center of the board, where it competes
+//  for territory with the opponent.
+// --------------------------------------------------------
+float Monte::getPrior( const Move& move )
+{
+	// Pass moves have no alternative
+	if( move.pieceNumber < 0 ) return 0.0f;
+
+	// Score gained by the move
+	float gain;
+		 if( move.pieceNumber > 8 ) gain = 5.0f;
+	else if( move.pieceNumber > 3 ) gain = 4.0f;
+	else if( move.pieceNumber > 1 ) gain = 3.0f;
+	else if( move.pieceNumber > 0 ) gain = 2.0f;
+	else gain = 1.0f;
+
+	// Get the oriented piece dimensions
+	Piece* piece = PieceSet::getPiece( move.pieceNumber );
+	int w = (move.rotated%2) ? piece->getSizeY( ) : piece->getSizeX( );
+	int h = (move.rotated%2) ? piece->getSizeX( ) : piece->getSizeY( );
+
+	// Distance of the piece center from the board center
+	float center = (float)(BOARD_SIZE-1) * 0.5f;
+	float dx = fabsf( (float)move.gridX + (float)(w-1)*0.5f - center );
+	float dy = fabsf( (float)move.gridY + (float)(h-1)*0.5f - center );
+
+	// Combine the score gain and centrality
+	return gain + Config::engine[pPriorCenter] * ( 1.0f - (dx+dy) / (2.0f*center) );
+}
+//
+// --------------------------------------------------------
+//	GetPolicyPriors - Computes the move priors as the
+//  softmax of the policy logits of the moves, running the
+//  network once for the position to score all of them.
+// --------------------------------------------------------
+void Monte::getPolicyPriors( const std::vector<Move>& moves, SearchState* state,
+							 std::pair<float,int> priors[] )
+{
+	// Begin profiling the policy network
+	__int64 policyTimeID = Profiler::startProfile( );
+
+	// Score the moves, keeping the greatest logit
+	float logits[NNUE_POLICY], maxLogit = -FLT_MAX;
+	Policy::getLogits( state->grid, state->pieces, state->player, logits );
+	for( unsigned int i = 0; i < moves.size( ); i++ ) {
+		priors[i] = std::make_pair( Policy::getMoveLogit( logits, moves[i] ), (int)i );
+		maxLogit = max( maxLogit, priors[i].first ); }
+
+	// Normalize the exponentials of the logits
+	float sum = 0.0f;
+	for( unsigned int i = 0; i < moves.size( ); i++ ) {
+		priors[i].first = expf( priors[i].first - maxLogit );
+		sum += priors[i].first; }
+	for( unsigned int i = 0; i < moves.size( ); i++ )
+		priors[i].first /= sum;
 
-	// Check if local patterns are acceptable
-	char gridPattern = grid[gx][gy];
-	switch( piecePattern ) {
-		case MATCH_NOT_PLAYERS: 
-			if( gridPattern == player ) return false; break;
-		case MATCH_NOT_COVERED:
-			if( gridPattern != GRID_COVER_NONE ) return false; 
-			else if( gx == m_startTile[player][0] && 
-					 gy == m_startTile[player][1] ) *liberty = true; break;
-		case MATCH_LIBERTY:
-			if( gridPattern == player ) *liberty = true; }
+	// Increment function runtime costs
+	Profiler::endProfile( tPolicyPriors, policyTimeID );
+}
+//
+// --------------------------------------------------------
+//	FindNode - Returns the table entry holding the position
+//  with the specified key, or NULL if it is not present.
+// --------------------------------------------------------
+Node* Monte::findNode( unsigned __int64 key )
+{
+	int index = (int)( key & (TABLE_SIZE-1) );
+	for( int i = 0; i < TABLE_PROBES; i++ ) {
+		Node* node = m_table + ((index+i) & (TABLE_SIZE-1));
+		if( node->m_key == key ) return node; }
 
-	// Pattern valid
-	return true;
+	return NULL;
 }
 //
 // --------------------------------------------------------
-//	LoadPieceConfigs - Initializes the piece information 
-//  structures using information form the provided file.
+//	InsertNode - Places a new node for the specified key in
+//  the table. An empty entry is used if one is available,
+//  otherwise the least visited entry is replaced. The root
+//  and the nodes on the current path are never replaced.
+//  Returns NULL if no entry could be claimed.
 // --------------------------------------------------------
-void Monte::loadPieceConfigs( )
+Node* Monte::insertNode( unsigned __int64 key, int player )
 {
-	// Open piece structure file for reading
-	std::wstring filename = std::wstring( L"Pieces.txt" );
-	std::fstream file( filename.c_str( ), std::ios::in );
+	// Find an entry to claim
+	Node* victim = NULL;
+	int index = (int)( key & (TABLE_SIZE-1) );
+	for( int i = 0; i < TABLE_PROBES; i++ )
+	{
+		// Use the first empty entry
+		Node* node = m_table + ((index+i) & (TABLE_SIZE-1));
+		if( !node->m_key ) { victim = node; break; }
+
+		// Skip the root and path nodes
+		bool isProtected = ( node == m_root );
+		for( int j = 0; j < m_pathLength && !isProtected; j++ )
+			if( node == m_pathNodes[j] ) isProtected = true;
+		if( isProtected ) continue;
 
-	// Check for file load failure
-	if( !file.is_open( ) ) {
-		std::cerr << "Couldn't open Pieces.txt!" << std::endl;
-		throw 1; // TODO: better error handling
+		// Keep the least visited entry
+		if( !victim || node->m_nVisits < victim->m_nVisits ) victim = node;
 	}
 
-	// Parse file for piece layouts
-	for( int i = 0; i < 21; i++ ) 
+	// Check for a full probe sequence
+	if( !victim ) return NULL;
+
+	// Evict the current occupant
+	if( victim->m_key ) { releaseNode( victim ); m_nReplacements++; }
+
+	// Claim the entry
+	victim->initialize( key, player ); m_nodeCount++;
+	return victim;
+}
+//
+// --------------------------------------------------------
+//	GetChild - Returns the node reached by an edge, or NULL
+//  if the node is not in the table. The cached node is
+//  verified against the key since table entries may be
+//  replaced.
+// --------------------------------------------------------
+Node* Monte::getChild( Edge* edge )
+{
+	// Check for an unknown position
+	if( !edge->m_childKey ) return NULL;
+
+	// Check the cached node
+	if( edge->m_child && edge->m_child->m_key == edge->m_childKey ) 
+		return edge->m_child;
+
+	// Look up the node in the table
+	edge->m_child = findNode( edge->m_childKey );
+	return edge->m_child;
+}
+//
+// --------------------------------------------------------
+//	ReleaseNode - Returns the edges of a node to the arena
+//  and marks its table entry as empty.
+// --------------------------------------------------------
+void Monte::releaseNode( Node* node )
+{
+	// Free the edge list
+	Edge* edge = node->m_edges;
+	while( edge ) {
+		Edge* next = edge->m_next;
+		m_edgePool.freeChunk( edge );
+		m_edgeCount--;
+		edge = next; }
+
+	// Free the table entry
+	node->m_key = 0; node->m_edges = NULL;
+	m_nodeCount--;
+}
+//
+// --------------------------------------------------------
+//	ReleaseUnreachableNodes - Marks the nodes which can be
+//  reached from the root along the edges of the graph and
+//  releases every other node. This recycles the positions
+//  which are already behind the game as well as those of
+//  the moves not played, which would otherwise hold their
+//  table entries against less visited new nodes. All the
+//  nodes are released if there is no root.
+// --------------------------------------------------------
+void Monte::releaseUnreachableNodes( )
+{
+	// Mark the nodes reachable from the root
+	std::vector<Node*> stack;
+	if( m_root ) { m_root->m_marked = TRUE; stack.push_back( m_root ); }
+	while( !stack.empty( ) )
 	{
-		// Read in dimensions
-		file >> m_piece[i].sizeX;
-		file >> m_piece[i].sizeY;
-		file >> m_piece[i].rot;
-		file >> m_piece[i].flip;
-
-		// Read in piece layout
-		for( int k = 0; k < m_piece[i].sizeY; k++ )
-		for( int j = 0; j < m_piece[i].sizeX; j++ )
-			file >> m_piece[i].layout[j][k];
+		Node* node = stack.back( ); stack.pop_back( );
+		for( Edge* edge = node->m_edges; edge; edge = edge->m_next ) {
+			Node* child = getChild( edge );
+			if( child && !child->m_marked ) {
+				child->m_marked = TRUE; stack.push_back( child ); } }
 	}
-}
\ No newline at end of file
+
+	// Release the unmarked nodes and clear the marks
+	for( int i = 0; i < TABLE_SIZE; i++ )
+		if( m_table[i].m_key ) {
+			if( !m_table[i].m_marked ) releaseNode( m_table + i );
+			else m_table[i].m_marked = FALSE; }
+}
+//
+// --------------------------------------------------------
+//	GetDepth - Returns the number of pieces played.
+// --------------------------------------------------------
+int Monte::getDepth( int pieces[] )
+{
+	int depth = 0;
+	for( int p = 0; p < NUM_PLAYERS; p++ )
+	for( int i = 0; i < PIECE_COUNT; i++ )
+		if( !(pieces[p] & (1<<i)) ) depth++;
+
+	return depth;
+}
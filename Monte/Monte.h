@@ -32,35 +32,81 @@
 class Monte
 {
 public:
+	// Contruction
+	Monte( ) { m_table = NULL; m_root = NULL; m_nodeCount = 0; m_edgeCount = 0; m_moveSearched = false; }
+
 	// Initialize the AI players settings data
 	void startup( int boardSize, int startTile[][2], int nPlayers );
 
-	// Enumerate available moves and select one at random to return
+	// Uses Monte-Carlo tree search to select a move, reusing the
+	// search graph from the previous turn where possible
 	Move makeMove( char grid[][20], bool pieces[][21], int score[], int player );
 
 	// Shutdown AI player
-	void shutdown( ) { }
+	void shutdown( );
+
+	// Mean reward of the last move for PLAYER_MAX, false if no move was searched
+	bool getMoveUtility( float* utility ) { *utility = m_moveUtility; return m_moveSearched; }
 
 private:
-	// Piece layout structure
-	struct Piece { int sizeX, sizeY; int rot; int flip; char layout[7][6]; };
-
-	// Enumerates all available moves for the given game state
-	void getAvailableMoves( std::vector<Move>* out, char grid[][20], 
-		bool pieces[][21], int player );
-
-	// Valid move checking
-	bool isValidMove( Move move, char grid[][20], int player );
-	bool isValidPattern( int pieceNumber, bool* liberty, int px, int py, 
-		int gx, int gy, char grid[][20], int player );
-
-	// Load piece configurations
-	void loadPieceConfigs( );
-	
-	// Match settings data
-	int m_nPlayers, m_boardSize;    
+	// Game state used for move replay and playouts
+	struct SearchState { short grid[14][14]; int pieces[2]; int score[2];
+						 int player; MoveLists moveLists; };
+
+	// Monte-Carlo tree search iteration
+	void runSimulation( );
+
+	// Tree policy helpers
+	Edge* selectEdge( Node* node );
+	void expandNode( Node* node, SearchState* state );
+
+	// Progressive widening helpers
+	int getEligibleChildren( Node* node );
+	float getPrior( const Move& move );
+	void getPolicyPriors( const std::vector<Move>& moves, SearchState* state,
+		std::pair<float,int> priors[] );
+
+	// Default policy, returns the reward for PLAYER_MAX
+	float playout( SearchState*& state, SearchState*& next );
+
+	// Applies a move to the search state
+	void applyMove( const Move* move, SearchState*& state, SearchState*& next );
+
+	// Node table management
+	Node* findNode( unsigned __int64 key );
+	Node* insertNode( unsigned __int64 key, int player );
+	Node* getChild( Edge* edge );
+	void releaseNode( Node* node );
+	void releaseUnreachableNodes( );
+	int getDepth( int pieces[] );
+
+	// Search graph data
+	Node* m_table;				//< Hash table of search graph nodes
+	Node* m_root;				//< Root node of the search graph
+	int m_nodeCount;			//< Number of occupied table entries
+	int m_edgeCount;			//< Number of allocated edges
+	MemoryPool m_edgePool;		//< Edge memory arena
+
+	// Search path data
+	Node* m_pathNodes[128];		//< Nodes visited in the current iteration
+	Edge* m_pathEdges[128];		//< Edges traversed in the current iteration
+	int m_pathLength;			//< Number of edges traversed
+
+	// Search statistics
+	int m_nTranspositions;		//< New edges leading to existing nodes
+	int m_nReplacements;		//< Nodes evicted from the table
+
+	// Search state data
+	SearchState m_rootState;	//< Game state at the root node
+	SearchState m_state[2];		//< Simulation state buffers
+
+	// Search cut-off timer
+	Timer m_matchTimer;
 	int m_startTile[4][2];
-	Piece m_piece[21];
+
+	// Search utility of the last move
+	float m_moveUtility;
+	bool m_moveSearched;
 };
 
 // End definition
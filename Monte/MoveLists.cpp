@@ -485,8 +485,9 @@ const Move* MoveLists::getFirstMove( int player, int pieces )
 	//     x-coordinate are selected
 	m_nextMoveList = m_moveList[player]; 
 
-	// (3) Ignore sleeping liberties
-	while( !m_nextMoveList->isAwake )
+	// (3) Ignore sleeping liberties and liberties without
+	//     any of the selectable pieces
+	while( !m_nextMoveList->isAwake || !(pieces & m_nextMoveList->validPieces) )
 	if( !(m_nextMoveList = m_nextMoveList->next ) ) 
 		return NULL;
 
@@ -542,7 +543,8 @@ const Move* MoveLists::getNextMove( )
 			//     x-coordinate are selected
 			// (3) Ignore sleeping liberties
 			do if( !(m_nextMoveList = m_nextMoveList->next) ) return NULL;
-				while( !m_nextMoveList->isAwake );
+				while( !m_nextMoveList->isAwake || 
+					   !(m_validPieces & m_nextMoveList->validPieces) );
 
 			// (4) Pieces with higher indexes are selected 
 			m_nextPieceIndex = PIECE_COUNT-1;
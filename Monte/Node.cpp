@@ -3,7 +3,8 @@
 	Project: Monte AI for Blokus
 
 	Description:
-	 Defines the structure of a node in the Monte Carlo search tree.
+	 Defines the structure of the nodes and edges in the Monte Carlo search
+ graph.
 
     Copyright (C) 2011 Lucas Sherman
 
@@ -28,4 +29,42 @@
 #include "Includes.h"
 
 // Include header
-#include "Node.h"
\ No newline at end of file
+#include "Node.h"
+
+// --------------------------------------------------------
+//	Initialize - Resets the edge statistics. The edge is
+//  not inserted into any nodes list of edges.
+// --------------------------------------------------------
+void Edge::initialize( const Move& move, float prior )
+{
+	// Graph structure
+	m_next = NULL;
+	m_child = NULL;
+	m_childKey = 0;
+
+	// Move data
+	m_move = move;
+	m_prior = prior;
+
+	// Search statistics
+	m_nVisits = 0.0f;
+	m_value = 0.0f;
+}
+//
+// --------------------------------------------------------
+//	Initialize - Resets the node statistics and marks the
+//  table entry as holding the specified position.
+// --------------------------------------------------------
+void Node::initialize( unsigned __int64 key, int player )
+{
+	// Position data
+	m_key = key;
+	m_player = player;
+	m_marked = FALSE;
+
+	// Search statistics
+	m_edges = NULL;
+	m_expanded = FALSE;
+	m_nVisits = 0.0f;
+	m_value = 0.0f;
+}
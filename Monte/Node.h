@@ -3,7 +3,8 @@
 	Project: Monte AI for Blokus
 
 	Description:
-	 Defines the structure of a node in the Monte Carlo search tree.
+	 Defines the structure of the nodes and edges in the Monte Carlo search
+ graph.
 
     Copyright (C) 2011 Lucas Sherman
 
@@ -28,17 +29,59 @@
 #ifndef NODE_H
 #define NODE_H
 
+// Forward declarations
+class Node;
+
+// Define Edge
+class Edge
+{
+	friend class Monte;
+
+public:
+	// Initializes an unvisited edge
+	void initialize( const Move& move, float prior );
+
+	// Edge statistics accessors
+	float getVisits( ) { return m_nVisits; }
+	float getMeanValue( )
+	{ return (m_nVisits > 0.0f) ? m_value/m_nVisits : 0.0f; }
+	const Move& getMove( ) { return m_move; }
+	float getPrior( ) { return m_prior; }
+
+private:
+	Edge *m_next;		   //< Next edge leaving the same node
+	Node *m_child;		   //< Cached node reached by the edge
+	unsigned __int64 m_childKey; //< Key of the node reached, 0 if unknown
+	Move m_move;		   //< Move made along this edge (-1 for a pass)
+	float m_prior;		   //< Prior estimate of the moves strength
+	float m_nVisits;	   //< Number of times this edge has been traversed
+	float m_value;		   //< Total reward for PLAYER_MAX along the edge
+};
+
 // Define Node
 class Node
 {
+	friend class Monte;
+
 public:
+	// Initializes an unexpanded node
+	void initialize( unsigned __int64 key, int player );
+
+	// Node statistics accessors
+	float getVisits( ) { return m_nVisits; }
+	float getMeanValue( )
+	{ return (m_nVisits > 0.0f) ? m_value/m_nVisits : 0.0f; }
 
 private:
-    MoveLists m_moveLists; //< Stores this nodes enumerated move lists
+	unsigned __int64 m_key;	//< Hash key of the position, 0 if unused
+	Edge *m_edges;		   //< Edges leaving the node, best prior first
+	int m_player;		   //< Player to move in the position
+	int m_marked;		   //< Node was reached by the last graph sweep
+	int m_expanded;		   //< Edges of this node have been generated
 	float m_nVisits;	   //< Number of times this node has been visited
-	float m_value;		   //< The estimated value of this node
+	float m_value;		   //< Total reward for PLAYER_MAX from the node
 
 };
 
 // End definition
-#endif
\ No newline at end of file
+#endif
@@ -39,6 +39,7 @@ enum ProfilerFunction
 	tMinimaxSearch,
 		tMoveGeneration,
 		tMoveEnumeration,
+		tPolicyPriors,
 		tSimulateMoves,
 			tMoveValidation,
 			tLeakDetection,
@@ -105,6 +106,8 @@ public:
 			/ (double)m_timeCosts[tTotal] + 0.5) << "%\n";
 		std::cout << "      - Move Enumeration: " << (int)(100.0*(double)m_timeCosts[tMoveEnumeration] 
 			/ (double)m_timeCosts[tTotal] + 0.5) << "%\n";
+		std::cout << "      - Policy Priors: " << (int)(100.0*(double)m_timeCosts[tPolicyPriors] 
+			/ (double)m_timeCosts[tTotal] + 0.5) << "%\n";
 		std::cout << "      - Move Simulation: " << (int)(100.0*(double)m_timeCosts[tSimulateMoves] 
 			/ (double)m_timeCosts[tTotal] + 0.5) << "%\n";
 		std::cout << "        - Move Validation(shared): " << (int)(100.0*(double)m_timeCosts[tMoveValidation] 
@@ -27,9 +27,31 @@
 // Standard Includes
 #include "Includes.h"
 
+// Self-play adapter of the AI player
+class MonteSelfPlay : public SelfPlayEngine
+{
+public:
+	void startup( int boardSize, int startTile[][2], int nPlayers ) {
+		m_player.startup( boardSize, startTile, nPlayers ); }
+	void shutdown( ) { m_player.shutdown( ); }
+	Move makeMove( char board[][20], bool pieces[][21], int score[], int player, int ply, Move moves[42] ) {
+		return m_player.makeMove( board, pieces, score, player ); }
+	bool getMoveUtility( float* utility ) { return m_player.getMoveUtility( utility ); }
+
+private:
+	Monte m_player;
+};
+
+// Self-play adapter construction
+static SelfPlayEngine* createEngine( ) { return new MonteSelfPlay; }
+
 // Application entry point
 int main( int argc, char* argv[] )
 {
+	// Play headless self-play games for training data
+	if( argc > 1 && std::string( argv[1] ) == "-selfplay" )
+		return SelfPlay::runCommand( argc-2, argv+2, &createEngine, false );
+
 	// AI Player
 	Monte player;
 
@@ -65,7 +87,8 @@ int main( int argc, char* argv[] )
 	// Main program loop
 	while( !gameData->matchOver ) {
 		if( gameData->turnReady ) {
-			gameData->move = player.makeMove( gameData->board, gameData->pieces, gameData->score, gameData->player );
+			gameData->move = player.makeMove( gameData->board, gameData->pieces, 
+				gameData->score, gameData->player );
 			gameData->moveReady = TRUE; gameData->turnReady = FALSE; } }
 
 	// Shutdown ai player
@@ -0,0 +1,287 @@
+/* ============================================================================
+
+    Project: Blokus AI - Neural Network Trainer
+
+    Implements writing and memory mapping of binary training datasets.
+
+    File: Dataset.cpp
+
+============================================================================= */
+
+// Local includes
+#include "Dataset.h"
+
+// Standard library includes
+#include <cstring>
+#include <fstream>
+#include <math.h>
+
+// --------------------------------------------------------
+// Constructor
+// --------------------------------------------------------
+Dataset::Dataset() : m_file(INVALID_HANDLE_VALUE), m_mapping(NULL),
+    m_view(NULL), m_records(NULL), m_count(0), m_clock(0) {
+    memset(m_views, 0, sizeof(m_views));
+    InitializeCriticalSection(&m_lock);
+}
+
+// --------------------------------------------------------
+// Destructor
+// --------------------------------------------------------
+Dataset::~Dataset() {
+    close();
+    DeleteCriticalSection(&m_lock);
+}
+
+// --------------------------------------------------------
+// Writes the header and records to a dataset file
+// --------------------------------------------------------
+bool Dataset::write(const char *filename,
+    const PositionRecord *records, int count) {
+    std::ofstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    DatasetHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DATASET_MAGIC, sizeof(header.magic));
+    header.recordSize = sizeof(PositionRecord);
+    header.count = count;
+
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)records, sizeof(PositionRecord)*count);
+    return file.good();
+}
+
+// --------------------------------------------------------
+// Appends a game to the end of a dataset file
+// --------------------------------------------------------
+bool Dataset::appendGame(const char *filename,
+    PositionRecord *records, int count) {
+    std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file.is_open()) {
+        for (int i = 0; i < count; i++) {
+            records[i].game = 0;
+        }
+        return write(filename, records, count);
+    }
+
+    // Check the header against the file
+    DatasetHeader header;
+    if (!file.read((char*)&header, sizeof(header)) ||
+        memcmp(header.magic, DATASET_MAGIC, sizeof(header.magic)) != 0 ||
+        header.recordSize != sizeof(PositionRecord) ||
+        header.count + (unsigned __int64)count > 0xFFFFFFFF) {
+        return false;
+    }
+
+    // Number the game after the last record
+    unsigned int game = 0;
+    if (header.count > 0) {
+        PositionRecord last;
+        file.seekg(sizeof(header) + (std::streamoff)(header.count-1)*sizeof(PositionRecord));
+        if (!file.read((char*)&last, sizeof(last))) {
+            return false;
+        }
+        game = last.game + 1;
+    }
+    for (int i = 0; i < count; i++) {
+        records[i].game = game;
+    }
+
+    // Write the records after the last one, then the new count
+    file.seekp(sizeof(header) + (std::streamoff)header.count*sizeof(PositionRecord));
+    file.write((const char*)records, sizeof(PositionRecord)*count);
+    header.count += count;
+    file.seekp(0);
+    file.write((const char*)&header, sizeof(header));
+    return file.good();
+}
+
+// --------------------------------------------------------
+// Maps the dataset file and validates its header
+// --------------------------------------------------------
+bool Dataset::open(const char *filename) {
+    close();
+
+    // Open the file and check its header
+    m_file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    DatasetHeader header;
+    DWORD nRead;
+    if (!GetFileSizeEx(m_file, &fileSize) ||
+        !ReadFile(m_file, &header, sizeof(header), &nRead, NULL) ||
+        nRead != sizeof(header) ||
+        memcmp(header.magic, DATASET_MAGIC, sizeof(header.magic)) != 0 ||
+        header.recordSize != sizeof(PositionRecord) ||
+        (unsigned __int64)fileSize.QuadPart < sizeof(DatasetHeader) +
+            (unsigned __int64)header.count*sizeof(PositionRecord)) {
+        close(); return false;
+    }
+    m_count = header.count;
+
+    // Map the whole file read-only if the address space has room
+    // for it, otherwise its views are mapped as they are read
+    m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (m_mapping == NULL) {
+        close(); return false;
+    }
+    if ((unsigned __int64)fileSize.QuadPart <= (SIZE_T)-1) {
+        m_view = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+    if (m_view != NULL) {
+        m_records = (const PositionRecord*)((const DatasetHeader*)m_view + 1);
+    } else if (m_count > 0 && mapView(0) == NULL) {
+        close(); return false;
+    }
+
+    return true;
+}
+
+// --------------------------------------------------------
+// Unmaps the dataset file
+// --------------------------------------------------------
+void Dataset::close() {
+    if (m_view != NULL) {
+        UnmapViewOfFile(m_view);
+    }
+    for (int i = 0; i < DATASET_VIEWS; i++) {
+        if (m_views[i].base != NULL) {
+            UnmapViewOfFile(m_views[i].base);
+        }
+    }
+    if (m_mapping != NULL) {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+    }
+    m_file = INVALID_HANDLE_VALUE;
+    m_mapping = NULL;
+    m_view = NULL;
+    m_records = NULL;
+    m_count = 0;
+    memset(m_views, 0, sizeof(m_views));
+}
+
+// --------------------------------------------------------
+// Copies a record from the whole file or from its view,
+// a zeroed record if the view could not be mapped
+// --------------------------------------------------------
+bool Dataset::read(__int64 index, PositionRecord *record) const {
+    if (m_records != NULL) {
+        *record = m_records[index];
+        return true;
+    }
+
+    EnterCriticalSection(&m_lock);
+    const View *view = mapView(index);
+    if (view != NULL) {
+        *record = view->records[index - view->first];
+    } else {
+        memset(record, 0, sizeof(*record));
+    }
+    LeaveCriticalSection(&m_lock);
+    return view != NULL;
+}
+
+// --------------------------------------------------------
+// Returns the view holding a record, replacing the least
+// recently used view with the window of the record if no
+// view holds it. Returns NULL if it could not be mapped.
+// --------------------------------------------------------
+const Dataset::View *Dataset::mapView(__int64 index) const {
+    for (int i = 0; i < DATASET_VIEWS; i++) {
+        View &view = m_views[i];
+        if (view.base != NULL && index >= view.first &&
+            index < view.first + view.count) {
+            view.used = ++m_clock;
+            return &view;
+        }
+    }
+
+    // Release the least recently used view
+    View *view = &m_views[0];
+    for (int i = 1; i < DATASET_VIEWS; i++) {
+        if (m_views[i].used < view->used) {
+            view = &m_views[i];
+        }
+    }
+    if (view->base != NULL) {
+        UnmapViewOfFile(view->base);
+        view->base = NULL;
+    }
+
+    // Map the window of the record from the allocation
+    // granularity boundary before it
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    __int64 first = index / DATASET_WINDOW * DATASET_WINDOW;
+    __int64 count = (m_count - first < DATASET_WINDOW) ? m_count - first : DATASET_WINDOW;
+    unsigned __int64 offset = sizeof(DatasetHeader) + first*sizeof(PositionRecord);
+    unsigned __int64 start = offset - offset % info.dwAllocationGranularity;
+    const void *base = MapViewOfFile(m_mapping, FILE_MAP_READ,
+        (DWORD)(start >> 32), (DWORD)start,
+        (SIZE_T)(offset - start + count*sizeof(PositionRecord)));
+    if (base == NULL) {
+        return NULL;
+    }
+
+    view->base = base;
+    view->records = (const PositionRecord*)((const char*)base + (offset - start));
+    view->first = first;
+    view->count = count;
+    view->used = ++m_clock;
+    return view;
+}
+
+// --------------------------------------------------------
+// Counts the tiles of a player
+// --------------------------------------------------------
+int PositionRecord::getScore(int player) const {
+    int score = 0;
+    for (int x = 0; x < 14; x++) {
+        for (int y = 0; y < 14; y++) {
+            score += (getSquare(x, y) == RECORD_BLUE + player);
+        }
+    }
+    return score;
+}
+
+// --------------------------------------------------------
+// Converts the search score from half precision
+// --------------------------------------------------------
+float PositionRecord::getSearch() const {
+    if (!hasSearch()) {
+        return 0.0f;
+    }
+    int exponent = (search >> 10) & 0x1F;
+    float value = (exponent == 0) ? ldexpf((float)(search & 0x3FF), -24) :
+        ldexpf((float)((search & 0x3FF) | 0x400), exponent - 25);
+    return (search & 0x8000) ? -value : value;
+}
+
+// --------------------------------------------------------
+// Converts the search score to half precision, rounding to
+// the nearest value and saturating at the largest
+// --------------------------------------------------------
+void PositionRecord::setSearch(float value) {
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    unsigned short sign = (unsigned short)((bits >> 16) & 0x8000);
+    int exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+    unsigned int mantissa = (bits & 0x7FFFFF) | 0x800000;
+
+    unsigned int half;
+    if (exponent <= 0) {
+        half = (exponent < -10) ? 0 : (mantissa + (1 << (13 - exponent))) >> (14 - exponent);
+    } else {
+        half = ((unsigned int)exponent << 10) + (((mantissa & 0x7FFFFF) + 0x1000) >> 13);
+    }
+    search = (unsigned short)(sign | ((half < 0x7C00) ? half : 0x7BFF));
+}
@@ -0,0 +1,145 @@
+/* ============================================================================
+
+    Project: Blokus AI - Neural Network Trainer
+
+    Defines the binary training dataset, a file of fixed-size position
+    records which is memory mapped for training without any parsing.
+
+    File: Dataset.h
+
+============================================================================= */
+
+#ifndef DATASET_H
+#define DATASET_H
+
+#include <windows.h>
+
+// Dataset file identifier and version
+#define DATASET_MAGIC "BLKDSET2"
+
+// Records of each view of a file which can not be mapped whole, and the
+// number of views kept mapped
+#define DATASET_WINDOW (1<<20)
+#define DATASET_VIEWS  4
+
+// Board square values in a position record
+#define RECORD_EMPTY 0
+#define RECORD_BLUE  1
+#define RECORD_GOLD  2
+
+// Search score of positions without one, a half precision NaN
+#define RECORD_NO_SEARCH 0x7E00
+
+// -----------------------------------------------------------------------------
+// A single training position, padded to 64 bytes so records never straddle
+// a cache line in the mapped file.
+// -----------------------------------------------------------------------------
+struct PositionRecord {
+    unsigned char board[49];    // 2 bits per square, square x*14+y
+    unsigned char pieces[2][3]; // Available pieces, bit j of byte i is piece 8i+j
+    unsigned char player;       // Player to move
+    unsigned char result;       // Label, the game score in percent for blue
+    unsigned char ply;          // Ply of the position within its game
+    unsigned short search;      // Search score of the move played for blue
+                                // as a half precision float
+    unsigned int game;          // Index of the game within the dataset
+
+    // Square value accessors
+    int getSquare(int x, int y) const {
+        int i = x*14+y; return (board[i>>2] >> ((i&3)*2)) & 3;
+    }
+    void setSquare(int x, int y, int value) {
+        int i = x*14+y; board[i>>2] |= (unsigned char)(value << ((i&3)*2));
+    }
+
+    // Tiles placed by a player, counted from the board
+    int getScore(int player) const;
+
+    // Search score accessors, the score is in the units of the engine
+    // which played the game
+    bool hasSearch() const { return search != RECORD_NO_SEARCH; }
+    float getSearch() const;
+    void setSearch(float value);
+};
+
+// -----------------------------------------------------------------------------
+// Dataset file header, padded to 64 bytes to keep the records aligned
+// -----------------------------------------------------------------------------
+struct DatasetHeader {
+    char magic[8];
+    unsigned int recordSize;
+    unsigned int count;
+    unsigned char reserved[48];
+};
+
+class Dataset {
+    public:
+        Dataset();
+        ~Dataset();
+
+        // ---------------------------------------------------------------------
+        // Writes the records to a dataset file, overwriting an existing
+        // file. Returns false if the file could not be written.
+        // ---------------------------------------------------------------------
+        static bool write(const char *filename,
+            const PositionRecord *records, int count);
+
+        // ---------------------------------------------------------------------
+        // Appends the records of a game to a dataset file, creating it if it
+        // does not exist. The records are given the index after the last
+        // game of the file. Returns false if the file could not be written
+        // or is not a dataset file.
+        // ---------------------------------------------------------------------
+        static bool appendGame(const char *filename,
+            PositionRecord *records, int count);
+
+        // ---------------------------------------------------------------------
+        // Maps a dataset file into memory read-only. A file too large for
+        // the address space is mapped in views of DATASET_WINDOW records
+        // as they are read. Returns false if the file could not be mapped
+        // or is not a dataset file.
+        // ---------------------------------------------------------------------
+        bool open(const char *filename);
+
+        // ---------------------------------------------------------------------
+        // Unmaps the dataset file
+        // ---------------------------------------------------------------------
+        void close();
+
+        // ---------------------------------------------------------------------
+        // Copies a record, mapping the view holding it if the file is not
+        // mapped whole. Safe to call from several threads. Returns false if
+        // the view could not be mapped.
+        // ---------------------------------------------------------------------
+        bool read(__int64 index, PositionRecord *record) const;
+
+        __int64 size() const { return m_count; }
+
+        // Records of a file mapped whole, NULL if it is mapped in views
+        const PositionRecord *records() const { return m_records; }
+
+    private:
+        // A mapped view of the records from first
+        struct View {
+            const void *base;
+            const PositionRecord *records;
+            __int64 first;
+            __int64 count;
+            unsigned int used;
+        };
+
+        const View *mapView(__int64 index) const;
+
+        HANDLE m_file;
+        HANDLE m_mapping;
+        const void *m_view;
+        const PositionRecord *m_records;
+        __int64 m_count;
+
+        // Views of a file mapped in windows, least recently used replaced
+        mutable View m_views[DATASET_VIEWS];
+        mutable unsigned int m_clock;
+        mutable CRITICAL_SECTION m_lock;
+};
+
+#endif /* DATASET_H */
@@ -0,0 +1,62 @@
+/* ============================================================================
+
+    Project: Blokus AI - Neural Network Trainer
+
+    Converts networks saved as text by NeuralNetwork::DumpData to binary
+    model files, either in the NeuralNetwork layout or as Nnue weights
+    which the engine maps and evaluates in place.
+
+    Usage: ModelConvert <network.txt> <model file> [network|nnue|quantised]
+
+    File: ModelConvert.cpp
+
+============================================================================= */
+
+#include <iostream>
+#include <cstring>
+
+#include "NeuralNetwork.h"
+#include "Nnue.h"
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0]
+            << " <network.txt> <model file> [network|nnue|quantised]" << std::endl;
+        return 1;
+    }
+    const char *format = (argc > 3) ? argv[3] : "network";
+
+    NeuralNetwork network;
+    if (!network.LoadData(argv[1])) {
+        std::cerr << "Error occurred while loading " << argv[1] << std::endl;
+        return 1;
+    }
+
+    bool saved = false;
+    if (strcmp(format, "network") == 0) {
+        saved = network.DumpBinary(argv[2]);
+    } else if (strcmp(format, "nnue") == 0 || strcmp(format, "quantised") == 0) {
+        Nnue nnue;
+        if (!nnue.load(network)) {
+            std::cerr << argv[1] << " does not have the Nnue topology" << std::endl;
+            network.Cleanup();
+            return 1;
+        }
+        if (strcmp(format, "quantised") == 0) {
+            nnue.quantise();
+        }
+        saved = nnue.save(argv[2]);
+    } else {
+        std::cerr << "Unknown format " << format << std::endl;
+        network.Cleanup();
+        return 1;
+    }
+    network.Cleanup();
+
+    if (!saved) {
+        std::cerr << "Error occurred while writing " << argv[2] << std::endl;
+        return 1;
+    }
+    std::cout << "Saved " << argv[2] << std::endl;
+    return 0;
+}
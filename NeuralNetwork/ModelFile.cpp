@@ -0,0 +1,126 @@
+/* ============================================================================
+
+    Project: Blokus AI - Neural Network Trainer
+
+    Implements writing and memory mapping of binary model files.
+
+    File: ModelFile.cpp
+
+============================================================================= */
+
+// Local includes
+#include "ModelFile.h"
+
+// Standard library includes
+#include <cstring>
+#include <fstream>
+
+// --------------------------------------------------------
+// Constructor
+// --------------------------------------------------------
+ModelFile::ModelFile() : m_file(INVALID_HANDLE_VALUE), m_mapping(NULL),
+    m_header(NULL) {
+}
+
+// --------------------------------------------------------
+// Destructor
+// --------------------------------------------------------
+ModelFile::~ModelFile() {
+    close();
+}
+
+// --------------------------------------------------------
+// FNV-1a hash of a block of memory
+// --------------------------------------------------------
+unsigned int ModelFile::checksum(const void *data, unsigned int size) {
+    const unsigned char *bytes = (const unsigned char*)data;
+    unsigned int hash = 2166136261U;
+    for (unsigned int i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619U;
+    }
+    return hash;
+}
+
+// --------------------------------------------------------
+// Writes the header and weights to a model file
+// --------------------------------------------------------
+bool ModelFile::write(const char *filename, ModelHeader &header,
+    const void *data, unsigned int dataSize) {
+    memcpy(header.magic, MODEL_MAGIC, sizeof(header.magic));
+    header.version = MODEL_VERSION;
+    header.dataSize = dataSize;
+    header.checksum = checksum(data, dataSize);
+
+    std::ofstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)data, dataSize);
+    return file.good();
+}
+
+// --------------------------------------------------------
+// Checks the identifier of a file
+// --------------------------------------------------------
+bool ModelFile::isModelFile(const char *filename) {
+    std::ifstream file(filename, std::ios::in | std::ios::binary);
+    char magic[8];
+    return file.read(magic, sizeof(magic)) &&
+        memcmp(magic, MODEL_MAGIC, sizeof(magic)) == 0;
+}
+
+// --------------------------------------------------------
+// Maps the model file and validates its header
+// --------------------------------------------------------
+bool ModelFile::open(const char *filename) {
+    close();
+
+    // Map the whole file read-only
+    m_file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    DWORD fileSize = GetFileSize(m_file, NULL);
+    if (fileSize < sizeof(ModelHeader)) {
+        close(); return false;
+    }
+    m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (m_mapping == NULL) {
+        close(); return false;
+    }
+    m_header = (const ModelHeader*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (m_header == NULL) {
+        close(); return false;
+    }
+
+    // Check the header and weights against the file
+    if (memcmp(m_header->magic, MODEL_MAGIC, sizeof(m_header->magic)) != 0 ||
+        m_header->version != MODEL_VERSION ||
+        m_header->nLayers > MODEL_MAX_LAYERS ||
+        fileSize < sizeof(ModelHeader) + m_header->dataSize ||
+        checksum(data(), m_header->dataSize) != m_header->checksum) {
+        close(); return false;
+    }
+
+    return true;
+}
+
+// --------------------------------------------------------
+// Unmaps the model file
+// --------------------------------------------------------
+void ModelFile::close() {
+    if (m_header != NULL) {
+        UnmapViewOfFile(m_header);
+    }
+    if (m_mapping != NULL) {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+    }
+    m_file = INVALID_HANDLE_VALUE;
+    m_mapping = NULL;
+    m_header = NULL;
+}
@@ -0,0 +1,100 @@
+/* ============================================================================
+
+    Project: Blokus AI - Neural Network Trainer
+
+    Defines the binary model file, a header describing the network followed
+    by its weights in aligned blobs. Files are memory mapped so an engine can
+    evaluate with the weights in place.
+
+    File: ModelFile.h
+
+============================================================================= */
+
+#ifndef MODEL_FILE_H
+#define MODEL_FILE_H
+
+#include <windows.h>
+
+// Model file identifier and version
+#define MODEL_MAGIC   "BLKMODEL"
+#define MODEL_VERSION 1
+
+// Alignment of each blob of weights within the file
+#define MODEL_ALIGNMENT 64
+
+// Most layers a model file describes
+#define MODEL_MAX_LAYERS 8
+
+// Weight layouts
+enum ModelType {
+    MODEL_NETWORK,       // NeuralNetwork layers as 32 bit floats
+    MODEL_NNUE,          // Nnue weights as 32 bit floats
+    MODEL_NNUE_QUANTISED // Nnue weights as 8 and 16 bit integers
+};
+
+// -----------------------------------------------------------------------------
+// Model file header, padded to 128 bytes to keep the weights aligned
+// -----------------------------------------------------------------------------
+struct ModelHeader {
+    char magic[8];
+    unsigned int version;
+    unsigned int type;                   // Weight layout, a ModelType
+    unsigned int nLayers;                // Layers including the inputs
+    unsigned int dataSize;               // Bytes of weights after the header
+    unsigned int checksum;               // FNV-1a hash of the weights
+    unsigned int policy;                 // Outputs of the policy head, 0 for none
+    int nodes[MODEL_MAX_LAYERS];         // Node count of each layer
+    int activations[MODEL_MAX_LAYERS];   // Activation of each layer
+    unsigned char reserved[32];
+};
+
+class ModelFile {
+    public:
+        ModelFile();
+        ~ModelFile();
+
+        // ---------------------------------------------------------------------
+        // Fills in the identifier and checksum of the header and writes it
+        // with the weights, overwriting an existing file. Returns false if
+        // the file could not be written.
+        // ---------------------------------------------------------------------
+        static bool write(const char *filename, ModelHeader &header,
+            const void *data, unsigned int dataSize);
+
+        // ---------------------------------------------------------------------
+        // Checks whether a file starts with the model file identifier
+        // ---------------------------------------------------------------------
+        static bool isModelFile(const char *filename);
+
+        // Rounds an offset up to the blob alignment
+        static unsigned int align(unsigned int offset) {
+            return (offset + MODEL_ALIGNMENT-1) & ~(MODEL_ALIGNMENT-1);
+        }
+
+        // ---------------------------------------------------------------------
+        // Maps a model file into memory read-only. Returns false if the file
+        // could not be mapped, is of another version or fails its checksum.
+        // ---------------------------------------------------------------------
+        bool open(const char *filename);
+
+        // ---------------------------------------------------------------------
+        // Unmaps the model file
+        // ---------------------------------------------------------------------
+        void close();
+
+        const ModelHeader *header() const { return m_header; }
+        const char *data() const { return (const char*)(m_header + 1); }
+
+    private:
+        static unsigned int checksum(const void *data, unsigned int size);
+
+        HANDLE m_file;
+        HANDLE m_mapping;
+        const ModelHeader *m_header;
+
+        // Mappings are not shared
+        ModelFile(const ModelFile&);
+        ModelFile &operator=(const ModelFile&);
+};
+
+#endif /* MODEL_FILE_H */
@@ -13,6 +13,7 @@
 
 // Local includes
 #include "NetworkTrainer.h"
+#include "Symmetry.h"
 
 // Standard library includes
 #include <cstring>
@@ -20,13 +21,23 @@
 #include <sstream>
 #include <string>
 #include <iostream>
+#include <algorithm>
+#include <ctime>
+#include <cmath>
+#include <cfloat>
+#include <climits>
+
+// Threading
+#include <process.h>
 
 // ------------------------------------------------------
 // Creates a new neural network with the given inputs
 // ------------------------------------------------------
 NetworkTrainer::NetworkTrainer(double learningRate, double momentum, 
     bool linearOutput) : m_numberOfPlayers(2), m_currentPly(0), 
-    m_currentPlayer(0)
+    m_currentPlayer(0), m_recording(NULL), m_plyInterval(0),
+    m_replicasInitialized(false), m_records(NULL), m_nRecords(0),
+    m_symmetries(1), m_nnueInputs(false)
 {
 	// Load game piece layouts 
 	m_gamePieceLayouts = PieceSet::instance( );
@@ -38,7 +49,7 @@ NetworkTrainer::NetworkTrainer(double learningRate, double momentum,
 	}
 	m_network.SetLinearOutput(linearOutput);
 	
-    m_network.Initialize(204, 10, 2);
+    m_network.Initialize(TRAINER_INPUTS, 10, TRAINER_OUTPUTS);
 }
 
 // -------------------------------------------------------
@@ -46,11 +57,14 @@ NetworkTrainer::NetworkTrainer(double learningRate, double momentum,
 // further training.
 // -------------------------------------------------------
 NetworkTrainer::NetworkTrainer(const char *filename) : m_numberOfPlayers(2),
-    m_currentPly(0), m_currentPlayer(0) {
+    m_currentPly(0), m_currentPlayer(0), m_recording(NULL), m_plyInterval(0),
+    m_replicasInitialized(false), m_records(NULL), m_nRecords(0),
+    m_symmetries(1), m_nnueInputs(false) {
     m_gamePieceLayouts = PieceSet::instance();
     if (!m_network.LoadData(filename)) {
         throw 1;
     }
+    m_nnueInputs = (m_network.Layers.front().NumberOfNodes == NNUE_FEATURES);
 }
 
 // -------------------------------------------------------
@@ -58,6 +72,9 @@ NetworkTrainer::NetworkTrainer(const char *filename) : m_numberOfPlayers(2),
 // -------------------------------------------------------
 NetworkTrainer::~NetworkTrainer() {
     m_network.Cleanup();
+    for (int i = 0; i < TRAINER_THREADS; i++) {
+        m_replicas[i].Cleanup();
+    }
 }
 
 // --------------------------------------------------------
@@ -71,42 +88,10 @@ bool NetworkTrainer::train(const char* filename)
 	    return false;
     }
 	
-	// Inputs: one for each board square (196), 
-    // one for packed piece array (6), one for current player (1),
-    // one for each score (2)
-	
-	// Set board neuron inputs
-	for(int i = 0; i < 14; i++) {
-	    for(int j = 0; j < 14; j++) {
-	        m_network.SetInput(i+j, m_board[i][j]);
-	    }
-	}
-	
-	// Pack pieces array
-	int piecesOut[2][3];
-	for( int p = 0; p < 2; p++ ) {
-	    for( int i = 0; i < 3; i++ ) {
-	        piecesOut[p][i] = 0;
-	        for( int j = 0; j < 8; j++ ) {
-	            if( 8*i+j >= 21 ) {
-	                continue; 
-	            } else { 
-	                piecesOut[p][i] |= (m_pieces[p][8*i+j] << j); 
-	            }
-	        }
-	    }
-	}
-	
-	// Set remaining piece inputs
-	for(int i = 0; i < 3; i++) {
-	    m_network.SetInput(196+2*i, piecesOut[0][i]);
-	    m_network.SetInput(196+2*i+1, piecesOut[1][i]);
-	}
-	
-	// And misc other inputs
-	m_network.SetInput(201, m_currentPlayer);
-	m_network.SetInput(202, m_scores[0]);
-	m_network.SetInput(203, m_scores[1]);
+	// Set the neuron inputs from the final position
+	float inputs[TRAINER_MAX_INPUTS];
+	encodeInputs(makeRecord(), inputs);
+	setInputs(m_network, inputs);
 	
 	// Set desired neuron outputs using this function
 	m_network.SetDesiredOutput(0, m_score/100.0);
@@ -134,42 +119,10 @@ VerifyResult NetworkTrainer::verify(const char *filename) {
 	    return result;
     }
 	
-	// Inputs: one for each board square (196), 
-    // one for each remaining piece (6), one for current player (1),
-    // one for each score (2)
-	
-	// Set board neuron inputs
-	for(int i = 0; i < 14; i++) {
-	    for(int j = 0; j < 14; j++) {
-	        m_network.SetInput(i+j, m_board[i][j]);
-	    }
-	}
-	
-    // Pack pieces array
-	int piecesOut[2][3];
-	for( int p = 0; p < 2; p++ ) {
-	    for( int i = 0; i < 3; i++ ) {
-	        piecesOut[p][i] = 0;
-	        for( int j = 0; j < 8; j++ ) {
-	            if( 8*i+j >= 21 ) {
-	                continue; 
-	            } else { 
-	                piecesOut[p][i] |= (m_pieces[p][8*i+j] << j); 
-	            }
-	        }
-	    }
-	}
-	
-	// Set remaining piece inputs
-	for(int i = 0; i < 21; i++) {
-	    m_network.SetInput(196+2*i, m_pieces[0][i]);
-	    m_network.SetInput(196+2*i+1, m_pieces[1][i]);
-	}
-	
-	// And misc other inputs
-	m_network.SetInput(201, m_currentPlayer);
-	m_network.SetInput(202, m_scores[0]);
-	m_network.SetInput(203, m_scores[1]);
+	// Set the neuron inputs from the final position
+	float inputs[TRAINER_MAX_INPUTS];
+	encodeInputs(makeRecord(), inputs);
+	setInputs(m_network, inputs);
 	
 	// And calculate the output
 	m_network.FeedForward();
@@ -189,6 +142,86 @@ void NetworkTrainer::save(const char *filename) {
     m_network.DumpData(filename);
 }
 
+// --------------------------------------------------------
+// Checks the quantised network before saving it
+// --------------------------------------------------------
+bool NetworkTrainer::exportNnue(const char *filename, double tolerance) {
+    Nnue reference, quantised;
+    if (!m_nnueInputs || !reference.load(m_network) || !quantised.load(m_network)) {
+        std::cout << "The network does not have the Nnue topology" << std::endl;
+        return false;
+    }
+    quantised.quantise();
+    if (!m_policyWeights.empty()) {
+        quantised.setPolicy(&m_policyWeights[0], &m_policyBiases[0]);
+    }
+    
+    int nValidation = (int)m_validation.size();
+    if (nValidation == 0) {
+        std::cout << "No validation positions are loaded" << std::endl;
+        return false;
+    }
+    
+    // Compare the outputs on the validation positions
+    std::vector<NnueAccumulator> floatSums(nValidation), quantisedSums(nValidation);
+    double maxError = 0.0, sumError = 0.0;
+    for (int k = 0; k < nValidation; k++) {
+        PositionRecord record;
+        if (!getSample(m_validation[k], &record)) {
+            std::cout << "Could not read the validation positions" << std::endl;
+            return false;
+        }
+        int features[NNUE_FEATURES];
+        int nFeatures = getFeatures(record, features);
+        reference.refresh(features, nFeatures, &floatSums[k]);
+        quantised.refresh(features, nFeatures, &quantisedSums[k]);
+        double error = fabs(reference.evaluate(&floatSums[k], record.player) -
+            quantised.evaluate(&quantisedSums[k], record.player));
+        maxError = (error > maxError) ? error : maxError;
+        sumError += error;
+    }
+    std::cout << "Quantised error: mean " << sumError / nValidation
+        << ", max " << maxError << std::endl;
+    
+    // Time the later layers of both networks
+    int repeats = 1 + 200000 / nValidation;
+    Nnue *networks[2] = { &reference, &quantised };
+    std::vector<NnueAccumulator> *sums[2] = { &floatSums, &quantisedSums };
+    const char *names[2] = { "Float", "Quantised" };
+    for (int n = 0; n < 2; n++) {
+        clock_t start = clock();
+        for (int r = 0; r < repeats; r++) {
+            for (int k = 0; k < nValidation; k++) {
+                networks[n]->evaluate(&(*sums[n])[k], k&1);
+            }
+        }
+        double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        std::cout << names[n] << ": " << 1e6 * seconds / ((double)repeats * nValidation)
+            << " us/evaluation, " << networks[n]->size() << " bytes" << std::endl;
+    }
+    
+    // Time the policy head, one pass of which scores every move
+    if (quantised.hasPolicy()) {
+        float logits[NNUE_POLICY];
+        clock_t start = clock();
+        for (int r = 0; r < repeats; r++) {
+            for (int k = 0; k < nValidation; k++) {
+                quantised.policy(&quantisedSums[k], k&1, logits);
+            }
+        }
+        double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        std::cout << "Policy: " << 1e6 * seconds / ((double)repeats * nValidation)
+            << " us/position" << std::endl;
+    }
+    
+    if (maxError > tolerance) {
+        std::cout << "Quantised error exceeds the tolerance of " << tolerance << std::endl;
+        return false;
+    }
+    
+    return quantised.save(filename);
+}
+
 // --------------------------------------------------------
 // Loads the given save file and sets our internal vars
 // --------------------------------------------------------
@@ -203,7 +236,16 @@ bool NetworkTrainer::loadFile(const char *filename) {
 	
 	// Initialize values
 	memset(m_board, 0, sizeof(m_board));
+	memset(m_scores, 0, sizeof(m_scores));
 	m_score = 50;
+	m_hasScore = false;
+	m_currentPly = 0;
+	m_currentPlayer = 0;
+	for (int p = 0; p < 2; p++) {
+	    for (int i = 0; i < 21; i++) {
+	        m_pieces[p][i] = true;
+	    }
+	}
 
 	// Parse file using newline and space delimiters 
 	std::string line; while( std::getline( file, line ) )
@@ -224,6 +266,7 @@ bool NetworkTrainer::loadFile(const char *filename) {
 			else if( token.compare("Wait_Game") == 0 ) ;
 			else if( token.compare("Score") == 0) {
 			    iss >> m_score;
+			    m_hasScore = true;
 			}
 			else if( token.compare("Start_Tile") == 0) ;
 
@@ -272,20 +315,829 @@ bool NetworkTrainer::loadFile(const char *filename) {
 	return true;
 }
 
+// --------------------------------------------------------
+// Records the loaded position, the label and game index
+// are set once the whole game has been loaded
+// --------------------------------------------------------
+PositionRecord NetworkTrainer::makeRecord() {
+    PositionRecord record;
+    memset(&record, 0, sizeof(record));
+    
+    // Board squares
+    for(int i = 0; i < 14; i++) {
+        for(int j = 0; j < 14; j++) {
+            record.setSquare(i, j, m_board[i][j]);
+        }
+    }
+    
+    // Pack pieces array
+    for( int p = 0; p < 2; p++ ) {
+        for( int i = 0; i < 21; i++ ) {
+            record.pieces[p][i/8] |= (unsigned char)(m_pieces[p][i] << (i%8));
+        }
+    }
+    
+    // And misc other data
+    record.player = (unsigned char)m_currentPlayer;
+    record.ply = (unsigned char)m_currentPly;
+    record.search = RECORD_NO_SEARCH;
+    
+    return record;
+}
+
+// --------------------------------------------------------
+// Encodes a position record as network inputs: one for
+// each board square (196), the packed piece arrays (6),
+// the current player (1) and each score (2)
+// --------------------------------------------------------
+void NetworkTrainer::encodeInputs(const PositionRecord &record, float *inputs) const {
+    if (m_nnueInputs) {
+        encodeFeatures(record, inputs);
+        return;
+    }
+    
+    // Board inputs, positive for blue and negative for gold
+    static const float squareInputs[4] = { 0.0f, 1.0f, -1.0f, 0.0f };
+    for(int i = 0; i < 14; i++) {
+        for(int j = 0; j < 14; j++) {
+            inputs[i*14+j] = squareInputs[record.getSquare(i, j)];
+        }
+    }
+    
+    // Remaining piece inputs
+    for(int i = 0; i < 3; i++) {
+        inputs[196+2*i] = (float)record.pieces[0][i];
+        inputs[196+2*i+1] = (float)record.pieces[1][i];
+    }
+    
+    // And misc other inputs
+    inputs[201] = (float)record.player;
+    inputs[202] = (float)record.getScore(0);
+    inputs[203] = (float)record.getScore(1);
+}
+
+// --------------------------------------------------------
+// Encodes a position record as Nnue features
+// --------------------------------------------------------
+void NetworkTrainer::encodeFeatures(const PositionRecord &record, float *inputs) {
+    for(int i = 0; i < NNUE_FEATURES; i++) {
+        inputs[i] = 0.0f;
+    }
+    
+    int features[NNUE_FEATURES];
+    int nFeatures = getFeatures(record, features);
+    for(int i = 0; i < nFeatures; i++) {
+        inputs[features[i]] = 1.0f;
+    }
+    inputs[NNUE_SIDE_FEATURE] = (record.player == 0) ? 1.0f : 0.0f;
+}
+
+// --------------------------------------------------------
+// Lists the active Nnue features of a position record,
+// except the player to move. Returns the feature count.
+// --------------------------------------------------------
+int NetworkTrainer::getFeatures(const PositionRecord &record, int *features) {
+    int nFeatures = 0;
+    
+    // Covered tiles
+    for(int i = 0; i < 14; i++) {
+        for(int j = 0; j < 14; j++) {
+            int square = record.getSquare(i, j);
+            if(square == RECORD_BLUE || square == RECORD_GOLD) {
+                features[nFeatures++] = Nnue::cellFeature(i, j, square - RECORD_BLUE);
+            }
+        }
+    }
+    
+    // Remaining pieces
+    for(int p = 0; p < 2; p++) {
+        for(int i = 0; i < NNUE_PIECES; i++) {
+            if(record.pieces[p][i/8] & (1 << (i%8))) {
+                features[nFeatures++] = Nnue::pieceFeature(i, p);
+            }
+        }
+    }
+    
+    return nFeatures;
+}
+
+// --------------------------------------------------------
+// Sets the input neurons of a network
+// --------------------------------------------------------
+void NetworkTrainer::setInputs(NeuralNetwork &network, const float *inputs) {
+    int nInputs = network.Layers.front().NumberOfNodes;
+    for(int i = 0; i < nInputs; i++) {
+        network.SetInput(i, inputs[i]);
+    }
+}
+
+// --------------------------------------------------------
+// Loads and labels the sampled positions of save games
+// --------------------------------------------------------
+int NetworkTrainer::loadGames(const char *directory,
+    std::vector<PositionRecord> &records, int plyInterval) {
+    records.clear();
+    
+    // Find the save files in the directory
+    std::string path = std::string(directory) + "\\";
+    WIN32_FIND_DATAA findData;
+    HANDLE find = FindFirstFileA((path + "*.sav").c_str(), &findData);
+    if (find == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    
+    // Replay each game, recording the sampled plies
+    int nGames = 0;
+    do {
+        size_t first = records.size();
+        m_recording = &records;
+        m_plyInterval = plyInterval;
+        bool loaded = loadFile((path + findData.cFileName).c_str());
+        m_recording = NULL;
+        if (!loaded) {
+            records.resize(first);
+            continue;
+        }
+        if (plyInterval <= 0) {
+            records.push_back(makeRecord());
+        }
+
+        // Label the positions with the score of the game, or the
+        // final result for blue if the file has no score
+        int result = 50;
+        if (m_hasScore) {
+            result = (int)(m_score + 0.5);
+            result = (result < 0) ? 0 : ((result > 100) ? 100 : result);
+        } else if (m_scores[0] != m_scores[1]) {
+            result = (m_scores[0] > m_scores[1]) ? 100 : 0;
+        }
+        for (size_t i = first; i < records.size(); i++) {
+            records[i].result = (unsigned char)result;
+            records[i].game = nGames;
+        }
+        nGames++;
+    } while (FindNextFileA(find, &findData));
+    FindClose(find);
+    
+    return nGames;
+}
+
+// --------------------------------------------------------
+// Loads the save games of a directory as samples
+// --------------------------------------------------------
+int NetworkTrainer::loadSamples(const char *directory,
+    double validationFraction, int plyInterval) {
+    m_dataset.close();
+    loadGames(directory, m_samples, plyInterval);
+    
+    m_nRecords = (int)m_samples.size();
+    m_records = m_nRecords ? &m_samples[0] : NULL;
+    splitSamples(validationFraction);
+    
+    return m_nRecords;
+}
+
+// --------------------------------------------------------
+// Converts the save games of a directory into a dataset
+// --------------------------------------------------------
+int NetworkTrainer::buildDataset(const char *directory, const char *filename,
+    int plyInterval) {
+    std::vector<PositionRecord> records;
+    int nGames = loadGames(directory, records, plyInterval);
+    
+    int nRecords = (int)records.size();
+    if (!Dataset::write(filename, nRecords ? &records[0] : NULL, nRecords)) {
+        return -1;
+    }
+    
+    std::cout << "Wrote " << nRecords << " positions from " << nGames
+        << " games to " << filename << std::endl;
+    return nRecords;
+}
+
+// --------------------------------------------------------
+// Maps a dataset file as the samples
+// --------------------------------------------------------
+int NetworkTrainer::loadDataset(const char *filename, double validationFraction) {
+    m_samples.clear();
+    bool opened = m_dataset.open(filename);
+    if (!opened || m_dataset.size() > INT_MAX/SYMMETRY_COUNT) {
+        if (opened) {
+            std::cout << filename << " has more records than can be sampled" << std::endl;
+            m_dataset.close();
+        }
+        m_records = NULL;
+        m_nRecords = 0;
+        splitSamples(validationFraction);
+        return -1;
+    }
+    
+    m_records = m_dataset.records();
+    m_nRecords = (int)m_dataset.size();
+    if (!splitSamples(validationFraction)) {
+        std::cout << "Could not read the records of " << filename << std::endl;
+        m_dataset.close();
+        m_records = NULL;
+        m_nRecords = 0;
+        return -1;
+    }
+    
+    return m_nRecords;
+}
+
+// --------------------------------------------------------
+// Splits the samples by game into training and validation,
+// training on every symmetry of a record and validating
+// on the record as played
+// --------------------------------------------------------
+bool NetworkTrainer::splitSamples(double validationFraction) {
+    m_training.clear();
+    m_validation.clear();
+    
+    int interval = validationFraction > 0.0 ?
+        (int)(1.0/validationFraction + 0.5) : 0;
+    for (int i = 0; i < m_nRecords; i++) {
+        PositionRecord record;
+        if (!getRecord(i, &record)) {
+            m_training.clear();
+            m_validation.clear();
+            return false;
+        }
+        if (interval && record.game % interval == interval-1) {
+            m_validation.push_back(i*m_symmetries);
+        } else {
+            for (int s = 0; s < m_symmetries; s++) {
+                m_training.push_back(i*m_symmetries + s);
+            }
+        }
+    }
+    
+    return true;
+}
+
+// --------------------------------------------------------
+// Renumbers the loaded samples for a new symmetry count
+// --------------------------------------------------------
+void NetworkTrainer::setAugmentation(int symmetries) {
+    symmetries = (symmetries < 1) ? 1 :
+        ((symmetries > SYMMETRY_COUNT) ? SYMMETRY_COUNT : symmetries);
+    
+    std::vector<int> training, validation;
+    for (size_t k = 0; k < m_training.size(); k++) {
+        if (m_training[k] % m_symmetries == 0) {
+            for (int s = 0; s < symmetries; s++) {
+                training.push_back(m_training[k] / m_symmetries * symmetries + s);
+            }
+        }
+    }
+    for (size_t k = 0; k < m_validation.size(); k++) {
+        validation.push_back(m_validation[k] / m_symmetries * symmetries);
+    }
+    
+    m_training.swap(training);
+    m_validation.swap(validation);
+    m_symmetries = symmetries;
+}
+
+// --------------------------------------------------------
+// Reads a record from the loaded samples, the whole mapped
+// dataset or a view of it
+// --------------------------------------------------------
+bool NetworkTrainer::getRecord(int index, PositionRecord *record) const {
+    if (m_records != NULL) {
+        *record = m_records[index];
+        return true;
+    }
+    return m_dataset.read(index, record);
+}
+
+// --------------------------------------------------------
+// Returns the record of a sample mirrored by the symmetry
+// of the sample. A colour swapping symmetry exchanges the
+// players, so the label is taken for the other side and
+// the search score, in unknown engine units, is dropped.
+// --------------------------------------------------------
+bool NetworkTrainer::getSample(int sample, PositionRecord *sampleRecord) const {
+    PositionRecord record;
+    if (!getRecord(sample / m_symmetries, &record)) {
+        return false;
+    }
+    int symmetry = sample % m_symmetries;
+    if (symmetry == SYMMETRY_IDENTITY) {
+        *sampleRecord = record;
+        return true;
+    }
+    
+    // Mirror the board squares
+    PositionRecord &mirrored = *sampleRecord;
+    mirrored = record;
+    memset(mirrored.board, 0, sizeof(mirrored.board));
+    bool swap = Symmetry::swapsColours(symmetry);
+    for (int i = 0; i < 14; i++) {
+        for (int j = 0; j < 14; j++) {
+            int x, y, square = record.getSquare(i, j);
+            Symmetry::mapTile(symmetry, i, j, &x, &y);
+            if (swap && square != RECORD_EMPTY) {
+                square = RECORD_BLUE + RECORD_GOLD - square;
+            }
+            mirrored.setSquare(x, y, square);
+        }
+    }
+    
+    // Exchange the players
+    if (swap) {
+        memcpy(mirrored.pieces[0], record.pieces[1], sizeof(record.pieces[1]));
+        memcpy(mirrored.pieces[1], record.pieces[0], sizeof(record.pieces[0]));
+        mirrored.player = (unsigned char)(1 - record.player);
+        mirrored.result = (unsigned char)(100 - record.result);
+        mirrored.search = RECORD_NO_SEARCH;
+    }
+    
+    return true;
+}
+
+// --------------------------------------------------------
+// Trains the network with mini-batches for some epochs
+// --------------------------------------------------------
+bool NetworkTrainer::trainEpochs(int epochs, int batchSize) {
+    // Create the replica networks on first use
+    if (!m_replicasInitialized) {
+        for (int i = 0; i < TRAINER_THREADS; i++) {
+            m_replicas[i].InitializeReplica(m_network);
+        }
+        m_replicasInitialized = true;
+    }
+    
+    // Check the inference time against the search leaf budget
+    double inference = m_network.MeasureInference(10000);
+    std::cout << "Inference " << inference << " us/position" << std::endl;
+    if (inference > TRAINER_LEAF_BUDGET) {
+        std::cout << "Warning: inference exceeds the leaf budget of "
+            << TRAINER_LEAF_BUDGET << " us" << std::endl;
+    }
+    
+    for (int epoch = 1; epoch <= epochs; epoch++) {
+        // Shuffle the training samples
+        std::random_shuffle(m_training.begin(), m_training.end());
+
+        // Train on each batch
+        clock_t start = clock();
+        double trainLoss = 0.0;
+        int nTraining = (int)m_training.size();
+        for (int i = 0; i < nTraining; i += batchSize) {
+            int count = (nTraining - i < batchSize) ? nTraining - i : batchSize;
+            double loss;
+            if (!runBatch(&m_training[i], count, true, &loss)) {
+                std::cout << "Could not read the samples of a batch, training "
+                    << "stopped in epoch " << epoch << std::endl;
+                return false;
+            }
+            trainLoss += loss;
+        }
+        double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        if (seconds < 1e-3) {
+            seconds = 1e-3;
+        }
+
+        // Validate the epoch
+        double validationLoss = 0.0;
+        int nValidation = (int)m_validation.size();
+        if (nValidation && !runBatch(&m_validation[0], nValidation, false,
+            &validationLoss)) {
+            std::cout << "Could not read the validation samples, training "
+                << "stopped in epoch " << epoch << std::endl;
+            return false;
+        }
+
+        // Report the losses and throughput
+        std::cout << "Epoch " << epoch
+            << ", training loss " << (nTraining ? trainLoss / nTraining : 0.0)
+            << ", validation loss " << (nValidation ? validationLoss / nValidation : 0.0)
+            << ", " << (int)(nTraining / seconds) << " positions/s" << std::endl;
+    }
+    
+    return true;
+}
+
+// --------------------------------------------------------
+// Uses Adam for mini-batch updates
+// --------------------------------------------------------
+void NetworkTrainer::setAdam(double learningRate) {
+    m_network.SetLearningRate(learningRate);
+    m_network.SetAdam(true);
+}
+
+// --------------------------------------------------------
+// Creates a new network with the given hidden layers
+// --------------------------------------------------------
+void NetworkTrainer::setTopology(const std::vector<int> &hiddenNodes,
+    int activation) {
+    std::vector<int> nodes, activations;
+    nodes.push_back(TRAINER_INPUTS);
+    activations.push_back(ACTIVATION_LINEAR);
+    for (size_t i = 0; i < hiddenNodes.size(); i++) {
+        nodes.push_back(hiddenNodes[i]);
+        activations.push_back(activation);
+    }
+    nodes.push_back(TRAINER_OUTPUTS);
+    activations.push_back(m_network.OutputActivation);
+    m_network.Initialize(nodes, activations);
+    m_nnueInputs = false;
+
+    // Replicas are recreated with the new topology
+    m_replicasInitialized = false;
+    m_policyWeights.clear();
+    m_policyBiases.clear();
+}
+
+// --------------------------------------------------------
+// Creates a new network on the Nnue features
+// --------------------------------------------------------
+void NetworkTrainer::setNnueTopology(const std::vector<int> &hiddenNodes) {
+    std::vector<int> nodes, activations;
+    nodes.push_back(NNUE_FEATURES);
+    activations.push_back(ACTIVATION_LINEAR);
+    nodes.push_back(NNUE_HIDDEN);
+    activations.push_back(ACTIVATION_RELU);
+    for (size_t i = 0; i < hiddenNodes.size(); i++) {
+        nodes.push_back(hiddenNodes[i]);
+        activations.push_back(ACTIVATION_RELU);
+    }
+    nodes.push_back(TRAINER_OUTPUTS);
+    activations.push_back(m_network.OutputActivation);
+    m_network.Initialize(nodes, activations);
+    m_nnueInputs = true;
+
+    m_replicasInitialized = false;
+    m_policyWeights.clear();
+    m_policyBiases.clear();
+}
+
+// --------------------------------------------------------
+// Trains the policy head on the fixed accumulator
+// --------------------------------------------------------
+int NetworkTrainer::trainPolicy(int epochs, int batchSize, double learningRate) {
+    Nnue nnue;
+    if (!m_nnueInputs || !nnue.load(m_network)) {
+        std::cout << "The network does not have the Nnue topology" << std::endl;
+        return 0;
+    }
+    
+    // Keep the samples with a move played
+    std::vector<int> training, validation;
+    PositionRecord record;
+    int piece, cells[5][2], nCells;
+    bool labelled;
+    for (size_t k = 0; k < m_training.size(); k++) {
+        if (!getMoveTarget(m_training[k], &record, &piece, cells, &nCells, &labelled)) {
+            std::cout << "Could not read the training samples" << std::endl;
+            return -1;
+        }
+        if (labelled) {
+            training.push_back(m_training[k]);
+        }
+    }
+    for (size_t k = 0; k < m_validation.size(); k++) {
+        if (!getMoveTarget(m_validation[k], &record, &piece, cells, &nCells, &labelled)) {
+            std::cout << "Could not read the validation samples" << std::endl;
+            return -1;
+        }
+        if (labelled) {
+            validation.push_back(m_validation[k]);
+        }
+    }
+    if (training.empty()) {
+        std::cout << "No samples are labelled with a move" << std::endl;
+        return 0;
+    }
+    
+    if (m_policyWeights.empty()) {
+        m_policyWeights.assign(NNUE_POLICY*NNUE_HIDDEN, 0.0f);
+        m_policyBiases.assign(NNUE_POLICY, 0.0f);
+    }
+    std::vector<float> gradWeights(NNUE_POLICY*NNUE_HIDDEN), gradBiases(NNUE_POLICY);
+    
+    for (int epoch = 1; epoch <= epochs; epoch++) {
+        std::random_shuffle(training.begin(), training.end());
+        
+        // Train on each batch
+        double trainLoss = 0.0;
+        int nTraining = (int)training.size();
+        for (int i = 0; i < nTraining; i += batchSize) {
+            int count = (nTraining - i < batchSize) ? nTraining - i : batchSize;
+            std::fill(gradWeights.begin(), gradWeights.end(), 0.0f);
+            std::fill(gradBiases.begin(), gradBiases.end(), 0.0f);
+            for (int k = i; k < i + count; k++) {
+                bool hit;
+                if (!getMoveTarget(training[k], &record, &piece, cells, &nCells, &labelled)) {
+                    std::cout << "Could not read the samples of a batch, training "
+                        << "stopped in epoch " << epoch << std::endl;
+                    return -1;
+                }
+                trainLoss += policyLoss(nnue, record, piece, cells, nCells,
+                    &gradWeights[0], &gradBiases[0], &hit);
+            }
+            float step = (float)(learningRate / count);
+            for (int w = 0; w < NNUE_POLICY*NNUE_HIDDEN; w++) {
+                m_policyWeights[w] -= step*gradWeights[w];
+            }
+            for (int b = 0; b < NNUE_POLICY; b++) {
+                m_policyBiases[b] -= step*gradBiases[b];
+            }
+        }
+        
+        // Validate the epoch
+        double validationLoss = 0.0;
+        int nValidation = (int)validation.size(), hits = 0;
+        for (int k = 0; k < nValidation; k++) {
+            bool hit;
+            if (!getMoveTarget(validation[k], &record, &piece, cells, &nCells, &labelled)) {
+                std::cout << "Could not read the validation samples, training "
+                    << "stopped in epoch " << epoch << std::endl;
+                return -1;
+            }
+            validationLoss += policyLoss(nnue, record, piece, cells, nCells,
+                NULL, NULL, &hit);
+            hits += hit ? 1 : 0;
+        }
+        
+        std::cout << "Epoch " << epoch
+            << ", policy training loss " << trainLoss / nTraining
+            << ", validation loss " << (nValidation ? validationLoss / nValidation : 0.0)
+            << ", piece accuracy " << (nValidation ? 100.0 * hits / nValidation : 0.0)
+            << "%" << std::endl;
+    }
+    
+    return (int)training.size();
+}
+
+// --------------------------------------------------------
+// Compares a sample with the next record of its game, in
+// the same symmetry, to find the move played from it
+// --------------------------------------------------------
+bool NetworkTrainer::getMoveTarget(int sample, PositionRecord *sampleRecord,
+    int *piece, int cells[][2], int *nCells, bool *labelled) const {
+    *labelled = false;
+    if (!getSample(sample, sampleRecord)) {
+        return false;
+    }
+    const PositionRecord &record = *sampleRecord;
+    PositionRecord next;
+    if (sample / m_symmetries + 1 >= m_nRecords) {
+        return true;
+    }
+    if (!getSample(sample + m_symmetries, &next)) {
+        return false;
+    }
+    if (next.game != record.game) {
+        return true;
+    }
+    
+    // Exactly one piece of the player to move was placed
+    int player = record.player, nPlaced = 0;
+    for (int p = 0; p < 2; p++) {
+        for (int i = 0; i < NNUE_PIECES; i++) {
+            int bit = 1 << (i%8);
+            if ((record.pieces[p][i/8] & bit) && !(next.pieces[p][i/8] & bit)) {
+                *piece = i;
+                nPlaced += (p == player) ? 1 : 2;
+            }
+        }
+    }
+    if (nPlaced != 1) {
+        return true;
+    }
+    
+    // Cells it covered
+    *nCells = 0;
+    for (int i = 0; i < 14; i++) {
+        for (int j = 0; j < 14; j++) {
+            if (record.getSquare(i, j) == RECORD_EMPTY &&
+                next.getSquare(i, j) == RECORD_BLUE + player && *nCells < 5) {
+                cells[*nCells][0] = i;
+                cells[*nCells][1] = j;
+                (*nCells)++;
+            }
+        }
+    }
+    
+    *labelled = *nCells > 0;
+    return true;
+}
+
+// --------------------------------------------------------
+// Cross entropy of the softmax over the pieces left with
+// the piece played, plus that of the softmax over the
+// empty cells with the covered cells weighted equally
+// --------------------------------------------------------
+double NetworkTrainer::policyLoss(const Nnue &nnue, const PositionRecord &record,
+    int piece, const int cells[][2], int nCells, float *gradWeights,
+    float *gradBiases, bool *hit) const {
+
+    // Run the head on the activated accumulator
+    int features[NNUE_FEATURES];
+    int nFeatures = getFeatures(record, features);
+    NnueAccumulator accumulator;
+    float values[NNUE_HIDDEN], logits[NNUE_POLICY], target[NNUE_POLICY];
+    bool legal[NNUE_POLICY];
+    nnue.refresh(features, nFeatures, &accumulator);
+    nnue.transform(&accumulator, record.player, values);
+    for (int k = 0; k < NNUE_POLICY; k++) {
+        const float *row = &m_policyWeights[k*NNUE_HIDDEN];
+        float x = m_policyBiases[k];
+        for (int j = 0; j < NNUE_HIDDEN; j++) {
+            x += row[j]*values[j];
+        }
+        logits[k] = x;
+        target[k] = 0.0f;
+    }
+    
+    // Outputs taking part in each softmax and their targets
+    for (int i = 0; i < NNUE_PIECES; i++) {
+        legal[Nnue::piecePolicy(i)] =
+            (record.pieces[record.player][i/8] & (1 << (i%8))) != 0;
+    }
+    for (int i = 0; i < 14; i++) {
+        for (int j = 0; j < 14; j++) {
+            legal[Nnue::cellPolicy(i, j)] = (record.getSquare(i, j) == RECORD_EMPTY);
+        }
+    }
+    target[Nnue::piecePolicy(piece)] = 1.0f;
+    for (int c = 0; c < nCells; c++) {
+        target[Nnue::cellPolicy(cells[c][0], cells[c][1])] = 1.0f / nCells;
+    }
+    
+    // Softmax over the pieces, then over the cells
+    double loss = 0.0;
+    int ranges[2][2] = { { 0, NNUE_PIECES }, { NNUE_PIECES, NNUE_POLICY } };
+    for (int r = 0; r < 2; r++) {
+        float maxLogit = -FLT_MAX;
+        int best = -1;
+        for (int k = ranges[r][0]; k < ranges[r][1]; k++) {
+            if (legal[k] && logits[k] > maxLogit) {
+                maxLogit = logits[k];
+                best = k;
+            }
+        }
+        double sum = 0.0;
+        for (int k = ranges[r][0]; k < ranges[r][1]; k++) {
+            sum += legal[k] ? exp(logits[k] - maxLogit) : 0.0;
+        }
+        for (int k = ranges[r][0]; k < ranges[r][1]; k++) {
+            if (!legal[k]) {
+                continue;
+            }
+            double p = exp(logits[k] - maxLogit) / sum;
+            if (target[k] > 0.0f) {
+                loss -= target[k] * log(p > 1e-30 ? p : 1e-30);
+            }
+            if (gradWeights != NULL) {
+                float delta = (float)(p - target[k]);
+                gradBiases[k] += delta;
+                for (int j = 0; j < NNUE_HIDDEN; j++) {
+                    gradWeights[k*NNUE_HIDDEN+j] += delta*values[j];
+                }
+            }
+        }
+        if (r == 0) {
+            *hit = (best == Nnue::piecePolicy(piece));
+        }
+    }
+    
+    return loss;
+}
+
+// --------------------------------------------------------
+// Computes a batch split across the replica networks and
+// applies the summed deltas when training
+// --------------------------------------------------------
+bool NetworkTrainer::runBatch(const int *samples, int count, bool train,
+    double *loss) {
+    // Launch the threads on contiguous ranges of the batch
+    BatchWork work[TRAINER_THREADS];
+    HANDLE threadHandles[TRAINER_THREADS];
+    for (int i = 0; i < TRAINER_THREADS; i++) {
+        int first = count*i/TRAINER_THREADS;
+        work[i].trainer = this;
+        work[i].network = &m_replicas[i];
+        work[i].samples = samples + first;
+        work[i].count = count*(i+1)/TRAINER_THREADS - first;
+        work[i].train = train;
+        work[i].loss = 0.0;
+        work[i].failed = false;
+        m_replicas[i].CopyWeights(m_network);
+        if (train) {
+            m_replicas[i].ClearDeltas();
+        }
+        threadHandles[i] = (HANDLE)_beginthreadex(NULL, 0,
+            &processBatch, (void*)&work[i], 0, NULL);
+    }
+    
+    // Wait for all of the threads
+    WaitForMultipleObjects(TRAINER_THREADS, threadHandles, TRUE, INFINITE);
+    for (int i = 0; i < TRAINER_THREADS; i++) {
+        CloseHandle(threadHandles[i]);
+    }
+    
+    // Drop the batch if any of its samples could not be read
+    for (int i = 0; i < TRAINER_THREADS; i++) {
+        if (work[i].failed) {
+            return false;
+        }
+    }
+    
+    // Reduce the losses and apply the deltas
+    *loss = 0.0;
+    if (train) {
+        m_network.ClearDeltas();
+    }
+    for (int i = 0; i < TRAINER_THREADS; i++) {
+        *loss += work[i].loss;
+        if (train) {
+            m_network.AddDeltas(m_replicas[i]);
+        }
+    }
+    if (train) {
+        m_network.ApplyDeltas(count);
+    }
+    
+    return true;
+}
+
+// --------------------------------------------------------
+// Starting address of batch threads
+// --------------------------------------------------------
+unsigned int __stdcall NetworkTrainer::processBatch(void *data) {
+    BatchWork *work = (BatchWork*)data;
+    NetworkTrainer *trainer = work->trainer;
+    NeuralNetwork &network = *work->network;
+    
+    for (int k = 0; k < work->count; k++) {
+        int i = work->samples[k];
+
+        // Compute the outputs of the sample
+        PositionRecord record;
+        if (!trainer->getSample(i, &record)) {
+            work->failed = true;
+            break;
+        }
+        float inputs[TRAINER_MAX_INPUTS];
+        trainer->encodeInputs(record, inputs);
+        trainer->setInputs(network, inputs);
+        network.SetDesiredOutput(0, record.result/100.0);
+        network.SetDesiredOutput(1, 1.0 - record.result/100.0);
+        network.FeedForward();
+        work->loss += network.CalculateError();
+
+        // Add the deltas of the sample
+        if (work->train) {
+            network.Accumulate();
+        }
+    }
+    
+    return 0;
+}
+
+// --------------------------------------------------------
+// Checks whether covering the tiles is a valid move for
+// the player: the tiles must touch a corner and no edge
+// of the player's tiles. A player's first move is always
+// taken to be valid.
+// --------------------------------------------------------
+bool NetworkTrainer::isValidFor(int player, int tiles[][2], int nTiles) {
+    if (m_scores[player] == 0) {
+        return true;
+    }
+    
+    char own = (char)(RECORD_BLUE + player);
+    bool corner = false;
+    for (int i = 0; i < nTiles; i++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            for (int dy = -1; dy <= 1; dy++) {
+                int x = tiles[i][0] + dx, y = tiles[i][1] + dy;
+                if ((dx == 0 && dy == 0) || x < 0 || x >= 14 || y < 0 || y >= 14 ||
+                    m_board[x][y] != own) {
+                    continue;
+                }
+                if (dx == 0 || dy == 0) {
+                    return false;
+                }
+                corner = true;
+            }
+        }
+    }
+    
+    return corner;
+}
+
 // --------------------------------------------------------
 //	Updates the game data to reflect the execution of the
 //  valid input move.
 // --------------------------------------------------------
 void NetworkTrainer::makeMove( Move move )
 {
-    // Add the move to the move history
-	m_moveHistory[m_currentPly] = move;
-	m_currentPly++;
-	
-	// Update piece registry
-	m_pieces[m_currentPlayer][move.pieceNumber] = false;
-
-	// Iterate over piece pattern and update game board
+	// Iterate over piece pattern to find the covered tiles
+	int tiles[25][2], nTiles = 0;
 	int gx = move.gridX, gy = move.gridY;
 	int x = m_gamePieceLayouts->getSizeX( move.pieceNumber );
 	int y = m_gamePieceLayouts->getSizeY( move.pieceNumber );
@@ -295,51 +1147,70 @@ void NetworkTrainer::makeMove( Move move )
 			for( int j = 0, gy = move.gridY; j < y; j++,gy++ )
 			for( int i = 0, gx = move.gridX; i < x; i++,gx++ )
 				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = m_currentPlayer; }
+					{ tiles[nTiles][0] = gx; tiles[nTiles][1] = gy; nTiles++; } }
 
 		else if( move.rotated == PIECE_ROTATE_90 ) {
 			for( int i = x-1, gy = move.gridY; i >= 0; i--,gy++ )
 			for( int j =   0, gx = move.gridX; j <  y; j++,gx++ )
 				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = m_currentPlayer; }
+					{ tiles[nTiles][0] = gx; tiles[nTiles][1] = gy; nTiles++; } }
 
 		else if( move.rotated == PIECE_ROTATE_180 ) {
 			for( int j = y-1, gy = move.gridY; j >= 0; j--,gy++ )
 			for( int i = x-1, gx = move.gridX; i >= 0; i--,gx++ )
 				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = m_currentPlayer; }
+					{ tiles[nTiles][0] = gx; tiles[nTiles][1] = gy; nTiles++; } }
 
 		else if( move.rotated == PIECE_ROTATE_270 ) {
 			for( int i =   0, gy = move.gridY; i <  x; i++,gy++ )
 			for( int j = y-1, gx = move.gridX; j >= 0; j--,gx++ )
 				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = m_currentPlayer; }
+					{ tiles[nTiles][0] = gx; tiles[nTiles][1] = gy; nTiles++; } }
 	} else {
 		if( move.rotated == PIECE_ROTATE_0 ) {
 			for( int j =   0, gy = move.gridY; j <  y; j++,gy++ )
 			for( int i = x-1, gx = move.gridX; i >= 0; i--,gx++ )
 				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = m_currentPlayer; }
+					{ tiles[nTiles][0] = gx; tiles[nTiles][1] = gy; nTiles++; } }
 
 		else if( move.rotated == PIECE_ROTATE_90 ) {
 			for( int i = x-1, gy = move.gridY; i >= 0; i--,gy++ )
 			for( int j = y-1, gx = move.gridX; j >= 0; j--,gx++ )
 				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = m_currentPlayer; }
+					{ tiles[nTiles][0] = gx; tiles[nTiles][1] = gy; nTiles++; } }
 
 		else if( move.rotated == PIECE_ROTATE_180 ) {
 			for( int j = y-1, gy = move.gridY; j >= 0; j--,gy++ )
 			for( int i =   0, gx = move.gridX; i <  x; i++,gx++ )
 				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = m_currentPlayer; }
+					{ tiles[nTiles][0] = gx; tiles[nTiles][1] = gy; nTiles++; } }
 
 		else if( move.rotated == PIECE_ROTATE_270 ) {
 			for( int i = 0, gy = move.gridY; i < x; i++,gy++ )
 			for( int j = 0, gx = move.gridX; j < y; j++,gx++ )
 				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = m_currentPlayer; }
+					{ tiles[nTiles][0] = gx; tiles[nTiles][1] = gy; nTiles++; } }
 	}
 
+	// Skipped turns are not saved, so a move which is not valid
+	// for the current player was made by the next player
+	if( !isValidFor( m_currentPlayer, tiles, nTiles ) ) {
+		m_currentPlayer++; m_currentPlayer %= m_numberOfPlayers; }
+
+	// Record the position before the move when sampling plies
+	if( m_recording != NULL && m_plyInterval > 0 &&
+		m_currentPly % m_plyInterval == 0 )
+		m_recording->push_back( makeRecord( ) );
+
+    // Add the move to the move history
+	m_moveHistory[m_currentPly] = move;
+	m_currentPly++;
+	
+	// Update piece registry and game board
+	m_pieces[m_currentPlayer][move.pieceNumber] = false;
+	for( int i = 0; i < nTiles; i++ )
+		m_board[tiles[i][0]][tiles[i][1]] = (char)( RECORD_BLUE + m_currentPlayer );
+
 	// Update player score variable
 	if     ( move.pieceNumber < 1 ) m_scores[m_currentPlayer] += 1;
 	else if( move.pieceNumber < 2 ) m_scores[m_currentPlayer] += 2;
@@ -352,8 +1223,8 @@ void NetworkTrainer::makeMove( Move move )
 	m_currentPlayer++; m_currentPlayer %= m_numberOfPlayers;
 	
 	// Skip turns for players unable to move
-	// NOTE: Not supported yet! Don't use positions with skip moves or
-	// end of game positions
+	// NOTE: Not supported yet! Skips are inferred from the next move
+	// instead, so the player to move at the end of a game may be wrong
 	/*
 	while( !isMoveAvailable( ) && prevPlayer != m_currentPlayer)
 	{
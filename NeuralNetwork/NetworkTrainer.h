@@ -15,9 +15,27 @@
 #define NETWORK_TRAINER_H
 
 #include "NeuralNetwork.h"
+#include "Dataset.h"
+#include "Nnue.h"
 #include "PieceSet.h"
 #include "Types.h"
 
+#include <vector>
+#include <windows.h>
+
+// Network inputs and outputs
+#define TRAINER_INPUTS  204
+#define TRAINER_OUTPUTS 2
+
+// Largest input encoding, the features of an accumulator network
+#define TRAINER_MAX_INPUTS NNUE_FEATURES
+
+// Number of threads computing each mini-batch
+#define TRAINER_THREADS 4
+
+// Inference budget per search leaf in microseconds
+#define TRAINER_LEAF_BUDGET 10.0
+
 struct VerifyResult {
     double networkOutput1; // Result from the first output neuron
     double networkOutput2; // Result from the second output neuron
@@ -59,19 +77,173 @@ class NetworkTrainer {
         // ---------------------------------------------------------------------
         void save(const char *filename);
         
+        // ---------------------------------------------------------------------
+        // Quantises a network on the Nnue features and compares it to the
+        // floating point network on the validation positions, reporting the
+        // output error, evaluation time and size of both. Saves the quantised
+        // network as a model file if the largest error is within the
+        // tolerance, for the engine to map and evaluate in place, with the
+        // policy head if one has been trained. Returns whether the network
+        // was saved.
+        // ---------------------------------------------------------------------
+        bool exportNnue(const char *filename, double tolerance = 0.02);
+        
         // ---------------------------------------------------------------------
         // Reads the saved game file given by the file, and obtains the 
         // neural network output. Returns a pair of floats representing the
         // neural network output and the score given in the file.
         // ---------------------------------------------------------------------        
         VerifyResult verify(const char *filename);
+        
+        // ---------------------------------------------------------------------
+        // Loads the positions of each save game in the given directory as
+        // training samples, holding out a fraction of the games for
+        // validation. Every plyInterval'th ply is sampled, or only the final
+        // position if zero. Returns the number of samples loaded.
+        // ---------------------------------------------------------------------
+        int loadSamples(const char *directory, double validationFraction = 0.1,
+            int plyInterval = 0);
+        
+        // ---------------------------------------------------------------------
+        // Converts the save games in the given directory into a binary
+        // dataset file of position records, sampling every plyInterval'th
+        // ply or only the final position if zero. Returns the number of
+        // records written, or -1 if the file could not be written.
+        // ---------------------------------------------------------------------
+        int buildDataset(const char *directory, const char *filename,
+            int plyInterval = 1);
+        
+        // ---------------------------------------------------------------------
+        // Memory maps a dataset file as the training samples, holding out a
+        // fraction of the games for validation. Returns the number of
+        // samples, or -1 if the file could not be mapped or has more
+        // samples than can be numbered.
+        // ---------------------------------------------------------------------
+        int loadDataset(const char *filename, double validationFraction = 0.1);
+        
+        // ---------------------------------------------------------------------
+        // Trains on each position mirrored by the given number of board
+        // symmetries of Blokus Duo: 2 doubles the training samples with the
+        // reflection in the diagonal through the start tiles, 4 adds the
+        // colour swapped reflections. Validation uses the positions as
+        // played. Applies to the loaded samples and any loaded later.
+        // ---------------------------------------------------------------------
+        void setAugmentation(int symmetries);
+        
+        // ---------------------------------------------------------------------
+        // Trains the network on the loaded samples with mini-batches. Each
+        // epoch shuffles the training samples, then the deltas of each batch
+        // are summed over TRAINER_THREADS threads and applied with momentum
+        // or Adam. Prints the training and validation loss and the
+        // throughput in positions per second after every epoch. Warns
+        // when inference exceeds TRAINER_LEAF_BUDGET per position. Stops
+        // with an error and returns false if the samples of a batch could
+        // not be read, discarding that batch.
+        // ---------------------------------------------------------------------
+        bool trainEpochs(int epochs, int batchSize = 256);
+        
+        // ---------------------------------------------------------------------
+        // Applies mini-batch deltas with Adam at the given learning rate
+        // instead of momentum.
+        // ---------------------------------------------------------------------
+        void setAdam(double learningRate);
+        
+        // ---------------------------------------------------------------------
+        // Replaces the network with a new one with the given hidden layer
+        // sizes, each using the given activation. The output layer keeps
+        // its activation. Discards any trained weights.
+        // ---------------------------------------------------------------------
+        void setTopology(const std::vector<int> &hiddenNodes,
+            int activation = ACTIVATION_RELU);
+        
+        // ---------------------------------------------------------------------
+        // Replaces the network with one for Nnue: the position features as
+        // inputs, a ReLU layer of NNUE_HIDDEN nodes for the accumulator, then
+        // the given ReLU hidden layers. Discards any trained weights.
+        // ---------------------------------------------------------------------
+        void setNnueTopology(const std::vector<int> &hiddenNodes);
+        
+        // ---------------------------------------------------------------------
+        // Trains a policy head on the accumulator of an Nnue network for some
+        // epochs, leaving the network itself unchanged. Each sample is
+        // labelled with the move played from it, found from the record of
+        // the next ply of its game, so only datasets which record every ply
+        // are labelled. The head predicts the piece played with a softmax
+        // over the pieces left and the cells it covers with a softmax over
+        // the empty cells. Prints the losses and how often the piece played
+        // has the greatest logit after every epoch. The head is saved by
+        // exportNnue and discarded with the network. Returns the number of
+        // labelled training samples, or -1 if the samples could not be read.
+        // ---------------------------------------------------------------------
+        int trainPolicy(int epochs, int batchSize = 256, double learningRate = 0.1);
     
     private:
+        // Multi-threading work communication structure
+        struct BatchWork {
+            NetworkTrainer *trainer;
+            NeuralNetwork *network;
+            const int *samples;
+            int count;
+            bool train;
+            double loss;
+            bool failed;
+        };
+    
         bool loadFile(const char *filename);
         void makeMove(Move move); 
+        bool isValidFor(int player, int tiles[][2], int nTiles);
+        
+        // Loads the sampled positions of the save games in a directory,
+        // labelled with the score of their game. Returns the game count.
+        int loadGames(const char *directory,
+            std::vector<PositionRecord> &records, int plyInterval);
+        
+        // Records the loaded position
+        PositionRecord makeRecord();
+        
+        // Encodes a position record as network inputs, either the
+        // position summary or the Nnue features
+        void encodeInputs(const PositionRecord &record, float *inputs) const;
+        static void encodeFeatures(const PositionRecord &record, float *inputs);
+        static int getFeatures(const PositionRecord &record, int *features);
+        void setInputs(NeuralNetwork &network, const float *inputs);
+        
+        // Holds out every n'th game of the samples for validation. Returns
+        // false, with no samples split, if a record could not be read.
+        bool splitSamples(double validationFraction);
+        
+        // Reads a loaded or mapped record. Returns false if the view of the
+        // dataset holding it could not be mapped.
+        bool getRecord(int index, PositionRecord *record) const;
+        
+        // Reads the position of a sample, the record index times the
+        // symmetry count plus the symmetry it is mirrored by. Returns false
+        // if its record could not be read.
+        bool getSample(int sample, PositionRecord *record) const;
+        
+        // Reads a sample and finds the piece and cells of the move played
+        // from it. Sets labelled to false if the next record of the game is
+        // not the position after a single move of the player to move.
+        // Returns false if either record could not be read.
+        bool getMoveTarget(int sample, PositionRecord *record, int *piece,
+            int cells[][2], int *nCells, bool *labelled) const;
+        
+        // Computes the policy loss of a sample labelled with the move played,
+        // adding the gradients of the policy head if given. Sets whether the
+        // piece played has the greatest logit.
+        double policyLoss(const Nnue &nnue, const PositionRecord &record,
+            int piece, const int cells[][2], int nCells, float *gradWeights,
+            float *gradBiases, bool *hit) const;
+        
+        // Computes the loss, and deltas if training, of a batch of samples
+        // on the replica networks, setting the summed loss. Returns false,
+        // leaving the network unchanged, if a sample could not be read.
+        bool runBatch(const int *samples, int count, bool train, double *loss);
+        static unsigned int __stdcall processBatch(void *data);
     
         char m_board[14][14];
         double m_score;
+        bool m_hasScore;
         bool m_pieces[2][21];
         int m_currentPlayer;
         int m_scores[2];
@@ -80,6 +252,27 @@ class NetworkTrainer {
         Move m_moveHistory[42];
 	    PieceSet* m_gamePieceLayouts;
         NeuralNetwork m_network;
+        bool m_nnueInputs;
+        
+        // Positions recorded while loading a save game
+        std::vector<PositionRecord> *m_recording;
+        int m_plyInterval;
+        
+        // Mini-batch training data, either loaded or mapped. The records
+        // pointer is NULL when the dataset is mapped in views.
+        NeuralNetwork m_replicas[TRAINER_THREADS];
+        bool m_replicasInitialized;
+        std::vector<PositionRecord> m_samples;
+        Dataset m_dataset;
+        const PositionRecord *m_records;
+        int m_nRecords;
+        int m_symmetries;
+        std::vector<int> m_training;
+        std::vector<int> m_validation;
+        
+        // Policy head, NNUE_POLICY rows of NNUE_HIDDEN weights
+        std::vector<float> m_policyWeights;
+        std::vector<float> m_policyBiases;
 };
 
 #endif /* NETWORK_TRAINER_H */
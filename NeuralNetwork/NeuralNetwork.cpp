@@ -33,6 +33,7 @@
 #include <sstream>
 #include <string.h>
 #include <math.h>
+#include <time.h>
 
 // Include Layers
 #include "NeuralNetworkLayer.h"
@@ -40,74 +41,115 @@
 // Include header
 #include "NeuralNetwork.h"
 
-// Initializes the neural network
+// Binary model files
+#include "ModelFile.h"
+
+// Activation function names used by the save format
+const char* NeuralNetwork::ActivationName[ACTIVATION_COUNT] = {
+	"sigmoid", "relu", "linear" };
+
+// Constructor
+NeuralNetwork::NeuralNetwork( )
+{
+	LearningRate = 1.0;
+	UseMomentum = false;
+	MomentumFactor = 0.9;
+	UseAdam = false;
+	OutputActivation = ACTIVATION_SIGMOID;
+}
+
+// Initializes a sigmoid neural network with one hidden layer
 void NeuralNetwork::Initialize( int nNodesInput, 
 								int nNodesHidden, 
 								int nNodesOutput )
 {
-	InputLayer.NumberOfNodes = nNodesInput;
-	InputLayer.NumberOfChildNodes = nNodesHidden;
-	InputLayer.NumberOfParentNodes = 0;
-	InputLayer.Initialize( nNodesInput, NULL, &HiddenLayer );
-	InputLayer.RandomizeWeights( );
-
-	HiddenLayer.NumberOfNodes = nNodesHidden;
-	HiddenLayer.NumberOfChildNodes = nNodesOutput;
-	HiddenLayer.NumberOfParentNodes = nNodesInput;
-	HiddenLayer.Initialize( nNodesHidden, &InputLayer, &OutputLayer );
-	HiddenLayer.RandomizeWeights( );
-
-	OutputLayer.NumberOfNodes = nNodesOutput;
-	OutputLayer.NumberOfChildNodes = 0;
-	OutputLayer.NumberOfParentNodes = nNodesHidden;
-	OutputLayer.Initialize( nNodesOutput, &HiddenLayer, NULL );
+	std::vector<int> nodes( 3 ), activations( 3, ACTIVATION_SIGMOID );
+	nodes[0] = nNodesInput;
+	nodes[1] = nNodesHidden;
+	nodes[2] = nNodesOutput;
+	activations[0] = ACTIVATION_LINEAR;
+	activations[2] = OutputActivation;
+
+	Initialize( nodes, activations );
+}
+
+// Initializes the neural network with a layer for each node count,
+// the input layer passes its values through unchanged
+void NeuralNetwork::Initialize( const std::vector<int>& nodes,
+								const std::vector<int>& activations )
+{
+	Cleanup( );
+
+	int nLayers = (int)nodes.size( );
+	Layers.resize( nLayers );
+	for( int l = 0; l < nLayers; l++ )
+	{
+		NeuralNetworkLayer& layer = Layers[l];
+		layer.NumberOfNodes = nodes[l];
+		layer.NumberOfChildNodes = ( l+1 < nLayers ) ? nodes[l+1] : 0;
+		layer.NumberOfParentNodes = ( l > 0 ) ? nodes[l-1] : 0;
+		layer.Activation = activations[l];
+		layer.LearningRate = LearningRate;
+		layer.UseMomentum = UseMomentum;
+		layer.MomentumFactor = MomentumFactor;
+		layer.UseAdam = UseAdam;
+	}
+	OutputActivation = activations[nLayers-1];
+
+	srand( (unsigned)time( NULL ) );
+	for( int l = 0; l < nLayers; l++ )
+	{
+		Layers[l].Initialize( nodes[l],
+			( l > 0 ) ? &Layers[l-1] : NULL,
+			( l+1 < nLayers ) ? &Layers[l+1] : NULL );
+		if( l+1 < nLayers ) Layers[l].RandomizeWeights( );
+	}
 }
 
 // Sets input neuron values
 void NeuralNetwork::SetInput( int i, double value )
 {
-	InputLayer.NeuronValues[i] = value;
+	InputLayer( ).NeuronValues[i] = (float)value;
 }
 
 // Sets the desired output values
 void NeuralNetwork::SetDesiredOutput( int i, double value )
 {
-	OutputLayer.DesiredValues[i] = value;
+	OutputLayer( ).DesiredValues[i] = (float)value;
 }
 
 // Returns the output neuron values
 double NeuralNetwork::GetOutput( int i )
 {
-	return OutputLayer.NeuronValues[i];
+	return OutputLayer( ).NeuronValues[i];
 }
 
 // Calculates neuron values 
 void NeuralNetwork::FeedForward( )
 {
-	InputLayer.CalculateNeuronValues( );
-	HiddenLayer.CalculateNeuronValues( );
-	OutputLayer.CalculateNeuronValues( );
+	for( size_t l = 1; l < Layers.size( ); l++ )
+		Layers[l].CalculateNeuronValues( );
 }
 
 // Computes error and adjusts weights
 void NeuralNetwork::BackPropogate( )
 {
-	OutputLayer.CalculateErrors( );
-	HiddenLayer.CalculateErrors( );
+	for( size_t l = Layers.size( )-1; l > 0; l-- )
+		Layers[l].CalculateErrors( );
 
-	HiddenLayer.AdjustWeights( );
-	InputLayer.AdjustWeights( );
+	for( size_t l = Layers.size( )-1; l > 0; l-- )
+		Layers[l-1].AdjustWeights( );
 }
 
 // Returns the largest output neuron
 int NeuralNetwork::GetMaxOutputID( )
 {
-	double max = OutputLayer.NeuronValues[0];
-	int id;
+	double max = OutputLayer( ).NeuronValues[0];
+	int id = 0;
 
-	for( int i = 1; i < OutputLayer.NumberOfNodes; i++ )
-		if( OutputLayer.NeuronValues[i] > max )
-			{ max = OutputLayer.NeuronValues[i]; id = i; }
+	for( int i = 1; i < OutputLayer( ).NumberOfNodes; i++ )
+		if( OutputLayer( ).NeuronValues[i] > max )
+			{ max = OutputLayer( ).NeuronValues[i]; id = i; }
 
 	return id;
 }
@@ -117,39 +159,36 @@ double NeuralNetwork::CalculateError( )
 {
 	double error = 0.0;
 
-	for( int i = 0; i < OutputLayer.NumberOfNodes; i++ )
-		error += pow(OutputLayer.NeuronValues[i]-
-				OutputLayer.DesiredValues[i], 2);
+	for( int i = 0; i < OutputLayer( ).NumberOfNodes; i++ )
+		error += pow(OutputLayer( ).NeuronValues[i]-
+				OutputLayer( ).DesiredValues[i], 2);
 
-	return error / (double)OutputLayer.NumberOfNodes;
+	return error / (double)OutputLayer( ).NumberOfNodes;
 }
 
 // Sets the learning rate of the network
 void NeuralNetwork::SetLearningRate( double rate )
 {
-	InputLayer.LearningRate = rate;
-	HiddenLayer.LearningRate = rate;
-	OutputLayer.LearningRate = rate;
+	LearningRate = rate;
+	for( size_t l = 0; l < Layers.size( ); l++ )
+		Layers[l].LearningRate = rate;
 }
 
-// Sets whether to use linear activation 
+// Sets whether to use linear activation for the output
 void NeuralNetwork::SetLinearOutput( bool useLinear )
 {
-	InputLayer.LinearOutput = useLinear;
-	HiddenLayer.LinearOutput = useLinear;
-	OutputLayer.LinearOutput = useLinear;
+	OutputActivation = useLinear ? ACTIVATION_LINEAR : ACTIVATION_SIGMOID;
+	if( !Layers.empty( ) ) OutputLayer( ).Activation = OutputActivation;
 }
 
 // Sets whether to train using momentum 
 void NeuralNetwork::SetMomentum( bool useMomentum, double factor )
 {
-	InputLayer.UseMomentum = useMomentum;
-	HiddenLayer.UseMomentum = useMomentum;
-	OutputLayer.UseMomentum = useMomentum;
-
-	InputLayer.MomentumFactor = factor;
-	HiddenLayer.MomentumFactor = factor;
-	OutputLayer.MomentumFactor = factor;
+	UseMomentum = useMomentum;
+	MomentumFactor = factor;
+	for( size_t l = 0; l < Layers.size( ); l++ ) {
+		Layers[l].UseMomentum = useMomentum;
+		Layers[l].MomentumFactor = factor; }
 }
 
 // Outputs neural network settings to file
@@ -160,154 +199,292 @@ void NeuralNetwork::DumpData( const char* name )
 
 	// Check for failure
 	if( !file.is_open( ) ) return;
+	file.precision( 9 );
 	
-	// Write number of nodes per layer to file
-	file << "\nNumber of Input Layer Nodes\n";
-	file << InputLayer.NumberOfNodes;
-	file << "\nNumber of Hidden Layer Nodes\n";
-	file << HiddenLayer.NumberOfNodes;
-	file << "\nNumber of Output Layer Nodes\n";
-	file << OutputLayer.NumberOfNodes;
+	// Write the topology to file
+	file << "\nNumber of Layers\n";
+	file << Layers.size( );
+	file << "\nLayer Nodes\n";
+	for( size_t l = 0; l < Layers.size( ); l++ )
+		file << Layers[l].NumberOfNodes << ' ';
+	file << "\nLayer Activations\n";
+	for( size_t l = 0; l < Layers.size( ); l++ )
+		file << ActivationName[Layers[l].Activation] << ' ';
 	file << "\n";
-	 
-	// Write input header into the file
-	file << "// --------------------------------\n";
-	file << "//           Input Layer           \n";
-	file << "// --------------------------------\n";
-
-	// Write node weights
-	file << "\nWeights:\n";
-	for( int i = 0; i < InputLayer.NumberOfNodes; i++ )
-	for( int j = 0; j < InputLayer.NumberOfChildNodes; j++ )
-		file << InputLayer.Weights[i][j] << ' ';
-
-	// Write bias weights
-	file << "\nBias Weights:\n";
-	for( int i = 0; i < InputLayer.NumberOfChildNodes; i++ ) {
-		file << InputLayer.BiasWeights[i] << ' ';
-	}
-	file << '\n';
-
-	// Write hidden header into the file
-	file << "// --------------------------------\n";
-	file << "//           Hidden Layer          \n";
-	file << "// --------------------------------\n";
-
-	// Write node weights
-	file << "\nWeights:\n";
-	for( int i = 0; i < HiddenLayer.NumberOfNodes; i++ ) {
-	    for( int j = 0; j < HiddenLayer.NumberOfChildNodes; j++ ) {
-		    file << HiddenLayer.Weights[i][j] << ' ';
-		}
-	}
 
-	// Write bias weights
-	file << "\nBias Weights:\n";
-	for( int i = 0; i < HiddenLayer.NumberOfChildNodes; i++ ) {
-		file << HiddenLayer.BiasWeights[i] << ' ';
-    }
-    file << '\n';
-
-	// Write output header into the file
-	file << "// --------------------------------\n";
-	file << "//           Output Layer          \n";
-	file << "// --------------------------------\n";
-
-	// Write node weights
-	file << "\nWeights:\n";
-	for( int i = 0; i < OutputLayer.NumberOfNodes; i++ ) {
-	    for( int j = 0; j < OutputLayer.NumberOfChildNodes; j++ ) {
-		    file << OutputLayer.Weights[i][j] << ' ';
-		}
-    }
-
-	// Write bias weights
-	file << "\nBias Weights:\n";
-	for( int i = 0; i < OutputLayer.NumberOfChildNodes; i++ ) {
-		file << OutputLayer.BiasWeights[i] << ' ';
-    }
+	// Write the weights of each layer with children
+	for( size_t l = 0; l+1 < Layers.size( ); l++ )
+	{
+		NeuralNetworkLayer& layer = Layers[l];
+
+		// Write layer header into the file
+		file << "// --------------------------------\n";
+		file << "//             Layer " << l << "\n";
+		file << "// --------------------------------\n";
+
+		// Write node weights
+		file << "\nWeights:\n";
+		for( int i = 0; i < layer.NumberOfNodes; i++ )
+		for( int j = 0; j < layer.NumberOfChildNodes; j++ )
+			file << layer.Weight( i, j ) << ' ';
+
+		// Write bias weights
+		file << "\nBias Weights:\n";
+		for( int i = 0; i < layer.NumberOfChildNodes; i++ )
+			file << layer.BiasWeights[i] << ' ';
+		file << '\n';
+	}
 
 	// Close file
 	file.close();
 }
 
-// Loads neural network settings from file
+// Loads neural network settings from file, either a binary model file,
+// or text with a layer list or the legacy input, hidden and output
+// layer node counts
 bool NeuralNetwork::LoadData( const char* name )
 {
-	// Open the file for reading, creating it if necessary
+	// Binary model files are detected by their identifier
+	if( ModelFile::isModelFile( name ) ) return LoadBinary( name );
+
+	// Open the file for reading
 	std::ifstream file(name);
 
 	// Check for failure
 	if(!file.is_open()) return false;
 	
-	// Loop through file reading each line
+	// Read the topology and collect the weight lines
+	std::vector<int> nodes, activations;
+	std::vector<std::string> data;
 	std::string line;
-	int fieldnum = 0;
-	while(file.good() && std::getline(file, line)) {
-	    // Keep reading until we get to a line that starts with a number
-	    if(!isdigit(line[0]) && line[0] != '-') {
-	        continue;
-	    }
-	    
-	    std::stringstream linestream(line, std::stringstream::in);
-	    int inputnodes, hiddennodes, outputnodes;
-	    double weight, bias;
-	    
-	    // Now do stuff based on the field number
-	    switch(fieldnum) {
-	        case 0: // Number of input layer nodes
-	            linestream >> inputnodes; break;
-	        case 1: // Number of hidden layer nodes
-	            linestream >> hiddennodes; break;
-	        case 2: // Number of output layer nodes
-	            linestream >> outputnodes;
-	            /* TODO: Cleanup(); */
-	            Initialize(inputnodes, hiddennodes, outputnodes);
-	            break;
-	        case 3: // Input layer weights (inputnodes * hiddennodes)
-	            for(int i = 0; i < inputnodes; i++) {
-	                for(int j = 0; j < hiddennodes; j++) {
-	                    linestream >> weight;
-	                    InputLayer.Weights[i][j] = weight;
-	                }
-	            }
-	            break;
-	        case 4: // Input layer bias weights (hiddennodes)
-	            for(int i = 0; i < hiddennodes; i++) {
-	                linestream >> bias;
-	                InputLayer.BiasWeights[i] = bias;
-	            }
-	            break;
-	        case 5: // Hidden layer weights (hiddennodes * outputnodes)
-	            for(int i = 0; i < hiddennodes; i++) {
-	                for(int j = 0; j < outputnodes; j++) {
-	                    linestream >> weight;
-	                    HiddenLayer.Weights[i][j] = weight;
-	                }
-	            }
-	            break;
-	        case 6: // Hidden layer bias weights (outputnodes)
-	            for(int i = 0; i < hiddennodes; i++) {
-	                linestream >> bias;
-	                HiddenLayer.BiasWeights[i] = bias;
-	            }
-	            break;
-	        default:
-	            break;
-	    }
-	    fieldnum++;
+	while( std::getline( file, line ) )
+	{
+		// Skip blank lines
+		if( !line.empty( ) && line[line.size( )-1] == '\r' ) line.erase( line.size( )-1 );
+		if( line.empty( ) ) continue;
+
+		// Layer node counts
+		if( line == "Layer Nodes" ) {
+			std::getline( file, line ); std::stringstream iss( line );
+			int n; while( iss >> n ) nodes.push_back( n ); }
+
+		// Layer activations
+		else if( line == "Layer Activations" ) {
+			std::getline( file, line ); std::stringstream iss( line );
+			std::string token; while( iss >> token ) {
+				int a = 0; while( a < ACTIVATION_COUNT && token != ActivationName[a] ) a++;
+				if( a == ACTIVATION_COUNT ) return false;
+				activations.push_back( a ); } }
+
+		// Layer count, implied by the node counts
+		else if( line == "Number of Layers" ) std::getline( file, line );
+
+		// Legacy node count of a single layer
+		else if( line.compare( 0, 10, "Number of " ) == 0 ) {
+			std::getline( file, line ); nodes.push_back( atoi( line.c_str( ) ) ); }
+
+		// Weight lines
+		else if( isdigit( line[0] ) || line[0] == '-' ) data.push_back( line );
 	}
-	
 	file.close();
 
+	// Legacy files have sigmoid hidden layers
+	if( nodes.size( ) < 2 ) return false;
+	if( activations.empty( ) ) {
+		activations.assign( nodes.size( ), ACTIVATION_SIGMOID );
+		activations.front( ) = ACTIVATION_LINEAR;
+		activations.back( ) = OutputActivation; }
+	if( activations.size( ) != nodes.size( ) ) return false;
+	if( data.size( ) < 2*(nodes.size( )-1) ) return false;
+
+	// Create the network and read the weights of each layer
+	Initialize( nodes, activations );
+	for( size_t l = 0; l+1 < Layers.size( ); l++ )
+	{
+		NeuralNetworkLayer& layer = Layers[l];
+
+		std::stringstream weights( data[2*l] );
+		for( int i = 0; i < layer.NumberOfNodes; i++ )
+		for( int j = 0; j < layer.NumberOfChildNodes; j++ )
+			weights >> layer.Weight( i, j );
+
+		std::stringstream biases( data[2*l+1] );
+		for( int j = 0; j < layer.NumberOfChildNodes; j++ )
+			biases >> layer.BiasWeights[j];
+
+		if( weights.fail( ) || biases.fail( ) ) return false;
+	}
+
 	// Return successful
 	return true;
 }
 
+// Size of the weight blobs of a binary model file, the weights of each
+// layer with children by child node and then its bias weights
+static unsigned int BinarySize( const std::vector<int>& nodes )
+{
+	unsigned int size = 0;
+	for( size_t l = 0; l+1 < nodes.size( ); l++ ) {
+		size = ModelFile::align( size + sizeof(float)*nodes[l]*nodes[l+1] );
+		size = ModelFile::align( size + sizeof(float)*nodes[l+1] ); }
+	return size;
+}
+
+// Outputs the neural network to a binary model file
+bool NeuralNetwork::DumpBinary( const char* name )
+{
+	if( Layers.size( ) > MODEL_MAX_LAYERS ) return false;
+
+	// Describe the topology in the header
+	ModelHeader header; memset( &header, 0, sizeof(header) );
+	header.type = MODEL_NETWORK;
+	header.nLayers = (unsigned int)Layers.size( );
+	std::vector<int> nodes;
+	for( size_t l = 0; l < Layers.size( ); l++ ) {
+		header.nodes[l] = Layers[l].NumberOfNodes;
+		header.activations[l] = Layers[l].Activation;
+		nodes.push_back( Layers[l].NumberOfNodes ); }
+
+	// Copy the weights of each layer with children into its blobs
+	std::vector<char> data( BinarySize( nodes ) + 1, 0 );
+	unsigned int offset = 0;
+	for( size_t l = 0; l+1 < Layers.size( ); l++ )
+	{
+		NeuralNetworkLayer& layer = Layers[l];
+
+		float* weights = (float*)&data[offset];
+		for( int j = 0; j < layer.NumberOfChildNodes; j++ )
+		for( int i = 0; i < layer.NumberOfNodes; i++ )
+			weights[j*layer.NumberOfNodes+i] = layer.Weight( i, j );
+		offset = ModelFile::align( offset + sizeof(float)*layer.NumberOfNodes*layer.NumberOfChildNodes );
+
+		float* biases = (float*)&data[offset];
+		for( int j = 0; j < layer.NumberOfChildNodes; j++ )
+			biases[j] = layer.BiasWeights[j];
+		offset = ModelFile::align( offset + sizeof(float)*layer.NumberOfChildNodes );
+	}
+
+	return ModelFile::write( name, header, &data[0], offset );
+}
+
+// Loads neural network settings from a binary model file
+bool NeuralNetwork::LoadBinary( const char* name )
+{
+	ModelFile file;
+	if( !file.open( name ) ) return false;
+
+	// Read and check the topology
+	const ModelHeader* header = file.header( );
+	if( header->type != MODEL_NETWORK || header->nLayers < 2 ) return false;
+	std::vector<int> nodes, activations;
+	for( unsigned int l = 0; l < header->nLayers; l++ ) {
+		if( header->nodes[l] <= 0 ) return false;
+		if( header->activations[l] < 0 || header->activations[l] >= ACTIVATION_COUNT ) return false;
+		nodes.push_back( header->nodes[l] );
+		activations.push_back( header->activations[l] ); }
+	if( BinarySize( nodes ) > header->dataSize ) return false;
+
+	// Create the network and copy the weights of each layer
+	Initialize( nodes, activations );
+	unsigned int offset = 0;
+	for( size_t l = 0; l+1 < Layers.size( ); l++ )
+	{
+		NeuralNetworkLayer& layer = Layers[l];
+
+		const float* weights = (const float*)( file.data( ) + offset );
+		for( int j = 0; j < layer.NumberOfChildNodes; j++ )
+		for( int i = 0; i < layer.NumberOfNodes; i++ )
+			layer.Weight( i, j ) = weights[j*layer.NumberOfNodes+i];
+		offset = ModelFile::align( offset + sizeof(float)*layer.NumberOfNodes*layer.NumberOfChildNodes );
+
+		const float* biases = (const float*)( file.data( ) + offset );
+		for( int j = 0; j < layer.NumberOfChildNodes; j++ )
+			layer.BiasWeights[j] = biases[j];
+		offset = ModelFile::align( offset + sizeof(float)*layer.NumberOfChildNodes );
+	}
+
+	// Return successful
+	return true;
+}
+
+// Initializes a network with the topology, settings and
+// weights of another, for computing deltas on other threads
+void NeuralNetwork::InitializeReplica( const NeuralNetwork& network )
+{
+	LearningRate = network.LearningRate;
+	UseMomentum = network.UseMomentum;
+	MomentumFactor = network.MomentumFactor;
+	UseAdam = network.UseAdam;
+
+	std::vector<int> nodes, activations;
+	for( size_t l = 0; l < network.Layers.size( ); l++ ) {
+		nodes.push_back( network.Layers[l].NumberOfNodes );
+		activations.push_back( network.Layers[l].Activation ); }
+
+	Initialize( nodes, activations );
+	CopyWeights( network );
+}
+
+// Copies the weights of a network with the same topology
+void NeuralNetwork::CopyWeights( const NeuralNetwork& network )
+{
+	for( size_t l = 0; l < Layers.size( ); l++ )
+		Layers[l].CopyWeights( network.Layers[l] );
+}
+
+// Computes errors and adds the weight deltas to the batch
+void NeuralNetwork::Accumulate( )
+{
+	for( size_t l = Layers.size( )-1; l > 0; l-- )
+		Layers[l].CalculateErrors( );
+
+	for( size_t l = 0; l < Layers.size( ); l++ )
+		Layers[l].AccumulateDeltas( );
+}
+
+// Clears the weight deltas of the batch
+void NeuralNetwork::ClearDeltas( )
+{
+	for( size_t l = 0; l < Layers.size( ); l++ )
+		Layers[l].ClearDeltas( );
+}
+
+// Adds the weight deltas of a replica
+void NeuralNetwork::AddDeltas( const NeuralNetwork& network )
+{
+	for( size_t l = 0; l < Layers.size( ); l++ )
+		Layers[l].AddDeltas( network.Layers[l] );
+}
+
+// Applies the mean weight deltas of the batch
+void NeuralNetwork::ApplyDeltas( int batchSize )
+{
+	for( size_t l = 0; l < Layers.size( ); l++ )
+		Layers[l].ApplyDeltas( batchSize );
+}
+
+// Sets whether to apply batch deltas with Adam
+void NeuralNetwork::SetAdam( bool useAdam )
+{
+	UseAdam = useAdam;
+	for( size_t l = 0; l < Layers.size( ); l++ )
+		Layers[l].UseAdam = useAdam;
+}
+
+// Measures the mean time of a feed forward pass
+double NeuralNetwork::MeasureInference( int iterations )
+{
+	clock_t start = clock( );
+	for( int k = 0; k < iterations; k++ ) FeedForward( );
+	clock_t stop = clock( );
+
+	return 1e6 * (double)( stop - start ) / CLOCKS_PER_SEC / iterations;
+}
+
 // Frees memory allocated by the network
 void NeuralNetwork::Cleanup( )
 {
-	InputLayer.Cleanup( );
-	HiddenLayer.Cleanup( );
-	OutputLayer.Cleanup( );
+	for( size_t l = 0; l < Layers.size( ); l++ )
+		Layers[l].Cleanup( );
+	Layers.clear( );
 }
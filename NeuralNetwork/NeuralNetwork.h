@@ -30,18 +30,29 @@
 #ifndef NEURAL_NETWORK_H
 #define NEURAL_NETWORK_H
 
+#include <vector>
 #include "NeuralNetworkLayer.h"
 
-// Neural network layer
+// Neural network of a stack of layers, from the input
+// layer to the output layer
 class NeuralNetwork
 {
 public:
-	NeuralNetworkLayer InputLayer;
-	NeuralNetworkLayer HiddenLayer;
-	NeuralNetworkLayer OutputLayer;
+	std::vector<NeuralNetworkLayer> Layers;
+
+	// Settings applied to the layers as they are created
+	double		LearningRate;
+	bool		UseMomentum;
+	double		MomentumFactor;
+	bool		UseAdam;
+	int			OutputActivation;
+
+	NeuralNetwork( );
 
 	void Initialize( int nNodesInput, int nNodesHidden, 
 				     int nNodesOutput );
+	void Initialize( const std::vector<int>& nodes,
+					 const std::vector<int>& activations );
 	void Cleanup( );
 	void SetInput( int i, double value );
 	double GetOutput( int i );
@@ -55,7 +66,29 @@ public:
 	void SetMomentum( bool useMomentum, double factor );
 	void DumpData( const char* name );
 	bool LoadData( const char* name );
+	bool DumpBinary( const char* name );
+	bool LoadBinary( const char* name );
+
+	// Mini-batch training
+	void InitializeReplica( const NeuralNetwork& network );
+	void CopyWeights( const NeuralNetwork& network );
+	void Accumulate( );
+	void ClearDeltas( );
+	void AddDeltas( const NeuralNetwork& network );
+	void ApplyDeltas( int batchSize );
+	void SetAdam( bool useAdam );
+
+	// Measures the mean time of a feed forward pass in microseconds,
+	// the cost of an evaluation at a search leaf
+	double MeasureInference( int iterations );
+
+	// Activation function names used by the save format
+	static const char* ActivationName[ACTIVATION_COUNT];
+
+private:
+	NeuralNetworkLayer& InputLayer( ) { return Layers.front( ); }
+	NeuralNetworkLayer& OutputLayer( ) { return Layers.back( ); }
 };
 
 // End definition
-#endif
+#endif
\ No newline at end of file
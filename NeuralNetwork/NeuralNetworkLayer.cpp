@@ -28,20 +28,142 @@
 
 // Standard library 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
-#include <time.h>
+
+// Vector instruction set, AVX2 when enabled by the compiler
+// with an SSE or scalar fallback
+#if defined(__AVX2__)
+	#include <immintrin.h>
+	#define NN_AVX2
+#elif defined(__SSE__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 1 )
+	#include <xmmintrin.h>
+	#define NN_SSE
+#endif
+
+// Adam optimizer decay rates and stability constant
+#define NN_ADAM_BETA1   0.9
+#define NN_ADAM_BETA2   0.999
+#define NN_ADAM_EPSILON 1e-8
+
+// Aligned allocation
+#ifdef _MSC_VER
+	#include <malloc.h>
+#endif
 
 // Include header
 #include "NeuralNetworkLayer.h"
 
+// Allocates a zeroed array aligned to the cache line
+static float* AllocateAligned( int n )
+{
+	float* p;
+#ifdef _MSC_VER
+	p = (float*)_aligned_malloc( sizeof(float)*n, NN_ALIGNMENT );
+#else
+	if( posix_memalign( (void**)&p, NN_ALIGNMENT, sizeof(float)*n ) ) p = NULL;
+#endif
+	memset( p, 0, sizeof(float)*n );
+	return p;
+}
+
+// Frees an aligned array
+static void FreeAligned( float* p )
+{
+#ifdef _MSC_VER
+	_aligned_free( p );
+#else
+	free( p );
+#endif
+}
+
+// Dot product of two aligned arrays of a padded length
+static inline float Dot( const float* a, const float* b, int n )
+{
+#if defined(NN_AVX2)
+	__m256 sum = _mm256_setzero_ps( );
+	for( int i = 0; i < n; i += 8 )
+		sum = _mm256_add_ps( sum, _mm256_mul_ps(
+			_mm256_load_ps( a+i ), _mm256_load_ps( b+i ) ) );
+	__m128 half = _mm_add_ps( _mm256_castps256_ps128( sum ),
+							  _mm256_extractf128_ps( sum, 1 ) );
+	half = _mm_add_ps( half, _mm_movehl_ps( half, half ) );
+	half = _mm_add_ss( half, _mm_shuffle_ps( half, half, 1 ) );
+	return _mm_cvtss_f32( half );
+#elif defined(NN_SSE)
+	__m128 sum = _mm_setzero_ps( );
+	for( int i = 0; i < n; i += 4 )
+		sum = _mm_add_ps( sum, _mm_mul_ps(
+			_mm_load_ps( a+i ), _mm_load_ps( b+i ) ) );
+	sum = _mm_add_ps( sum, _mm_movehl_ps( sum, sum ) );
+	sum = _mm_add_ss( sum, _mm_shuffle_ps( sum, sum, 1 ) );
+	return _mm_cvtss_f32( sum );
+#else
+	float sum = 0.0f;
+	for( int i = 0; i < n; i++ ) sum += a[i]*b[i];
+	return sum;
+#endif
+}
+
+// Adds a scaled aligned array of a padded length, y += a*x
+static inline void Axpy( float* y, float a, const float* x, int n )
+{
+#if defined(NN_AVX2)
+	__m256 s = _mm256_set1_ps( a );
+	for( int i = 0; i < n; i += 8 )
+		_mm256_store_ps( y+i, _mm256_add_ps( _mm256_load_ps( y+i ),
+			_mm256_mul_ps( s, _mm256_load_ps( x+i ) ) ) );
+#elif defined(NN_SSE)
+	__m128 s = _mm_set1_ps( a );
+	for( int i = 0; i < n; i += 4 )
+		_mm_store_ps( y+i, _mm_add_ps( _mm_load_ps( y+i ),
+			_mm_mul_ps( s, _mm_load_ps( x+i ) ) ) );
+#else
+	for( int i = 0; i < n; i++ ) y[i] += a*x[i];
+#endif
+}
+
+// Scales an aligned array of a padded length, y = a*x
+static inline void Scale( float* y, float a, const float* x, int n )
+{
+#if defined(NN_AVX2)
+	__m256 s = _mm256_set1_ps( a );
+	for( int i = 0; i < n; i += 8 )
+		_mm256_store_ps( y+i, _mm256_mul_ps( s, _mm256_load_ps( x+i ) ) );
+#elif defined(NN_SSE)
+	__m128 s = _mm_set1_ps( a );
+	for( int i = 0; i < n; i += 4 )
+		_mm_store_ps( y+i, _mm_mul_ps( s, _mm_load_ps( x+i ) ) );
+#else
+	for( int i = 0; i < n; i++ ) y[i] = a*x[i];
+#endif
+}
+
+// Logistic function. Evaluates exp(-x) as a power of two
+// with the integer part in the exponent bits and a cubic
+// for the fraction, with an absolute error below 1e-4.
+static inline float Sigmoid( float x )
+{
+	float t = -1.442695041f*x;
+	if( t < -126.0f ) t = -126.0f; else if( t > 126.0f ) t = 126.0f;
+
+	float whole = floorf( t ), f = t - whole;
+	union { float f; int i; } e; e.i = ( (int)whole + 127 ) << 23;
+	float p = 1.0f + f*( 0.6951786f + f*( 0.2261272f + f*0.0781440f ) );
+
+	return 1.0f / ( 1.0f + e.f*p );
+}
+
 // Constructor
 NeuralNetworkLayer::NeuralNetworkLayer( )
 {
 	ParentLayer = NULL;
 	ChildLayer = NULL;
-	LinearOutput = false;
+	Activation = ACTIVATION_SIGMOID;
 	UseMomentum = false;
 	MomentumFactor = 0.9;
+	UseAdam = false;
+	Updates = 0;
 }
 
 // Allocates memory for the neural network
@@ -49,11 +171,11 @@ void NeuralNetworkLayer::Initialize( int NumNodes,
 						   NeuralNetworkLayer* parent, 
 						   NeuralNetworkLayer* child )
 {
-	NeuronValues = (double*)malloc(sizeof(double)*
-									NumberOfNodes);
-	DesiredValues = (double*)malloc(sizeof(double)*
-									NumberOfNodes);
-	Errors = (double*)malloc(sizeof(double)*NumberOfNodes);
+	NodeStride = (int)( (NumberOfNodes+NN_PADDING-1) / NN_PADDING * NN_PADDING );
+
+	NeuronValues = AllocateAligned( NodeStride );
+	DesiredValues = AllocateAligned( NodeStride );
+	Errors = AllocateAligned( NodeStride );
 
 	ParentLayer = parent;
 	
@@ -61,62 +183,67 @@ void NeuralNetworkLayer::Initialize( int NumNodes,
 	{ 
 		ChildLayer = child;
 
-		Weights =(double**)malloc(sizeof(double)*
-								   NumberOfNodes);
-		WeightChanges =(double**)malloc(sizeof(double)*
-										 NumberOfNodes);
-		for( int i = 0; i < NumberOfNodes; i++ )
-		{
-			Weights[i] = (double*)malloc(sizeof(double)*
-										  NumberOfChildNodes);
-			WeightChanges[i] = (double*)malloc(sizeof(double)*
-										    NumberOfChildNodes);
-		}
+		Weights = AllocateAligned( NodeStride*NumberOfChildNodes );
+		WeightChanges = AllocateAligned( NodeStride*NumberOfChildNodes );
+
+		BiasValues = AllocateAligned( NumberOfChildNodes );
+		BiasWeights = AllocateAligned( NumberOfChildNodes );
 
-		BiasValues = (double*)malloc(sizeof(double)*
-									  NumberOfChildNodes);
-		BiasWeights = (double*)malloc(sizeof(double)*
-									   NumberOfChildNodes);
+		WeightDeltas = AllocateAligned( NodeStride*NumberOfChildNodes );
+		WeightVariances = AllocateAligned( NodeStride*NumberOfChildNodes );
+		BiasDeltas = AllocateAligned( NumberOfChildNodes );
+		BiasChanges = AllocateAligned( NumberOfChildNodes );
+		BiasVariances = AllocateAligned( NumberOfChildNodes );
 	} else {
 		Weights = NULL;
 		BiasValues = NULL;
 		BiasWeights = NULL;
 		WeightChanges = NULL;
+		WeightDeltas = NULL;
+		WeightVariances = NULL;
+		BiasDeltas = NULL;
+		BiasChanges = NULL;
+		BiasVariances = NULL;
 	}
-
-	for( int i = 0; i < NumberOfNodes; i++ )
-	{
-		NeuronValues[i] = 0;
-		DesiredValues[i] = 0;
-		Errors[i] = 0;
-
-		if( ChildLayer != NULL )
-			for( int j = 0; j < NumberOfChildNodes; j++ )
-			{
-				Weights[i][j] = 0;
-				WeightChanges[i][j] = 0;
-			}
-	}
+	Updates = 0;
 
 	if( ChildLayer != NULL )
 		for( int i = 0; i < NumberOfChildNodes; i++ )
-		{
 			BiasValues[i] = -1;
-			BiasWeights[i] = 0;
-		}
 }
 
-// Randomizes neural network weights
+// Randomizes neural network weights, scaled by the node count
+// for ReLU children to keep their activations from growing
 void NeuralNetworkLayer::RandomizeWeights( )
 {
-	srand( (unsigned)time( NULL ) );
+	double range = 1.0;
+	if( ChildLayer->Activation == ACTIVATION_RELU )
+		range = sqrt( 6.0 / NumberOfNodes );
 
 	for( int i = 0; i < NumberOfNodes; i++ )
 		for( int j = 0; j < NumberOfChildNodes; j++ )
-			Weights[i][j] = rand() / ((double)RAND_MAX/2.0) - 1.0;
+			Weight( i, j ) = (float)( range*( rand() / ((double)RAND_MAX/2.0) - 1.0 ) );
 
 	for( int i = 0; i < NumberOfChildNodes; i++ )
-		BiasWeights[i] = rand() / ((double)RAND_MAX/2.0) - 1.0;
+		BiasWeights[i] = (float)( range*( rand() / ((double)RAND_MAX/2.0) - 1.0 ) );
+}
+
+// Applies the activation function to a neuron input
+float NeuralNetworkLayer::Activate( float x )
+{
+	switch( Activation ) {
+		case ACTIVATION_RELU: return x > 0.0f ? x : 0.0f;
+		case ACTIVATION_LINEAR: return x;
+		default: return Sigmoid( x ); }
+}
+
+// Derivative of the activation function at a neuron value
+float NeuralNetworkLayer::Derivative( float value )
+{
+	switch( Activation ) {
+		case ACTIVATION_RELU: return value > 0.0f ? 1.0f : 0.0f;
+		case ACTIVATION_LINEAR: return 1.0f;
+		default: return value*(1.0f-value); }
 }
 
 // Calculates the neuron values from input
@@ -125,15 +252,12 @@ void NeuralNetworkLayer::CalculateNeuronValues( )
 	if( ParentLayer != NULL )
 		for( int j = 0; j < NumberOfNodes; j++ )
 		{
-			double x = 0;
-			for( int i = 0; i < NumberOfParentNodes; i++ )
-				x += ParentLayer->NeuronValues[i]*
-					 ParentLayer->Weights[i][j];
+			float x = Dot( ParentLayer->Weights + j*ParentLayer->NodeStride,
+						   ParentLayer->NeuronValues, ParentLayer->NodeStride );
 			x += ParentLayer->BiasValues[j]*
 				 ParentLayer->BiasWeights[j];
 
-			if( ChildLayer == NULL && LinearOutput ) NeuronValues[j] = x;
-			else NeuronValues[j] = 1.0 / (1+exp(-x));
+			NeuronValues[j] = Activate( x );
 		}
 }
 
@@ -143,20 +267,18 @@ void NeuralNetworkLayer::CalculateErrors( )
 	if( ChildLayer == NULL )
 		for( int i = 0; i < NumberOfNodes; i++ )
 			Errors[i] = (DesiredValues[i] - NeuronValues[i])*
-						 NeuronValues[i]*
-						(1.0 - NeuronValues[i]);
+						 Derivative( NeuronValues[i] );
 	else if( ParentLayer == NULL )
 		for( int i = 0; i < NumberOfNodes; i++ )
-			Errors[i] = 0.0;
+			Errors[i] = 0.0f;
 	else
+	{
+		memset( Errors, 0, sizeof(float)*NodeStride );
+		for( int j = 0; j < NumberOfChildNodes; j++ )
+			Axpy( Errors, ChildLayer->Errors[j], Weights + j*NodeStride, NodeStride );
 		for( int i = 0; i < NumberOfNodes; i++ )
-		{
-			double sum = 0.0;
-			for( int j = 0; j < NumberOfChildNodes; j++ )
-				sum += ChildLayer->Errors[j]*Weights[i][j];
-			Errors[i] = sum*NeuronValues[i]*
-						(1.0-NeuronValues[i]);
-		}
+			Errors[i] *= Derivative( NeuronValues[i] );
+	}
 }
 
 // Adjusts weights using error values
@@ -164,46 +286,143 @@ void NeuralNetworkLayer::AdjustWeights( )
 {
 	if( ChildLayer != NULL )
 	{
-		for( int i = 0; i < NumberOfNodes; i++ )
-			for( int j = 0; j < NumberOfChildNodes; j++ )
+		for( int j = 0; j < NumberOfChildNodes; j++ )
+		{
+			float* weights = Weights + j*NodeStride;
+			float rate = (float)LearningRate*ChildLayer->Errors[j];
+			if( UseMomentum )
 			{
-				double dw = LearningRate*ChildLayer->Errors[j]*
-						    NeuronValues[i];
-				if( UseMomentum )
-				{
-					Weights[i][j] += dw + MomentumFactor*
-								      WeightChanges[i][j];
-					WeightChanges[i][j] = dw;
-				} else 
-					Weights[i][j] += dw;
-			}
+				float* changes = WeightChanges + j*NodeStride;
+				Axpy( weights, (float)MomentumFactor, changes, NodeStride );
+				Scale( changes, rate, NeuronValues, NodeStride );
+				Axpy( weights, 1.0f, changes, NodeStride );
+			} else
+				Axpy( weights, rate, NeuronValues, NodeStride );
+		}
 
 		for( int j = 0; j < NumberOfChildNodes; j++ )
-			BiasWeights[j] += LearningRate*
+			BiasWeights[j] += (float)LearningRate*
 							  ChildLayer->Errors[j]*
 							  BiasValues[j];
 	}
 }
 
-// Frees memory allocated by the neural network layer
-void NeuralNetworkLayer::Cleanup( )
+// Adds the weight deltas of the current errors to the batch
+void NeuralNetworkLayer::AccumulateDeltas( )
 {
-	free(NeuronValues);
-	free(DesiredValues);
-	free(Errors);
+	if( ChildLayer != NULL )
+		for( int j = 0; j < NumberOfChildNodes; j++ )
+		{
+			Axpy( WeightDeltas + j*NodeStride, ChildLayer->Errors[j],
+				  NeuronValues, NodeStride );
+			BiasDeltas[j] += ChildLayer->Errors[j]*BiasValues[j];
+		}
+}
 
-	if( Weights != NULL ) 
+// Clears the weight deltas of the batch
+void NeuralNetworkLayer::ClearDeltas( )
+{
+	if( ChildLayer != NULL )
 	{
-		for( int i = 0; i < NumberOfNodes; i++ )
+		memset( WeightDeltas, 0, sizeof(float)*NodeStride*NumberOfChildNodes );
+		memset( BiasDeltas, 0, sizeof(float)*NumberOfChildNodes );
+	}
+}
+
+// Adds the weight deltas of a layer with the same topology
+void NeuralNetworkLayer::AddDeltas( const NeuralNetworkLayer& layer )
+{
+	if( ChildLayer != NULL )
+	{
+		for( int j = 0; j < NumberOfChildNodes; j++ )
+			Axpy( WeightDeltas + j*NodeStride, 1.0f,
+				  layer.WeightDeltas + j*NodeStride, NodeStride );
+		for( int j = 0; j < NumberOfChildNodes; j++ )
+			BiasDeltas[j] += layer.BiasDeltas[j];
+	}
+}
+
+// Applies the mean weight deltas of the batch
+void NeuralNetworkLayer::ApplyDeltas( int batchSize )
+{
+	if( ChildLayer == NULL ) return;
+
+	int n = NodeStride*NumberOfChildNodes;
+	float scale = 1.0f / (float)batchSize;
+	float rate = (float)LearningRate;
+	Updates++;
+
+	if( UseAdam )
+	{
+		// Bias corrected step size
+		float b1 = (float)NN_ADAM_BETA1, b2 = (float)NN_ADAM_BETA2;
+		float step = rate * (float)( sqrt( 1.0-pow( NN_ADAM_BETA2, Updates ) ) /
+									 ( 1.0-pow( NN_ADAM_BETA1, Updates ) ) );
+
+		for( int i = 0; i < n; i++ )
 		{
-			free(Weights[i]);
-			free(WeightChanges[i]);
+			float d = WeightDeltas[i]*scale;
+			WeightChanges[i] = b1*WeightChanges[i] + (1.0f-b1)*d;
+			WeightVariances[i] = b2*WeightVariances[i] + (1.0f-b2)*d*d;
+			Weights[i] += step*WeightChanges[i] /
+				( sqrtf( WeightVariances[i] ) + (float)NN_ADAM_EPSILON );
 		}
 
-		free(Weights);
-		free(WeightChanges);
+		for( int j = 0; j < NumberOfChildNodes; j++ )
+		{
+			float d = BiasDeltas[j]*scale;
+			BiasChanges[j] = b1*BiasChanges[j] + (1.0f-b1)*d;
+			BiasVariances[j] = b2*BiasVariances[j] + (1.0f-b2)*d*d;
+			BiasWeights[j] += step*BiasChanges[j] /
+				( sqrtf( BiasVariances[j] ) + (float)NN_ADAM_EPSILON );
+		}
+	}
+	else
+	{
+		// Momentum is the decayed sum of the previous changes
+		float momentum = UseMomentum ? (float)MomentumFactor : 0.0f;
+
+		for( int j = 0; j < NumberOfChildNodes; j++ )
+		{
+			float* changes = WeightChanges + j*NodeStride;
+			Scale( changes, momentum, changes, NodeStride );
+			Axpy( changes, rate*scale, WeightDeltas + j*NodeStride, NodeStride );
+			Axpy( Weights + j*NodeStride, 1.0f, changes, NodeStride );
+
+			BiasChanges[j] = momentum*BiasChanges[j] + rate*scale*BiasDeltas[j];
+			BiasWeights[j] += BiasChanges[j];
+		}
+	}
+}
+
+// Copies the weights of a layer with the same topology
+void NeuralNetworkLayer::CopyWeights( const NeuralNetworkLayer& layer )
+{
+	if( ChildLayer != NULL )
+	{
+		memcpy( Weights, layer.Weights, sizeof(float)*NodeStride*NumberOfChildNodes );
+		memcpy( BiasWeights, layer.BiasWeights, sizeof(float)*NumberOfChildNodes );
+	}
+}
+
+// Frees memory allocated by the neural network layer
+void NeuralNetworkLayer::Cleanup( )
+{
+	FreeAligned(NeuronValues);
+	FreeAligned(DesiredValues);
+	FreeAligned(Errors);
+
+	if( Weights != NULL ) 
+	{
+		FreeAligned(Weights);
+		FreeAligned(WeightChanges);
+		FreeAligned(WeightDeltas);
+		FreeAligned(WeightVariances);
+		FreeAligned(BiasDeltas);
+		FreeAligned(BiasChanges);
+		FreeAligned(BiasVariances);
 	}
 
-	if( BiasValues ) free(BiasValues);
-	if( BiasWeights ) free(BiasWeights);
+	if( BiasValues ) FreeAligned(BiasValues);
+	if( BiasWeights ) FreeAligned(BiasWeights);
 }
\ No newline at end of file
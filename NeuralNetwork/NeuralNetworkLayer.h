@@ -30,6 +30,14 @@
 #ifndef NEURAL_NETWORK_LAYER_H
 #define NEURAL_NETWORK_LAYER_H
 
+// Node arrays are padded to a multiple of the cache line
+#define NN_ALIGNMENT 64
+#define NN_PADDING   (NN_ALIGNMENT/sizeof(float))
+
+// Neuron activation functions
+enum ActivationFunction { ACTIVATION_SIGMOID, ACTIVATION_RELU,
+	ACTIVATION_LINEAR, ACTIVATION_COUNT };
+
 // Neural network layer
 class NeuralNetworkLayer
 {
@@ -37,19 +45,29 @@ public:
 	int			NumberOfNodes;
 	int			NumberOfChildNodes;
 	int			NumberOfParentNodes;
-	double**	Weights;
-	double**	WeightChanges;
-	double*		NeuronValues;
-	double*		DesiredValues;
-	double*		Errors;
-	double*		BiasWeights;
-	double*		BiasValues;
+	int			NodeStride;
+	float*		Weights;
+	float*		WeightChanges;
+	float*		NeuronValues;
+	float*		DesiredValues;
+	float*		Errors;
+	float*		BiasWeights;
+	float*		BiasValues;
 	double		LearningRate;
 
-	bool		LinearOutput;
+	int			Activation;
 	bool		UseMomentum;
 	double		MomentumFactor;
 
+	// Mini-batch deltas and optimizer state
+	float*		WeightDeltas;
+	float*		BiasDeltas;
+	float*		BiasChanges;
+	float*		WeightVariances;
+	float*		BiasVariances;
+	bool		UseAdam;
+	int			Updates;
+
 	NeuralNetworkLayer* ParentLayer;
 	NeuralNetworkLayer* ChildLayer;
 
@@ -63,6 +81,20 @@ public:
 	void CalculateErrors( );
 	void AdjustWeights( );
 	void CalculateNeuronValues( );
+	float Activate( float x );
+	float Derivative( float value );
+
+	// Mini-batch training, deltas are summed over the batch
+	// and applied with momentum or Adam updates
+	void AccumulateDeltas( );
+	void ClearDeltas( );
+	void AddDeltas( const NeuralNetworkLayer& layer );
+	void ApplyDeltas( int batchSize );
+	void CopyWeights( const NeuralNetworkLayer& layer );
+
+	// Weight from node i to child node j. The weights are stored
+	// row-major with one row of NodeStride weights per child node.
+	float& Weight( int i, int j ) { return Weights[j*NodeStride + i]; }
 };
 
 // End definition
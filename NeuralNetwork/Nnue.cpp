@@ -0,0 +1,808 @@
+/* ============================================================================
+
+    Project: Blokus AI - Neural Network Trainer
+
+    Implements the efficiently updatable evaluation network.
+
+    File: Nnue.cpp
+
+============================================================================= */
+
+// Local includes
+#include "Nnue.h"
+#include "NeuralNetwork.h"
+
+// Standard library includes
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+// Integer vector instruction set, AVX2 when enabled by the
+// compiler with an SSE2 or scalar fallback
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define NNUE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define NNUE_SSE2
+#endif
+
+// --------------------------------------------------------
+// Applies an activation function to a neuron input
+// --------------------------------------------------------
+static inline float activate(int activation, float x) {
+    switch (activation) {
+        case ACTIVATION_RELU: return x > 0.0f ? x : 0.0f;
+        case ACTIVATION_LINEAR: return x;
+        default: return 1.0f / (1.0f + expf(-x));
+    }
+}
+
+// --------------------------------------------------------
+// Rounds a value to the nearest integer
+// --------------------------------------------------------
+static inline int nearest(float x) {
+    return (int)floorf(x + 0.5f);
+}
+
+// --------------------------------------------------------
+// Dot product of 8 bit weights and 16 bit activations of a
+// length padded to a multiple of 16
+// --------------------------------------------------------
+static inline int dot(const signed char *w, const short *x, int n) {
+#if defined(NNUE_AVX2)
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < n; i += 16) {
+        __m256i w16 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(w+i)));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(w16,
+            _mm256_loadu_si256((const __m256i*)(x+i))));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum),
+        _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+    return _mm_cvtsi128_si32(half);
+#elif defined(NNUE_SSE2)
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < n; i += 16) {
+        // Sign extend the weights by unpacking into the high bytes
+        __m128i w8 = _mm_loadu_si128((const __m128i*)(w+i));
+        __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(w8, w8), 8);
+        __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(w8, w8), 8);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(lo,
+            _mm_loadu_si128((const __m128i*)(x+i))));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(hi,
+            _mm_loadu_si128((const __m128i*)(x+i+8))));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+#else
+    int sum = 0;
+    for (int i = 0; i < n; i++) {
+        sum += w[i]*x[i];
+    }
+    return sum;
+#endif
+}
+
+// --------------------------------------------------------
+// Multiplies the activation rows of a batch by the weight
+// rows of a layer, adding the biases and activating. Tiles
+// of 4 positions by 4 outputs share each load, and every
+// sum is accumulated in the order evaluate uses. Rows of
+// the activations have a stride of NNUE_HIDDEN.
+// --------------------------------------------------------
+static void multiplyLayer(const float *x, int n, int inputs, const float *w,
+    const float *b, int outputs, int activation, float *y) {
+    int r = 0;
+    for (; r + 4 <= n; r += 4) {
+        const float *x0 = &x[r*NNUE_HIDDEN], *x1 = x0 + NNUE_HIDDEN;
+        const float *x2 = x1 + NNUE_HIDDEN, *x3 = x2 + NNUE_HIDDEN;
+        float *y0 = &y[r*NNUE_HIDDEN], *y1 = y0 + NNUE_HIDDEN;
+        float *y2 = y1 + NNUE_HIDDEN, *y3 = y2 + NNUE_HIDDEN;
+        int j = 0;
+        for (; j + 4 <= outputs; j += 4) {
+            const float *w0 = &w[j*inputs], *w1 = w0 + inputs;
+            const float *w2 = w1 + inputs, *w3 = w2 + inputs;
+            float s00 = b[j], s01 = b[j+1], s02 = b[j+2], s03 = b[j+3];
+            float s10 = s00, s11 = s01, s12 = s02, s13 = s03;
+            float s20 = s00, s21 = s01, s22 = s02, s23 = s03;
+            float s30 = s00, s31 = s01, s32 = s02, s33 = s03;
+            for (int i = 0; i < inputs; i++) {
+                float a0 = x0[i], a1 = x1[i], a2 = x2[i], a3 = x3[i];
+                float c0 = w0[i], c1 = w1[i], c2 = w2[i], c3 = w3[i];
+                s00 += c0*a0; s01 += c1*a0; s02 += c2*a0; s03 += c3*a0;
+                s10 += c0*a1; s11 += c1*a1; s12 += c2*a1; s13 += c3*a1;
+                s20 += c0*a2; s21 += c1*a2; s22 += c2*a2; s23 += c3*a2;
+                s30 += c0*a3; s31 += c1*a3; s32 += c2*a3; s33 += c3*a3;
+            }
+            y0[j] = activate(activation, s00); y0[j+1] = activate(activation, s01);
+            y0[j+2] = activate(activation, s02); y0[j+3] = activate(activation, s03);
+            y1[j] = activate(activation, s10); y1[j+1] = activate(activation, s11);
+            y1[j+2] = activate(activation, s12); y1[j+3] = activate(activation, s13);
+            y2[j] = activate(activation, s20); y2[j+1] = activate(activation, s21);
+            y2[j+2] = activate(activation, s22); y2[j+3] = activate(activation, s23);
+            y3[j] = activate(activation, s30); y3[j+1] = activate(activation, s31);
+            y3[j+2] = activate(activation, s32); y3[j+3] = activate(activation, s33);
+        }
+        for (; j < outputs; j++) {
+            const float *row = &w[j*inputs];
+            for (int k = 0; k < 4; k++) {
+                const float *a = &x[(r+k)*NNUE_HIDDEN];
+                float s = b[j];
+                for (int i = 0; i < inputs; i++) {
+                    s += row[i]*a[i];
+                }
+                y[(r+k)*NNUE_HIDDEN + j] = activate(activation, s);
+            }
+        }
+    }
+
+    // Remaining positions
+    for (; r < n; r++) {
+        const float *a = &x[r*NNUE_HIDDEN];
+        for (int j = 0; j < outputs; j++) {
+            const float *row = &w[j*inputs];
+            float s = b[j];
+            for (int i = 0; i < inputs; i++) {
+                s += row[i]*a[i];
+            }
+            y[r*NNUE_HIDDEN + j] = activate(activation, s);
+        }
+    }
+}
+
+// --------------------------------------------------------
+// Constructor
+// --------------------------------------------------------
+Nnue::Nnue() : m_loaded(false), m_quantised(false), m_columns(NULL),
+    m_biases(NULL), m_activation(ACTIVATION_RELU), m_quantisedColumns(NULL),
+    m_quantisedBiases(NULL), m_scale(1.0f), m_hasPolicy(false),
+    m_policyWeights(NULL), m_policyBiases(NULL) {
+}
+
+// --------------------------------------------------------
+// Takes the next aligned blob of a layout
+// --------------------------------------------------------
+static inline const char *blob(const char *data, unsigned int &offset,
+    unsigned int size) {
+    const char *p = (data != NULL) ? data + offset : NULL;
+    offset = ModelFile::align(offset + size);
+    return p;
+}
+
+// --------------------------------------------------------
+// Lays out the weights: the scales of a quantised network,
+// then the first layer columns and biases, then the weight
+// rows and biases of each later layer, then the policy head
+// --------------------------------------------------------
+unsigned int Nnue::layout(const char *data) {
+    unsigned int offset = 0;
+    if (m_quantised) {
+        const float *scales = (const float*)blob(data, offset,
+            (unsigned int)(1 + 2*m_layers.size())*sizeof(float));
+        m_quantisedColumns = (const short*)blob(data, offset,
+            NNUE_FEATURES*NNUE_HIDDEN*sizeof(short));
+        m_quantisedBiases = (const short*)blob(data, offset, NNUE_HIDDEN*sizeof(short));
+        for (size_t l = 0; l < m_layers.size(); l++) {
+            Layer &layer = m_layers[l];
+            layer.stride = (layer.inputs + 15) & ~15;
+            layer.quantisedWeights = (const signed char*)blob(data, offset,
+                layer.outputs*layer.stride*sizeof(signed char));
+            layer.quantisedBiases = (const int*)blob(data, offset,
+                layer.outputs*sizeof(int));
+            if (scales != NULL) {
+                layer.dequantise = scales[1+2*l];
+                layer.scale = scales[2+2*l];
+            }
+        }
+        if (scales != NULL) {
+            m_scale = scales[0];
+        }
+    } else {
+        m_columns = (const float*)blob(data, offset, NNUE_FEATURES*NNUE_HIDDEN*sizeof(float));
+        m_biases = (const float*)blob(data, offset, NNUE_HIDDEN*sizeof(float));
+        for (size_t l = 0; l < m_layers.size(); l++) {
+            Layer &layer = m_layers[l];
+            layer.weights = (const float*)blob(data, offset,
+                layer.inputs*layer.outputs*sizeof(float));
+            layer.biases = (const float*)blob(data, offset, layer.outputs*sizeof(float));
+        }
+    }
+
+    if (m_hasPolicy) {
+        m_policyWeights = (const float*)blob(data, offset,
+            NNUE_POLICY*NNUE_HIDDEN*sizeof(float));
+        m_policyBiases = (const float*)blob(data, offset, NNUE_POLICY*sizeof(float));
+    }
+    return offset;
+}
+
+// --------------------------------------------------------
+// Maps a model file or copies the weights of a saved network
+// --------------------------------------------------------
+bool Nnue::load(const char *filename) {
+    m_loaded = false;
+
+    // Networks in the NeuralNetwork layout, text or binary, are copied
+    if (!ModelFile::isModelFile(filename) || !m_file.open(filename) ||
+        m_file.header()->type == MODEL_NETWORK) {
+        m_file.close();
+        NeuralNetwork network;
+        if (!network.LoadData(filename)) {
+            return false;
+        }
+
+        bool loaded = load(network);
+        network.Cleanup();
+        return loaded;
+    }
+
+    // Check the topology
+    const ModelHeader *header = m_file.header();
+    bool valid = (header->type == MODEL_NNUE || header->type == MODEL_NNUE_QUANTISED) &&
+        header->nLayers >= 3 && header->nodes[0] == NNUE_FEATURES &&
+        header->nodes[1] == NNUE_HIDDEN &&
+        (header->policy == 0 || header->policy == NNUE_POLICY);
+    for (unsigned int l = 2; valid && l < header->nLayers; l++) {
+        valid = header->nodes[l] > 0 && header->nodes[l] <= NNUE_HIDDEN;
+    }
+    if (!valid) {
+        m_file.close();
+        return false;
+    }
+
+    // Point the weights into the mapping
+    m_quantised = (header->type == MODEL_NNUE_QUANTISED);
+    m_hasPolicy = (header->policy != 0);
+    m_activation = header->activations[1];
+    m_layers.resize(header->nLayers-2);
+    for (size_t l = 0; l < m_layers.size(); l++) {
+        m_layers[l].inputs = header->nodes[l+1];
+        m_layers[l].outputs = header->nodes[l+2];
+        m_layers[l].activation = header->activations[l+2];
+    }
+    if (layout(NULL) > header->dataSize) {
+        m_file.close();
+        return false;
+    }
+    layout(m_file.data());
+    std::vector<char>().swap(m_image);
+
+    m_loaded = true;
+    return true;
+}
+
+// --------------------------------------------------------
+// Copies the weights of a network
+// --------------------------------------------------------
+bool Nnue::load(NeuralNetwork &network) {
+    m_loaded = false;
+    m_quantised = false;
+    m_hasPolicy = false;
+
+    // Check the topology
+    std::vector<NeuralNetworkLayer> &layers = network.Layers;
+    bool valid = layers.size() >= 3 && layers.size() <= MODEL_MAX_LAYERS &&
+        layers[0].NumberOfNodes == NNUE_FEATURES &&
+        layers[1].NumberOfNodes == NNUE_HIDDEN;
+    for (size_t l = 2; valid && l < layers.size(); l++) {
+        valid = layers[l].NumberOfNodes <= NNUE_HIDDEN;
+    }
+    if (!valid) {
+        return false;
+    }
+
+    m_activation = layers[1].Activation;
+    m_layers.resize(layers.size()-2);
+    for (size_t l = 1; l+1 < layers.size(); l++) {
+        m_layers[l-1].inputs = layers[l].NumberOfNodes;
+        m_layers[l-1].outputs = layers[l].NumberOfChildNodes;
+        m_layers[l-1].activation = layers[l+1].Activation;
+    }
+
+    // Lay out owned storage, filled through the weight pointers
+    m_file.close();
+    m_image.assign(layout(NULL), 0);
+    layout(&m_image[0]);
+
+    // First layer columns, one per feature
+    NeuralNetworkLayer &input = layers[0];
+    float *columns = (float*)m_columns, *biases = (float*)m_biases;
+    for (int i = 0; i < NNUE_FEATURES; i++) {
+        for (int j = 0; j < NNUE_HIDDEN; j++) {
+            columns[i*NNUE_HIDDEN+j] = input.Weight(i, j);
+        }
+    }
+    for (int j = 0; j < NNUE_HIDDEN; j++) {
+        biases[j] = input.BiasValues[j]*input.BiasWeights[j];
+    }
+
+    // Later layers
+    for (size_t l = 1; l+1 < layers.size(); l++) {
+        NeuralNetworkLayer &parent = layers[l];
+        Layer &layer = m_layers[l-1];
+        float *weights = (float*)layer.weights, *layerBiases = (float*)layer.biases;
+        for (int j = 0; j < layer.outputs; j++) {
+            for (int i = 0; i < layer.inputs; i++) {
+                weights[j*layer.inputs+i] = parent.Weight(i, j);
+            }
+            layerBiases[j] = parent.BiasValues[j]*parent.BiasWeights[j];
+        }
+    }
+
+    m_loaded = true;
+    return true;
+}
+
+// --------------------------------------------------------
+// Writes the weights to a model file
+// --------------------------------------------------------
+bool Nnue::save(const char *filename) const {
+    if (!m_loaded) {
+        return false;
+    }
+
+    ModelHeader header;
+    memset(&header, 0, sizeof(header));
+    header.type = m_quantised ? MODEL_NNUE_QUANTISED : MODEL_NNUE;
+    header.nLayers = (unsigned int)m_layers.size() + 2;
+    header.policy = m_hasPolicy ? NNUE_POLICY : 0;
+    header.nodes[0] = NNUE_FEATURES;
+    header.activations[0] = ACTIVATION_LINEAR;
+    header.nodes[1] = NNUE_HIDDEN;
+    header.activations[1] = m_activation;
+    for (size_t l = 0; l < m_layers.size(); l++) {
+        header.nodes[l+2] = m_layers[l].outputs;
+        header.activations[l+2] = m_layers[l].activation;
+    }
+
+    // The weights are contiguous in either storage
+    if (isMapped()) {
+        return ModelFile::write(filename, header, m_file.data(),
+            m_file.header()->dataSize);
+    }
+    return ModelFile::write(filename, header, &m_image[0],
+        (unsigned int)m_image.size());
+}
+
+// --------------------------------------------------------
+// Copies the policy head after the value weights, which
+// keep their offsets in the new storage
+// --------------------------------------------------------
+bool Nnue::setPolicy(const float *weights, const float *biases) {
+    if (!m_loaded) {
+        return false;
+    }
+
+    m_hasPolicy = false;
+    unsigned int valueSize = layout(NULL);
+    m_hasPolicy = true;
+    std::vector<char> image(layout(NULL), 0);
+    memcpy(&image[0], isMapped() ? m_file.data() : &m_image[0], valueSize);
+    layout(&image[0]);
+    memcpy((float*)m_policyWeights, weights, NNUE_POLICY*NNUE_HIDDEN*sizeof(float));
+    memcpy((float*)m_policyBiases, biases, NNUE_POLICY*sizeof(float));
+    m_image.swap(image);
+    m_file.close();
+    return true;
+}
+
+// --------------------------------------------------------
+// Bounds the activation of a neuron input range
+// --------------------------------------------------------
+static inline void activateRange(int activation, float &lo, float &hi) {
+    lo = activate(activation, lo);
+    hi = activate(activation, hi);
+}
+
+// --------------------------------------------------------
+// Quantises the weights with a scale per layer. Scales are
+// set by the range of values each layer can produce, found
+// by carrying the ranges of its inputs through the layer.
+// --------------------------------------------------------
+void Nnue::quantise() {
+    if (!m_loaded || m_quantised) {
+        return;
+    }
+
+    // Range of each accumulator sum over the most features a
+    // position can have
+    float lo[NNUE_HIDDEN], hi[NNUE_HIDDEN], bound = 0.0f;
+    std::vector<float> column(NNUE_FEATURES);
+    for (int j = 0; j < NNUE_HIDDEN; j++) {
+        for (int i = 0; i < NNUE_FEATURES; i++) {
+            column[i] = m_columns[i*NNUE_HIDDEN+j];
+        }
+        std::sort(column.begin(), column.end());
+        lo[j] = hi[j] = m_biases[j];
+        for (int i = 0; i < NNUE_MAX_ACTIVE; i++) {
+            lo[j] += (column[i] < 0.0f) ? column[i] : 0.0f;
+            hi[j] += (column[NNUE_FEATURES-1-i] > 0.0f) ? column[NNUE_FEATURES-1-i] : 0.0f;
+        }
+        bound = (-lo[j] > bound) ? -lo[j] : bound;
+        bound = (hi[j] > bound) ? hi[j] : bound;
+    }
+
+    // Scale the accumulator to 16 bits, less the rounding of each feature
+    std::vector<float> scales(1 + 2*m_layers.size());
+    float scale = (float)(NNUE_QUANT_ACTIVATION - (NNUE_MAX_ACTIVE+1)/2) /
+        ((bound > 0.0f) ? bound : 1.0f);
+    scales[0] = scale;
+    std::vector<short> columns(NNUE_FEATURES*NNUE_HIDDEN), biases(NNUE_HIDDEN);
+    for (int i = 0; i < NNUE_FEATURES*NNUE_HIDDEN; i++) {
+        columns[i] = (short)nearest(m_columns[i]*scale);
+    }
+    for (int j = 0; j < NNUE_HIDDEN; j++) {
+        biases[j] = (short)nearest(m_biases[j]*scale);
+        activateRange(m_activation, lo[j], hi[j]);
+    }
+    float inputScale = (m_activation == ACTIVATION_SIGMOID) ?
+        (float)NNUE_QUANT_ACTIVATION : scale;
+
+    std::vector< std::vector<signed char> > weights(m_layers.size());
+    std::vector< std::vector<int> > layerBiases(m_layers.size());
+    for (size_t l = 0; l < m_layers.size(); l++) {
+        const Layer &layer = m_layers[l];
+
+        // Scale the weights by the largest weight of the layer
+        float weightMax = 0.0f;
+        for (int k = 0; k < layer.inputs*layer.outputs; k++) {
+            float w = fabsf(layer.weights[k]);
+            weightMax = (w > weightMax) ? w : weightMax;
+        }
+        float weightScale = NNUE_QUANT_WEIGHT / ((weightMax > 0.0f) ? weightMax : 1.0f);
+
+        int stride = (layer.inputs + 15) & ~15;
+        weights[l].assign(layer.outputs*stride, 0);
+        layerBiases[l].resize(layer.outputs);
+        scales[1+2*l] = 1.0f / (inputScale*weightScale);
+
+        // Quantise the weights and find the range of each output
+        float outputLo[NNUE_HIDDEN], outputHi[NNUE_HIDDEN], outputBound = 0.0f;
+        for (int j = 0; j < layer.outputs; j++) {
+            outputLo[j] = outputHi[j] = layer.biases[j];
+            for (int i = 0; i < layer.inputs; i++) {
+                float w = layer.weights[j*layer.inputs+i];
+                weights[l][j*stride+i] = (signed char)nearest(w*weightScale);
+                outputLo[j] += (w > 0.0f) ? w*lo[i] : w*hi[i];
+                outputHi[j] += (w > 0.0f) ? w*hi[i] : w*lo[i];
+            }
+            layerBiases[l][j] = nearest(layer.biases[j]*inputScale*weightScale);
+            activateRange(layer.activation, outputLo[j], outputHi[j]);
+            outputBound = (-outputLo[j] > outputBound) ? -outputLo[j] : outputBound;
+            outputBound = (outputHi[j] > outputBound) ? outputHi[j] : outputBound;
+        }
+        scales[2+2*l] = NNUE_QUANT_ACTIVATION / ((outputBound > 0.0f) ? outputBound : 1.0f);
+
+        for (int j = 0; j < layer.outputs; j++) {
+            lo[j] = outputLo[j];
+            hi[j] = outputHi[j];
+        }
+        inputScale = scales[2+2*l];
+    }
+
+    // Keep the policy head, which is not quantised
+    std::vector<float> policy;
+    if (m_hasPolicy) {
+        policy.assign(m_policyWeights, m_policyWeights + NNUE_POLICY*NNUE_HIDDEN);
+        policy.insert(policy.end(), m_policyBiases, m_policyBiases + NNUE_POLICY);
+    }
+
+    // Replace the float weights with the quantised layout, the
+    // scales blob first so that binding the layout reads them
+    m_quantised = true;
+    std::vector<char> image(layout(NULL), 0);
+    memcpy(&image[0], &scales[0], scales.size()*sizeof(float));
+    layout(&image[0]);
+    memcpy((short*)m_quantisedColumns, &columns[0], columns.size()*sizeof(short));
+    memcpy((short*)m_quantisedBiases, &biases[0], biases.size()*sizeof(short));
+    for (size_t l = 0; l < m_layers.size(); l++) {
+        memcpy((signed char*)m_layers[l].quantisedWeights, &weights[l][0], weights[l].size());
+        memcpy((int*)m_layers[l].quantisedBiases, &layerBiases[l][0],
+            layerBiases[l].size()*sizeof(int));
+    }
+    if (m_hasPolicy) {
+        memcpy((float*)m_policyWeights, &policy[0], NNUE_POLICY*NNUE_HIDDEN*sizeof(float));
+        memcpy((float*)m_policyBiases, &policy[NNUE_POLICY*NNUE_HIDDEN],
+            NNUE_POLICY*sizeof(float));
+    }
+    m_image.swap(image);
+    m_file.close();
+}
+
+// --------------------------------------------------------
+// Size of the weights in bytes
+// --------------------------------------------------------
+int Nnue::size() const {
+    if (isMapped()) {
+        return (int)m_file.header()->dataSize;
+    }
+    return (int)m_image.size();
+}
+
+// --------------------------------------------------------
+// Sums the columns of the active features
+// --------------------------------------------------------
+void Nnue::refresh(const int *features, int nFeatures,
+    NnueAccumulator *accumulator) const {
+    if (m_quantised) {
+        for (int j = 0; j < NNUE_HIDDEN; j++) {
+            accumulator->quantised[j] = m_quantisedBiases[j];
+        }
+        for (int i = 0; i < nFeatures; i++) {
+            const short *column = &m_quantisedColumns[features[i]*NNUE_HIDDEN];
+            for (int j = 0; j < NNUE_HIDDEN; j++) {
+                accumulator->quantised[j] += column[j];
+            }
+        }
+        return;
+    }
+
+    for (int j = 0; j < NNUE_HIDDEN; j++) {
+        accumulator->values[j] = m_biases[j];
+    }
+    for (int i = 0; i < nFeatures; i++) {
+        const float *column = &m_columns[features[i]*NNUE_HIDDEN];
+        for (int j = 0; j < NNUE_HIDDEN; j++) {
+            accumulator->values[j] += column[j];
+        }
+    }
+}
+
+// --------------------------------------------------------
+// Adds and subtracts the columns of changed features
+// --------------------------------------------------------
+void Nnue::update(const NnueAccumulator *in, NnueAccumulator *out,
+    const int *added, int nAdded, const int *removed, int nRemoved) const {
+    *out = *in;
+    if (m_quantised) {
+        for (int i = 0; i < nAdded; i++) {
+            const short *column = &m_quantisedColumns[added[i]*NNUE_HIDDEN];
+            for (int j = 0; j < NNUE_HIDDEN; j++) {
+                out->quantised[j] += column[j];
+            }
+        }
+        for (int i = 0; i < nRemoved; i++) {
+            const short *column = &m_quantisedColumns[removed[i]*NNUE_HIDDEN];
+            for (int j = 0; j < NNUE_HIDDEN; j++) {
+                out->quantised[j] -= column[j];
+            }
+        }
+        return;
+    }
+
+    for (int i = 0; i < nAdded; i++) {
+        const float *column = &m_columns[added[i]*NNUE_HIDDEN];
+        for (int j = 0; j < NNUE_HIDDEN; j++) {
+            out->values[j] += column[j];
+        }
+    }
+    for (int i = 0; i < nRemoved; i++) {
+        const float *column = &m_columns[removed[i]*NNUE_HIDDEN];
+        for (int j = 0; j < NNUE_HIDDEN; j++) {
+            out->values[j] -= column[j];
+        }
+    }
+}
+
+// --------------------------------------------------------
+// Runs the layers after the accumulator
+// --------------------------------------------------------
+float Nnue::evaluate(const NnueAccumulator *accumulator, int player) const {
+    if (m_quantised) {
+        return evaluateQuantised(accumulator, player);
+    }
+
+    float buffer[2][NNUE_HIDDEN];
+    float *values = buffer[0], *next = buffer[1];
+    transform(accumulator, player, values);
+
+    // Later layers
+    int n = NNUE_HIDDEN;
+    for (size_t l = 0; l < m_layers.size(); l++) {
+        const Layer &layer = m_layers[l];
+        for (int j = 0; j < layer.outputs; j++) {
+            const float *row = &layer.weights[j*layer.inputs];
+            float x = layer.biases[j];
+            for (int i = 0; i < layer.inputs; i++) {
+                x += row[i]*values[i];
+            }
+            next[j] = activate(layer.activation, x);
+        }
+        float *swap = values; values = next; next = swap;
+        n = layer.outputs;
+    }
+
+    return (n > 1) ? values[0] - values[1] : values[0];
+}
+
+// --------------------------------------------------------
+// Runs the layers after the accumulators of a batch
+// --------------------------------------------------------
+void Nnue::evaluateBatch(const NnueAccumulator *const *accumulators,
+    const int *players, int n, float *values) const {
+    for (int start = 0; start < n; start += NNUE_MAX_BATCH) {
+        int count = std::min(n - start, NNUE_MAX_BATCH);
+        if (m_quantised) {
+            evaluateQuantisedBatch(&accumulators[start], &players[start],
+                count, &values[start]);
+            continue;
+        }
+
+        // Activation rows of the batch
+        float buffer[2][NNUE_MAX_BATCH*NNUE_HIDDEN];
+        float *rows = buffer[0], *next = buffer[1];
+        for (int r = 0; r < count; r++) {
+            transform(accumulators[start+r], players[start+r], &rows[r*NNUE_HIDDEN]);
+        }
+
+        // Later layers
+        int outputs = NNUE_HIDDEN;
+        for (size_t l = 0; l < m_layers.size(); l++) {
+            const Layer &layer = m_layers[l];
+            multiplyLayer(rows, count, layer.inputs, layer.weights,
+                layer.biases, layer.outputs, layer.activation, next);
+            float *swap = rows; rows = next; next = swap;
+            outputs = layer.outputs;
+        }
+
+        for (int r = 0; r < count; r++) {
+            const float *row = &rows[r*NNUE_HIDDEN];
+            values[start+r] = (outputs > 1) ? row[0] - row[1] : row[0];
+        }
+    }
+}
+
+// --------------------------------------------------------
+// Activates the quantised accumulator with the side to
+// move as the 16 bit inputs of the later layers
+// --------------------------------------------------------
+void Nnue::transformQuantised(const NnueAccumulator *accumulator, int player,
+    short *values) const {
+    const short *side = &m_quantisedColumns[NNUE_SIDE_FEATURE*NNUE_HIDDEN];
+    for (int j = 0; j < NNUE_HIDDEN; j++) {
+        int x = accumulator->quantised[j] + (player == 0 ? side[j] : 0);
+        if (m_activation == ACTIVATION_RELU) {
+            values[j] = (short)(x > 0 ? x : 0);
+        } else if (m_activation == ACTIVATION_LINEAR) {
+            values[j] = (short)x;
+        } else {
+            values[j] = (short)nearest(NNUE_QUANT_ACTIVATION*activate(m_activation, x/m_scale));
+        }
+    }
+}
+
+// --------------------------------------------------------
+// Runs the quantised layers after the accumulator
+// --------------------------------------------------------
+float Nnue::evaluateQuantised(const NnueAccumulator *accumulator,
+    int player) const {
+    short buffer[2][NNUE_HIDDEN];
+    short *values = buffer[0], *next = buffer[1];
+    float outputs[NNUE_HIDDEN];
+
+    // Activate the accumulator with the side to move
+    transformQuantised(accumulator, player, values);
+
+    // Later layers, the last one left as floating point
+    int n = NNUE_HIDDEN;
+    for (size_t l = 0; l < m_layers.size(); l++) {
+        const Layer &layer = m_layers[l];
+        bool last = (l+1 == m_layers.size());
+        for (int j = 0; j < layer.outputs; j++) {
+            int sum = dot(&layer.quantisedWeights[j*layer.stride], values, layer.stride);
+            float x = activate(layer.activation,
+                (sum + layer.quantisedBiases[j])*layer.dequantise);
+            if (last) {
+                outputs[j] = x;
+            } else {
+                next[j] = (short)nearest(x*layer.scale);
+            }
+        }
+        for (int j = layer.outputs; !last && j < ((layer.outputs + 15) & ~15); j++) {
+            next[j] = 0;
+        }
+        short *swap = values; values = next; next = swap;
+        n = layer.outputs;
+    }
+
+    return (n > 1) ? outputs[0] - outputs[1] : outputs[0];
+}
+
+// --------------------------------------------------------
+// Runs the quantised layers after the accumulators of a
+// batch, taking each weight row once for all positions
+// --------------------------------------------------------
+void Nnue::evaluateQuantisedBatch(const NnueAccumulator *const *accumulators,
+    const int *players, int n, float *values) const {
+    short buffer[2][NNUE_MAX_BATCH][NNUE_HIDDEN];
+    short (*rows)[NNUE_HIDDEN] = buffer[0], (*next)[NNUE_HIDDEN] = buffer[1];
+    float outputs[NNUE_MAX_BATCH][NNUE_HIDDEN];
+
+    for (int r = 0; r < n; r++) {
+        transformQuantised(accumulators[r], players[r], rows[r]);
+    }
+
+    // Later layers, the last one left as floating point
+    int outputCount = NNUE_HIDDEN;
+    for (size_t l = 0; l < m_layers.size(); l++) {
+        const Layer &layer = m_layers[l];
+        bool last = (l+1 == m_layers.size());
+        for (int j = 0; j < layer.outputs; j++) {
+            const signed char *row = &layer.quantisedWeights[j*layer.stride];
+            for (int r = 0; r < n; r++) {
+                int sum = dot(row, rows[r], layer.stride);
+                float x = activate(layer.activation,
+                    (sum + layer.quantisedBiases[j])*layer.dequantise);
+                if (last) {
+                    outputs[r][j] = x;
+                } else {
+                    next[r][j] = (short)nearest(x*layer.scale);
+                }
+            }
+        }
+        for (int j = layer.outputs; !last && j < ((layer.outputs + 15) & ~15); j++) {
+            for (int r = 0; r < n; r++) {
+                next[r][j] = 0;
+            }
+        }
+        short (*swap)[NNUE_HIDDEN] = rows; rows = next; next = swap;
+        outputCount = layer.outputs;
+    }
+
+    for (int r = 0; r < n; r++) {
+        values[r] = (outputCount > 1) ? outputs[r][0] - outputs[r][1] : outputs[r][0];
+    }
+}
+
+// --------------------------------------------------------
+// Activates the accumulator with the side to move
+// --------------------------------------------------------
+void Nnue::transform(const NnueAccumulator *accumulator, int player,
+    float *values) const {
+    if (m_quantised) {
+        const short *side = &m_quantisedColumns[NNUE_SIDE_FEATURE*NNUE_HIDDEN];
+        for (int j = 0; j < NNUE_HIDDEN; j++) {
+            int x = accumulator->quantised[j] + (player == 0 ? side[j] : 0);
+            values[j] = activate(m_activation, x/m_scale);
+        }
+        return;
+    }
+
+    const float *side = &m_columns[NNUE_SIDE_FEATURE*NNUE_HIDDEN];
+    for (int j = 0; j < NNUE_HIDDEN; j++) {
+        float x = accumulator->values[j] + (player == 0 ? side[j] : 0.0f);
+        values[j] = activate(m_activation, x);
+    }
+}
+
+// --------------------------------------------------------
+// Runs the policy head on the activated accumulator
+// --------------------------------------------------------
+void Nnue::policy(const NnueAccumulator *accumulator, int player,
+    float *logits) const {
+    float values[NNUE_HIDDEN];
+    transform(accumulator, player, values);
+    for (int k = 0; k < NNUE_POLICY; k++) {
+        const float *row = &m_policyWeights[k*NNUE_HIDDEN];
+        float x = m_policyBiases[k];
+        for (int j = 0; j < NNUE_HIDDEN; j++) {
+            x += row[j]*values[j];
+        }
+        logits[k] = x;
+    }
+}
+
+// --------------------------------------------------------
+// Scores a move by its piece and the cells it covers
+// --------------------------------------------------------
+float Nnue::placementLogit(const float *logits, int piece,
+    const int cells[][2], int nCells) {
+    float sum = 0.0f;
+    for (int i = 0; i < nCells; i++) {
+        sum += logits[cellPolicy(cells[i][0], cells[i][1])];
+    }
+    return logits[piecePolicy(piece)] + ((nCells > 0) ? sum/nCells : 0.0f);
+}
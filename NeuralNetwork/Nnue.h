@@ -0,0 +1,239 @@
+/* ============================================================================
+
+    Project: Blokus AI - Neural Network Trainer
+
+    Defines an efficiently updatable evaluation network. The first layer is
+    kept as an accumulator which a search updates with the few features a
+    move changes, so only the small later layers run at each leaf. A loaded
+    network can be quantised to 16 bit accumulators and 8 bit later layers
+    evaluated with integer vector instructions. Weights can be saved to a
+    binary model file and evaluated from it in place once mapped. A policy
+    head on the accumulator can score every move of a position in one pass.
+
+    File: Nnue.h
+
+============================================================================= */
+
+#ifndef NNUE_H
+#define NNUE_H
+
+#include <vector>
+
+#include "ModelFile.h"
+
+// Feature layout: the tiles covered by each player, the pieces each player
+// has left, and whether player 0 (blue) is to move
+#define NNUE_CELLS        196
+#define NNUE_PIECES       21
+#define NNUE_SIDE_FEATURE (2*NNUE_CELLS + 2*NNUE_PIECES)
+#define NNUE_FEATURES     (NNUE_SIDE_FEATURE + 1)
+
+// Most features of a position: each placed piece adds its tiles and
+// removes its piece feature, so a position has at most the 89 tiles of
+// each piece set and the side to move
+#define NNUE_MAX_ACTIVE   (2*89 + 1)
+
+// Accumulator width, which is also the widest later layer
+#define NNUE_HIDDEN 64
+
+// Positions whose later layers evaluateBatch runs together
+#define NNUE_MAX_BATCH 32
+
+// Policy head outputs: a logit for each piece then for each cell. A move is
+// scored by the logit of its piece plus the mean logit of the cells it
+// covers, so one pass over the head scores every move of a position.
+#define NNUE_POLICY (NNUE_PIECES + NNUE_CELLS)
+
+// Largest magnitude of quantised activations and later layer weights
+#define NNUE_QUANT_ACTIVATION 32767
+#define NNUE_QUANT_WEIGHT     127
+
+class NeuralNetwork;
+
+// -----------------------------------------------------------------------------
+// First layer sums of a position, without the side to move feature which is
+// added at evaluation so that passes need no update. Quantised networks use
+// 16 bit sums.
+// -----------------------------------------------------------------------------
+struct NnueAccumulator {
+    union {
+        float values[NNUE_HIDDEN];
+        short quantised[NNUE_HIDDEN];
+    };
+};
+
+class Nnue {
+    public:
+        Nnue();
+
+        // ---------------------------------------------------------------------
+        // Loads the weights from a network saved by NeuralNetwork::DumpData
+        // or DumpBinary, or maps a model file written by save and evaluates
+        // with its weights in place. The network must have NNUE_FEATURES
+        // inputs, a first hidden layer of NNUE_HIDDEN nodes and no later
+        // layer wider than that. Returns false if the file could not be read
+        // or has another topology.
+        // ---------------------------------------------------------------------
+        bool load(const char *filename);
+        bool load(NeuralNetwork &network);
+
+        // ---------------------------------------------------------------------
+        // Writes the weights, quantised if they are, to a model file which
+        // load maps without copying. Returns false if nothing is loaded or
+        // the file could not be written.
+        // ---------------------------------------------------------------------
+        bool save(const char *filename) const;
+
+        // ---------------------------------------------------------------------
+        // Quantises the loaded weights. The first layer weights become 16 bit
+        // with a scale that keeps the sum of any NNUE_MAX_ACTIVE features
+        // within 16 bits, the later layers 8 bit with a scale per layer.
+        // Activations between the later layers are requantised to 16 bits
+        // with a scale bounding the largest value each layer can produce.
+        // Accumulators must be refreshed after quantising.
+        // ---------------------------------------------------------------------
+        void quantise();
+
+        bool isLoaded() const { return m_loaded; }
+        bool isQuantised() const { return m_quantised; }
+        bool hasPolicy() const { return m_hasPolicy; }
+
+        // ---------------------------------------------------------------------
+        // Adds or replaces the policy head, NNUE_POLICY rows of NNUE_HIDDEN
+        // weights and a bias for each output. The head stays floating point
+        // when the rest of the network is quantised, and is saved after the
+        // value weights. Returns false if nothing is loaded.
+        // ---------------------------------------------------------------------
+        bool setPolicy(const float *weights, const float *biases);
+
+        // Size of the weights in bytes
+        int size() const;
+
+        // Whether the weights are used in place from a mapped model file
+        bool isMapped() const { return m_file.header() != NULL; }
+
+        // Feature indices
+        static int cellFeature(int x, int y, int player) {
+            return player*NNUE_CELLS + x*14 + y;
+        }
+        static int pieceFeature(int piece, int player) {
+            return 2*NNUE_CELLS + player*NNUE_PIECES + piece;
+        }
+
+        // Policy output indices
+        static int piecePolicy(int piece) {
+            return piece;
+        }
+        static int cellPolicy(int x, int y) {
+            return NNUE_PIECES + x*14 + y;
+        }
+
+        // ---------------------------------------------------------------------
+        // Scores a move from the policy logits, the logit of its piece plus
+        // the mean logit of the cells it covers
+        // ---------------------------------------------------------------------
+        static float placementLogit(const float *logits, int piece,
+            const int cells[][2], int nCells);
+
+        // ---------------------------------------------------------------------
+        // Computes the accumulator of a position from its active features
+        // ---------------------------------------------------------------------
+        void refresh(const int *features, int nFeatures,
+            NnueAccumulator *accumulator) const;
+
+        // ---------------------------------------------------------------------
+        // Computes the accumulator after a move from the one before it by
+        // adding the columns of the features the move set and subtracting
+        // those it cleared. The input is left unchanged, so a search undoes
+        // the move by returning to the input accumulator.
+        // ---------------------------------------------------------------------
+        void update(const NnueAccumulator *in, NnueAccumulator *out,
+            const int *added, int nAdded, const int *removed, int nRemoved) const;
+
+        // ---------------------------------------------------------------------
+        // Evaluates the later layers for the player to move. Returns the
+        // difference of the two outputs, the advantage of player 0, or the
+        // single output of a network with one.
+        // ---------------------------------------------------------------------
+        float evaluate(const NnueAccumulator *accumulator, int player) const;
+
+        // ---------------------------------------------------------------------
+        // Evaluates the later layers for a batch of accumulators, each with
+        // its player to move, giving the same values as evaluate. Each layer
+        // is run as a product of the batch activations and the weights, in
+        // groups of NNUE_MAX_BATCH positions, so each weight is loaded once
+        // per group rather than once per position.
+        // ---------------------------------------------------------------------
+        void evaluateBatch(const NnueAccumulator *const *accumulators,
+            const int *players, int n, float *values) const;
+
+        // ---------------------------------------------------------------------
+        // Activates the accumulator with the side to move feature, giving the
+        // inputs of the later layers and the policy head as floating point
+        // ---------------------------------------------------------------------
+        void transform(const NnueAccumulator *accumulator, int player,
+            float *values) const;
+
+        // ---------------------------------------------------------------------
+        // Computes the NNUE_POLICY logits of the policy head for the player
+        // to move. The network must have a policy head.
+        // ---------------------------------------------------------------------
+        void policy(const NnueAccumulator *accumulator, int player,
+            float *logits) const;
+
+    private:
+        // A dense layer after the accumulator, weights stored by output row.
+        // Quantised rows are padded to a multiple of 16 weights.
+        struct Layer {
+            int inputs, outputs, activation;
+            const float *weights;
+            const float *biases;
+            int stride;
+            const signed char *quantisedWeights;
+            const int *quantisedBiases;
+            float dequantise;         // Sum to value, the inverse of both scales
+            float scale;              // Value to quantised output activation
+        };
+
+        // ---------------------------------------------------------------------
+        // Walks the weight blobs of the model file layout for the topology,
+        // pointing the weights into the data if it is given. Returns the
+        // size of the layout in bytes.
+        // ---------------------------------------------------------------------
+        unsigned int layout(const char *data);
+
+        float evaluateQuantised(const NnueAccumulator *accumulator,
+            int player) const;
+        void evaluateQuantisedBatch(const NnueAccumulator *const *accumulators,
+            const int *players, int n, float *values) const;
+        void transformQuantised(const NnueAccumulator *accumulator, int player,
+            short *values) const;
+
+        bool m_loaded;
+        bool m_quantised;
+        const float *m_columns;       // First layer weights by feature
+        const float *m_biases;        // First layer bias contributions
+        int m_activation;             // Activation of the accumulator
+        std::vector<Layer> m_layers;
+
+        // Quantised first layer
+        const short *m_quantisedColumns;
+        const short *m_quantisedBiases;
+        float m_scale;                // Accumulator value to quantised sum
+
+        // Policy head, weights stored by output row
+        bool m_hasPolicy;
+        const float *m_policyWeights;
+        const float *m_policyBiases;
+
+        // Storage of the weights, either owned in the model file layout or
+        // a mapped model file
+        std::vector<char> m_image;
+        ModelFile m_file;
+
+        // Weights point into the storage
+        Nnue(const Nnue&);
+        Nnue &operator=(const Nnue&);
+};
+
+#endif /* NNUE_H */
@@ -43,6 +43,9 @@
 // Type definitions
 #include "Types.h"
 
+// Self-play driver
+#include "SelfPlay.h"
+
 // Include header
 #include "Random.h"
 
@@ -29,9 +29,31 @@
 // Standard Includes
 #include "Includes.h"
 
+// Self-play adapter of the AI player
+class RandomSelfPlay : public SelfPlayEngine
+{
+public:
+	void startup( int boardSize, int startTile[][2], int nPlayers ) {
+		m_player.startup( boardSize, startTile, nPlayers ); }
+	void shutdown( ) { m_player.shutdown( ); }
+	Move makeMove( char board[][20], bool pieces[][21], int score[], int player, int ply, Move moves[42] ) {
+		return m_player.makeMove( board, pieces, score, player ); }
+	bool getMoveUtility( float* utility ) { return false; }
+
+private:
+	Random m_player;
+};
+
+// Self-play adapter construction
+static SelfPlayEngine* createEngine( ) { return new RandomSelfPlay; }
+
 // Application entry point
 int main( int argc, char* argv[] )
 {
+	// Play headless self-play games for training data
+	if( argc > 1 && std::string( argv[1] ) == "-selfplay" )
+		return SelfPlay::runCommand( argc-2, argv+2, &createEngine, false );
+
 	// AI Player
 	Random player;
 
@@ -0,0 +1,135 @@
+/* ===========================================================================
+
+	Project: Headless match runner for Blokus
+
+	Description:
+	  Launches an AI player executable and exchanges the match state and
+	  its moves through the shared memory map used by the simulator.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Standard includes
+#include "Includes.h"
+
+// Include header
+#include "EngineProcess.h"
+
+// Milliseconds a stopped player is given to exit
+#define EXIT_WAIT  1000
+
+// Static member variables
+volatile long EngineProcess::m_nextKey;
+
+// --------------------------------------------------------
+//	Initializes the state.
+// --------------------------------------------------------
+EngineProcess::EngineProcess( ) :
+	m_transport( PlayerTransport::create( ) ),
+	m_memoryView( NULL )
+{
+}
+//
+// --------------------------------------------------------
+//	Start - Builds a memory map named by the runner process
+//  and a key, loads the match settings into it and
+//  launches the player with the name on its command line.
+// --------------------------------------------------------
+bool EngineProcess::start( const std::string& name, const MatchCore& core, int player )
+{
+	stop( );
+
+	// Generate a memory map filename unique among the runner's players
+	std::stringstream filename; filename << "BlokusRunner" << Platform::getProcessId( )
+		<< "_" << Platform::increment( &m_nextKey );
+
+	// Build the memory map
+	m_memoryView = m_transport->open( filename.str( ) );
+	if( !m_memoryView ) return false;
+
+	// Load match settings into mapped file
+	core.getGameSettings( m_memoryView, player );
+
+	// Launch AI agent process
+	std::string exename = std::string( "Players" PATH_SEPARATOR ) + name;
+	if( !m_transport->launch( exename ) ) { stop( ); return false; }
+
+	return true;
+}
+//
+// --------------------------------------------------------
+//	Stop - Sets the match over indicator the players wait
+//  on between turns and releases the process and map.
+// --------------------------------------------------------
+void EngineProcess::stop( )
+{
+	if( m_memoryView ) m_memoryView->matchOver = true;
+	m_transport->close( EXIT_WAIT );
+	m_memoryView = NULL;
+}
+//
+// --------------------------------------------------------
+//	GetMove - Copies the match state into the map and
+//  notifies the player, then yields until its move is
+//  ready, the time limit passes or the process exits.
+//  The players clear the turn indicator after posting
+//  their move, so a player moving again after a skip
+//  is only notified once the previous turn is cleared.
+// --------------------------------------------------------
+int EngineProcess::getMove( const MatchCore& core, float timeLimit, Move* move )
+{
+	if( !m_transport->isRunning( ) ) return ENGINE_EXITED;
+	unsigned int startTime = Platform::getTime( );
+	unsigned int limit = (unsigned int)( timeLimit * 1000.0f );
+
+	// Wait for the previous turn to be cleared
+	while( m_memoryView->turnReady )
+	{
+		if( !m_transport->isRunning( ) )
+			return ENGINE_EXITED;
+		if( Platform::getTime( ) - startTime > limit )
+			return ENGINE_TIMEOUT;
+		Platform::yield( );
+	}
+
+	// Copy the match state and notify the ai process
+	m_memoryView->moveReady = false;
+	core.getGameState( m_memoryView );
+	m_memoryView->turnReady = true;
+
+	// Wait for the move
+	while( !m_memoryView->moveReady )
+	{
+		// Verify AI still active
+		if( !m_transport->isRunning( ) )
+			return ENGINE_EXITED;
+
+		// Check the time limit
+		if( Platform::getTime( ) - startTime > limit )
+			return ENGINE_TIMEOUT;
+
+		Platform::yield( );
+	}
+
+	// Take the move
+	*move = m_memoryView->move;
+	m_memoryView->moveReady = false;
+
+	return ENGINE_MOVED;
+}
@@ -0,0 +1,68 @@
+/* ===========================================================================
+
+	Project: Headless match runner for Blokus
+
+	Description:
+	  Launches an AI player executable and exchanges the match state and
+	  its moves through the shared memory map used by the simulator.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Begin definition
+#ifndef ENGINE_PROCESS_H
+#define ENGINE_PROCESS_H
+
+// Move request results
+#define ENGINE_MOVED     0   //< The player returned a move
+#define ENGINE_TIMEOUT   1   //< The player exceeded the time limit
+#define ENGINE_EXITED    2   //< The player process is not running
+
+// AI player process
+class EngineProcess
+{
+public:
+	EngineProcess( );
+	~EngineProcess( ) { stop( ); delete m_transport; }
+
+	// Launches Players\<name> as the player of a match in the
+	// settings of the core. Returns false if it can not be started.
+	bool start( const std::string& name, const MatchCore& core, int player );
+
+	// Signals the end of the match to the player and closes it,
+	// terminating the process if it does not exit
+	void stop( );
+
+	// Hands the turn in the core to the player and waits for its
+	// move, returning one of the move request results
+	int getMove( const MatchCore& core, float timeLimit, Move* move );
+
+private:
+	// Copying would close the process twice
+	EngineProcess( const EngineProcess& );
+	EngineProcess& operator=( const EngineProcess& );
+
+	PlayerTransport* m_transport;	//< Memory map and player process
+	GameData* m_memoryView;			//< View of the shared memory map
+
+	static volatile long m_nextKey;	//< Key of the next memory map name
+};
+
+// End definition
+#endif
@@ -0,0 +1,54 @@
+/* ===========================================================================
+
+	Project: Headless match runner for Blokus
+
+	Description:
+	  Includes the standard header files used by the match runner.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Begin definitions
+#ifndef INCLUDES_H
+#define INCLUDES_H
+
+// C++ Standard library 
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <time.h>
+
+// Operating system services
+#include "Platform.h"
+
+// Type definitions
+#include "Types.h"
+
+// Match rules
+#include "MatchCore.h"
+
+// Engine processes
+#include "PlayerTransport.h"
+#include "EngineProcess.h"
+
+// End def
+#endif
@@ -0,0 +1,212 @@
+/* ===========================================================================
+
+	Project: Headless match runner for Blokus
+
+	Description:
+	  Wraps the threads, clocks and file system services of the operating
+	  system used by the runner, for Win32 and POSIX.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Include header
+#include "Platform.h"
+
+// Operating system headers
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+// Thread entry and data, released by the thread
+struct ThreadStart { ThreadEntry entry; void* data; };
+
+// Win32 implementation
+#ifdef _WIN32
+
+// --------------------------------------------------------
+//	RunThread - Calls the entry of a thread started by
+//  startThread and releases its start data.
+// --------------------------------------------------------
+static unsigned int __stdcall runThread( void* start )
+{
+	ThreadStart info = *(ThreadStart*)start;
+	delete (ThreadStart*)start;
+	info.entry( info.data );
+
+	return 0;
+}
+//
+// --------------------------------------------------------
+//	StartThread - Launches a thread with the C runtime,
+//  returning its handle.
+// --------------------------------------------------------
+void* Platform::startThread( ThreadEntry entry, void* data )
+{
+	ThreadStart* start = new ThreadStart; start->entry = entry; start->data = data;
+	HANDLE thread = (HANDLE)_beginthreadex( NULL, 0, &runThread, start, 0, NULL );
+	if( !thread ) delete start;
+
+	return thread;
+}
+//
+// --------------------------------------------------------
+//	JoinThread - Waits on the thread handle and closes it.
+// --------------------------------------------------------
+void Platform::joinThread( void* thread )
+{
+	WaitForSingleObject( (HANDLE)thread, INFINITE );
+	CloseHandle( (HANDLE)thread );
+}
+//
+// --------------------------------------------------------
+//	Mutex - Unnamed mutex objects of the process.
+// --------------------------------------------------------
+void* Platform::createMutex( ) { return CreateMutex( NULL, FALSE, NULL ); }
+void Platform::destroyMutex( void* mutex ) { CloseHandle( (HANDLE)mutex ); }
+void Platform::lock( void* mutex ) { WaitForSingleObject( (HANDLE)mutex, INFINITE ); }
+void Platform::unlock( void* mutex ) { ReleaseMutex( (HANDLE)mutex ); }
+//
+// --------------------------------------------------------
+//	Atomics - Interlocked operations.
+// --------------------------------------------------------
+long Platform::increment( volatile long* value ) { return InterlockedIncrement( value ); }
+void Platform::exchange( volatile long* target, long value ) { InterlockedExchange( target, value ); }
+//
+// --------------------------------------------------------
+//	GetTime - System tick count, which wraps after about
+//  49 days.
+// --------------------------------------------------------
+unsigned int Platform::getTime( ) { return GetTickCount( ); }
+//
+// --------------------------------------------------------
+//	Yield - Switches to a thread ready on this processor.
+// --------------------------------------------------------
+void Platform::yield( ) { SwitchToThread( ); }
+//
+// --------------------------------------------------------
+//	System - Process and processor information.
+// --------------------------------------------------------
+int Platform::getProcessId( ) { return (int)GetCurrentProcessId( ); }
+int Platform::getProcessorCount( )
+{
+	SYSTEM_INFO systemInfo; GetSystemInfo( &systemInfo );
+	return (int)systemInfo.dwNumberOfProcessors;
+}
+//
+// --------------------------------------------------------
+//	MakeDirectory - Fails quietly if the directory exists.
+// --------------------------------------------------------
+void Platform::makeDirectory( const char* path ) { CreateDirectoryA( path, NULL ); }
+
+// POSIX implementation
+#else
+
+// --------------------------------------------------------
+//	RunThread - Calls the entry of a thread started by
+//  startThread and releases its start data.
+// --------------------------------------------------------
+static void* runThread( void* start )
+{
+	ThreadStart info = *(ThreadStart*)start;
+	delete (ThreadStart*)start;
+	info.entry( info.data );
+
+	return NULL;
+}
+//
+// --------------------------------------------------------
+//	StartThread - Launches a pthread, returning its id.
+// --------------------------------------------------------
+void* Platform::startThread( ThreadEntry entry, void* data )
+{
+	ThreadStart* start = new ThreadStart; start->entry = entry; start->data = data;
+	pthread_t* thread = new pthread_t;
+	if( pthread_create( thread, NULL, &runThread, start ) != 0 ) {
+		delete start; delete thread; return NULL; }
+
+	return thread;
+}
+//
+// --------------------------------------------------------
+//	JoinThread - Joins the pthread and releases its id.
+// --------------------------------------------------------
+void Platform::joinThread( void* thread )
+{
+	pthread_join( *(pthread_t*)thread, NULL );
+	delete (pthread_t*)thread;
+}
+//
+// --------------------------------------------------------
+//	Mutex - Default pthread mutexes.
+// --------------------------------------------------------
+void* Platform::createMutex( )
+{
+	pthread_mutex_t* mutex = new pthread_mutex_t;
+	pthread_mutex_init( mutex, NULL );
+
+	return mutex;
+}
+void Platform::destroyMutex( void* mutex )
+{
+	pthread_mutex_destroy( (pthread_mutex_t*)mutex );
+	delete (pthread_mutex_t*)mutex;
+}
+void Platform::lock( void* mutex ) { pthread_mutex_lock( (pthread_mutex_t*)mutex ); }
+void Platform::unlock( void* mutex ) { pthread_mutex_unlock( (pthread_mutex_t*)mutex ); }
+//
+// --------------------------------------------------------
+//	Atomics - GCC builtins with a full barrier.
+// --------------------------------------------------------
+long Platform::increment( volatile long* value ) { return __sync_add_and_fetch( value, 1 ); }
+void Platform::exchange( volatile long* target, long value ) { __sync_lock_test_and_set( target, value ); __sync_synchronize( ); }
+//
+// --------------------------------------------------------
+//	GetTime - Monotonic clock in milliseconds, truncated
+//  to wrap like the Win32 tick count.
+// --------------------------------------------------------
+unsigned int Platform::getTime( )
+{
+	timespec now; clock_gettime( CLOCK_MONOTONIC, &now );
+	return (unsigned int)( now.tv_sec*1000 + now.tv_nsec/1000000 );
+}
+//
+// --------------------------------------------------------
+//	Yield - Lets another thread run.
+// --------------------------------------------------------
+void Platform::yield( ) { sched_yield( ); }
+//
+// --------------------------------------------------------
+//	System - Process and processor information.
+// --------------------------------------------------------
+int Platform::getProcessId( ) { return (int)getpid( ); }
+int Platform::getProcessorCount( ) { return (int)sysconf( _SC_NPROCESSORS_ONLN ); }
+//
+// --------------------------------------------------------
+//	MakeDirectory - Fails quietly if the directory exists.
+// --------------------------------------------------------
+void Platform::makeDirectory( const char* path ) { mkdir( path, 0755 ); }
+
+#endif
@@ -0,0 +1,79 @@
+/* ===========================================================================
+
+	Project: Headless match runner for Blokus
+
+	Description:
+	  Wraps the threads, clocks and file system services of the operating
+	  system used by the runner, for Win32 and POSIX.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Begin definition
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+// Separator of the directories in a path
+#ifdef _WIN32
+#define PATH_SEPARATOR "\\"
+#else
+#define PATH_SEPARATOR "/"
+#endif
+
+// Thread entry function
+typedef void (*ThreadEntry)( void* data );
+
+// Operating system services of the runner
+class Platform
+{
+public:
+	// Starts a thread running the entry, returns NULL on failure
+	static void* startThread( ThreadEntry entry, void* data );
+
+	// Waits for a thread to finish and releases it
+	static void joinThread( void* thread );
+
+	// Mutual exclusion between the threads
+	static void* createMutex( );
+	static void destroyMutex( void* mutex );
+	static void lock( void* mutex );
+	static void unlock( void* mutex );
+
+	// Atomically increments a value, returning the new value
+	static long increment( volatile long* value );
+
+	// Atomically sets a value
+	static void exchange( volatile long* target, long value );
+
+	// Milliseconds since an unspecified start, wrapping around
+	static unsigned int getTime( );
+
+	// Gives the rest of the time slice to another thread
+	static void yield( );
+
+	// Process and system information
+	static int getProcessId( );
+	static int getProcessorCount( );
+
+	// Creates a directory if it does not exist
+	static void makeDirectory( const char* path );
+};
+
+// End definition
+#endif
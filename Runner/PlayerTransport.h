@@ -0,0 +1,60 @@
+/* ===========================================================================
+
+	Project: Headless match runner for Blokus
+
+	Description:
+	  Shares the match state with an AI player process through a memory
+	  map, implemented for Win32 and POSIX.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Begin definition
+#ifndef PLAYER_TRANSPORT_H
+#define PLAYER_TRANSPORT_H
+
+// Shared memory map and process of an AI player. The map
+// holds the GameData of the simulator's protocol and the
+// player receives the name of the map as its command line.
+class PlayerTransport
+{
+public:
+	virtual ~PlayerTransport( ) { }
+
+	// Creates a zeroed memory map from the name, unique among the
+	// players running, and returns its view or NULL on failure
+	virtual GameData* open( const std::string& name ) = 0;
+
+	// Launches the executable with the name of the map, returns
+	// false if it can not be started
+	virtual bool launch( const std::string& exename ) = 0;
+
+	// Returns false once the player process has exited
+	virtual bool isRunning( ) = 0;
+
+	// Gives the player the milliseconds to exit, terminating it if
+	// it does not, and releases the process and map
+	virtual void close( unsigned int exitWait ) = 0;
+
+	// Creates the transport of the operating system
+	static PlayerTransport* create( );
+};
+
+// End definition
+#endif
@@ -0,0 +1,164 @@
+/* ===========================================================================
+
+	Project: Headless match runner for Blokus
+
+	Description:
+	  Launches an AI player with fork and exec and shares the match state
+	  through a POSIX shared memory object.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Standard includes
+#include "Includes.h"
+
+// POSIX implementation
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+// Debug AI modules
+#define DEBUG_AIS  0
+
+// Player over a POSIX shared memory object
+class PosixTransport : public PlayerTransport
+{
+public:
+	PosixTransport( );
+	~PosixTransport( ) { close( 0 ); }
+
+	GameData* open( const std::string& name );
+	bool launch( const std::string& exename );
+	bool isRunning( );
+	void close( unsigned int exitWait );
+
+private:
+	std::string m_name;				//< Shared memory object name
+	GameData* m_memoryView;			//< Mapping of the shared memory
+	pid_t m_process;				//< Player process, or -1
+};
+
+// --------------------------------------------------------
+//	Create - Returns the transport of the platform.
+// --------------------------------------------------------
+PlayerTransport* PlayerTransport::create( )
+{
+	return new PosixTransport;
+}
+//
+// --------------------------------------------------------
+//	Initializes the state.
+// --------------------------------------------------------
+PosixTransport::PosixTransport( ) :
+	m_memoryView( NULL ),
+	m_process( -1 )
+{
+}
+//
+// --------------------------------------------------------
+//	Open - Creates the shared memory object, named with a
+//  leading slash, and maps it. New objects are zeroed
+//  when they are sized.
+// --------------------------------------------------------
+GameData* PosixTransport::open( const std::string& name )
+{
+	close( 0 );
+
+	// Create the shared memory object
+	std::string objectName = "/" + name;
+	int fd = shm_open( objectName.c_str( ), O_CREAT | O_EXCL | O_RDWR, 0600 );
+	if( fd == -1 ) return NULL;
+	m_name = objectName;
+
+	// Size and map it, the mapping keeps the object open
+	void* view = MAP_FAILED;
+	if( ftruncate( fd, sizeof(GameData) ) == 0 )
+		view = mmap( NULL, sizeof(GameData), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+	::close( fd );
+	if( view == MAP_FAILED ) { close( 0 ); return NULL; }
+	m_memoryView = (GameData*)view;
+
+	return m_memoryView;
+}
+//
+// --------------------------------------------------------
+//	Launch - Forks and executes the player with the object
+//  name as its only argument, which the player reads
+//  from argv[0] like the Win32 command line. The output
+//  of the player is discarded unless debugging.
+// --------------------------------------------------------
+bool PosixTransport::launch( const std::string& exename )
+{
+	// A failed exec is only seen by the child
+	if( access( exename.c_str( ), X_OK ) != 0 ) return false;
+
+	m_process = fork( );
+	if( m_process == -1 ) return false;
+	if( m_process == 0 )
+	{
+		// Only async signal safe calls until exec
+		if( !DEBUG_AIS ) {
+			int null = ::open( "/dev/null", O_WRONLY );
+			if( null != -1 ) { dup2( null, 1 ); dup2( null, 2 ); } }
+		execl( exename.c_str( ), m_name.c_str( ), (char*)NULL );
+		_exit( 127 );
+	}
+
+	return true;
+}
+//
+// --------------------------------------------------------
+//	IsRunning - Polls the child, reaping it once it has
+//  exited.
+// --------------------------------------------------------
+bool PosixTransport::isRunning( )
+{
+	if( m_process == -1 ) return false;
+	int status; pid_t result = waitpid( m_process, &status, WNOHANG );
+	if( result == 0 || ( result == -1 && errno == EINTR ) ) return true;
+	m_process = -1;
+
+	return false;
+}
+//
+// --------------------------------------------------------
+//	Close - Polls the child for its exit, killing it when
+//  the wait passes, and unmaps and unlinks the object.
+// --------------------------------------------------------
+void PosixTransport::close( unsigned int exitWait )
+{
+	// Close the player process
+	if( m_process != -1 ) {
+		unsigned int startTime = Platform::getTime( );
+		while( isRunning( ) && Platform::getTime( ) - startTime < exitWait ) usleep( 1000 );
+		if( m_process != -1 ) {
+			kill( m_process, SIGKILL );
+			waitpid( m_process, NULL, 0 );
+			m_process = -1; } }
+
+	// Close the shared memory
+	if( m_memoryView ) { munmap( m_memoryView, sizeof(GameData) ); m_memoryView = NULL; }
+	if( !m_name.empty( ) ) { shm_unlink( m_name.c_str( ) ); m_name.clear( ); }
+}
+
+#endif
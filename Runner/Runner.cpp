@@ -0,0 +1,168 @@
+/* ===========================================================================
+
+	Project: Headless match runner for Blokus
+
+	Description:
+	  Plays engine versus engine games on the match core as fast as the
+	  AI players respond, without the simulator.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Standard includes
+#include "Includes.h"
+
+// Include header
+#include "Runner.h"
+
+// Colour names
+static const char* colourName[2] = { "Blue", "Red" };
+
+// --------------------------------------------------------
+//	Initializes the state.
+// --------------------------------------------------------
+Runner::Runner( const std::string& playerA, const std::string& playerB, float moveTime ) :
+	m_moveTime( moveTime )
+{
+	m_player[0] = playerA; m_player[1] = playerB;
+}
+//
+// --------------------------------------------------------
+//	Run - Plays the games in order, swapping colours each
+//  game, and displays the running totals for player A.
+// --------------------------------------------------------
+void Runner::run( int nGames, int randomPlies, unsigned int seed, const char* saveName ) const
+{
+	// Create directory if it does not exist
+	if( saveName ) Platform::makeDirectory( "Saves" );
+
+	int count[3] = { 0, 0, 0 }; int forfeits = 0;
+	for( int g = 0; g < nGames; g++ )
+	{
+		// Draw the opening shared by the pair
+		std::vector<Move> opening;
+		getRandomOpening( randomPlies, seed + g/2, opening );
+
+		// Compose the save filename
+		std::stringstream filename;
+		if( saveName ) filename << "Saves" PATH_SEPARATOR << saveName << g+1 << ".sav";
+
+		// Play the game
+		GameResult result = playGame( g%2, opening,
+			saveName ? filename.str( ).c_str( ) : NULL );
+		count[result.result]++; if( result.forfeit != -1 ) forfeits++;
+		printResult( g+1, g%2, result );
+	}
+
+	// Display the totals
+	float score = nGames ? ( count[RESULT_WIN] + 0.5f*count[RESULT_DRAW] ) / nGames : 0.0f;
+	std::cout << "\n" << m_player[0] << " versus " << m_player[1] << ": +"
+			  << count[RESULT_WIN] << " =" << count[RESULT_DRAW] << " -" << count[RESULT_LOSS]
+			  << ", score " << 100.0f*score << "%, " << forfeits << " forfeits\n";
+}
+//
+// --------------------------------------------------------
+//	PlayGame - Launches a process for each player, plays
+//  the opening and then requests the moves of the player
+//  to move until the match core reports the game over.
+// --------------------------------------------------------
+GameResult Runner::playGame( int colourA, const std::vector<Move>& opening,
+	const char* saveFile ) const
+{
+	GameResult result; result.forfeit = -1; result.reason = NULL;
+	MatchCore core;
+
+	// Play the opening
+	for( size_t i = 0; i < opening.size( ) && !core.isOver( ); i++ )
+		core.makeMove( opening[i] );
+
+	// Launch the players by colour
+	EngineProcess engine[2];
+	for( int c = 0; c < 2; c++ )
+		if( !engine[c].start( m_player[c == colourA ? 0 : 1], core, c ) )
+			throw "Could not launch AI player";
+
+	// Play until no one can move
+	while( !core.isOver( ) )
+	{
+		int colour = core.getCurrentPlayer( );
+		Move move; int status = engine[colour].getMove( core, m_moveTime, &move );
+
+		// Check for a forfeit
+		if( status == ENGINE_TIMEOUT ) result.reason = "move time exceeded";
+		else if( status == ENGINE_EXITED ) result.reason = "player exited";
+		else if( !core.isValidMove( move ) ) result.reason = "illegal move";
+		if( result.reason ) { result.forfeit = colour == colourA ? 0 : 1; break; }
+
+		core.makeMove( move );
+	}
+
+	// Close the players
+	engine[0].stop( ); engine[1].stop( );
+
+	// Save the game
+	if( saveFile ) {
+		std::ofstream file( saveFile );
+		if( !file.is_open( ) || !core.saveToStream( file ) )
+			throw "Could not write save file"; }
+
+	// Score the game for player A
+	result.plies = core.getPly( );
+	result.score[0] = core.getScore( colourA );
+	result.score[1] = core.getScore( 1-colourA );
+	if( result.forfeit != -1 ) result.result = result.forfeit ? RESULT_WIN : RESULT_LOSS;
+	else if( result.score[0] > result.score[1] ) result.result = RESULT_WIN;
+	else if( result.score[0] < result.score[1] ) result.result = RESULT_LOSS;
+	else result.result = RESULT_DRAW;
+
+	return result;
+}
+//
+// --------------------------------------------------------
+//	PrintResult - Displays the players and their colours,
+//  the scores and any forfeit.
+// --------------------------------------------------------
+void Runner::printResult( int game, int colourA, const GameResult& result ) const
+{
+	static const char* resultName[3] = { "loss", "draw", "win" };
+
+	std::stringstream line;
+	line << "Game " << game << ": " << m_player[0] << " (" << colourName[colourA] << ") "
+		 << result.score[0] << " - " << result.score[1] << " " << m_player[1]
+		 << " (" << colourName[1-colourA] << "), " << resultName[result.result];
+	if( result.forfeit != -1 ) line << ", " << m_player[result.forfeit] << " forfeits: " << result.reason;
+	line << "\n";
+
+	std::cout << line.str( );
+}
+//
+// --------------------------------------------------------
+//	GetRandomOpening - Plays random moves on an empty match
+//  from the seed, stopping early if the game ends.
+// --------------------------------------------------------
+void Runner::getRandomOpening( int plies, unsigned int seed, std::vector<Move>& opening )
+{
+	MatchCore core; std::vector<Move> moves;
+	opening.clear( ); srand( seed );
+
+	while( (int)opening.size( ) < plies && !core.isOver( ) ) {
+		core.getMoves( moves );
+		Move move = moves[ rand( ) % moves.size( ) ];
+		opening.push_back( move ); core.makeMove( move ); }
+}
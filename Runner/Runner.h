@@ -0,0 +1,87 @@
+/* ===========================================================================
+
+	Project: Headless match runner for Blokus
+
+	Description:
+	  Plays engine versus engine games on the match core as fast as the
+	  AI players respond, without the simulator.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Begin definition
+#ifndef RUNNER_H
+#define RUNNER_H
+
+// Runner settings
+#define RUNNER_GAMES          2    //< Default number of games
+#define RUNNER_RANDOM_PLIES   4    //< Default random plies opening each game
+#define RUNNER_MOVE_TIME   60.0f   //< Default seconds allowed per move
+
+// Game results for player A
+#define RESULT_LOSS  0
+#define RESULT_DRAW  1
+#define RESULT_WIN   2
+
+// Result of a game between players A and B
+struct GameResult
+{
+	int result;				//< Result for player A
+	int score[2];			//< Final scores of players A and B
+	int plies;				//< Plies played, including skips
+	int forfeit;			//< Player forfeiting the game, A (0) or B (1), or -1
+	const char* reason;		//< Reason for the forfeit
+};
+
+// Define match runner
+class Runner
+{
+public:
+	// Sets the AI players, executables in the Players directory
+	Runner( const std::string& playerA, const std::string& playerB,
+		float moveTime = RUNNER_MOVE_TIME );
+
+	// Plays the games in colour swapped pairs, each pair sharing a
+	// random opening, and displays the results. Games are saved to
+	// the Saves directory when a save name is given.
+	void run( int nGames, int randomPlies, unsigned int seed, const char* saveName ) const;
+
+	// Plays a game from the opening moves with player A as the colour,
+	// launching both players for the game. A player which exceeds the
+	// move time, exits or makes an illegal move forfeits. The game is
+	// written to the save file if one is given.
+	GameResult playGame( int colourA, const std::vector<Move>& opening,
+		const char* saveFile ) const;
+
+	// Displays the result of a game
+	void printResult( int game, int colourA, const GameResult& result ) const;
+
+	// Draws an opening of random moves from the seed
+	static void getRandomOpening( int plies, unsigned int seed, std::vector<Move>& opening );
+
+	// Player names
+	const std::string& getPlayer( int player ) const { return m_player[player]; }
+
+private:
+	std::string m_player[2];	//< Executables of players A and B
+	float m_moveTime;			//< Seconds allowed per move
+};
+
+// End definition
+#endif
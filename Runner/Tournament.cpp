@@ -0,0 +1,257 @@
+/* ===========================================================================
+
+	Project: Headless match runner for Blokus
+
+	Description:
+	  Plays a tournament between two AI players on concurrent games,
+	  estimating the Elo difference and stopping early once a sequential
+	  probability ratio test decides between two Elo hypotheses.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Standard includes
+#include "Includes.h"
+#include <math.h>
+
+// Opening book
+#include "OpeningBook.h"
+
+// Include header
+#include "Runner.h"
+#include "Tournament.h"
+
+// --------------------------------------------------------
+//	Initializes the state.
+// --------------------------------------------------------
+Tournament::Tournament( const Runner& runner, const TournamentSettings& settings ) :
+	m_runner( runner ),
+	m_settings( settings )
+{
+	m_settings.nThreads = std::max( 1, std::min( settings.nThreads, TOURNAMENT_MAX_THREADS ) );
+	m_settings.nGames = std::max( 0, settings.nGames );
+
+	// Wald's bounds for the error rates
+	m_lowerBound = log( TOURNAMENT_BETA / ( 1.0 - TOURNAMENT_ALPHA ) );
+	m_upperBound = log( ( 1.0 - TOURNAMENT_BETA ) / TOURNAMENT_ALPHA );
+}
+//
+// --------------------------------------------------------
+//	Run - Draws the openings and plays the games on the
+//  worker threads, then displays the final results.
+// --------------------------------------------------------
+int Tournament::run( )
+{
+	// Draw the openings, which also loads the piece layouts
+	// before the workers construct their match cores
+	drawOpenings( );
+
+	// Reset the run data
+	m_nextGame = 0; m_stop = false; m_error = NULL;
+	m_count[0] = m_count[1] = m_count[2] = 0;
+	m_forfeits = 0; m_result = SPRT_NONE;
+	m_mutex = Platform::createMutex( );
+
+	// Display the test
+	std::cout << m_runner.getPlayer( 0 ) << " versus " << m_runner.getPlayer( 1 )
+			  << ", " << m_settings.nGames << " games on " << m_settings.nThreads
+			  << " threads, SPRT elo0 " << m_settings.elo0 << " elo1 " << m_settings.elo1
+			  << " LLR bounds (" << m_lowerBound << ", " << m_upperBound << ")\n";
+
+	// Launch the workers
+	void* threads[TOURNAMENT_MAX_THREADS];
+	int nThreads = m_settings.nThreads;
+	for( int i = 0; i < nThreads; i++ )
+		threads[i] = Platform::startThread( &workerThread, this );
+
+	// Wait for all of the workers
+	for( int i = 0; i < nThreads; i++ ) if( threads[i] ) Platform::joinThread( threads[i] );
+	Platform::destroyMutex( m_mutex );
+	if( m_error ) throw m_error;
+
+	// Display the final results
+	std::cout << "\nFinal: "; printStatus( );
+	if( m_result == SPRT_ACCEPT_H1 )
+		std::cout << "H1 accepted, " << m_runner.getPlayer( 0 ) << " is stronger\n";
+	else if( m_result == SPRT_ACCEPT_H0 )
+		std::cout << "H0 accepted, " << m_runner.getPlayer( 0 ) << " is not stronger\n";
+	else std::cout << "Game limit reached, the test is undecided\n";
+
+	return m_result;
+}
+//
+// --------------------------------------------------------
+//	DrawOpenings - Draws an opening for each colour swapped
+//  pair of games from the seed of the pair, so openings
+//  do not depend on the order the games finish in.
+// --------------------------------------------------------
+void Tournament::drawOpenings( )
+{
+	// Open the book
+	OpeningBook book; bool useBook = m_settings.bookFile != NULL;
+	if( useBook ) book.openBook( m_settings.bookFile );
+
+	int nPairs = ( m_settings.nGames + 1 ) / 2;
+	m_openings.assign( nPairs, std::vector<Move>( ) );
+	for( int p = 0; p < nPairs; p++ )
+	{
+		std::vector<Move>& opening = m_openings[p];
+		MatchCore core; std::vector<Move> moves;
+		srand( m_settings.seed + p );
+
+		// Follow the book, then play random moves
+		bool inBook = useBook;
+		while( (int)opening.size( ) < m_settings.openingPlies && !core.isOver( ) )
+		{
+			Move move;
+			if( inBook && book.isInBook( opening ) ) {
+				move = book.makeMove( opening );
+				if( core.isValidMove( move ) ) {
+					opening.push_back( move ); core.makeMove( move ); continue; } }
+			inBook = false;
+
+			core.getMoves( moves );
+			move = moves[ rand( ) % moves.size( ) ];
+			opening.push_back( move ); core.makeMove( move );
+		}
+	}
+}
+//
+// --------------------------------------------------------
+//	WorkerThread - Claims games by index and plays them,
+//  swapping colours each game so that both games of a
+//  pair share its opening. The results are counted and
+//  tested as they finish, ignoring games which finish
+//  after the test is decided.
+// --------------------------------------------------------
+void Tournament::workerThread( void* data )
+{
+	Tournament* tournament = (Tournament*)data;
+	const TournamentSettings& settings = tournament->m_settings;
+
+	// Game loop
+	int game;
+	while( !tournament->m_stop &&
+		( game = (int)Platform::increment( &tournament->m_nextGame ) - 1 ) < settings.nGames )
+	{
+		// Play the game
+		GameResult result; const char* error = NULL;
+		try { result = tournament->m_runner.playGame( game%2, tournament->m_openings[game/2], NULL );
+		} catch( const char *s ) { error = s; }
+
+		Platform::lock( tournament->m_mutex );
+		if( error ) {
+			// Stop the tournament on the first error
+			if( !tournament->m_error ) tournament->m_error = error;
+			Platform::exchange( &tournament->m_stop, true ); }
+		else if( !tournament->m_stop )
+		{
+			// Count the result
+			int* count = tournament->m_count;
+			count[result.result]++; if( result.forfeit != -1 ) tournament->m_forfeits++;
+			tournament->m_runner.printResult( game+1, game%2, result );
+
+			// Test the results
+			double llr = getLLR( count, settings.elo0, settings.elo1 );
+			if( llr >= tournament->m_upperBound ) tournament->m_result = SPRT_ACCEPT_H1;
+			else if( llr <= tournament->m_lowerBound ) tournament->m_result = SPRT_ACCEPT_H0;
+			if( tournament->m_result != SPRT_NONE ) Platform::exchange( &tournament->m_stop, true );
+
+			// Report the progress
+			int nGames = count[0] + count[1] + count[2];
+			if( nGames % TOURNAMENT_REPORT == 0 ) tournament->printStatus( );
+		}
+		Platform::unlock( tournament->m_mutex );
+	}
+}
+//
+// --------------------------------------------------------
+//	PrintStatus - Displays the results of player A with
+//  the Elo estimate and the log likelihood ratio.
+// --------------------------------------------------------
+void Tournament::printStatus( ) const
+{
+	double elo, error; getEloInterval( m_count, &elo, &error );
+	double llr = getLLR( m_count, m_settings.elo0, m_settings.elo1 );
+
+	std::stringstream line; line.setf( std::ios::fixed ); line.precision( 1 );
+	line << m_count[0] + m_count[1] + m_count[2] << " games: +" << m_count[RESULT_WIN]
+		 << " =" << m_count[RESULT_DRAW] << " -" << m_count[RESULT_LOSS]
+		 << ", " << m_forfeits << " forfeits, Elo " << elo << " +/- " << error;
+	line.precision( 2 ); line << ", LLR " << llr << "\n";
+
+	std::cout << line.str( );
+}
+//
+// --------------------------------------------------------
+//	GetElo - Converts a score fraction to the Elo rating
+//  difference of the logistic model, limiting the score
+//  away from the infinite differences of 0 and 1.
+// --------------------------------------------------------
+double Tournament::getElo( double score )
+{
+	score = std::max( 0.001, std::min( score, 0.999 ) );
+
+	return -400.0 * log10( 1.0/score - 1.0 );
+}
+//
+// --------------------------------------------------------
+//	GetEloInterval - Takes the mean and standard error of
+//  the game scores and converts the mean and the ends of
+//  its 95% confidence interval to Elo.
+// --------------------------------------------------------
+void Tournament::getEloInterval( const int count[3], double* elo, double* error )
+{
+	int n = count[0] + count[1] + count[2];
+	if( n == 0 ) { *elo = 0.0; *error = 0.0; return; }
+
+	// Mean and variance of the game scores
+	double w = (double)count[RESULT_WIN]/n, d = (double)count[RESULT_DRAW]/n, l = (double)count[RESULT_LOSS]/n;
+	double score = w + 0.5*d;
+	double variance = w*(1.0-score)*(1.0-score) + d*(0.5-score)*(0.5-score) + l*score*score;
+	double margin = 1.96 * sqrt( variance / n );
+
+	*elo = getElo( score );
+	*error = ( getElo( score + margin ) - getElo( score - margin ) ) / 2.0;
+}
+//
+// --------------------------------------------------------
+//	GetLLR - Log likelihood ratio of the expected scores
+//  of the hypotheses, with the game scores taken as
+//  normal with the observed variance:
+//    LLR = n (s1-s0) (2s - s0 - s1) / (2 var)
+//  Half a game of each result is added so that results
+//  which are all the same still have a variance.
+// --------------------------------------------------------
+double Tournament::getLLR( const int count[3], double elo0, double elo1 )
+{
+	if( count[0] + count[1] + count[2] == 0 ) return 0.0;
+	double n = count[0] + count[1] + count[2] + 1.5;
+
+	// Mean and variance of the game scores
+	double w = (count[RESULT_WIN]+0.5)/n, d = (count[RESULT_DRAW]+0.5)/n, l = (count[RESULT_LOSS]+0.5)/n;
+	double score = w + 0.5*d;
+	double variance = w*(1.0-score)*(1.0-score) + d*(0.5-score)*(0.5-score) + l*score*score;
+
+	// Expected scores of the hypotheses
+	double s0 = 1.0 / ( 1.0 + pow( 10.0, -elo0/400.0 ) );
+	double s1 = 1.0 / ( 1.0 + pow( 10.0, -elo1/400.0 ) );
+
+	return n * ( s1 - s0 ) * ( 2.0*score - s0 - s1 ) / ( 2.0*variance );
+}
@@ -0,0 +1,111 @@
+/* ===========================================================================
+
+	Project: Headless match runner for Blokus
+
+	Description:
+	  Plays a tournament between two AI players on concurrent games,
+	  estimating the Elo difference and stopping early once a sequential
+	  probability ratio test decides between two Elo hypotheses.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Begin definition
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+// Tournament settings
+#define TOURNAMENT_GAMES       1000   //< Default game limit
+#define TOURNAMENT_MAX_THREADS   32   //< Maximum concurrent games
+#define TOURNAMENT_PLIES          4   //< Default opening plies
+#define TOURNAMENT_ELO0        0.0f   //< Default Elo of the null hypothesis
+#define TOURNAMENT_ELO1        5.0f   //< Default Elo of the alternative hypothesis
+#define TOURNAMENT_ALPHA       0.05   //< Chance of accepting the alternative falsely
+#define TOURNAMENT_BETA        0.05   //< Chance of accepting the null falsely
+#define TOURNAMENT_REPORT        10   //< Games between status reports
+
+// Sequential test results
+#define SPRT_NONE       0   //< Game limit reached undecided
+#define SPRT_ACCEPT_H0  1   //< Player A is not elo1 stronger
+#define SPRT_ACCEPT_H1  2   //< Player A is not elo0 weaker
+
+// Tournament settings
+struct TournamentSettings
+{
+	int nGames;				//< Most games to play
+	int nThreads;			//< Games played at once
+	int openingPlies;		//< Plies opening each pair of games
+	unsigned int seed;		//< Seed of the first opening
+	float elo0, elo1;		//< Elo of player A over B under each hypothesis
+	const char* bookFile;	//< Opening book, NULL for random openings
+};
+
+// Define tournament
+class Tournament
+{
+public:
+	Tournament( const Runner& runner, const TournamentSettings& settings );
+
+	// Plays games until the game limit or a test decision, returns
+	// the sequential test result
+	int run( );
+
+	// Elo difference of a score fraction
+	static double getElo( double score );
+
+	// Elo difference of the results with the half width of its 95%
+	// confidence interval. Results are counted by RESULT_*.
+	static void getEloInterval( const int count[3], double* elo, double* error );
+
+	// Log likelihood ratio of the results between the hypotheses,
+	// using the normal approximation of the mean game score
+	static double getLLR( const int count[3], double elo0, double elo1 );
+
+private:
+	// Draws the openings of the game pairs, following the book while
+	// the position is in it and then playing random moves
+	void drawOpenings( );
+
+	// Worker thread entry, plays games until none are left or the
+	// test is decided
+	static void workerThread( void* data );
+
+	// Displays the results so far
+	void printStatus( ) const;
+
+	const Runner& m_runner;					//< Player settings and game loop
+	TournamentSettings m_settings;			//< Run settings
+	std::vector< std::vector<Move> > m_openings;	//< Opening of each pair
+
+	// Shared run data
+	volatile long m_nextGame;		//< Index of the next game to start
+	volatile long m_stop;			//< Stops the workers claiming games
+	void* m_mutex;					//< Serializes results and output
+	const char* m_error;			//< First error playing a game
+
+	// Run results
+	int m_count[3];					//< Results of player A by RESULT_*
+	int m_forfeits;					//< Forfeited games
+	int m_result;					//< Sequential test result
+	double m_lowerBound;			//< LLR accepting the null hypothesis
+	double m_upperBound;			//< LLR accepting the alternative
+};
+
+// End definition
+#endif
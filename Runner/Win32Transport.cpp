@@ -0,0 +1,137 @@
+/* ===========================================================================
+
+	Project: Headless match runner for Blokus
+
+	Description:
+	  Launches an AI player with CreateProcess and shares the match state
+	  through a named file mapping, as the simulator does.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Standard includes
+#include "Includes.h"
+
+// Win32 implementation
+#ifdef _WIN32
+#include <windows.h>
+
+// Debug AI modules
+#define DEBUG_AIS  0
+
+// Player over a named file mapping
+class Win32Transport : public PlayerTransport
+{
+public:
+	Win32Transport( );
+	~Win32Transport( ) { close( 0 ); }
+
+	GameData* open( const std::string& name );
+	bool launch( const std::string& exename );
+	bool isRunning( );
+	void close( unsigned int exitWait );
+
+private:
+	std::string m_name;				//< Memory map name
+	HANDLE m_memoryMappedFile;		//< Shared memory map
+	GameData* m_memoryView;			//< View of the shared memory map
+	PROCESS_INFORMATION m_pinfo;	//< Player process
+};
+
+// --------------------------------------------------------
+//	Create - Returns the transport of the platform.
+// --------------------------------------------------------
+PlayerTransport* PlayerTransport::create( )
+{
+	return new Win32Transport;
+}
+//
+// --------------------------------------------------------
+//	Initializes the state.
+// --------------------------------------------------------
+Win32Transport::Win32Transport( ) :
+	m_memoryMappedFile( NULL ),
+	m_memoryView( NULL )
+{
+	ZeroMemory( &m_pinfo, sizeof(m_pinfo) );
+}
+//
+// --------------------------------------------------------
+//	Open - Builds a page file backed memory map with the
+//  name and its view.
+// --------------------------------------------------------
+GameData* Win32Transport::open( const std::string& name )
+{
+	close( 0 ); m_name = name;
+
+	// Build the memory map and its view
+	m_memoryMappedFile = CreateFileMappingA( INVALID_HANDLE_VALUE,
+		NULL, PAGE_READWRITE, 0, sizeof(GameData), m_name.c_str( ) );
+	if( !m_memoryMappedFile ) return NULL;
+	m_memoryView = (GameData*)MapViewOfFile( m_memoryMappedFile,
+		FILE_MAP_ALL_ACCESS, 0, 0, sizeof(GameData) );
+	if( !m_memoryView ) { close( 0 ); return NULL; }
+
+	return m_memoryView;
+}
+//
+// --------------------------------------------------------
+//	Launch - Starts the player without a window, with the
+//  map name as its whole command line.
+// --------------------------------------------------------
+bool Win32Transport::launch( const std::string& exename )
+{
+	STARTUPINFOA sinfo; GetStartupInfoA( &sinfo );
+	if( !CreateProcessA( exename.c_str( ), &m_name[0], NULL, NULL,
+			FALSE, DEBUG_AIS ? 0 : CREATE_NO_WINDOW, NULL, NULL,
+			&sinfo, &m_pinfo ) ) {
+		ZeroMemory( &m_pinfo, sizeof(m_pinfo) ); return false; }
+
+	return true;
+}
+//
+// --------------------------------------------------------
+//	IsRunning - Polls the process handle.
+// --------------------------------------------------------
+bool Win32Transport::isRunning( )
+{
+	return m_pinfo.hProcess &&
+		WaitForSingleObject( m_pinfo.hProcess, 0 ) == WAIT_TIMEOUT;
+}
+//
+// --------------------------------------------------------
+//	Close - Waits on the process handle for the exit and
+//  releases the process and map.
+// --------------------------------------------------------
+void Win32Transport::close( unsigned int exitWait )
+{
+	// Close the player process
+	if( m_pinfo.hProcess ) {
+		if( WaitForSingleObject( m_pinfo.hProcess, exitWait ) == WAIT_TIMEOUT )
+			TerminateProcess( m_pinfo.hProcess, 0 );
+		CloseHandle( m_pinfo.hProcess );
+		CloseHandle( m_pinfo.hThread );
+		ZeroMemory( &m_pinfo, sizeof(m_pinfo) ); }
+
+	// Close the memory map
+	if( m_memoryView ) { UnmapViewOfFile( m_memoryView ); m_memoryView = NULL; }
+	if( m_memoryMappedFile ) { CloseHandle( m_memoryMappedFile ); m_memoryMappedFile = NULL; }
+}
+
+#endif
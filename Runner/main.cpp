@@ -0,0 +1,77 @@
+/* ===========================================================================
+
+	Project: Headless match runner for Blokus
+
+	Description:
+	  Plays engine versus engine games between two AI player executables
+	  without the simulator.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Standard Includes
+#include "Includes.h"
+
+// Include header
+#include "Runner.h"
+#include "Tournament.h"
+
+// Application entry point
+int main( int argc, char* argv[] )
+{
+	// Display runner header
+	std::cout << " ***************************\n";
+	std::cout << "     Blokus Match Runner\n";
+	std::cout << " ***************************\n";
+
+	// Play a tournament on concurrent games
+	if( argc > 1 && std::string( argv[1] ) == "-tournament" ) {
+		if( argc < 4 ) { std::cout << "Usage: Runner -tournament <player A> <player B> [games] "
+			"[threads] [elo0] [elo1] [opening plies] [seed] [book file]\n"; return 1; }
+		TournamentSettings settings;
+		settings.nGames = ( argc > 4 ) ? atoi( argv[4] ) : TOURNAMENT_GAMES;
+		settings.nThreads = ( argc > 5 ) ? atoi( argv[5] ) : std::max( Platform::getProcessorCount( )/2, 1 );
+		settings.elo0 = ( argc > 6 ) ? (float)atof( argv[6] ) : TOURNAMENT_ELO0;
+		settings.elo1 = ( argc > 7 ) ? (float)atof( argv[7] ) : TOURNAMENT_ELO1;
+		settings.openingPlies = ( argc > 8 ) ? atoi( argv[8] ) : TOURNAMENT_PLIES;
+		settings.seed = ( argc > 9 ) ? (unsigned int)atoi( argv[9] ) : (unsigned int)time(NULL);
+		settings.bookFile = ( argc > 10 ) ? argv[10] : NULL;
+		try { Runner runner( argv[2], argv[3] );
+			Tournament tournament( runner, settings ); tournament.run( );
+		} catch( const char *s ) {
+			std::cerr << "Error running tournament:\n	" << s << "\n\n"; return 1; }
+		return 0; }
+
+	// Read the command line
+	if( argc < 3 ) { std::cout << "Usage: Runner <player A> <player B> [games] "
+		"[random plies] [seed] [move time] [save name]\n"; return 1; }
+	int nGames = ( argc > 3 ) ? atoi( argv[3] ) : RUNNER_GAMES;
+	int randomPlies = ( argc > 4 ) ? atoi( argv[4] ) : RUNNER_RANDOM_PLIES;
+	unsigned int seed = ( argc > 5 ) ? (unsigned int)atoi( argv[5] ) : (unsigned int)time(NULL);
+	float moveTime = ( argc > 6 ) ? (float)atof( argv[6] ) : RUNNER_MOVE_TIME;
+	const char* saveName = ( argc > 7 ) ? argv[7] : NULL;
+
+	// Play the games
+	try { Runner runner( argv[1], argv[2], moveTime );
+		runner.run( nGames, randomPlies, seed, saveName );
+	} catch( const char *s ) {
+		std::cerr << "Error running match:\n	" << s << "\n\n"; return 1; }
+
+	return 0;
+}
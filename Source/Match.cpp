@@ -96,29 +96,29 @@ void Match::main( )
 	m_mousePosition = mouseposition - m_mouseDirection * (mouseposition.y/m_mouseDirection.y); 
 
 	// Return if the match is already over
-	if( m_matchEnd == TRUE ) return;
+	if( m_core.isOver( ) ) return;
 
 	// Check if an AI player is next to move 
-	if( m_agentFilename[m_currentPlayer] != L"" &&
+	if( m_agentFilename[m_core.getCurrentPlayer( )] != L"" &&
 	  ( m_waitTurn == WAIT_NONE ||
 		m_waitTurn == WAIT_STEP ) )
 	{
 		unsigned long exitCode;
 
 		// Verify AI still active
-		GetExitCodeProcess( m_pinfo[m_currentPlayer].hProcess, &exitCode );
-		if( exitCode != STILL_ACTIVE ) m_agentFilename[m_currentPlayer] = L"";
+		GetExitCodeProcess( m_pinfo[m_core.getCurrentPlayer( )].hProcess, &exitCode );
+		if( exitCode != STILL_ACTIVE ) m_agentFilename[m_core.getCurrentPlayer( )] = L"";
 
 		// Check move ready
-		else if( m_memoryView[m_currentPlayer]->moveReady )
-			if( isValidMove( m_memoryView[m_currentPlayer]->move ) ) 
+		else if( m_memoryView[m_core.getCurrentPlayer( )]->moveReady )
+			if( m_core.isValidMove( m_memoryView[m_core.getCurrentPlayer( )]->move ) ) 
 			{
 				// Clear forward history
 				m_undoHistory.clear( ); 
 
 				// Make the move on the board
-				m_memoryView[m_currentPlayer]->moveReady = FALSE;
-				makeMove( m_memoryView[m_currentPlayer]->move );
+				m_memoryView[m_core.getCurrentPlayer( )]->moveReady = FALSE;
+				makeMove( m_memoryView[m_core.getCurrentPlayer( )]->move );
 
 				// Update waiting indicator
 				if( m_waitTurn == WAIT_STEP ) m_waitTurn = WAIT_HALTED;
@@ -126,22 +126,22 @@ void Match::main( )
 			else DebugBreak( );
 
 		// Launch AI move selection thread
-		else if( !m_memoryView[m_currentPlayer]->turnReady ) getAiMove( );
+		else if( !m_memoryView[m_core.getCurrentPlayer( )]->turnReady ) getAiMove( );
 	} 
 	
 	// Handle player move selections
-	if( m_agentFilename[m_currentPlayer] == L"" || m_waitTurn == WAIT_HALTED ) 
+	if( m_agentFilename[m_core.getCurrentPlayer( )] == L"" || m_waitTurn == WAIT_HALTED ) 
 	{
 		// Check for no piece selected
 		if( m_selectedPiece == NONE ) {
 			float objDist = m_camera.getMaxDist( ); m_intersectedPiece  = NONE;
-			for( int i = 0; i < 21; i++ ) if( m_pieces[m_currentPlayer][i] ) {
+			for( int i = 0; i < 21; i++ ) if( m_core.hasPiece( m_core.getCurrentPlayer( ), i ) ) {
 
 				// Intersection buffer variable declarations
 				unsigned long face; float bary1, bary2, dist; int hit;
 
 				// Perform intersection test with the object
-				m_gamePieces[m_currentPlayer][i].intersectRay( &mouseposition, 
+				m_gamePieces[m_core.getCurrentPlayer( )][i].intersectRay( &mouseposition, 
 					&m_mouseDirection, &hit, &face, &bary1, &bary2, &dist );
 
 				// If the mesh intersected closer than last hit update info
@@ -168,8 +168,8 @@ void Match::main( )
 
 			// Compute transformed grid position
 			DirectX::Vector3 position = m_mousePosition + offset;
-			m_playerMove.gridX =  (int)(position.x + (float)m_boardSize/2.0f + 2.0f) - 2; 
-			m_playerMove.gridY = -(int)(position.z - (float)m_boardSize/2.0f - 2.0f) - 2; 
+			m_playerMove.gridX =  (int)(position.x + (float)m_core.getBoardSize( )/2.0f + 2.0f) - 2; 
+			m_playerMove.gridY = -(int)(position.z - (float)m_core.getBoardSize( )/2.0f - 2.0f) - 2; 
 			if( m_playerMove.rotated == PIECE_ROTATE_180 ||
 				m_playerMove.rotated == PIECE_ROTATE_270 ) m_playerMove.gridX -= sizeX-1;
 			if( m_playerMove.rotated == PIECE_ROTATE_90 ||
@@ -180,9 +180,9 @@ void Match::main( )
 				else m_playerMove.gridX -= sizeX-1;
 
 			// Snap piece to integer grid coordinates if it is within valid boundaries
-			if( m_playerMove.gridX > -2 && m_playerMove.gridX < m_boardSize-sizeX+2 && 
-				m_playerMove.gridY > -2 && m_playerMove.gridY < m_boardSize-sizeY+2 ) 
-				setPiecePosition( m_playerMove, m_currentPlayer );
+			if( m_playerMove.gridX > -2 && m_playerMove.gridX < m_core.getBoardSize( )-sizeX+2 && 
+				m_playerMove.gridY > -2 && m_playerMove.gridY < m_core.getBoardSize( )-sizeY+2 ) 
+				setPiecePosition( m_playerMove, m_core.getCurrentPlayer( ) );
 			else 
 			{
 				// Compute piece rotation parameters
@@ -190,9 +190,9 @@ void Match::main( )
 				float az = m_playerMove.flipped ? D3DX_PI : 0.0f;
 
 				// Reposition piece and update transforms
-				m_gamePieces[m_currentPlayer][m_playerMove.pieceNumber].setPosition( &position );
-				m_gamePieces[m_currentPlayer][m_playerMove.pieceNumber].setRotation( 0.0f, ay, az );
-				m_gamePieces[m_currentPlayer][m_playerMove.pieceNumber].update( );
+				m_gamePieces[m_core.getCurrentPlayer( )][m_playerMove.pieceNumber].setPosition( &position );
+				m_gamePieces[m_core.getCurrentPlayer( )][m_playerMove.pieceNumber].setRotation( 0.0f, ay, az );
+				m_gamePieces[m_core.getCurrentPlayer( )][m_playerMove.pieceNumber].update( );
 			}
 		}
 	}
@@ -325,7 +325,7 @@ void Match::onMouseEvent( UINT message, WPARAM wParam, LPARAM lParam )
 				// Select intersected piece and comput offsets
 				m_selectedPiece = m_intersectedPiece;
 				D3DXVec3Subtract( &m_mouseDragOffset, 
-					m_gamePieces[m_currentPlayer][m_selectedPiece].getPosition( ), 
+					m_gamePieces[m_core.getCurrentPlayer( )][m_selectedPiece].getPosition( ), 
 					&m_mousePosition );
 
 				// Construct partial move 
@@ -342,15 +342,15 @@ void Match::onMouseEvent( UINT message, WPARAM wParam, LPARAM lParam )
 			if( m_selectedPiece != NONE ) 
 			{
 				// Check if the move is valid
-				if( isValidMove( m_playerMove ) ) {
+				if( m_core.isValidMove( m_playerMove ) ) {
 
 					// Make the move on the board
 					makeMove( m_playerMove );
 
 				} else {
 					Move defaultPos = m_piecePosition[MODE_DUO][m_selectedPiece];
-					if( m_currentPlayer == PLAYER_RED ) defaultPos.gridX += 30;
-					setPiecePosition( defaultPos, m_currentPlayer );
+					if( m_core.getCurrentPlayer( ) == PLAYER_RED ) defaultPos.gridX += 30;
+					setPiecePosition( defaultPos, m_core.getCurrentPlayer( ) );
 				}
 
 				// Clear selection 
@@ -481,36 +481,12 @@ void Match::load3dPiecePositions( )
 // --------------------------------------------------------
 void Match::applyMatchSettings( )
 {
-	// Update match type
-	m_matchMode = MODE_DUO;
+	// Begin a duo match
+	m_core.reset( MODE_DUO );
 
 	// Wait options
 	m_waitTurn = WAIT_HALTED; 
 
-	// Number of players
-	if( m_matchMode == MODE_DUO ) m_numberOfPlayers = 2;
-	else m_numberOfPlayers = 2;
-
-	// Board dimensions
-	if( m_matchMode == MODE_DUO ) m_boardSize = 14;
-	else m_boardSize = 20;
-
-	// Starting tile
-	if( m_matchMode == MODE_DUO ) {
-		m_startTile[PLAYER_BLUE][0] = 4;
-		m_startTile[PLAYER_BLUE][1] = 4;
-		m_startTile[PLAYER_RED] [0] = 9;
-		m_startTile[PLAYER_RED] [1] = 9;
-	} else {
-		m_startTile[PLAYER_BLUE][0] = 0;
-		m_startTile[PLAYER_BLUE][1] = 0;
-		m_startTile[PLAYER_RED][0] = 19;
-		m_startTile[PLAYER_RED][1] = 0;
-		m_startTile[PLAYER_GREEN][0] = 19;
-		m_startTile[PLAYER_GREEN][1] = 19;
-		m_startTile[PLAYER_YELLOW][0] = 0;
-		m_startTile[PLAYER_YELLOW][1] = 19; }
-
 	// Set player types
 	for( int i = 0; i < 4; i++ ) 
 		m_agentFilename[i] = L"";
@@ -521,7 +497,7 @@ void Match::applyMatchSettings( )
 		TerminateProcess( m_pinfo[i].hProcess, 0 );
 
 	// Launch new AI processes
-	for( int i = 0; i < m_numberOfPlayers; i++ ) 
+	for( int i = 0; i < m_core.getNumberOfPlayers( ); i++ ) 
 		setAiPlayer( i, m_agentFilename[i].c_str( ) );
 
 	// Clear records
@@ -533,16 +509,9 @@ void Match::applyMatchSettings( )
 // --------------------------------------------------------
 void Match::onMatchEnd( )
 {
-	int winner = 0;
-
 	// Update win/loss record keeping 
-	for( int i = 1; i < m_numberOfPlayers; i++ )
-		if( m_score[i] > m_score[winner] ) winner = i;
-	for( int i = winner; i < m_numberOfPlayers; i++ )
-		if( m_score[winner] == m_score[i] ) m_record[i]++;
-
-	// Set the end flag
-	m_matchEnd = TRUE;
+	for( int i = 0; i < m_core.getNumberOfPlayers( ); i++ )
+		if( m_core.isWinner( i ) ) m_record[i]++;
 }
 //
 // --------------------------------------------------------
@@ -551,37 +520,21 @@ void Match::onMatchEnd( )
 // --------------------------------------------------------
 bool Match::beginNewMatch( MatchSettings* settings )
 {
-	// Clear board data
-	for( int i = 0; i < 20; i++ )
-	for( int j = 0; j < 20; j++ )
-		m_board[i][j] = GRID_COVER_NONE;
-
-	// Reset player scores
-	for( int i = 0; i < 4; i++ )
-		m_score[i] = 0;
-
-	// Replace game pieces
-	for( int i = 0; i < 4;  i++ )
-	for( int j = 0; j < 21; j++ )
-		m_pieces[i][j] = true;
+	// Clear board, pieces and scores
+	m_core.clear( );
 
 	// Launch new AI processes
-	for( int i = 0; i < m_numberOfPlayers; i++ ) 
+	for( int i = 0; i < m_core.getNumberOfPlayers( ); i++ ) 
 	if( m_agentFilename[i] != L"" ) 
 		setAiPlayer( i, m_agentFilename[i].c_str( ) );
 
 	// Clear tracking variables
-	m_currentPlayer = PLAYER_BLUE;
 	m_intersectedPiece = NONE;
 	m_selectedPiece = NONE;
-	m_currentPly = 0;
 
 	// Reset 3D game board
 	reset3dGameBoard( );
 
-	// Set match end flag
-	m_matchEnd = FALSE;
-
 	// Success
 	return true;
 }
@@ -593,7 +546,7 @@ bool Match::beginNewMatch( MatchSettings* settings )
 void Match::reset3dGameBoard( ) 
 {
 	// Hide unused game piece models
-	for( int i = m_numberOfPlayers; i < 4; i++ ) {
+	for( int i = m_core.getNumberOfPlayers( ); i < 4; i++ ) {
 		for( int j = 0; j < 21; j++ ) 
 			m_gamePieces[i][j].hide( );
 		m_startMarker[i].hide( ); }
@@ -601,258 +554,35 @@ void Match::reset3dGameBoard( )
 	// Position game piece models
 	for( int i = 0; i < 21; i++ )
 	for( int j = 0; j <  4; j++ ) { 
-		Move defaultPos = m_piecePosition[m_matchMode][i];
+		Move defaultPos = m_piecePosition[m_core.getMatchMode( )][i];
 		if( j == PLAYER_RED ) defaultPos.gridX += 30;
 		setPiecePosition( defaultPos, j ); }
 
 	// Position pointers models
 	for( int i = 0; i < 4; i++ ) {
-		float x = -(float)m_boardSize/2.0f + 0.5f + 1.0f*m_startTile[i][0]; 
-		float y =  (float)m_boardSize/2.0f - 0.5f - 1.0f*m_startTile[i][1]; 
+		float x = -(float)m_core.getBoardSize( )/2.0f + 0.5f + 1.0f*m_core.getStartTile( i, 0 ); 
+		float y =  (float)m_core.getBoardSize( )/2.0f - 0.5f - 1.0f*m_core.getStartTile( i, 1 ); 
 		m_startMarker[i].setPosition( x, 0.0f, y );
 		m_startMarker[i].update( ); }
 }
 //
 // --------------------------------------------------------
-//	Checks the validity of the given move for the current
-//  player.
-// --------------------------------------------------------
-bool Match::isValidMove( Move move )
-{
-	// Check if piece pattern is available for use
-	if( move.pieceNumber < 0 || move.pieceNumber > 21 ||
-		!m_pieces[m_currentPlayer][move.pieceNumber] )
-		return false;
-
-	// Check for valid rotation angle
-	if( move.rotated < PIECE_ROTATE_0 ||
-		move.rotated > PIECE_ROTATE_270 )
-		return false;
-
-	// Run pattern analysis between grid and piece
-	bool coversLiberty = false;
-	int gx = move.gridX, gy = move.gridY;
-	int x = m_gamePieceLayouts->getSizeX( move.pieceNumber );
-	int y = m_gamePieceLayouts->getSizeY( move.pieceNumber );
-	if( move.flipped == PIECE_UNFLIPPED ) {
-		if( move.rotated == PIECE_ROTATE_0 ) {
-			for( int j = 0, gy = move.gridY; j < y; j++,gy++ )
-			for( int i = 0, gx = move.gridX; i < x; i++,gx++ )
-				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy ) ) return false; }
-
-		else if( move.rotated == PIECE_ROTATE_90 ) {
-			for( int i = x-1, gy = move.gridY; i >= 0; i--,gy++ )
-			for( int j =   0, gx = move.gridX; j <  y; j++,gx++ )
-				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy ) ) return false; }
-
-		else if( move.rotated == PIECE_ROTATE_180 ) {
-			for( int j = y-1, gy = move.gridY; j >= 0; j--,gy++ )
-			for( int i = x-1, gx = move.gridX; i >= 0; i--,gx++ )
-				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy ) ) return false; }
-
-		else if( move.rotated == PIECE_ROTATE_270 ) {
-			for( int i =   0, gy = move.gridY; i <  x; i++,gy++ )
-			for( int j = y-1, gx = move.gridX; j >= 0; j--,gx++ )
-				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy ) ) return false; }
-	} else {
-		if( move.rotated == PIECE_ROTATE_0 ) {
-			for( int j =   0, gy = move.gridY; j <  y; j++,gy++ )
-			for( int i = x-1, gx = move.gridX; i >= 0; i--,gx++ )
-				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy ) ) return false; }
-
-		else if( move.rotated == PIECE_ROTATE_90 ) {
-			for( int i = x-1, gy = move.gridY; i >= 0; i--,gy++ )
-			for( int j = y-1, gx = move.gridX; j >= 0; j--,gx++ )
-				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy ) ) return false; }
-
-		else if( move.rotated == PIECE_ROTATE_180 ) {
-			for( int j = y-1, gy = move.gridY; j >= 0; j--,gy++ )
-			for( int i =   0, gx = move.gridX; i <  x; i++,gx++ )
-				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy ) ) return false; }
-
-		else if( move.rotated == PIECE_ROTATE_270 ) {
-			for( int i = 0, gy = move.gridY; i < x; i++,gy++ )
-			for( int j = 0, gx = move.gridX; j < y; j++,gx++ )
-				if( !isValidPattern( move.pieceNumber, &coversLiberty, i, j, gx, gy ) ) return false; }
-	}
-
-	// Check if liberty is covered
-	if( coversLiberty ) return true;
-	else return false;
-}
-//
-// --------------------------------------------------------
-//	Checks if the patterns on the grid and piece are
-//	compatible and updates the liberty covered flag
-//	if necessary.
-// --------------------------------------------------------
-bool Match::isValidPattern( int pieceNumber, bool* liberty, 
-						   int px, int py, int gx, int gy )
-{
-	// Check for outside grid bounds on a covering tile
-	char piecePattern = m_gamePieceLayouts->indexOf( pieceNumber, px, py );
-	if( gx < 0 || gx >= m_boardSize || gy < 0 || gy >= m_boardSize ) 
-		if( piecePattern == MATCH_NOT_COVERED ) return false;
-		else return true;
-
-	// Check if local patterns are acceptable
-	char gridPattern = m_board[gx][gy];
-	switch( piecePattern ) {
-		case MATCH_NOT_PLAYERS: 
-			if( gridPattern == m_currentPlayer ) return false; break;
-		case MATCH_NOT_COVERED:
-			if( gridPattern != GRID_COVER_NONE ) return false; 
-			else if( gx == m_startTile[m_currentPlayer][0] &&
-					 gy == m_startTile[m_currentPlayer][1] ) *liberty = true; break;
-		case MATCH_LIBERTY:
-			if( gridPattern == m_currentPlayer ) *liberty = true; }
-
-	return true;
-}
-//
-// --------------------------------------------------------
 //	Updates the game data to reflect the execution of the
 //  valid input move.
 // --------------------------------------------------------
 void Match::makeMove( Move move )
 {
 	// Map the move to unique value
-	move.rotated %= m_gamePieceLayouts->getOrients( move.pieceNumber );
-	if( move.flipped && !m_gamePieceLayouts->getFlips( move.pieceNumber ) )
-	{ move.flipped = FALSE; move.rotated = (move.rotated + (move.rotated%2) ? 0 : 1 )%4; }
-
-	// Add the move to the move history
-	m_moveHistory[m_currentPly] = move;
-	m_currentPly++;
-
-	// Update piece registry
-	m_pieces[m_currentPlayer][move.pieceNumber] = false;
-
-	// Iterate over piece pattern and update game board
-	int gx = move.gridX, gy = move.gridY;
-	int x = m_gamePieceLayouts->getSizeX( move.pieceNumber );
-	int y = m_gamePieceLayouts->getSizeY( move.pieceNumber );
-	if( move.flipped == PIECE_UNFLIPPED )
-	{
-		if( move.rotated == PIECE_ROTATE_0 ) {
-			for( int j = 0, gy = move.gridY; j < y; j++,gy++ )
-			for( int i = 0, gx = move.gridX; i < x; i++,gx++ )
-				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = m_currentPlayer; }
-
-		else if( move.rotated == PIECE_ROTATE_90 ) {
-			for( int i = x-1, gy = move.gridY; i >= 0; i--,gy++ )
-			for( int j =   0, gx = move.gridX; j <  y; j++,gx++ )
-				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = m_currentPlayer; }
-
-		else if( move.rotated == PIECE_ROTATE_180 ) {
-			for( int j = y-1, gy = move.gridY; j >= 0; j--,gy++ )
-			for( int i = x-1, gx = move.gridX; i >= 0; i--,gx++ )
-				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = m_currentPlayer; }
-
-		else if( move.rotated == PIECE_ROTATE_270 ) {
-			for( int i =   0, gy = move.gridY; i <  x; i++,gy++ )
-			for( int j = y-1, gx = move.gridX; j >= 0; j--,gx++ )
-				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = m_currentPlayer; }
-	} else {
-		if( move.rotated == PIECE_ROTATE_0 ) {
-			for( int j =   0, gy = move.gridY; j <  y; j++,gy++ )
-			for( int i = x-1, gx = move.gridX; i >= 0; i--,gx++ )
-				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = m_currentPlayer; }
-
-		else if( move.rotated == PIECE_ROTATE_90 ) {
-			for( int i = x-1, gy = move.gridY; i >= 0; i--,gy++ )
-			for( int j = y-1, gx = move.gridX; j >= 0; j--,gx++ )
-				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = m_currentPlayer; }
-
-		else if( move.rotated == PIECE_ROTATE_180 ) {
-			for( int j = y-1, gy = move.gridY; j >= 0; j--,gy++ )
-			for( int i =   0, gx = move.gridX; i <  x; i++,gx++ )
-				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = m_currentPlayer; }
-
-		else if( move.rotated == PIECE_ROTATE_270 ) {
-			for( int i = 0, gy = move.gridY; i < x; i++,gy++ )
-			for( int j = 0, gx = move.gridX; j < y; j++,gx++ )
-				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = m_currentPlayer; }
-	}
+	move = m_core.getUniqueMove( move );
 
 	// Position 3D game piece
-	setPiecePosition( move, m_currentPlayer );
-
-	// Update player score variable
-	if     ( move.pieceNumber < 1 ) m_score[m_currentPlayer] += 1;
-	else if( move.pieceNumber < 2 ) m_score[m_currentPlayer] += 2;
-	else if( move.pieceNumber < 4 ) m_score[m_currentPlayer] += 3;
-	else if( move.pieceNumber < 9 ) m_score[m_currentPlayer] += 4;
-	else m_score[m_currentPlayer] += 5;
-
-	// Update current player variable
-	int prevPlayer = m_currentPlayer;
-	m_currentPlayer++; m_currentPlayer %= m_numberOfPlayers;
-	
-	// Skip turns for players unable to move
-	while( !isMoveAvailable( ) && prevPlayer != m_currentPlayer)
-	{
-		// Move to next player
-		m_currentPlayer++; m_currentPlayer %= m_numberOfPlayers;
-
-		// Put a skip move on the history
-		Move skip; skip.pieceNumber = -1;
-		skip.flipped = skip.gridX = skip.gridY = skip.rotated = 0;
-		m_moveHistory[m_currentPly] = skip;
-		m_currentPly++;
-	}
-
-	// Check for game over condition (if no one can move)
-	if( prevPlayer == m_currentPlayer && !isMoveAvailable( ) ) 
-	{
-		// Remove extra skips
-		for( int i = 0; i < m_numberOfPlayers; i++ ) 
-			m_currentPly--;
-
-		// Run end processes
-		onMatchEnd( );
-	}
-}
-//
-// --------------------------------------------------------
-//	Returns false if there is no available move for the 
-//	current player.
-// --------------------------------------------------------
-bool Match::isMoveAvailable( )
-{
-	Move move; 
-
-	// Cycle through available pieces
-	for( int i = 0; i < 21; i++ ) 
-	if( m_pieces[m_currentPlayer][i] )
-	{
-		move.pieceNumber = i;
-
-		// Cycle through all orients
-		for( int x = -1; x < m_boardSize-m_gamePieceLayouts->getSizeY( move.pieceNumber )+2; x++ )
-		for( int y = -1; y < m_boardSize-m_gamePieceLayouts->getSizeY( move.pieceNumber )+2; y++ )
-		for( int r = 0; r < m_gamePieceLayouts->getOrients( move.pieceNumber ); r++ )
-		for( int f = 0; f <= m_gamePieceLayouts->getFlips( move.pieceNumber ); f++ )
-		{
-			move.flipped = f;
-			move.rotated = r;
-			move.gridX = x;
-			move.gridY = y;
+	setPiecePosition( move, m_core.getCurrentPlayer( ) );
 
-			if( isValidMove( move ) ) 
-				return true;
-		}
-	}
+	// Play the move, passing for players unable to move
+	m_core.makeMove( move );
 
-	return false;
+	// Run end processes if no one can move
+	if( m_core.isOver( ) ) onMatchEnd( );
 }
 //
 // --------------------------------------------------------
@@ -865,8 +595,8 @@ DirectX::Vector3 Match::getPiecePosition( Move move )
 	float sizeX = (float)m_gamePieceLayouts->getSizeX( move.pieceNumber );
 	float sizeY = (float)m_gamePieceLayouts->getSizeY( move.pieceNumber );
 
-	float x = -(float)m_boardSize/2.0f + 0.5f + (float)move.gridX; 
-	float y =  (float)m_boardSize/2.0f - 0.5f - (float)move.gridY;
+	float x = -(float)m_core.getBoardSize( )/2.0f + 0.5f + (float)move.gridX; 
+	float y =  (float)m_core.getBoardSize( )/2.0f - 0.5f - (float)move.gridY;
 	DirectX::Vector3 position( x, move.flipped ? 0.2f : 0.0f, y );
 
 	if( move.flipped == PIECE_UNFLIPPED ) {
@@ -908,32 +638,13 @@ void Match::setPiecePosition( Move move, int player )
 // --------------------------------------------------------
 void Match::getAiMove( )
 {
-	// Copy board structure
-	for( int i = 0; i < 20; i++ )
-	for( int j = 0; j < 20; j++ )
-		m_memoryView[m_currentPlayer]->board[i][j] = m_board[i][j];
-
-	// Copy piece structure
-	for( int i = 0; i < 4;  i++ )
-	for( int j = 0; j < 21; j++ )
-		m_memoryView[m_currentPlayer]->pieces[i][j] = m_pieces[i][j];
+	GameData* data = m_memoryView[m_core.getCurrentPlayer( )];
 
-	// Copy move history structure
-	for( int i = 0; i < m_currentPly; i++ )
-		m_memoryView[m_currentPlayer]->moveHistory[i] = m_moveHistory[i];
-
-	// Copy score structure
-	for( int i = 0; i < 4; i++ )
-		m_memoryView[m_currentPlayer]->score[i] = m_score[i];
-
-	// Copy current move ply
-	m_memoryView[m_currentPlayer]->ply = m_currentPly;
-
-	// Copy player
-	m_memoryView[m_currentPlayer]->player = m_currentPlayer;
+	// Copy the match state
+	m_core.getGameState( data );
 
 	// Notify the ai process
-	m_memoryView[m_currentPlayer]->turnReady = TRUE;
+	data->turnReady = TRUE;
 }
 //
 // --------------------------------------------------------
@@ -971,9 +682,9 @@ void Match::buildMemoryMap( )
 void Match::setAiPlayer( int player, const wchar_t* name )
 {
 	// Check if the AI player is unchanged
-	if( ( m_currentPlayer != player && 
+	if( ( m_core.getCurrentPlayer( ) != player && 
 		m_agentFilename[player] == name ) ||
-		player > m_numberOfPlayers ) return;
+		player > m_core.getNumberOfPlayers( ) ) return;
 
 	// Terminate any pre-existing AI process
 	if( m_pinfo[player].hProcess ) {
@@ -987,19 +698,7 @@ void Match::setAiPlayer( int player, const wchar_t* name )
 		{ m_agentFilename[player] = L""; return; }
 
 	// Load match settings into mapped file
-	m_memoryView[player]->nPlayers = m_numberOfPlayers;
-	m_memoryView[player]->boardSize = m_boardSize;
-	m_memoryView[player]->player = player;
-
-	// Clear indicator variables
-	m_memoryView[player]->moveReady = FALSE;
-	m_memoryView[player]->matchOver = FALSE;
-	m_memoryView[player]->turnReady = FALSE;
-
-	// Load starting tiles into mapped file
-	for( int i = 0; i < m_numberOfPlayers; i++ ) {
-		m_memoryView[player]->startTile[i][0] = m_startTile[i][0];
-		m_memoryView[player]->startTile[i][1] = m_startTile[i][1]; }
+	m_core.getGameSettings( m_memoryView[player], player );
 
 	// Copy memory map filename 
 	wchar_t commandline[1024];
@@ -1046,8 +745,8 @@ void Match::stop( )
 		m_waitTurn = WAIT_HALTED; 
 
 	// Stop AI player execution
-	setAiPlayer( m_currentPlayer, 
-		m_agentFilename[m_currentPlayer].c_str( ) );
+	setAiPlayer( m_core.getCurrentPlayer( ), 
+		m_agentFilename[m_core.getCurrentPlayer( )].c_str( ) );
 }
 // 
 // --------------------------------------------------------
@@ -1055,101 +754,30 @@ void Match::stop( )
 // --------------------------------------------------------
 void Match::undoMove( )
 {
-	// Mark match incomplete
-	m_matchEnd = FALSE;
-
 	// Check if the is a prev move
-	if( m_currentPly == 0 ) return;
-
-	// Remove the move from the history
-	m_currentPly--; Move move = m_moveHistory[m_currentPly];
+	if( m_core.getPly( ) == 0 ) return;
 
 	// Terminate the ai process and reload
-	if( m_agentFilename[m_currentPlayer] != L"" )
-		setAiPlayer( m_currentPlayer, m_agentFilename[m_currentPlayer].c_str( ) );
+	int player = m_core.getCurrentPlayer( );
+	if( m_agentFilename[player] != L"" )
+		setAiPlayer( player, m_agentFilename[player].c_str( ) );
 
-	// Return to the previous player
-	if( !m_currentPlayer ) 
-		m_currentPlayer = m_numberOfPlayers;
-	m_currentPlayer--;
+	// Take the move back, returning to the previous player
+	Move move = m_core.undoPly( );
+	player = m_core.getCurrentPlayer( );
 
 	// Check if the move was a skip
 	if( move.pieceNumber == -1 ) { undoMove( ); return; }
 	m_undoHistory.push_front( move );
 
 	// If the next player is AI pause move
-	if( m_agentFilename[m_currentPlayer] != L"" && 
+	if( m_agentFilename[player] != L"" && 
 		m_waitTurn == WAIT_NONE ) m_waitTurn = WAIT_HALTED;
 
-	// Move the piece off the board
-	int x = m_gamePieceLayouts->getSizeX( move.pieceNumber );
-	int y = m_gamePieceLayouts->getSizeY( move.pieceNumber );
-	if( move.flipped == PIECE_UNFLIPPED )
-	{
-		if( move.rotated == PIECE_ROTATE_0 ) {
-			for( int j = 0, gy = move.gridY; j < y; j++,gy++ )
-			for( int i = 0, gx = move.gridX; i < x; i++,gx++ )
-				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = GRID_COVER_NONE; }
-
-		else if( move.rotated == PIECE_ROTATE_90 ) {
-			for( int i = x-1, gy = move.gridY; i >= 0; i--,gy++ )
-			for( int j =   0, gx = move.gridX; j <  y; j++,gx++ )
-				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = GRID_COVER_NONE; }
-
-		else if( move.rotated == PIECE_ROTATE_180 ) {
-			for( int j = y-1, gy = move.gridY; j >= 0; j--,gy++ )
-			for( int i = x-1, gx = move.gridX; i >= 0; i--,gx++ )
-				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = GRID_COVER_NONE; }
-
-		else if( move.rotated == PIECE_ROTATE_270 ) {
-			for( int i =   0, gy = move.gridY; i <  x; i++,gy++ )
-			for( int j = y-1, gx = move.gridX; j >= 0; j--,gx++ )
-				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = GRID_COVER_NONE; }
-	} else 
-	{
-		if( move.rotated == PIECE_ROTATE_0 ) {
-			for( int j =   0, gy = move.gridY; j <  y; j++,gy++ )
-			for( int i = x-1, gx = move.gridX; i >= 0; i--,gx++ )
-				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = GRID_COVER_NONE; }
-
-		else if( move.rotated == PIECE_ROTATE_90 ) {
-			for( int i = x-1, gy = move.gridY; i >= 0; i--,gy++ )
-			for( int j = y-1, gx = move.gridX; j >= 0; j--,gx++ )
-				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = GRID_COVER_NONE; }
-
-		else if( move.rotated == PIECE_ROTATE_180 ) {
-			for( int j = y-1, gy = move.gridY; j >= 0; j--,gy++ )
-			for( int i =   0, gx = move.gridX; i <  x; i++,gx++ )
-				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = GRID_COVER_NONE; }
-
-		else if( move.rotated == PIECE_ROTATE_270 ) {
-			for( int i = 0, gy = move.gridY; i < x; i++,gy++ )
-			for( int j = 0, gx = move.gridX; j < y; j++,gx++ )
-				if( m_gamePieceLayouts->indexOf( move.pieceNumber, i, j ) == MATCH_NOT_COVERED ) 
-					m_board[gx][gy] = GRID_COVER_NONE; }
-	}
-
 	// Move physical piece off the board
-	Move defaultPos = m_piecePosition[m_matchMode][move.pieceNumber];
-	if( m_currentPlayer == PLAYER_RED ) defaultPos.gridX += 30;
-	setPiecePosition( defaultPos, m_currentPlayer );
-
-	// Update piece registry
-	m_pieces[m_currentPlayer][move.pieceNumber] = true;
-
-	// Update player score variable
-	if     ( move.pieceNumber < 1 ) m_score[m_currentPlayer] -= 1;
-	else if( move.pieceNumber < 2 ) m_score[m_currentPlayer] -= 2;
-	else if( move.pieceNumber < 4 ) m_score[m_currentPlayer] -= 3;
-	else if( move.pieceNumber < 9 ) m_score[m_currentPlayer] -= 4;
-	else m_score[m_currentPlayer] -= 5;
+	Move defaultPos = m_piecePosition[m_core.getMatchMode( )][move.pieceNumber];
+	if( player == PLAYER_RED ) defaultPos.gridX += 30;
+	setPiecePosition( defaultPos, player );
 }
 //
 // --------------------------------------------------------
@@ -1168,7 +796,7 @@ void Match::redoMove( )
 	if( move.pieceNumber == NONE ) return;
 
 	// If the next player is AI pause
-	if( m_agentFilename[m_currentPlayer] != L"" && 
+	if( m_agentFilename[m_core.getCurrentPlayer( )] != L"" && 
 		m_waitTurn == WAIT_NONE ) m_waitTurn = WAIT_HALTED;
 	else if( m_waitTurn == WAIT_HALTED  ) m_waitTurn = WAIT_NONE;
 
@@ -1200,44 +828,8 @@ int Match::saveToDisk( const wchar_t* filename )
 	// Check for failure
 	if( !file.is_open( ) ) return FALSE;
 	 
-	// Write version header into the file
-	file << "// --------------------------------\n";
-	file << "//        Blokus Save File\n";
-	file << "// --------------------------------\n";
-
-	// Write match settings into the file
-	file << "\n// MatchSettings";
-	file << "\nNumber_Of_Players " << m_numberOfPlayers;
-	file << "\nSize_Of_Board "	   << m_boardSize;
-
-	// Write start tile data into the file
-	file << "\n\n// Start Tiles";
-	for( int i = 0; i < m_numberOfPlayers; i++ )
-		file << "\nStart_Tile " << i
-			<< " " << m_startTile[i][0]
-			<< " " << m_startTile[i][1];
-
-	// Write move history into the file
-	file << "\n\n// Move History";
-	for( int i = 0; i < m_currentPly; i++ ) {
-		Move move = m_moveHistory[i];
-		if( move.pieceNumber == NONE ) continue;
-		file << "\nMove" 
-			 << " " << move.pieceNumber 
-			 << " " << move.gridX
-			 << " " << move.gridY
-			 << " " << move.rotated
-			 << " " << move.flipped; }
-
-	// Write available pieces into the file
-	file << "\n\n// Available Pieces";
-	for( int i = 0; i < m_numberOfPlayers; i++ ) {
-		file << "\nPieces " << i << " ";
-		for( int j = 0; j < 21; j++ )
-			file << m_pieces[i][j]; }
-
-	// Write endl
-	file << "\n";
+	// Write the match into the file
+	if( !m_core.saveToStream( file ) ) return FALSE;
 
 	// Close file
 	file.close( );
@@ -1270,75 +862,17 @@ int Match::loadFromDisk( const wchar_t* filename )
 			  m_agentFilename[i] = L"";
 		   beginNewMatch( NULL ); }
 
-	// Parse file using newline and space delimiters 
-	std::string line; while( std::getline( file, line ) )
-	{
-		// Put line data onto stream for delimination
-		std::string token; std::stringstream iss; iss << line;
-
-		// Parse leading token on line
-		while( std::getline( iss, token, ' ' ) )
-		{
-			// Ignore line comments
-			if( token.substr( 0, 2 ) == "//" ) break;
-
-			// Read simple state and settings data
-			else if( token == "Number_Of_Players" ) iss >> m_numberOfPlayers;
-			else if( token == "Size_Of_Board" )		iss >> m_boardSize;
-			else if( token == "Wait_Turn" )	;
-			else if( token == "Wait_Game" )	;
-			else if( token == "Score" ) ; // Score, used for neural network
-
-			// Read starting tiles
-			else if( token == "Start_Tile" )
-			{
-				// Read in player start tile data
-				int playerNumber; iss >> playerNumber;
-				iss >> m_startTile[playerNumber][0];
-				iss >> m_startTile[playerNumber][1];
-			}
-
-			// Read player pieces
-			else if( token == "Pieces" )
-			{
-				// Get the player number
-				int playerNumber; iss >> playerNumber;
-
-				// Read the players piece bitstring
-				std::string bitStr; iss >> bitStr;
-				if( bitStr.size( ) != 21 ) return FALSE;
-				for( int i = 0; i < bitStr.size( ); i++ )
-					if( bitStr.at( i ) == '0' ) 
-						m_pieces[playerNumber][i] = false;
-					else m_pieces[playerNumber][i] = true;
-			}
+	// Replay the saved moves
+	if( !m_core.loadFromStream( file ) ) return FALSE;
 
-			// Read in move 
-			else if( token == "Move" ) 
-			{
-				Move move; 
-
-				// Get the move definition
-				iss >> move.pieceNumber;
-				iss >> move.gridX;
-				iss >> move.gridY;
-				iss >> move.rotated;
-				iss >> move.flipped;
-
-				// Convert to newer version
-				// if necessary to do so
-				move.rotated %= m_gamePieceLayouts->getOrients( move.pieceNumber );
-				if( move.flipped && !m_gamePieceLayouts->getFlips( move.pieceNumber ) )
-					move.flipped = FALSE;
-
-				// Make the move
-				makeMove( move );
-			}
+	// Position the 3D pieces of the replayed moves
+	for( int i = 0; i < m_core.getPly( ); i++ ) {
+		const Move& move = m_core.getMove( i );
+		if( move.pieceNumber != -1 ) setPiecePosition( 
+			move, i % m_core.getNumberOfPlayers( ) ); }
 
-			// Unexpected token
-			else return FALSE;
-		}
-	}
+	// Run end processes if the match was complete
+	if( m_core.isOver( ) ) onMatchEnd( );
 
 	// Close file
 	file.close( );
@@ -1384,13 +918,14 @@ void Match::displayDebugInfo( )
 
 	// Compose move history string
 	std::wstringstream strStream; strStream.str(L" ");
-	for( int i = 0; i < m_currentPly; i++ ) { 
+	for( int i = 0; i < m_core.getPly( ); i++ ) { 
+			const Move& move = m_core.getMove( i );
 			strStream << L"( ";
-			strStream << L"P:"  << m_moveHistory[i].pieceNumber;
-			strStream << L" X:" << m_moveHistory[i].gridX;
-			strStream << L" Y:" << m_moveHistory[i].gridY; 
-			strStream << L" F:" << m_moveHistory[i].flipped;
-			strStream << L" R:" << m_moveHistory[i].rotated; 
+			strStream << L"P:"  << move.pieceNumber;
+			strStream << L" X:" << move.gridX;
+			strStream << L" Y:" << move.gridY; 
+			strStream << L" F:" << move.flipped;
+			strStream << L" R:" << move.rotated; 
 			strStream << L" )";
 			strStream << "\n"; }
 
@@ -1398,15 +933,15 @@ void Match::displayDebugInfo( )
 	font->drawText( m_manager->getDisplayWidth( )-200, 0, strStream.str( ).c_str( ), COLOR::WHITE );
 
 	// Render grid internals
-	for( int i = 0; i < m_boardSize; i++ )
-	for( int j = 0; j < m_boardSize; j++ )
+	for( int i = 0; i < m_core.getBoardSize( ); i++ )
+	for( int j = 0; j < m_core.getBoardSize( ); j++ )
 	{
 		std::wstring str;
-		if( m_board[i][j] == GRID_COVER_BLUE   ) str = std::wstring( L"B" );
-		if( m_board[i][j] == GRID_COVER_RED    ) str = std::wstring( L"R" );
-		if( m_board[i][j] == GRID_COVER_GREEN  ) str = std::wstring( L"G" );
-		if( m_board[i][j] == GRID_COVER_YELLOW ) str = std::wstring( L"Y" );
-		if( m_board[i][j] == GRID_COVER_NONE   ) str = std::wstring( L"-" );
+		if( m_core.getBoard( i, j ) == GRID_COVER_BLUE   ) str = std::wstring( L"B" );
+		if( m_core.getBoard( i, j ) == GRID_COVER_RED    ) str = std::wstring( L"R" );
+		if( m_core.getBoard( i, j ) == GRID_COVER_GREEN  ) str = std::wstring( L"G" );
+		if( m_core.getBoard( i, j ) == GRID_COVER_YELLOW ) str = std::wstring( L"Y" );
+		if( m_core.getBoard( i, j ) == GRID_COVER_NONE   ) str = std::wstring( L"-" );
 		font->drawText( 50+15*i, 200+15*j, str.c_str( ), COLOR::WHITE );
 	}
 
@@ -1430,8 +965,8 @@ void Match::displayMatchInfo( )
 	DirectX::Font* font = &DirectX::EngineManager::instance( )->getWindowStyle( )->font;
 
 	// Render score value text
-	strStream.str(L" "); strStream << L"Scores - B: " << m_score[0] << L" R: " << m_score[1];
-	strStream << L"G: " << m_score[3] << L" Y: " << m_score[4];
+	strStream.str(L" "); strStream << L"Scores - B: " << m_core.getScore( 0 ) << L" R: " << m_core.getScore( 1 );
+	strStream << L"G: " << m_core.getScore( 2 ) << L" Y: " << m_core.getScore( 3 );
 	font->drawText( 300, 10, strStream.str( ).c_str( ), COLOR::WHITE );
 
 	// Render record value text
@@ -1441,16 +976,16 @@ void Match::displayMatchInfo( )
 
 	// Render current player
 	std::wstring playerToMove;
-	if( m_currentPlayer == PLAYER_BLUE   ) playerToMove = std::wstring( L"Next to move: Blue" );
-	if( m_currentPlayer == PLAYER_RED    ) playerToMove = std::wstring( L"Next to move: Red" );
-	if( m_currentPlayer == PLAYER_GREEN  ) playerToMove = std::wstring( L"Next to move: Green" );
-	if( m_currentPlayer == PLAYER_YELLOW ) playerToMove = std::wstring( L"Next to move: Yellow" );
+	if( m_core.getCurrentPlayer( ) == PLAYER_BLUE   ) playerToMove = std::wstring( L"Next to move: Blue" );
+	if( m_core.getCurrentPlayer( ) == PLAYER_RED    ) playerToMove = std::wstring( L"Next to move: Red" );
+	if( m_core.getCurrentPlayer( ) == PLAYER_GREEN  ) playerToMove = std::wstring( L"Next to move: Green" );
+	if( m_core.getCurrentPlayer( ) == PLAYER_YELLOW ) playerToMove = std::wstring( L"Next to move: Yellow" );
 	font->drawText( 300, 40, playerToMove.c_str( ), COLOR::WHITE );
 
 	// Display blinking wait messages for status indication
 	if( (m_manager->getRunningTime( ) - (float)(int)m_manager->getRunningTime( )) > 0.25f )
-		if( m_matchEnd ) 
+		if( m_core.isOver( ) ) 
 			font->drawText( 300, 55, L"Press ENTER to continue", COLOR::WHITE );
-		else if( m_waitTurn == WAIT_HALTED && m_agentFilename[m_currentPlayer] != L"" ) 
+		else if( m_waitTurn == WAIT_HALTED && m_agentFilename[m_core.getCurrentPlayer( )] != L"" ) 
 			font->drawText( 300, 55, L"Press SPACE to continue", COLOR::WHITE );
 }
@@ -71,7 +71,7 @@ public:
 	void stop( ); void play( ); void step( ); 
 
 	// Returns TRUE if the match is over
-	int isOver( ) { return m_matchEnd; }
+	int isOver( ) { return m_core.isOver( ); }
 						
 private:
 	// DirectX Engine Components
@@ -99,18 +99,8 @@ private:
 	// Piece layouts singleton
 	PieceSet* m_gamePieceLayouts;	
 
-	// Match State
-	Move m_moveHistory[42];			//< History of each move this game
-	int m_currentPly;				//< Current move ply
-	int m_startTile[4][2];			//< Start tile of each player
-	char m_board[20][20];			//< Game board state
-	int m_boardSize;				//< Size in tiles of game board
-	bool m_pieces[4][21];			//< Pieces remaining for each player
-	int m_currentPlayer;			//< Current player to move
-	int m_numberOfPlayers;			//< Number of players in this match
-	int m_matchMode;				//< Match mode (duo or classic)
-	int m_score[4];					//< Current score of each player
-	int m_matchEnd;					//< Match completed indicator
+	// Match rules and state
+	MatchCore m_core;
 
 	// Training and Analysis
 	int m_debugText;				//< Display extra debug information
@@ -147,8 +137,6 @@ private:
 
 	// Game play functions
 	void makeMove( Move move );
-	bool isValidMove( Move move );
-	bool isMoveAvailable( );
 
 	// AI player I/O
 	void buildMemoryMap( );
@@ -157,8 +145,6 @@ private:
 	// Piece processing helper functions
 	void setPiecePosition( Move move, int player );
 	DirectX::Vector3 getPiecePosition( Move move );
-	bool isValidPattern( int pieceNumber, bool* liberty, 
-			int px, int py, int gx, int gy );
 
 	// Debug Rendering functions
 	void displaySystemInfo( );
@@ -33,6 +33,7 @@
 // Game Header files
 #include "PieceSet.h"
 #include "Types.h" 
+#include "MatchCore.h"
 #include "Match.h"
 #include "MatchUI.h"
 #include "OpeningUI.h"
@@ -0,0 +1,364 @@
+/* ===========================================================================
+
+	Project: SPSA parameter tuner for the Beam AI player
+
+	Description:
+	  Tunes the Beam engine config by simultaneous perturbation stochastic
+	  approximation, scoring perturbed configs by headless self-play games.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Standard includes
+#include "Includes.h"
+#include <math.h>
+
+// Include header
+#include "Spsa.h"
+
+// Tuner settings
+#define CHECKPOINT_FNAME "SpsaCheckpoint.txt" //< Tuning progress checkpoint
+#define PLUS_FNAME  "SpsaPlus.txt"    //< Config of the plus perturbation
+#define MINUS_FNAME "SpsaMinus.txt"   //< Config of the minus perturbation
+#define RESULT_FNAME "SpsaResult"     //< Prefix of the worker result files
+#define MAX_WORKERS      64   //< Maximum worker process count
+#define OPENING_PLIES     4   //< Random plies opening each pair of games
+
+// SPSA gain sequences a/(k+1+A)^alpha and c/(k+1)^gamma,
+// in units of the parameter tuning steps
+#define SPSA_RATE      4.0    //< Step gain a per unit of match result
+#define SPSA_PERTURB   1.0    //< Perturbation gain c
+#define SPSA_STABILITY 0.1    //< Stability constant A as a fraction of the iterations
+#define SPSA_ALPHA     0.602  //< Step gain decay
+#define SPSA_GAMMA     0.101  //< Perturbation gain decay
+
+// --------------------------------------------------------
+//	SelectParameters - Selects the parameters to tune by
+//  name. Every parameter with a tuning step is selected
+//  when no names are given.
+// --------------------------------------------------------
+void Spsa::selectParameters( int nNames, char* names[] )
+{
+	// Select every tunable parameter
+	m_tuned.clear( );
+	if( nNames == 0 ) {
+		for( int i = 0; i < Config::nParameters; i++ )
+			if( Config::parameter[i].step > 0.0f ) m_tuned.push_back( i );
+		return; }
+
+	// Select the named parameters
+	for( int j = 0; j < nNames; j++ ) {
+		int i = 0; while( i < Config::nParameters && std::string( names[j] ) != Config::parameter[i].name ) i++;
+		if( i == Config::nParameters ) throw "Unknown parameter name";
+		if( Config::parameter[i].step <= 0.0f ) throw "Parameter is not tunable";
+		m_tuned.push_back( i ); }
+}
+//
+// --------------------------------------------------------
+//	Tune - Runs SPSA iterations until the iteration count
+//  is reached. Each iteration perturbs every tuned value
+//  by a random sign, plays the plus and minus configs
+//  against each other and steps along the estimated
+//  gradient of the result. The config file and the
+//  checkpoint are rewritten after every iteration.
+// --------------------------------------------------------
+void Spsa::tune( const char* executable, const char* filename, int iterations, int nGames )
+{
+	// Load the config, the checkpoint takes precedence
+	try { Config::load( filename );
+		std::cout << "Engine config " << filename << " loaded\n";
+	} catch( const char *s ) {
+		std::cout << "Using default engine config:\n	" << s << "\n"; }
+	m_iteration = 0; if( loadCheckpoint( ) )
+		std::cout << "Resuming from iteration " << m_iteration << "\n";
+
+	// Current parameter values
+	const int n = Config::nParameters;
+	std::vector<float> theta( n ); getConfig( &theta[0] );
+	int stability = (int)( SPSA_STABILITY * iterations );
+	srand( (unsigned int)time(NULL) );
+
+	// Tuning loop
+	while( m_iteration < iterations )
+	{
+		// Gains of the iteration
+		double a = SPSA_RATE / pow( m_iteration + 1.0 + stability, SPSA_ALPHA );
+		double c = SPSA_PERTURB / pow( m_iteration + 1.0, SPSA_GAMMA );
+
+		// Perturb the tuned parameters in random directions
+		std::vector<float> plus( theta ), minus( theta );
+		std::vector<int> delta( m_tuned.size( ) );
+		for( size_t j = 0; j < m_tuned.size( ); j++ ) {
+			int i = m_tuned[j]; delta[j] = ( rand( ) & 1 ) ? 1 : -1;
+			float shift = (float)( c * delta[j] ) * Config::parameter[i].step;
+			plus[i] += shift; minus[i] -= shift; }
+
+		// Write the perturbed configs for the workers
+		setConfig( &plus[0] ); Config::save( PLUS_FNAME );
+		setConfig( &minus[0] ); Config::save( MINUS_FNAME );
+
+		// Score the plus config against the minus config
+		float score = runWorkers( executable, m_iteration, nGames );
+		double result = 2.0*score - 1.0;
+
+		// Step along the gradient estimate, within the bounds
+		setConfig( &theta[0] );
+		for( size_t j = 0; j < m_tuned.size( ); j++ ) {
+			const Config::Parameter& p = Config::parameter[m_tuned[j]];
+			Config::set( p.name, *p.value + (float)( a*result / (2.0*c*delta[j]) ) * p.step ); }
+		getConfig( &theta[0] );
+
+		// Checkpoint the progress
+		m_iteration++; Config::save( filename ); saveCheckpoint( );
+
+		// Display the iteration results
+		std::cout << "Iteration " << m_iteration << ", plus score " << score << "\n";
+		for( size_t j = 0; j < m_tuned.size( ); j++ )
+			std::cout << "	" << Config::parameter[m_tuned[j]].name << " "
+					  << *Config::parameter[m_tuned[j]].value << "\n";
+	}
+}
+//
+// --------------------------------------------------------
+//	RunWorkers - Splits the games of an iteration into
+//  colour swapped pairs across one worker process per
+//  processor and waits for their results.
+// --------------------------------------------------------
+float Spsa::runWorkers( const char* executable, int iteration, int nGames )
+{
+	// Get the worker count
+	SYSTEM_INFO systemInfo; GetSystemInfo( &systemInfo );
+	int nPairs = max( nGames/2, 1 );
+	int nWorkers = min( min( (int)systemInfo.dwNumberOfProcessors, MAX_WORKERS ), nPairs );
+
+	// Launch the workers
+	HANDLE processHandles[MAX_WORKERS];
+	for( int w = 0; w < nWorkers; w++ )
+	{
+		// Remove any stale result
+		std::stringstream result; result << RESULT_FNAME << w << ".txt";
+		DeleteFileA( result.str( ).c_str( ) );
+
+		// Compose the worker command line
+		int games = 2*( nPairs*(w+1)/nWorkers - nPairs*w/nWorkers );
+		std::stringstream command; command << "\"" << executable << "\" -play "
+			<< PLUS_FNAME << " " << MINUS_FNAME << " " << games << " "
+			<< iteration*MAX_WORKERS + w << " " << result.str( );
+
+		// Create the worker process
+		STARTUPINFOA startupInfo; PROCESS_INFORMATION processInfo;
+		ZeroMemory( &startupInfo, sizeof(startupInfo) ); startupInfo.cb = sizeof(startupInfo);
+		std::string commandLine = command.str( );
+		if( !CreateProcessA( NULL, &commandLine[0], NULL, NULL, FALSE,
+				0, NULL, NULL, &startupInfo, &processInfo ) )
+			throw "Could not create worker process";
+		CloseHandle( processInfo.hThread );
+		processHandles[w] = processInfo.hProcess;
+	}
+
+	// Wait for all of the workers
+	WaitForMultipleObjects( nWorkers, processHandles, TRUE, INFINITE );
+	for( int w = 0; w < nWorkers; w++ ) CloseHandle( processHandles[w] );
+
+	// Gather the results
+	float totalScore = 0.0f; int totalGames = 0;
+	for( int w = 0; w < nWorkers; w++ ) {
+		std::stringstream result; result << RESULT_FNAME << w << ".txt";
+		std::ifstream file( result.str( ).c_str( ) ); float score; int games;
+		if( !(file >> score >> games) ) throw "Worker process failed";
+		totalScore += score; totalGames += games; }
+
+	return totalScore / (float)totalGames;
+}
+//
+// --------------------------------------------------------
+//	Play - Worker process entry. Starts the engine, loads
+//  both configs over its startup config and plays pairs
+//  of games sharing a random opening with the colours
+//  swapped.
+// --------------------------------------------------------
+void Spsa::play( const char* fileA, const char* fileB,
+	int nGames, unsigned int seed, const char* resultFile )
+{
+	// Silence the engine output
+	std::cout.setstate( std::ios::failbit );
+
+	// Start the engine
+	Minimax engine; int startTile[NUM_PLAYERS][2] = { { 4, 4 }, { 9, 9 } };
+	engine.startup( BOARD_SIZE, startTile, NUM_PLAYERS );
+
+	// Load the configs
+	const int n = Config::nParameters;
+	std::vector<float> base( n ), configA( n ), configB( n ); getConfig( &base[0] );
+	Config::load( fileA ); getConfig( &configA[0] ); setConfig( &base[0] );
+	Config::load( fileB ); getConfig( &configB[0] );
+	float* config[2] = { &configA[0], &configB[0] };
+
+	// Play the games
+	float score = 0.0f;
+	for( int g = 0; g < nGames; g++ )
+		score += playGame( engine, config, g%2, seed*1000 + g/2 );
+
+	// Shutdown the engine
+	engine.shutdown( );
+
+	// Write the result
+	std::ofstream file( resultFile, std::ios::trunc );
+	if( !file.is_open( ) ) throw "Could not open result file";
+	file << score << " " << nGames << "\n";
+}
+//
+// --------------------------------------------------------
+//	PlayGame - Plays a game between two configs without
+//  the simulator. The engine is reconfigured before each
+//  of its moves, and players without a move available
+//  pass until neither player can move.
+// --------------------------------------------------------
+float Spsa::playGame( Minimax& engine, float* config[2], int colourA, unsigned int seed )
+{
+	// Begin from the empty board
+	char board[20][20]; bool pieces[NUM_PLAYERS][21]; int score[NUM_PLAYERS] = { 0, 0 };
+	for( int i = 0; i < 20; i++ ) for( int j = 0; j < 20; j++ ) board[i][j] = GRID_COVER_NONE;
+	for( int p = 0; p < NUM_PLAYERS; p++ ) for( int i = 0; i < 21; i++ ) pieces[p][i] = true;
+	int startTile[NUM_PLAYERS][2] = { { 4, 4 }, { 9, 9 } };
+
+	// Move lists for move detection and the random opening
+	MoveLists moveLists; moveLists.allocateMemoryPool( 250 );
+	srand( seed );
+
+	// Game loop
+	Move moves[42]; int ply = 0, player = PLAYER_BLUE, nPasses = 0;
+	while( nPasses < NUM_PLAYERS )
+	{
+		// Reformat game board for move generation
+		short grid[14][14]; int newPieces[2];
+		MoveSimulator::reformatBoard( board, grid, pieces, newPieces, startTile );
+		moveLists.generateMoves( grid, newPieces );
+
+		// Get the first available move, waking all liberties if none are awake
+		const Move* move = NULL; if( moveLists.isMoveAvailable( player ) ) {
+			move = moveLists.getFirstMove( player, newPieces[player] );
+			if( move == NULL ) moveLists.clearLibertyModeSettings( );
+			move = moveLists.getFirstMove( player, newPieces[player] ); }
+
+		// Pass if no move is available
+		if( move == NULL ) nPasses++;
+		else
+		{
+			Move selected; nPasses = 0;
+
+			// Select a random opening move
+			if( ply < OPENING_PLIES ) {
+				int nMoves = 0; while( move ) { nMoves++; move = moveLists.getNextMove( ); }
+				int index = rand( ) % nMoves; move = moveLists.getFirstMove( player, newPieces[player] );
+				while( index-- ) move = moveLists.getNextMove( );
+				selected = *move; }
+
+			// Select a move with the config of the player
+			else {
+				setConfig( config[player == colourA ? 0 : 1] ); engine.configure( );
+				selected = engine.makeMove( board, pieces, score, player, ply, moves );
+				if( !MoveSimulator::isValidMove( &selected, grid, newPieces, player ) )
+					throw "Engine made an invalid move"; }
+
+			// Make the move
+			score[player] += MoveSimulator::applyMove( &selected, board, player );
+			pieces[player][selected.pieceNumber] = false;
+			moves[ply++] = selected;
+		}
+
+		// Return used memory chunks to pool
+		moveLists.deallocateMemoryChunks( );
+		player = 1 - player;
+	}
+
+	// Deallocate memory pool
+	moveLists.deallocateMemoryPool( );
+
+	// Score the game for config A
+	if( score[colourA] > score[1-colourA] ) return 1.0f;
+	if( score[colourA] < score[1-colourA] ) return 0.0f;
+	return 0.5f;
+}
+//
+// --------------------------------------------------------
+//	GetConfig - Copies every parameter value.
+// --------------------------------------------------------
+void Spsa::getConfig( float values[] )
+{
+	for( int i = 0; i < Config::nParameters; i++ )
+		values[i] = *Config::parameter[i].value;
+}
+//
+// --------------------------------------------------------
+//	SetConfig - Restores every parameter value.
+// --------------------------------------------------------
+void Spsa::setConfig( const float values[] )
+{
+	for( int i = 0; i < Config::nParameters; i++ )
+		*Config::parameter[i].value = values[i];
+}
+//
+// --------------------------------------------------------
+//	LoadCheckpoint - Loads the completed iteration count
+//  and the parameter values from the checkpoint file,
+//  returns false if there is no checkpoint.
+// --------------------------------------------------------
+bool Spsa::loadCheckpoint( )
+{
+	// Open the checkpoint file for reading
+	std::ifstream file( CHECKPOINT_FNAME );
+	if( !file.is_open( ) ) return false;
+
+	// Parse file using newline and space delimiters
+	std::string line; while( std::getline( file, line ) )
+	{
+		// Put line data onto stream for delimination
+		std::string token; std::stringstream iss; iss << line;
+		if( !(iss >> token) || token.substr( 0, 2 ) == "//" ) continue;
+
+		// Read the iteration count or a parameter
+		float value; if( !(iss >> value) ) throw "Error parsing checkpoint";
+		if( token == "Iteration" ) m_iteration = (int)value;
+		else Config::set( token, value );
+	}
+
+	return true;
+}
+//
+// --------------------------------------------------------
+//	SaveCheckpoint - Saves the completed iteration count
+//  and the parameter values to the checkpoint file.
+// --------------------------------------------------------
+void Spsa::saveCheckpoint( )
+{
+	// Open the checkpoint file for rewriting
+	std::ofstream file( CHECKPOINT_FNAME, std::ios::trunc );
+	if( !file.is_open( ) ) throw "Could not open checkpoint file";
+
+	// Write version header into the file
+	file << "// --------------------------------\n";
+	file << "//        SPSA Checkpoint\n";
+	file << "// --------------------------------\n\n";
+
+	// Write the progress and parameters
+	file << "Iteration " << m_iteration << "\n";
+	for( int i = 0; i < Config::nParameters; i++ )
+		file << Config::parameter[i].name << " " << *Config::parameter[i].value << "\n";
+}
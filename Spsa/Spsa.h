@@ -0,0 +1,71 @@
+/* ===========================================================================
+
+	Project: SPSA parameter tuner for the Beam AI player
+
+	Description:
+	  Tunes the Beam engine config by simultaneous perturbation stochastic
+	  approximation, scoring perturbed configs by headless self-play games.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Begin definition
+#ifndef SPSA_H
+#define SPSA_H
+
+// Define tuner
+class Spsa
+{
+public:
+	// Selects the tuned parameters, all parameters with
+	// a tuning step are tuned if none are specified
+	void selectParameters( int nNames, char* names[] );
+
+	// Tunes the engine config, resuming from the checkpoint if one
+	// exists. Worker processes are launched from the executable.
+	void tune( const char* executable, const char* filename, int iterations, int nGames );
+
+	// Worker process entry, plays games between two configs and
+	// writes the total score of the first config to the result file
+	static void play( const char* fileA, const char* fileB,
+		int nGames, unsigned int seed, const char* resultFile );
+
+private:
+	// Config snapshots of every parameter value
+	static void getConfig( float values[] );
+	static void setConfig( const float values[] );
+
+	// Headless self-play game, returns the score of config A
+	static float playGame( Minimax& engine, float* config[2],
+		int colourA, unsigned int seed );
+
+	// Plays the games of an iteration on worker processes,
+	// returns the mean score of the plus perturbation
+	float runWorkers( const char* executable, int iteration, int nGames );
+
+	// Checkpoint input and output
+	bool loadCheckpoint( );
+	void saveCheckpoint( );
+
+	std::vector<int> m_tuned;	//< Indices of the tuned parameters
+	int m_iteration;			//< Completed iterations
+};
+
+// End definition
+#endif
@@ -0,0 +1,69 @@
+/* ===========================================================================
+
+	Project: SPSA parameter tuner for the Beam AI player
+
+	Description:
+	  Tunes the Beam engine config with SPSA, or plays the self-play games
+	  of one iteration when launched as a worker process.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Standard Includes
+#include "Includes.h"
+
+// Include header
+#include "Spsa.h"
+
+// Tuner settings
+#define CONFIG_FNAME "BeamConfig.txt" //< Default engine config filename
+#define ITERATIONS    200  //< Default iteration count
+#define GAMES          32  //< Default games per iteration
+
+// Application entry point
+int main( int argc, char* argv[] )
+{
+	// Play the games of a worker process
+	if( argc > 1 && std::string( argv[1] ) == "-play" ) {
+		if( argc < 7 ) return 1;
+		try { Spsa::play( argv[2], argv[3], atoi( argv[4] ), (unsigned int)atoi( argv[5] ), argv[6] );
+		} catch( const char *s ) {
+			std::cerr << "Error playing games:\n	" << s << "\n\n"; return 1; }
+		return 0; }
+
+	// Display tuner header
+	std::cout << " ***************************\n";
+	std::cout << "    Beam SPSA Tuner\n";
+	std::cout << " ***************************\n";
+
+	// Read the command line
+	const char* filename = ( argc > 1 ) ? argv[1] : CONFIG_FNAME;
+	int iterations = ( argc > 2 ) ? atoi( argv[2] ) : ITERATIONS;
+	int nGames = ( argc > 3 ) ? atoi( argv[3] ) : GAMES;
+	if( argc < 2 ) std::cout << "Usage: Spsa [config file] [iterations] [games] [parameters...]\n";
+
+	// Tune the config
+	try { Spsa spsa;
+		spsa.selectParameters( max( argc-4, 0 ), argv+4 );
+		spsa.tune( argv[0], filename, iterations, nGames );
+	} catch( const char *s ) {
+		std::cerr << "Error tuning config:\n	" << s << "\n\n"; return 1; }
+
+	return 0;
+}
@@ -0,0 +1,363 @@
+/* ===========================================================================
+
+	Project: Weight tuner for the Beam AI player
+
+	Description:
+	  Fits the weights of the Beam weight heuristic to the outcomes of
+	  recorded games by minimizing the logistic loss over their positions.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Standard includes
+#include "Includes.h"
+#include <math.h>
+#include <float.h>
+
+// Include header
+#include "Tuner.h"
+
+// Tuner settings
+#define MAX_THREADS       4   //< Feature extraction and loss thread count
+#define SCALE_ITERATIONS 40   //< Golden section iterations of the scale fit
+
+// Adam optimizer settings
+#define ADAM_BETA1   0.9
+#define ADAM_BETA2   0.999
+#define ADAM_EPSILON 1e-8
+
+// --------------------------------------------------------
+//	LoadGames - Loads every save file in the directory.
+//  Files which are corrupt or not Blokus Duo games are
+//  reported and skipped.
+// --------------------------------------------------------
+int Tuner::loadGames( const char* directory )
+{
+	// Find the save files in the directory
+	std::string path = std::string( directory ) + "\\";
+	WIN32_FIND_DATAA findData; HANDLE find =
+		FindFirstFileA( (path + "*.sav").c_str( ), &findData );
+	if( find == INVALID_HANDLE_VALUE ) throw "Could not find any save files";
+
+	// Load each of the games
+	do { try { loadGame( (path + findData.cFileName).c_str( ) );
+		} catch( const char *s ) {
+			std::cerr << "Skipped " << findData.cFileName << ":\n	" << s << "\n"; } }
+	while( FindNextFileA( find, &findData ) );
+
+	// Close the search handle
+	FindClose( find );
+
+	return (int)m_games.size( );
+}
+//
+// --------------------------------------------------------
+//	LoadGame - Loads the start tiles and move history of a
+//  single save file. Skipped turns are not recorded in
+//  the file and are inferred when replaying the game.
+// --------------------------------------------------------
+void Tuner::loadGame( const char* filename )
+{
+	// Open the specified file for reading
+	std::ifstream file( filename );
+	if( !file.is_open( ) ) throw "Could not open save file";
+
+	// Default match settings
+	Game game; int nPlayers = NUM_PLAYERS, boardSize = BOARD_SIZE;
+	game.startTile[PLAYER_BLUE][0] = 4; game.startTile[PLAYER_BLUE][1] = 4;
+	game.startTile[PLAYER_RED][0]  = 9; game.startTile[PLAYER_RED][1]  = 9;
+
+	// Parse file using newline and space delimiters
+	std::string line; while( std::getline( file, line ) )
+	{
+		// Put line data onto stream for delimination
+		std::string token; std::stringstream iss; iss << line;
+		if( !(iss >> token) || token.substr( 0, 2 ) == "//" ) continue;
+
+		// Read match settings
+		if( token == "Number_Of_Players" ) iss >> nPlayers;
+		else if( token == "Size_Of_Board" ) iss >> boardSize;
+
+		// Read starting tiles
+		else if( token == "Start_Tile" ) {
+			int player; iss >> player;
+			if( player < 0 || player >= NUM_PLAYERS ) throw "Unsupported player count";
+			iss >> game.startTile[player][0] >> game.startTile[player][1]; }
+
+		// Read in move
+		else if( token == "Move" ) {
+			Move move; iss >> move.pieceNumber >> move.gridX >> move.gridY >> move.rotated >> move.flipped;
+			if( iss.fail( ) || move.pieceNumber < 0 || move.pieceNumber >= PIECE_COUNT ) throw "Error parsing move";
+			game.moves.push_back( move ); }
+
+		// Ignore data recomputed by the replay
+		else if( token == "Pieces" || token == "Score" ||
+				 token == "Wait_Turn" || token == "Wait_Game" ) ;
+
+		// Unexpected token
+		else throw "Unexpected token in save file";
+	}
+
+	// Verify the game is a Blokus Duo game
+	if( nPlayers != NUM_PLAYERS || boardSize != BOARD_SIZE )
+		throw "Unsupported match settings";
+
+	m_games.push_back( game );
+}
+//
+// --------------------------------------------------------
+//	ExtractFeatures - Replays the loaded games on several
+//  threads and collects the weight heuristic features of
+//  every position before a move, labelled with the final
+//  outcome of the game for the max player.
+// --------------------------------------------------------
+int Tuner::extractFeatures( )
+{
+	// Extract the features of the games on each thread
+	MtWork work[MAX_THREADS];
+	runThreads( &extractGameFeatures, work );
+
+	// Gather the positions from the threads
+	m_positions.clear( );
+	for( int i = 0; i < MAX_THREADS; i++ )
+		m_positions.insert( m_positions.end( ),
+			work[i].positions.begin( ), work[i].positions.end( ) );
+
+	return (int)m_positions.size( );
+}
+//
+// --------------------------------------------------------
+//	ExtractGameFeatures - Starting address of extraction
+//  threads. Replays every nThreads'th game, reformatting
+//  the board and generating its move lists before each
+//  move as the player would at the root of its search.
+// --------------------------------------------------------
+unsigned int __stdcall Tuner::extractGameFeatures( void* dataOut )
+{
+	// Get the work data
+	MtWork* work = (MtWork*)dataOut;
+	const std::vector<Game>& games = work->tuner->m_games;
+
+	// Thread move lists
+	MoveLists moveLists; moveLists.allocateMemoryPool( 250 );
+
+	// Replay the games assigned to the thread
+	for( int g = work->thread; g < (int)games.size( ); g += work->nThreads )
+	{
+		// Copy the start tiles for reformatting
+		int startTile[NUM_PLAYERS][2];
+		for( int p = 0; p < NUM_PLAYERS; p++ ) {
+			startTile[p][0] = games[g].startTile[p][0];
+			startTile[p][1] = games[g].startTile[p][1]; }
+
+		// Begin from the empty board
+		char board[20][20]; bool pieces[NUM_PLAYERS][21]; int score[NUM_PLAYERS] = { 0, 0 };
+		for( int i = 0; i < 20; i++ ) for( int j = 0; j < 20; j++ ) board[i][j] = GRID_COVER_NONE;
+		for( int p = 0; p < NUM_PLAYERS; p++ ) for( int i = 0; i < 21; i++ ) pieces[p][i] = true;
+
+		// Replay the move history
+		size_t first = work->positions.size( ); int player = PLAYER_BLUE;
+		for( size_t m = 0; m < games[g].moves.size( ); m++ )
+		{
+			const Move& move = games[g].moves[m];
+
+			// Reformat game board for move generation
+			short grid[14][14]; int newPieces[2];
+			MoveSimulator::reformatBoard( board, grid, pieces, newPieces, startTile );
+
+			// Infer skipped turns from the validity of the move
+			if( !MoveSimulator::isValidMove( &move, grid, newPieces, player ) ) player = 1 - player;
+			if( !MoveSimulator::isValidMove( &move, grid, newPieces, player ) ) {
+				std::cerr << "Invalid move " << m << " in game " << g << "\n";
+				work->positions.resize( first ); break; }
+
+			// Extract the features of the position
+			Position position; moveLists.generateMoves( grid, newPieces );
+			Heuristic::getWeightFeatures( &moveLists, grid, newPieces,
+				score, player, position.features );
+			moveLists.deallocateMemoryChunks( );
+			work->positions.push_back( position );
+
+			// Make the move
+			score[player] += MoveSimulator::applyMove( &move, board, player );
+			pieces[player][move.pieceNumber] = false;
+			player = 1 - player;
+		}
+
+		// Label the positions with the outcome of the game
+		float result = ( score[PLAYER_MAX] > score[PLAYER_MIN] ) ? 1.0f :
+					   ( score[PLAYER_MAX] < score[PLAYER_MIN] ) ? 0.0f : 0.5f;
+		for( size_t i = first; i < work->positions.size( ); i++ )
+			work->positions[i].result = result;
+	}
+
+	// Deallocate memory pool
+	moveLists.deallocateMemoryPool( );
+
+	return 0;
+}
+//
+// --------------------------------------------------------
+//	FitScale - Fits the scale relating the evaluation to
+//  the expected outcome with the current weights. The
+//  loss is convex in the scale, so a golden section
+//  search over its logarithm finds the minimum.
+// --------------------------------------------------------
+float Tuner::fitScale( )
+{
+	// Golden section search bounds on log10 of the scale
+	const double golden = 0.5*( sqrt( 5.0 ) - 1.0 );
+	double a = -7.0, b = 0.0;
+	double c = b - golden*(b-a), d = a + golden*(b-a);
+	double lossC = computeLoss( Heuristic::weights, pow( 10.0, c ), NULL );
+	double lossD = computeLoss( Heuristic::weights, pow( 10.0, d ), NULL );
+
+	// Narrow the bounds onto the minimum
+	for( int i = 0; i < SCALE_ITERATIONS; i++ )
+		if( lossC < lossD ) { b = d; d = c; lossD = lossC; c = b - golden*(b-a);
+			lossC = computeLoss( Heuristic::weights, pow( 10.0, c ), NULL ); }
+		else { a = c; c = d; lossC = lossD; d = a + golden*(b-a);
+			lossD = computeLoss( Heuristic::weights, pow( 10.0, d ), NULL ); }
+
+	// Store the fitted scale
+	m_scale = (float)pow( 10.0, 0.5*(a+b) );
+	std::cout << "Scale " << m_scale << ", loss "
+			  << computeLoss( Heuristic::weights, m_scale, NULL ) << "\n";
+
+	return m_scale;
+}
+//
+// --------------------------------------------------------
+//	FitWeights - Fits the heuristic weights to the outcomes
+//  with the Adam optimizer, holding the scale fixed. The
+//  weights with the lowest loss are kept.
+// --------------------------------------------------------
+float Tuner::fitWeights( int iterations, float rate )
+{
+	// Optimizer state
+	float weights[nWeights], bestWeights[nWeights]; double bestLoss = DBL_MAX;
+	double gradient[nWeights], moment[nWeights], variance[nWeights];
+	for( int k = 0; k < nWeights; k++ ) { weights[k] = Heuristic::weights[k];
+		moment[k] = 0.0; variance[k] = 0.0; }
+
+	// Descend the loss gradient
+	for( int t = 1; t <= iterations; t++ )
+	{
+		// Compute the loss and keep the best weights
+		double loss = computeLoss( weights, m_scale, gradient );
+		if( loss < bestLoss ) { bestLoss = loss;
+			for( int k = 0; k < nWeights; k++ ) bestWeights[k] = weights[k]; }
+		if( t == 1 || t % 100 == 0 )
+			std::cout << "Iteration " << t << ", loss " << loss << "\n";
+
+		// Update the weights with bias corrected moments
+		for( int k = 0; k < nWeights; k++ ) {
+			moment[k] = ADAM_BETA1*moment[k] + (1.0-ADAM_BETA1)*gradient[k];
+			variance[k] = ADAM_BETA2*variance[k] + (1.0-ADAM_BETA2)*gradient[k]*gradient[k];
+			double m = moment[k] / (1.0-pow( ADAM_BETA1, t ));
+			double v = variance[k] / (1.0-pow( ADAM_BETA2, t ));
+			weights[k] -= (float)( rate*m / (sqrt( v ) + ADAM_EPSILON) ); }
+	}
+
+	// Store the best weights
+	for( int k = 0; k < nWeights; k++ )
+		Heuristic::weights[k] = bestWeights[k];
+
+	return (float)bestLoss;
+}
+//
+// --------------------------------------------------------
+//	ComputeLoss - Computes the mean logistic loss of the
+//  predicted outcomes on several threads, along with its
+//  gradient with respect to the weights if specified.
+// --------------------------------------------------------
+double Tuner::computeLoss( const float weights[], double scale, double gradient[] )
+{
+	// Compute the partial sums on each thread
+	MtWork work[MAX_THREADS];
+	for( int i = 0; i < MAX_THREADS; i++ ) {
+		work[i].weights = weights; work[i].scale = scale; }
+	runThreads( &computePartialLoss, work );
+
+	// Sum the partial loss and gradient
+	double n = (double)m_positions.size( ), loss = 0.0;
+	if( gradient ) for( int k = 0; k < nWeights; k++ ) gradient[k] = 0.0;
+	for( int i = 0; i < MAX_THREADS; i++ ) { loss += work[i].loss;
+		if( gradient ) for( int k = 0; k < nWeights; k++ )
+			gradient[k] += work[i].gradient[k] / n; }
+
+	return loss / n;
+}
+//
+// --------------------------------------------------------
+//	ComputePartialLoss - Starting address of loss threads.
+//  Sums the loss and gradient over a contiguous range of
+//  the positions. The outcome is predicted as a logistic
+//  function of the scaled evaluation.
+// --------------------------------------------------------
+unsigned int __stdcall Tuner::computePartialLoss( void* dataOut )
+{
+	// Get the work data
+	MtWork* work = (MtWork*)dataOut;
+	const std::vector<Position>& positions = work->tuner->m_positions;
+
+	// Get the range of positions for the thread
+	size_t begin = positions.size( ) * work->thread / work->nThreads;
+	size_t end = positions.size( ) * (work->thread+1) / work->nThreads;
+
+	// Sum over the positions
+	work->loss = 0.0;
+	for( int k = 0; k < nWeights; k++ ) work->gradient[k] = 0.0;
+	for( size_t i = begin; i < end; i++ )
+	{
+		// Evaluate the position
+		const Position& position = positions[i]; double value = 0.0;
+		for( int k = 0; k < nWeights; k++ )
+			value += work->weights[k] * position.features[k];
+		double z = work->scale * value;
+
+		// Logistic loss, computed without overflow for large values
+		work->loss += log( 1.0 + exp( -fabs( z ) ) ) + max( z, 0.0 ) - position.result*z;
+
+		// Loss gradient
+		double error = 1.0 / (1.0 + exp( -z )) - position.result;
+		for( int k = 0; k < nWeights; k++ )
+			work->gradient[k] += error * work->scale * position.features[k];
+	}
+
+	return 0;
+}
+//
+// --------------------------------------------------------
+//	RunThreads - Runs the work function on MAX_THREADS
+//  threads, each with its own work data, and waits for
+//  all of them to complete.
+// --------------------------------------------------------
+void Tuner::runThreads( unsigned int (__stdcall *function)( void* ), MtWork work[] )
+{
+	// Launch the threads
+	HANDLE threadHandles[MAX_THREADS];
+	for( int i = 0; i < MAX_THREADS; i++ ) {
+		work[i].tuner = this; work[i].thread = i; work[i].nThreads = MAX_THREADS;
+		threadHandles[i] = (HANDLE)_beginthreadex( NULL, 0, function, (void*)&work[i], 0, NULL ); }
+
+	// Wait for all of the threads
+	WaitForMultipleObjects( MAX_THREADS, threadHandles, TRUE, INFINITE );
+	for( int i = 0; i < MAX_THREADS; i++ ) CloseHandle( threadHandles[i] );
+}
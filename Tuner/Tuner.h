@@ -0,0 +1,80 @@
+/* ===========================================================================
+
+	Project: Weight tuner for the Beam AI player
+
+	Description:
+	  Fits the weights of the Beam weight heuristic to the outcomes of
+	  recorded games by minimizing the logistic loss over their positions.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Begin definition
+#ifndef TUNER_H
+#define TUNER_H
+
+// Define tuner
+class Tuner
+{
+public:
+	// Loads the games from the save files in a directory,
+	// returns the number of games loaded
+	int loadGames( const char* directory );
+
+	// Replays the loaded games and extracts the features
+	// of each position, returns the number of positions
+	int extractFeatures( );
+
+	// Fits the scale of the evaluation to the outcomes
+	float fitScale( );
+
+	// Fits the weights to the outcomes, returns the final loss
+	float fitWeights( int iterations, float rate );
+
+private:
+	// Recorded game structure
+	struct Game { int startTile[2][2]; std::vector<Move> moves; };
+
+	// Position feature vector and outcome for the max player
+	struct Position { int features[nWeights]; float result; };
+
+	// Multi-threading work communication structure
+	struct MtWork { Tuner* tuner; int thread; int nThreads; std::vector<Position> positions;
+					const float* weights; double scale; double loss; double gradient[nWeights]; };
+
+	// Loads a single save file
+	void loadGame( const char* filename );
+
+	// Threaded feature extraction and loss functions
+	static unsigned int __stdcall extractGameFeatures( void* dataOut );
+	static unsigned int __stdcall computePartialLoss( void* dataOut );
+
+	// Computes the mean loss and its gradient over all positions
+	double computeLoss( const float weights[], double scale, double gradient[] );
+
+	// Runs a work function on each thread and waits for them
+	void runThreads( unsigned int (__stdcall *function)( void* ), MtWork work[] );
+
+	std::vector<Game> m_games;			//< Loaded games
+	std::vector<Position> m_positions;	//< Extracted positions
+	float m_scale;						//< Evaluation to outcome scale
+};
+
+// End definition
+#endif
@@ -0,0 +1,92 @@
+/* ===========================================================================
+
+	Project: Weight tuner for the Beam AI player
+
+	Description:
+	  Fits the Beam weight heuristic to a directory of save files and writes
+	  the tuned weights into the config loaded by the Beam player.
+
+    Copyright (C) 2011 Lucas Sherman, David Gloe, Mary Southern, Tobias Gulden
+
+	Lucas Sherman, email: LucasASherman@gmail.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+=========================================================================== */
+
+// Standard Includes
+#include "Includes.h"
+
+// Include header
+#include "Tuner.h"
+
+// Tuner settings
+#define CONFIG_FNAME "BeamConfig.txt" //< Default engine config filename
+#define ITERATIONS     1000  //< Default optimizer iteration count
+#define LEARNING_RATE  1.0f  //< Optimizer step size in evaluation units
+
+// Application entry point
+int main( int argc, char* argv[] )
+{
+	// Display tuner header
+	std::cout << " ***************************\n";
+	std::cout << "    Beam Weight Tuner\n";
+	std::cout << " ***************************\n";
+
+	// Display usage information
+	if( argc < 2 ) { std::cout << "Usage: Tuner <save directory> [config file] [iterations]\n"; return 1; }
+	const char* directory = argv[1];
+	const char* filename = ( argc > 2 ) ? argv[2] : CONFIG_FNAME;
+	int iterations = ( argc > 3 ) ? atoi( argv[3] ) : ITERATIONS;
+
+	// Load piece configurations
+	PieceSet::initPieceConfigurations( );
+
+	// Continue from the weights of an existing config
+	try { Config::load( filename );
+		std::cout << "Starting from engine config " << filename << "\n";
+	} catch( const char* ) {
+		std::cout << "Starting from default engine config\n"; }
+
+	// Tune the weights
+	Tuner tuner; Timer timer; timer.start( );
+	try {
+		// Load the games
+		int nGames = tuner.loadGames( directory );
+		timer.update( ); std::cout << "Loaded " << nGames << " games in "
+			<< timer.getElapsedTime( ) << " seconds\n";
+
+		// Extract the position features
+		int nPositions = tuner.extractFeatures( );
+		if( !nPositions ) throw "No positions to tune on";
+		timer.update( ); std::cout << "Extracted " << nPositions << " positions in "
+			<< timer.getElapsedTime( ) << " seconds\n";
+
+		// Fit the scale and then the weights
+		tuner.fitScale( );
+		float loss = tuner.fitWeights( iterations, LEARNING_RATE );
+		timer.update( ); std::cout << "Fit weights with loss " << loss << " in "
+			<< timer.getElapsedTime( ) << " seconds\n";
+
+		// Save the weights with the rest of the config
+		Config::save( filename );
+		for( int i = nEngineParameters; i < Config::nParameters; i++ )
+			std::cout << Config::parameter[i].name << " " << *Config::parameter[i].value << "\n";
+		std::cout << "Engine config saved to " << filename << "\n";
+	}
+	catch( const char *s ) {
+		std::cerr << "Error tuning weights:\n	" << s << "\n\n"; return 1; }
+
+	return 0;
+}